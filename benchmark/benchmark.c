@@ -0,0 +1,151 @@
+#include "benchmark.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_check.h"
+#include "lpg_cli.h"
+#include "lpg_load_module.h"
+#include "lpg_prefetch_modules.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static void fail_on_parse_error(complete_parse_error const error, callback_user const user)
+{
+    (void)user;
+    fprintf(stderr, "Parse error in line %u\n", (unsigned)(error.relative.where.line + 1));
+    abort();
+}
+
+static void fail_on_semantic_error(complete_semantic_error const error, void *const user)
+{
+    (void)user;
+    fprintf(stderr, "Semantic error in line %u\n", (unsigned)(error.relative.where.line + 1));
+    abort();
+}
+
+static success_indicator write_to_stderr(void *const user, char const *const data, size_t const length)
+{
+    (void)user;
+    if (fwrite(data, 1, length, stderr) == length)
+    {
+        return success_yes;
+    }
+    return success_no;
+}
+
+static external_function_result assert_impl(value const *const captures, void *environment, optional_value const self,
+                                            value *const arguments, interpreter *const context)
+{
+    (void)context;
+    (void)self;
+    (void)captures;
+    (void)environment;
+    ASSUME(arguments[0].kind == value_kind_enum_element);
+    ASSERT(value_as_enum_element(arguments[0]).which == 1);
+    return external_function_result_from_success(value_from_unit());
+}
+
+void benchmark_program_compile(benchmark_program *const compiled, char const *const source)
+{
+    benchmark_program_compile_in(compiled, unicode_view_from_c_str("benchmark.lpg"), unicode_view_from_c_str(source),
+                                 unicode_view_from_c_str(LPG_BENCHMARK_MODULE_DIRECTORY));
+}
+
+void benchmark_program_compile_in(benchmark_program *const compiled, unicode_view const file_name,
+                                  unicode_view const source_view, unicode_view const current_import_directory)
+{
+    benchmark_program_compile_prefetched(compiled, file_name, source_view, current_import_directory, 0);
+}
+
+void benchmark_program_compile_prefetched(benchmark_program *const compiled, unicode_view const file_name,
+                                          unicode_view const source_view, unicode_view const current_import_directory,
+                                          size_t const parse_threads)
+{
+    compiled->standard_library = describe_standard_library();
+    source_file_lines_owning const lines = source_file_lines_owning_scan(source_view);
+    stream_writer const diagnostics = {write_to_stderr, NULL};
+    cli_parser_user user = {diagnostics, false};
+    expression_pool pool = expression_pool_create();
+    optional_sequence const root = parse(user, file_name, source_view, source_file_lines_from_owning(lines), &pool);
+    ASSERT(root.has_value);
+    module_loader loader =
+        module_loader_create(unicode_view_from_c_str(LPG_BENCHMARK_MODULE_DIRECTORY), fail_on_parse_error, NULL);
+    module_cache modules = module_cache_create();
+    if (parse_threads > 0)
+    {
+        loader.cache = &modules;
+        prefetch_modules(&loader, root.value, current_import_directory, parse_threads);
+    }
+    compiled->checked = check(root.value, compiled->standard_library.globals, fail_on_semantic_error, &loader,
+                              source_file_create(file_name, source_view, source_file_lines_from_owning(lines)),
+                              current_import_directory, default_compile_time_budget(1000000), NULL, NULL);
+    module_cache_free(modules);
+    sequence_free(&root.value);
+    expression_pool_free(pool);
+    source_file_lines_owning_free(lines);
+
+    structure const globals = compiled->standard_library.globals;
+    ASSUME(globals.count == standard_library_element_count);
+    for (size_t i = 0; i < standard_library_element_count; ++i)
+    {
+        optional_value const compile_time_value = globals.members[i].compile_time_value;
+        compiled->globals[i] = compile_time_value.is_set ? compile_time_value.value_ : value_from_unit();
+    }
+    garbage_collector *const boxes = &compiled->standard_library.stable->memory;
+    compiled->globals[0] = value_from_function_pointer(
+        function_pointer_value_from_external(side_effect_impl, NULL, NULL, *globals.members[0].what.function_pointer_),
+        boxes);
+    compiled->globals[4] = value_from_function_pointer(
+        function_pointer_value_from_external(assert_impl, NULL, NULL, *globals.members[4].what.function_pointer_),
+        boxes);
+}
+
+void benchmark_program_free(benchmark_program const *const freed)
+{
+    checked_program_free(&freed->checked);
+    standard_library_description_free(&freed->standard_library);
+}
+
+benchmark_run_result benchmark_program_run(benchmark_program const *const program, benchmark_interpreter const which,
+                                           size_t const max_recursion, uint64_t const max_executed_instructions)
+{
+    garbage_collector gc = garbage_collector_create_collecting(SIZE_MAX, 1024 * 1024);
+    value_stack stack = value_stack_create();
+    bytecode_cache compiled_functions = bytecode_cache_create();
+    execution_usage usage = execution_usage_create();
+    interpreter context = interpreter_create(
+        program->globals, &gc, &stack, (which == benchmark_interpreter_bytecode) ? &compiled_functions : NULL,
+        &program->checked.functions, &program->checked.interfaces,
+        execution_budget_create(max_executed_instructions, max_recursion, interpreter_default_max_frame_memory,
+                                SIZE_MAX, duration_from_milliseconds(execution_budget_no_deadline)),
+        &usage);
+    size_t const allocations_before = count_total_allocations();
+    duration const started_at = read_monotonic_clock();
+    external_function_result const result = call_checked_function(
+        program->checked.functions[0], optional_function_id_create(0), NULL, optional_value_empty, NULL, &context);
+    duration const finished_at = read_monotonic_clock();
+    size_t const allocations_after = count_total_allocations();
+    bytecode_cache_free(compiled_functions);
+    value_stack_free(stack);
+    garbage_collector_statistics const heap = gc.statistics;
+    garbage_collector_free(gc);
+    benchmark_run_result const run = {result.code,
+                                      usage.executed_instructions,
+                                      (allocations_after - allocations_before),
+                                      absolute_duration_difference(started_at, finished_at),
+                                      heap,
+                                      usage.peak_frame_memory};
+    return run;
+}
+
+void benchmark_report(char const *const name, uint64_t const operations, char const *const operation_name,
+                      benchmark_run_result const result)
+{
+    uint64_t const milliseconds = (result.how_long.milliseconds > 0) ? result.how_long.milliseconds : 1;
+    printf("%-32s %8" PRIu64 " ms %12" PRIu64 " %s/s %12" PRIu64 " instructions %10zu allocations\n", name,
+           result.how_long.milliseconds, ((operations * 1000u) / milliseconds), operation_name,
+           result.executed_instructions, result.dynamic_allocations);
+    printf("%-32s %12" PRIu64 " bytes allocated %12" PRIu64 " bytes collected %10zu bytes peak %10zu collections\n",
+           "", result.heap.allocated_bytes, result.heap.collected_bytes, result.heap.peak_heap_size,
+           result.heap.collections);
+}
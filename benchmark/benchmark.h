@@ -0,0 +1,47 @@
+#pragma once
+#include "lpg_checked_program.h"
+#include "lpg_interpret.h"
+#include "lpg_monotonic_clock.h"
+#include "lpg_standard_library.h"
+
+typedef struct benchmark_program
+{
+    standard_library_description standard_library;
+    checked_program checked;
+    value globals[standard_library_element_count];
+} benchmark_program;
+
+/*aborts if the source code contains any error*/
+void benchmark_program_compile(LPG_NON_NULL(benchmark_program *const compiled), char const *const source);
+/*like benchmark_program_compile, but modules are also imported from current_import_directory*/
+void benchmark_program_compile_in(LPG_NON_NULL(benchmark_program *const compiled), unicode_view const file_name,
+                                  unicode_view const source, unicode_view const current_import_directory);
+/*like benchmark_program_compile_in, but the imported modules are parsed by parse_threads threads before the program
+ * is checked. 0 parses them while checking like benchmark_program_compile_in.*/
+void benchmark_program_compile_prefetched(LPG_NON_NULL(benchmark_program *const compiled), unicode_view const file_name,
+                                          unicode_view const source, unicode_view const current_import_directory,
+                                          size_t const parse_threads);
+void benchmark_program_free(LPG_NON_NULL(benchmark_program const *const freed));
+
+typedef struct benchmark_run_result
+{
+    external_function_result_code code;
+    uint64_t executed_instructions;
+    size_t dynamic_allocations;
+    duration how_long;
+    garbage_collector_statistics heap;
+    /*the largest amount of memory that the register frames of the interpreter have occupied at the same time*/
+    size_t peak_frame_memory;
+} benchmark_run_result;
+
+typedef enum benchmark_interpreter {
+    benchmark_interpreter_bytecode,
+    benchmark_interpreter_tree_walker
+} benchmark_interpreter;
+
+benchmark_run_result benchmark_program_run(LPG_NON_NULL(benchmark_program const *const program),
+                                           benchmark_interpreter const which, size_t const max_recursion,
+                                           uint64_t const max_executed_instructions);
+
+void benchmark_report(char const *const name, uint64_t const operations, char const *const operation_name,
+                      benchmark_run_result const result);
@@ -0,0 +1,47 @@
+#include "benchmark_calls.h"
+#include "benchmark.h"
+#include "lpg_assert.h"
+
+char const *const benchmark_fibonacci_source = "let std = import std\n"
+                                               "let integers = import integer\n"
+                                               "let integer = integers.integer\n"
+                                               "let fibonacci = (n: integer): integer\n"
+                                               "    match integer_less(n, 2)\n"
+                                               "        case boolean.true:\n"
+                                               "            n\n"
+                                               "        case boolean.false:\n"
+                                               "            match subtract(n, 1)\n"
+                                               "                case subtract_result.ok(let a):\n"
+                                               "                    match subtract(n, 2)\n"
+                                               "                        case subtract_result.ok(let b):\n"
+                                               "                            match add(fibonacci(a), fibonacci(b))\n"
+                                               "                                case add_result.ok(let sum):\n"
+                                               "                                    sum\n"
+                                               "                                case add_result.overflow:\n"
+                                               "                                    fail()\n"
+                                               "                        case subtract_result.underflow:\n"
+                                               "                            fail()\n"
+                                               "                case subtract_result.underflow:\n"
+                                               "                    fail()\n"
+                                               "fibonacci(std.runtime_value[integer](24))\n";
+
+void benchmark_calls(void)
+{
+    benchmark_program program;
+    benchmark_program_compile(&program, benchmark_fibonacci_source);
+    /*fibonacci(24) calls fibonacci 2 * fibonacci(25) - 1 times*/
+    uint64_t const calls = (2 * 75025) - 1;
+    {
+        benchmark_run_result const result =
+            benchmark_program_run(&program, benchmark_interpreter_bytecode, 1000, UINT64_MAX);
+        ASSERT(result.code == external_function_result_success);
+        benchmark_report("calls (fibonacci)", calls, "calls", result);
+    }
+    {
+        benchmark_run_result const result =
+            benchmark_program_run(&program, benchmark_interpreter_tree_walker, 1000, UINT64_MAX);
+        ASSERT(result.code == external_function_result_success);
+        benchmark_report("calls (fibonacci, tree walker)", calls, "calls", result);
+    }
+    benchmark_program_free(&program);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+/*computes fibonacci(24) with one call per step of the recursion*/
+extern char const *const benchmark_fibonacci_source;
+
+void benchmark_calls(void);
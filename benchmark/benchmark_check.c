@@ -0,0 +1,319 @@
+#include "benchmark_check.h"
+#include "benchmark.h"
+#include "lpg_allocate.h"
+#include "lpg_array_size.h"
+#include "lpg_assert.h"
+#include "lpg_cli.h"
+#include "lpg_path.h"
+#include "lpg_read_file.h"
+#include "lpg_write_file.h"
+#include <stdio.h>
+#include <string.h>
+
+static void write_line(memory_writer *const source, size_t const indentation, char const *const format, size_t const a,
+                       size_t const b)
+{
+    for (size_t i = 0; i < indentation; ++i)
+    {
+        ASSERT(memory_writer_write(source, "    ", 4) == success_yes);
+    }
+    char line[128];
+    int const length = snprintf(line, sizeof(line), format, a, b);
+    ASSERT(length > 0);
+    ASSERT((size_t)length < sizeof(line));
+    ASSERT(memory_writer_write(source, line, (size_t)length) == success_yes);
+}
+
+/*Every integer range is a different type argument, so every line instantiates the generics again. The second half of
+ * the program refers to the same instantiations again.*/
+static memory_writer generate_instantiations(size_t const distinct_arguments)
+{
+    memory_writer source = {NULL, 0, 0};
+    ASSERT(memory_writer_write(&source, "let std = import std\n", 21) == success_yes);
+    for (size_t repetition = 0; repetition < 2; ++repetition)
+    {
+        for (size_t i = 0; i < distinct_arguments; ++i)
+        {
+            size_t const name = ((repetition * distinct_arguments) + i);
+            write_line(&source, 0, "let option_%zu = std.option[int(0, %zu)]\n", name, i);
+            write_line(&source, 0, "let array_%zu = std.array[int(0, %zu)]\n", name, i);
+        }
+    }
+    return source;
+}
+
+/*The innermost of the nested lambdas reads every variable of the outermost function.*/
+static memory_writer generate_locals(size_t const variable_count, size_t const depth)
+{
+    memory_writer source = {NULL, 0, 0};
+    ASSERT(memory_writer_write(&source, "let v0 = 0\n", 11) == success_yes);
+    for (size_t i = 1; i < variable_count; ++i)
+    {
+        write_line(&source, 0, "let v%zu = v%zu\n", i, (i - 1));
+    }
+    for (size_t i = 0; i < depth; ++i)
+    {
+        write_line(&source, i, "let f%zu = ()\n", i, 0);
+    }
+    for (size_t i = 0; i < variable_count; ++i)
+    {
+        write_line(&source, depth, "let r%zu = v%zu\n", i, i);
+    }
+    return source;
+}
+
+/*Every conversion looks up the implementation of one of many implementations of the same interface.*/
+static memory_writer generate_implementations(size_t const implementation_count)
+{
+    memory_writer source = {NULL, 0, 0};
+    char const header[] = "let shape = interface\n"
+                          "    area(): int(0, 1)\n";
+    ASSERT(memory_writer_write(&source, header, sizeof(header) - 1) == success_yes);
+    for (size_t i = 0; i < implementation_count; ++i)
+    {
+        write_line(&source, 0, "impl shape for int(0, %zu)\n", i, 0);
+        write_line(&source, 1, "area(): int(0, 1)\n", 0, 0);
+        write_line(&source, 2, "1\n", 0, 0);
+    }
+    for (size_t i = 0; i < implementation_count; ++i)
+    {
+        write_line(&source, 0, "let v%zu : int(0, %zu) = 0\n", i, i);
+        write_line(&source, 0, "let c%zu : shape = v%zu\n", i, i);
+        write_line(&source, 0, "let a%zu = c%zu.area()\n", i, i);
+    }
+    return source;
+}
+
+/*Module i imports the modules 2i+1 and 2i+2, so the imports form a binary tree. Every module defines functions that
+ * take some time to parse, but only a few instructions to evaluate.*/
+static void generate_modules(unicode_view const directory, size_t const module_count, size_t const function_count)
+{
+    ASSERT(create_directory(directory) == success_yes);
+    for (size_t i = 0; i < module_count; ++i)
+    {
+        memory_writer source = {NULL, 0, 0};
+        for (size_t child = ((i * 2) + 1); child <= ((i * 2) + 2); ++child)
+        {
+            if (child < module_count)
+            {
+                write_line(&source, 0, "let child_%zu = import module_%zu\n", child, child);
+            }
+        }
+        write_line(&source, 0, "let t = int(0, 100)\n", 0, 0);
+        for (size_t k = 0; k < function_count; ++k)
+        {
+            write_line(&source, 0, "let f%zu = (a: t)\n", k, 0);
+            for (size_t line = 0; line < 10; ++line)
+            {
+                write_line(&source, 1, "let b%zu = a\n", line, 0);
+            }
+            write_line(&source, 1, "a\n", 0, 0);
+        }
+        write_line(&source, 0, "let export = struct\n", 0, 0);
+        write_line(&source, 1, "f0: type_of(f0)\n", 0, 0);
+        write_line(&source, 0, "export{f0}\n", 0, 0);
+        char file_name[64];
+        int const length = snprintf(file_name, sizeof(file_name), "module_%zu.lpg", i);
+        ASSERT(length > 0);
+        unicode_view const pieces[] = {directory, unicode_view_create(file_name, (size_t)length)};
+        unicode_string const path = path_combine(pieces, LPG_ARRAY_SIZE(pieces));
+        ASSERT(write_file(unicode_view_from_string(path), memory_writer_content(source)) == success_yes);
+        unicode_string_free(&path);
+        memory_writer_free(&source);
+    }
+}
+
+static void report_check_in(char const *const name, memory_writer const source, uint64_t const operations,
+                            char const *const operation_name, unicode_view const import_directory,
+                            size_t const parse_threads)
+{
+    size_t const allocations_before = count_total_allocations();
+    duration const started_at = read_monotonic_clock();
+    benchmark_program program;
+    benchmark_program_compile_prefetched(&program, unicode_view_from_c_str("benchmark.lpg"),
+                                         memory_writer_content(source), import_directory, parse_threads);
+    benchmark_run_result result;
+    memset(&result, 0, sizeof(result));
+    result.code = external_function_result_success;
+    result.how_long = absolute_duration_difference(read_monotonic_clock(), started_at);
+    result.dynamic_allocations = (count_total_allocations() - allocations_before);
+    benchmark_report(name, operations, operation_name, result);
+    benchmark_program_free(&program);
+}
+
+static void report_check(char const *const name, memory_writer const source, uint64_t const operations,
+                         char const *const operation_name)
+{
+    report_check_in(name, source, operations, operation_name,
+                    unicode_view_from_c_str(LPG_BENCHMARK_MODULE_DIRECTORY), 0);
+}
+
+/*checks a program that is too small to be measured a number of times*/
+static void report_repeated_check(char const *const name, memory_writer const source, size_t const repetitions,
+                                  uint64_t const operations, char const *const operation_name)
+{
+    size_t const allocations_before = count_total_allocations();
+    duration const started_at = read_monotonic_clock();
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        benchmark_program program;
+        benchmark_program_compile_prefetched(&program, unicode_view_from_c_str("benchmark.lpg"),
+                                             memory_writer_content(source),
+                                             unicode_view_from_c_str(LPG_BENCHMARK_MODULE_DIRECTORY), 0);
+        benchmark_program_free(&program);
+    }
+    benchmark_run_result result;
+    memset(&result, 0, sizeof(result));
+    result.code = external_function_result_success;
+    result.how_long = absolute_duration_difference(read_monotonic_clock(), started_at);
+    result.dynamic_allocations = (count_total_allocations() - allocations_before);
+    benchmark_report(name, (operations * repetitions), operation_name, result);
+}
+
+#ifdef __linux__
+typedef struct watch_benchmark
+{
+    unicode_view edited_module;
+    blob original_content;
+    size_t edits;
+    duration edited_at;
+    size_t allocations_at_edit;
+    benchmark_run_result first_build;
+    /*the sum over all the rebuilds*/
+    benchmark_run_result rebuilds;
+} watch_benchmark;
+
+/*changes a leaf module after every build, so that only this module has to be parsed again*/
+static bool edit_after_build(size_t const builds, bool const has_error, void *user)
+{
+    ASSERT(!has_error);
+    watch_benchmark *const state = user;
+    benchmark_run_result *const measured = (builds == 1) ? &state->first_build : &state->rebuilds;
+    measured->how_long.milliseconds +=
+        absolute_duration_difference(read_monotonic_clock(), state->edited_at).milliseconds;
+    measured->dynamic_allocations += (count_total_allocations() - state->allocations_at_edit);
+    if (builds > state->edits)
+    {
+        return false;
+    }
+    memory_writer edited = {NULL, 0, 0};
+    write_line(&edited, 0, "let edit_%zu = %zu\n", builds, builds);
+    ASSERT(success_yes == memory_writer_write(&edited, state->original_content.data, state->original_content.length));
+    state->edited_at = read_monotonic_clock();
+    state->allocations_at_edit = count_total_allocations();
+    ASSERT(success_yes == write_file(state->edited_module, memory_writer_content(edited)));
+    memory_writer_free(&edited);
+    return true;
+}
+
+/*Compares the time from saving a module to the result of lpg watch with a build that starts from nothing. The edited
+ * leaf is imported by every module on the way to the root of the tree, so all of them are checked again.*/
+static void benchmark_watch(unicode_view const directory, size_t const module_count)
+{
+    unicode_view const main_pieces[] = {directory, unicode_view_from_c_str("main.lpg")};
+    unicode_string main_file = path_combine(main_pieces, LPG_ARRAY_SIZE(main_pieces));
+    ASSERT(success_yes == write_file(unicode_view_from_string(main_file),
+                                     unicode_view_from_c_str("let root = import module_0\n")));
+    char leaf_name[64];
+    int const leaf_length = snprintf(leaf_name, sizeof(leaf_name), "module_%zu.lpg", (module_count - 1));
+    ASSERT(leaf_length > 0);
+    unicode_view const leaf_pieces[] = {directory, unicode_view_create(leaf_name, (size_t)leaf_length)};
+    unicode_string const leaf = path_combine(leaf_pieces, LPG_ARRAY_SIZE(leaf_pieces));
+    blob_or_error const original = read_file_unicode_view_name(unicode_view_from_string(leaf));
+    ASSERT(!original.error);
+    memory_writer diagnostics = {NULL, 0, 0};
+    benchmark_run_result empty;
+    memset(&empty, 0, sizeof(empty));
+    empty.code = external_function_result_success;
+
+    char *cold_arguments[] = {"lpg", "run", unicode_string_c_str(&main_file)};
+    benchmark_run_result cold = empty;
+    size_t const allocations_before = count_total_allocations();
+    duration const cold_started_at = read_monotonic_clock();
+    ASSERT(!run_cli(LPG_ARRAY_SIZE(cold_arguments), cold_arguments, memory_writer_erase(&diagnostics), directory,
+                    unicode_view_from_c_str(LPG_BENCHMARK_MODULE_DIRECTORY)));
+    cold.how_long = absolute_duration_difference(read_monotonic_clock(), cold_started_at);
+    cold.dynamic_allocations = (count_total_allocations() - allocations_before);
+    benchmark_report("build (modules, cold)", module_count, "modules", cold);
+
+    char *watch_arguments[] = {"lpg", "watch", unicode_string_c_str(&main_file), "run"};
+    compiler_arguments const arguments = parse_compiler_arguments(LPG_ARRAY_SIZE(watch_arguments), watch_arguments);
+    ASSERT(arguments.valid);
+    watch_benchmark state = {unicode_view_from_string(leaf), original.success, 10, read_monotonic_clock(),
+                             count_total_allocations(), empty, empty};
+    ASSERT(!run_watch(&arguments, memory_writer_erase(&diagnostics), directory,
+                      unicode_view_from_c_str(LPG_BENCHMARK_MODULE_DIRECTORY), edit_after_build, &state));
+    ASSERT(diagnostics.used == 0);
+    benchmark_report("watch (modules, first build)", module_count, "modules", state.first_build);
+    state.rebuilds.how_long.milliseconds /= state.edits;
+    state.rebuilds.dynamic_allocations /= state.edits;
+    benchmark_report("watch (modules, edit to result)", module_count, "modules", state.rebuilds);
+
+    ASSERT(success_yes == write_file(unicode_view_from_string(leaf),
+                                     unicode_view_create(original.success.data, original.success.length)));
+    memory_writer_free(&diagnostics);
+    blob_free(&original.success);
+    unicode_string_free(&leaf);
+    ASSERT(0 == remove(unicode_string_c_str(&main_file)));
+    unicode_string_free(&main_file);
+}
+#endif
+
+void benchmark_check(void)
+{
+    {
+        char const *const modules[] = {"algorithm", "array",  "c_ffi", "ecmascript", "equality", "integer",
+                                       "option",    "ranges", "set",   "std",        "unit"};
+        memory_writer source = {NULL, 0, 0};
+        for (size_t i = 0; i < LPG_ARRAY_SIZE(modules); ++i)
+        {
+            ASSERT(success_yes == stream_writer_write_string(memory_writer_erase(&source), "let "));
+            ASSERT(success_yes == stream_writer_write_string(memory_writer_erase(&source), modules[i]));
+            ASSERT(success_yes == stream_writer_write_string(memory_writer_erase(&source), " = import "));
+            ASSERT(success_yes == stream_writer_write_string(memory_writer_erase(&source), modules[i]));
+            ASSERT(success_yes == stream_writer_write_string(memory_writer_erase(&source), "\n"));
+        }
+        report_repeated_check("check (standard library)", source, 100, LPG_ARRAY_SIZE(modules), "modules");
+        memory_writer_free(&source);
+    }
+    {
+        size_t const distinct_arguments = 2000;
+        memory_writer source = generate_instantiations(distinct_arguments);
+        report_check("check (option[T], array[T])", source, (distinct_arguments * 4), "lookups");
+        memory_writer_free(&source);
+    }
+    {
+        size_t const variable_count = 4000;
+        size_t const depth = 8;
+        memory_writer source = generate_locals(variable_count, depth);
+        report_check("check (local variables)", source, (variable_count * 2), "lookups");
+        memory_writer_free(&source);
+    }
+    {
+        size_t const implementation_count = 2000;
+        memory_writer source = generate_implementations(implementation_count);
+        report_check("check (implementations)", source, (implementation_count * 3), "lookups");
+        memory_writer_free(&source);
+    }
+    {
+        size_t const module_count = 48;
+        unicode_string const executable = get_current_executable_path();
+        unicode_view const pieces[] = {
+            path_remove_leaf(unicode_view_from_string(executable)), unicode_view_from_c_str("benchmark_modules")};
+        unicode_string const directory = path_combine(pieces, LPG_ARRAY_SIZE(pieces));
+        unicode_string_free(&executable);
+        generate_modules(unicode_view_from_string(directory), module_count, 50);
+        memory_writer source = {NULL, 0, 0};
+        write_line(&source, 0, "let root = import module_%zu\n", 0, 0);
+        report_check_in("check (modules)", source, module_count, "modules", unicode_view_from_string(directory), 0);
+        report_check_in("check (modules, 1 parse thread)", source, module_count, "modules",
+                        unicode_view_from_string(directory), 1);
+        report_check_in("check (modules, 4 parse threads)", source, module_count, "modules",
+                        unicode_view_from_string(directory), 4);
+#ifdef __linux__
+        benchmark_watch(unicode_view_from_string(directory), module_count);
+#endif
+        memory_writer_free(&source);
+        unicode_string_free(&directory);
+    }
+}
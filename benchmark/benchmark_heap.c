@@ -0,0 +1,34 @@
+#include "benchmark_heap.h"
+#include "benchmark.h"
+#include "lpg_assert.h"
+
+/*every iteration creates two strings that are garbage right away, so the heap should not grow with the number of
+ * iterations*/
+static char const *const strings_source = "let std = import std\n"
+                                          "let integers = import integer\n"
+                                          "let integer = integers.integer\n"
+                                          "let i = std.make_mutable[integer](0)\n"
+                                          "loop\n"
+                                          "    match integer_equals(i.load(), 100000)\n"
+                                          "        case boolean.true:\n"
+                                          "            break\n"
+                                          "        case boolean.false:\n"
+                                          "            std.unit_value\n"
+                                          "    let garbage = concat(integer_to_string(i.load()), \" bottles\")\n"
+                                          "    match add(i.load(), 1)\n"
+                                          "        case add_result.ok(let next):\n"
+                                          "            i.store(next)\n"
+                                          "        case add_result.overflow:\n"
+                                          "            fail()\n";
+
+void benchmark_heap(void)
+{
+    benchmark_program program;
+    benchmark_program_compile(&program, strings_source);
+    uint64_t const iterations = 100000;
+    benchmark_run_result const result =
+        benchmark_program_run(&program, benchmark_interpreter_bytecode, 1000, UINT64_MAX);
+    ASSERT(result.code == external_function_result_success);
+    benchmark_report("heap (temporary strings)", iterations, "iterations", result);
+    benchmark_program_free(&program);
+}
@@ -0,0 +1,55 @@
+#include "benchmark_integers.h"
+#include "benchmark.h"
+#include "lpg_assert.h"
+
+/*sums the integers from 0 to 99999 with algorithm.enumerate*/
+static char const *const enumerate_source = "let std = import std\n"
+                                            "let integers = import integer\n"
+                                            "let integer = integers.integer\n"
+                                            "let algorithm = import algorithm\n"
+                                            "let sum = std.make_mutable[integer](0)\n"
+                                            "let on_element = (element: integer): std.unit\n"
+                                            "    match add(sum.load(), element)\n"
+                                            "        case add_result.ok(let next):\n"
+                                            "            sum.store(next)\n"
+                                            "        case add_result.overflow:\n"
+                                            "            fail()\n"
+                                            "algorithm.enumerate[type_of(on_element)](0, "
+                                            "std.runtime_value[integer](99999), on_element)\n"
+                                            "assert(integer_equals(sum.load(), 4999950000))\n";
+
+/*counts down with subtract and compares with integer_less in every iteration*/
+static char const *const count_down_source = "let std = import std\n"
+                                             "let integers = import integer\n"
+                                             "let integer = integers.integer\n"
+                                             "let i = std.make_mutable[integer](std.runtime_value[integer](100000))\n"
+                                             "loop\n"
+                                             "    match integer_less(i.load(), 1)\n"
+                                             "        case boolean.true:\n"
+                                             "            break\n"
+                                             "        case boolean.false:\n"
+                                             "            std.unit_value\n"
+                                             "    match subtract(i.load(), 1)\n"
+                                             "        case subtract_result.ok(let next):\n"
+                                             "            i.store(next)\n"
+                                             "        case subtract_result.underflow:\n"
+                                             "            fail()\n"
+                                             "assert(integer_equals(i.load(), 0))\n";
+
+static void run_counting_loop(char const *const name, char const *const source)
+{
+    benchmark_program program;
+    benchmark_program_compile(&program, source);
+    uint64_t const iterations = 100000;
+    benchmark_run_result const result =
+        benchmark_program_run(&program, benchmark_interpreter_bytecode, 1000, UINT64_MAX);
+    ASSERT(result.code == external_function_result_success);
+    benchmark_report(name, iterations, "iterations", result);
+    benchmark_program_free(&program);
+}
+
+void benchmark_integers(void)
+{
+    run_counting_loop("integers (algorithm.enumerate)", enumerate_source);
+    run_counting_loop("integers (count down)", count_down_source);
+}
@@ -0,0 +1,26 @@
+#include "benchmark_memory.h"
+#include "benchmark.h"
+#include "lpg_assert.h"
+#include "lpg_read_file.h"
+#include <stdio.h>
+
+/*Runs all the programs in tests/in_lpg_2 to see how much memory values occupy in registers, in the heap of the
+ * interpreter and in the memory of the checked program.*/
+void benchmark_memory(void)
+{
+    blob_or_error const source = read_file(LPG_BENCHMARK_IN_LPG_2_DIRECTORY "/all_tests.lpg");
+    ASSERT(!source.error);
+    benchmark_program program;
+    benchmark_program_compile_in(&program, unicode_view_from_c_str("all_tests.lpg"),
+                                 unicode_view_create(source.success.data, source.success.length),
+                                 unicode_view_from_c_str(LPG_BENCHMARK_IN_LPG_2_DIRECTORY));
+    blob_free(&source.success);
+    garbage_collector_statistics const checked = program.checked.memory.statistics;
+    benchmark_run_result const result =
+        benchmark_program_run(&program, benchmark_interpreter_bytecode, 1000, UINT64_MAX);
+    ASSERT(result.code == external_function_result_success);
+    benchmark_report("memory (tests/in_lpg_2)", 1, "runs", result);
+    printf("%-32s %12zu bytes per value %10zu bytes peak frames %10zu bytes checked program\n", "", sizeof(value),
+           result.peak_frame_memory, checked.peak_heap_size);
+    benchmark_program_free(&program);
+}
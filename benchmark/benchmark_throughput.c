@@ -0,0 +1,68 @@
+#include "benchmark_throughput.h"
+#include "benchmark.h"
+#include "benchmark_calls.h"
+#include "lpg_allocate.h"
+#include "lpg_array_size.h"
+#include "lpg_assert.h"
+#include "lpg_execution.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+/*Runs the same checked program many times on a growing number of threads. Every thread has its own heap and stack,
+ * so the executions per second should grow with the number of threads until the cores are all busy.*/
+void benchmark_throughput(void)
+{
+    benchmark_program program;
+    benchmark_program_compile(&program, benchmark_fibonacci_source);
+    shared_program const shared = shared_program_create(&program.checked, program.globals);
+    size_t const execution_count = 16;
+    execution_result *const results = allocate_array(execution_count, sizeof(*results));
+    static size_t const thread_counts[] = {1, 2, 4, 8};
+    uint64_t single_threaded_rate = 0;
+    for (size_t i = 0; i < LPG_ARRAY_SIZE(thread_counts); ++i)
+    {
+        duration const started_at = read_monotonic_clock();
+        execute_in_parallel(&shared,
+                            execution_budget_create(UINT64_MAX, 1000, interpreter_default_max_frame_memory, SIZE_MAX,
+                                                    duration_from_milliseconds(execution_budget_no_deadline)),
+                            execution_count, thread_counts[i], results);
+        duration const finished_at = read_monotonic_clock();
+        for (size_t k = 0; k < execution_count; ++k)
+        {
+            ASSERT(results[k].code == external_function_result_success);
+            ASSERT(results[k].usage.executed_instructions == results[0].usage.executed_instructions);
+        }
+        uint64_t const milliseconds = absolute_duration_difference(started_at, finished_at).milliseconds;
+        uint64_t const rate = ((execution_count * 1000u) / ((milliseconds > 0) ? milliseconds : 1));
+        if (i == 0)
+        {
+            single_threaded_rate = ((rate > 0) ? rate : 1);
+        }
+        printf("throughput (fibonacci, %zu threads) %8" PRIu64 " ms %8" PRIu64 " executions/s %6" PRIu64
+               "%% of one thread\n",
+               thread_counts[i], milliseconds, rate, ((rate * 100u) / single_threaded_rate));
+    }
+    /*the same executions taking turns on one thread show the cost of suspending and resuming*/
+    static uint64_t const slices[] = {100, 10000};
+    for (size_t i = 0; i < LPG_ARRAY_SIZE(slices); ++i)
+    {
+        duration const started_at = read_monotonic_clock();
+        execute_round_robin(&shared,
+                            execution_budget_create(UINT64_MAX, 1000, interpreter_default_max_frame_memory, SIZE_MAX,
+                                                    duration_from_milliseconds(execution_budget_no_deadline)),
+                            execution_count, slices[i], results);
+        duration const finished_at = read_monotonic_clock();
+        for (size_t k = 0; k < execution_count; ++k)
+        {
+            ASSERT(results[k].code == external_function_result_success);
+        }
+        uint64_t const milliseconds = absolute_duration_difference(started_at, finished_at).milliseconds;
+        uint64_t const rate = ((execution_count * 1000u) / ((milliseconds > 0) ? milliseconds : 1));
+        printf("round robin (fibonacci, slice %" PRIu64 ") %8" PRIu64 " ms %8" PRIu64 " executions/s %6" PRIu64
+               "%% of one thread\n",
+               slices[i], milliseconds, rate, ((rate * 100u) / single_threaded_rate));
+    }
+    deallocate(results);
+    shared_program_free(shared);
+    benchmark_program_free(&program);
+}
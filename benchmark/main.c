@@ -0,0 +1,40 @@
+#include "benchmark_calls.h"
+#include "benchmark_check.h"
+#include "benchmark_heap.h"
+#include "benchmark_integers.h"
+#include "benchmark_memory.h"
+#include "benchmark_throughput.h"
+#include "lpg_allocate.h"
+#include "lpg_array_size.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef struct named_benchmark
+{
+    char const *name;
+    void (*run)(void);
+} named_benchmark;
+
+int main(int const argc, char **const argv)
+{
+    static named_benchmark const benchmarks[] = {{"calls", benchmark_calls},
+                                                 {"check", benchmark_check},
+                                                 {"heap", benchmark_heap},
+                                                 {"integers", benchmark_integers},
+                                                 {"memory", benchmark_memory},
+                                                 {"throughput", benchmark_throughput}};
+    for (size_t i = 0; i < LPG_ARRAY_SIZE(benchmarks); ++i)
+    {
+        if ((argc >= 2) && strcmp(argv[1], benchmarks[i].name))
+        {
+            continue;
+        }
+        benchmarks[i].run();
+    }
+    if (count_active_allocations() != 0)
+    {
+        printf("Detected memory leak, %zu active allocation(s)\n", count_active_allocations());
+        return 1;
+    }
+    return 0;
+}
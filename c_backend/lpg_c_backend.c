@@ -2,6 +2,7 @@
 #include "lpg_allocate.h"
 #include "lpg_assert.h"
 #include "lpg_instruction.h"
+#include "lpg_match_table.h"
 #include "lpg_standard_library.h"
 #include "lpg_structure_member.h"
 #include <string.h>
@@ -579,11 +580,33 @@ static success_indicator generate_function_name(function_id const id, stream_wri
     return success_yes;
 }
 
+/*The backend creates some tuple types itself, for example for method pointers and for tuple instructions. These are
+ * not interned in the program, so tuples are matched by their elements here.*/
+static bool is_same_definition(type const defined, type const needle)
+{
+    if ((defined.kind != type_kind_tuple) || (needle.kind != type_kind_tuple))
+    {
+        return type_equals(defined, needle);
+    }
+    if (defined.tuple_.length != needle.tuple_.length)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < defined.tuple_.length; ++i)
+    {
+        if (!type_equals(defined.tuple_.elements[i], needle.tuple_.elements[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 static unicode_string const *find_type_definition(type_definitions const definitions, type const needle)
 {
     for (size_t i = 0; i < definitions.count; ++i)
     {
-        if (type_equals(definitions.elements[i].what, needle))
+        if (is_same_definition(definitions.elements[i].what, needle))
         {
             return &definitions.elements[i].name;
         }
@@ -1552,11 +1575,11 @@ static success_indicator generate_value(value const generated, type const type_o
     {
     case value_kind_integer:
     {
-        if (integer_less(generated.integer_, integer_create(1, 0)))
+        if (integer_less(value_as_integer(generated), integer_create(1, 0)))
         {
             char buffer[40];
             unicode_view const formatted =
-                integer_format(generated.integer_, lower_case_digits, 10, buffer, sizeof(buffer));
+                integer_format(value_as_integer(generated), lower_case_digits, 10, buffer, sizeof(buffer));
             LPG_TRY(stream_writer_write_unicode_view(c_output, formatted));
             LPG_TRY(stream_writer_write_string(c_output, "u"));
             return success_yes;
@@ -1567,12 +1590,12 @@ static success_indicator generate_value(value const generated, type const type_o
     case value_kind_string:
         state->standard_library.using_string = true;
         LPG_TRY(stream_writer_write_string(c_output, "string_literal("));
-        LPG_TRY(encode_string_literal(generated.string, c_output));
+        LPG_TRY(encode_string_literal(value_as_string(generated), c_output));
         LPG_TRY(stream_writer_write_string(c_output, ", "));
         {
             char buffer[40];
             unicode_view const formatted = integer_format(
-                integer_create(0, generated.string.length), lower_case_digits, 10, buffer, sizeof(buffer));
+                integer_create(0, value_as_string(generated).length), lower_case_digits, 10, buffer, sizeof(buffer));
             LPG_TRY(stream_writer_write_unicode_view(c_output, formatted));
         }
         LPG_TRY(stream_writer_write_string(c_output, ")"));
@@ -1580,41 +1603,41 @@ static success_indicator generate_value(value const generated, type const type_o
 
     case value_kind_function_pointer:
     {
-        if (generated.function_pointer.external)
+        function_pointer_value const function = value_as_function_pointer(generated);
+        if (function.external)
         {
             LPG_TO_DO();
         }
-        if (generated.function_pointer.capture_count > 0)
+        if (function.capture_count > 0)
         {
             LPG_TRY(generate_value(
-                value_from_tuple(
-                    value_tuple_create(generated.function_pointer.captures, generated.function_pointer.capture_count)),
+                value_from_tuple(value_tuple_create(function.captures, function.capture_count)),
                 type_from_tuple_type(state->program->functions[type_of.lambda.lambda].signature->captures), state,
                 c_output));
         }
         else
         {
-            LPG_TRY(generate_function_name(generated.function_pointer.code, c_output));
+            LPG_TRY(generate_function_name(function.code, c_output));
         }
         return success_yes;
     }
 
     case value_kind_tuple:
         ASSUME(type_of.kind == type_kind_tuple);
-        ASSUME(generated.tuple_.element_count == type_of.tuple_.length);
-        if (generated.tuple_.element_count == 0)
+        ASSUME(value_as_tuple(generated).element_count == type_of.tuple_.length);
+        if (value_as_tuple(generated).element_count == 0)
         {
             LPG_TRY(stream_writer_write_string(c_output, "unit_impl"));
             return success_yes;
         }
         LPG_TRY(stream_writer_write_string(c_output, "{"));
-        for (size_t i = 0; i < generated.tuple_.element_count; ++i)
+        for (size_t i = 0; i < value_as_tuple(generated).element_count; ++i)
         {
             if (i > 0)
             {
                 LPG_TRY(stream_writer_write_string(c_output, ", "));
             }
-            LPG_TRY(generate_value(generated.tuple_.elements[i], type_of.tuple_.elements[i], state, c_output));
+            LPG_TRY(generate_value(value_as_tuple(generated).elements[i], type_of.tuple_.elements[i], state, c_output));
         }
         LPG_TRY(stream_writer_write_string(c_output, "}"));
         return success_yes;
@@ -1623,7 +1646,7 @@ static success_indicator generate_value(value const generated, type const type_o
     {
         ASSUME(type_of.kind == type_kind_structure);
         structure const schema = state->program->structs[type_of.structure_];
-        ASSUME(generated.structure.count == schema.count);
+        ASSUME(value_as_structure(generated).count == schema.count);
         LPG_TRY(stream_writer_write_string(c_output, "{"));
         for (size_t i = 0; i < schema.count; ++i)
         {
@@ -1631,7 +1654,7 @@ static success_indicator generate_value(value const generated, type const type_o
             {
                 LPG_TRY(stream_writer_write_string(c_output, ", "));
             }
-            LPG_TRY(generate_value(generated.structure.members[i], schema.members[i].what, state, c_output));
+            LPG_TRY(generate_value(value_as_structure(generated).members[i], schema.members[i].what, state, c_output));
         }
         LPG_TRY(stream_writer_write_string(c_output, "}"));
         return success_yes;
@@ -1642,7 +1665,7 @@ static success_indicator generate_value(value const generated, type const type_o
         LPG_TO_DO();
 
     case value_kind_type_erased:
-        return generate_type_erased_value(generated.type_erased, state, c_output);
+        return generate_type_erased_value(value_as_type_erased(generated), state, c_output);
 
     case value_kind_generic_struct:
     case value_kind_generic_lambda:
@@ -1657,20 +1680,21 @@ static success_indicator generate_value(value const generated, type const type_o
     case value_kind_enum_element:
     {
         ASSUME(type_of.kind == type_kind_enumeration);
+        enum_element_value const element = value_as_enum_element(generated);
         enumeration const enum_ = state->program->enums[type_of.enum_];
         if (has_stateful_element(enum_))
         {
             LPG_TRY(stream_writer_write_string(c_output, "{"));
-            LPG_TRY(stream_writer_write_integer(c_output, integer_create(0, generated.enum_element.which)));
-            optional_type const enum_state = enum_.elements[generated.enum_element.which].state;
+            LPG_TRY(stream_writer_write_integer(c_output, integer_create(0, element.which)));
+            optional_type const enum_state = enum_.elements[element.which].state;
             if (enum_state.is_set)
             {
                 LPG_TRY(stream_writer_write_string(c_output, ", {."));
                 LPG_TRY(generate_struct_member_name(
-                    unicode_view_from_string(enum_.elements[generated.enum_element.which].name), c_output));
+                    unicode_view_from_string(enum_.elements[element.which].name), c_output));
                 LPG_TRY(stream_writer_write_string(c_output, " = "));
                 ASSUME(enum_state.is_set);
-                LPG_TRY(generate_value(value_or_unit(generated.enum_element.state), enum_state.value, state, c_output));
+                LPG_TRY(generate_value(value_or_unit(element.state), enum_state.value, state, c_output));
                 LPG_TRY(stream_writer_write_string(c_output, "}}"));
             }
             else
@@ -1681,7 +1705,7 @@ static success_indicator generate_value(value const generated, type const type_o
         }
         char buffer[64];
         unicode_view const formatted = integer_format(
-            integer_create(0, generated.enum_element.which), lower_case_digits, 10, buffer, sizeof(buffer));
+            integer_create(0, element.which), lower_case_digits, 10, buffer, sizeof(buffer));
         LPG_TRY(stream_writer_write_unicode_view(c_output, formatted));
         return success_yes;
     }
@@ -1817,14 +1841,276 @@ static success_indicator generate_current_function(c_backend_state *const state,
     }
     else
     {
-        LPG_TRY(generate_value(
-            value_from_function_pointer(function_pointer_value_from_internal(current_function_id, NULL, 0)),
-            function_type, state, c_output));
+        LPG_TRY(generate_value(value_from_internal_function(current_function_id), function_type, state, c_output));
     }
     LPG_TRY(stream_writer_write_string(c_output, ";\n"));
     return success_yes;
 }
 
+static bool breaks_out_of_loop(instruction_sequence const sequence)
+{
+    for (size_t i = 0; i < sequence.length; ++i)
+    {
+        instruction const element = sequence.elements[i];
+        switch (element.type)
+        {
+        case instruction_break:
+            return true;
+
+        case instruction_match:
+            for (size_t j = 0; j < element.match.count; ++j)
+            {
+                if (breaks_out_of_loop(element.match.cases[j].action))
+                {
+                    return true;
+                }
+            }
+            break;
+
+        case instruction_loop:
+        case instruction_call:
+        case instruction_global:
+        case instruction_read_struct:
+        case instruction_literal:
+        case instruction_tuple:
+        case instruction_enum_construct:
+        case instruction_get_captures:
+        case instruction_lambda_with_captures:
+        case instruction_get_method:
+        case instruction_erase_type:
+        case instruction_return:
+        case instruction_instantiate_struct:
+        case instruction_new_array:
+        case instruction_current_function:
+            break;
+        }
+    }
+    return false;
+}
+
+static bool can_generate_switch(match_instruction const match, match_table const *const table)
+{
+    if (table->kind == match_table_kind_linear)
+    {
+        return false;
+    }
+    /*a break inside of a switch would leave the switch instead of the loop*/
+    for (size_t i = 0; i < match.count; ++i)
+    {
+        if (breaks_out_of_loop(match.cases[i].action))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static success_indicator generate_match_key(c_backend_state *state, checked_function const *const current_function,
+                                            register_id const key, stream_writer const c_output)
+{
+    LPG_TRY(generate_c_read_access(state, current_function, key, c_output));
+    ASSUME(state->registers[key].type_of.is_set);
+    type const key_type = state->registers[key].type_of.value;
+    if ((key_type.kind == type_kind_enumeration) && has_stateful_element(state->program->enums[key_type.enum_]))
+    {
+        LPG_TRY(stream_writer_write_string(c_output, ".which"));
+    }
+    return success_yes;
+}
+
+static success_indicator generate_match_case(c_backend_state *state, checked_function const *const current_function,
+                                             function_id const current_function_id, match_instruction const match,
+                                             size_t const case_index, bool const ends_with_break,
+                                             size_t const indentation, garbage_collector *const additional_memory,
+                                             stream_writer const c_output)
+{
+    match_instruction_case const this_case = match.cases[case_index];
+    LPG_TRY(indent(indentation, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, "{\n"));
+    size_t const previous_register_count = state->active_register_count;
+    switch (this_case.kind)
+    {
+    case match_instruction_case_kind_stateful_enum:
+    {
+        ASSUME(state->registers[match.key].type_of.is_set);
+        ASSUME(state->registers[match.key].type_of.value.kind == type_kind_enumeration);
+        enumeration const enum_ = state->program->enums[state->registers[match.key].type_of.value.enum_];
+        optional_type const maybe_state_type = enum_.elements[this_case.stateful_enum.element].state;
+        ASSUME(maybe_state_type.is_set);
+        type const state_type = maybe_state_type.value;
+        set_register_variable(state, this_case.stateful_enum.where, register_resource_ownership_owns, state_type);
+        LPG_TRY(indent(indentation + 1, c_output));
+        LPG_TRY(generate_type(
+            state_type, &state->standard_library, state->definitions, state->program, additional_memory, c_output));
+        LPG_TRY(stream_writer_write_string(c_output, " const "));
+        LPG_TRY(generate_register_name(this_case.stateful_enum.where, current_function, c_output));
+        LPG_TRY(stream_writer_write_string(c_output, " = "));
+        LPG_TRY(generate_c_read_access(state, current_function, match.key, c_output));
+        LPG_TRY(stream_writer_write_string(c_output, "."));
+        LPG_TRY(generate_struct_member_name(
+            unicode_view_from_string(enum_.elements[this_case.stateful_enum.element].name), c_output));
+        LPG_TRY(stream_writer_write_string(c_output, ";\n"));
+        LPG_TRY(generate_add_reference_to_register(state, current_function, this_case.stateful_enum.where,
+                                                   state_type, indentation + 1, state->program, c_output));
+        ASSUME(state->active_register_count == (previous_register_count + 1));
+        break;
+    }
+
+    case match_instruction_case_kind_default:
+    case match_instruction_case_kind_value:
+        break;
+    }
+    LPG_TRY(generate_sequence(state, current_function, current_function_id, this_case.action, (indentation + 1),
+                              additional_memory, c_output));
+
+    LPG_TRY(
+        free_registers(state, previous_register_count, indentation + 1, current_function, ~(register_id)0, c_output));
+
+    if (this_case.value.is_set)
+    {
+        LPG_TRY(indent(indentation + 1, c_output));
+        LPG_TRY(generate_register_name(match.result, current_function, c_output));
+        LPG_TRY(stream_writer_write_string(c_output, " = "));
+        LPG_TRY(generate_c_read_access(state, current_function, this_case.value.value, c_output));
+        LPG_TRY(stream_writer_write_string(c_output, ";\n"));
+    }
+
+    LPG_TRY(generate_add_reference_to_register(
+        state, current_function, match.result, match.result_type, indentation + 1, state->program, c_output));
+
+    if (ends_with_break)
+    {
+        LPG_TRY(indent(indentation + 1, c_output));
+        LPG_TRY(stream_writer_write_string(c_output, "break;\n"));
+    }
+
+    LPG_TRY(indent(indentation, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, "}\n"));
+    return success_yes;
+}
+
+static success_indicator generate_match_switch(c_backend_state *state, checked_function const *const current_function,
+                                               function_id const current_function_id, match_instruction const match,
+                                               match_table const *const table, size_t const indentation,
+                                               garbage_collector *const additional_memory,
+                                               stream_writer const c_output)
+{
+    LPG_TRY(indent(indentation, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, "switch ("));
+    LPG_TRY(generate_match_key(state, current_function, match.key, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, ")\n"));
+    LPG_TRY(indent(indentation, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, "{\n"));
+    for (size_t i = 0; i < match.count; ++i)
+    {
+        if (i == table->default_case)
+        {
+            LPG_TRY(indent(indentation, c_output));
+            LPG_TRY(stream_writer_write_string(c_output, "default:\n"));
+        }
+        else
+        {
+            LPG_TRY(indent(indentation, c_output));
+            LPG_TRY(stream_writer_write_string(c_output, "case "));
+            LPG_TRY(stream_writer_write_integer(c_output, integer_create(0, table->case_keys[i])));
+            LPG_TRY(stream_writer_write_string(c_output, "u:\n"));
+            /*the last case handles everything else like the else at the end of an if chain*/
+            if ((table->default_case == match_table_no_case) && (i == (match.count - 1)))
+            {
+                LPG_TRY(indent(indentation, c_output));
+                LPG_TRY(stream_writer_write_string(c_output, "default:\n"));
+            }
+        }
+        LPG_TRY(generate_match_case(
+            state, current_function, current_function_id, match, i, true, indentation, additional_memory, c_output));
+    }
+    LPG_TRY(indent(indentation, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, "}\n"));
+    return success_yes;
+}
+
+static success_indicator generate_match(c_backend_state *state, checked_function const *const current_function,
+                                        function_id const current_function_id, match_instruction const match,
+                                        match_table const *const table, size_t const indentation,
+                                        garbage_collector *const additional_memory, stream_writer const c_output)
+{
+    set_register_variable(state, match.result, register_resource_ownership_owns, match.result_type);
+    LPG_TRY(indent(indentation, c_output));
+    LPG_TRY(generate_type(
+        match.result_type, &state->standard_library, state->definitions, state->program, additional_memory, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, " "));
+    LPG_TRY(generate_register_name(match.result, current_function, c_output));
+    LPG_TRY(stream_writer_write_string(c_output, ";\n"));
+    if (can_generate_switch(match, table))
+    {
+        return generate_match_switch(
+            state, current_function, current_function_id, match, table, indentation, additional_memory, c_output);
+    }
+    for (size_t i = 0; i < match.count; ++i)
+    {
+        LPG_TRY(indent(indentation, c_output));
+        if (i > 0)
+        {
+            LPG_TRY(stream_writer_write_string(c_output, "else"));
+        }
+        if (i != (match.count - 1))
+        {
+            if (i > 0)
+            {
+                LPG_TRY(stream_writer_write_string(c_output, " "));
+            }
+            LPG_TRY(stream_writer_write_string(c_output, "if ("));
+            ASSUME(state->registers[match.key].type_of.is_set);
+            type const key_type = state->registers[match.key].type_of.value;
+            if ((key_type.kind == type_kind_enumeration) &&
+                has_stateful_element(state->program->enums[key_type.enum_]))
+            {
+                LPG_TRY(generate_match_key(state, current_function, match.key, c_output));
+                LPG_TRY(stream_writer_write_string(c_output, " == "));
+                switch (match.cases[i].kind)
+                {
+                case match_instruction_case_kind_default:
+                    LPG_TO_DO();
+
+                case match_instruction_case_kind_value:
+                    LPG_TRY(generate_c_read_access(state, current_function, match.cases[i].key_value, c_output));
+                    LPG_TRY(stream_writer_write_string(c_output, ".which"));
+                    break;
+
+                case match_instruction_case_kind_stateful_enum:
+                    LPG_TRY(stream_writer_write_integer(
+                        c_output, integer_create(0, match.cases[i].stateful_enum.element)));
+                    break;
+                }
+            }
+            else
+            {
+                ASSUME(match.cases[i].kind == match_instruction_case_kind_value);
+                if (key_type.kind == type_kind_string)
+                {
+                    state->standard_library.using_string = true;
+                    LPG_TRY(stream_writer_write_string(c_output, "string_equals("));
+                    LPG_TRY(generate_c_read_access(state, current_function, match.key, c_output));
+                    LPG_TRY(stream_writer_write_string(c_output, ", "));
+                    LPG_TRY(generate_c_read_access(state, current_function, match.cases[i].key_value, c_output));
+                    LPG_TRY(stream_writer_write_string(c_output, ")"));
+                }
+                else
+                {
+                    LPG_TRY(generate_c_read_access(state, current_function, match.key, c_output));
+                    LPG_TRY(stream_writer_write_string(c_output, " == "));
+                    LPG_TRY(generate_c_read_access(state, current_function, match.cases[i].key_value, c_output));
+                }
+            }
+            LPG_TRY(stream_writer_write_string(c_output, ")"));
+        }
+        LPG_TRY(stream_writer_write_string(c_output, "\n"));
+        LPG_TRY(generate_match_case(state, current_function, current_function_id, match, i, false, indentation,
+                                    additional_memory, c_output));
+    }
+    return success_yes;
+}
+
 static success_indicator generate_instruction(c_backend_state *state, checked_function const *const current_function,
                                               function_id const current_function_id, instruction const input,
                                               size_t const indentation, garbage_collector *const additional_memory,
@@ -2633,31 +2919,29 @@ static success_indicator generate_instruction(c_backend_state *state, checked_fu
             return success_yes;
 
         case value_kind_function_pointer:
+        {
             set_register_variable(state, input.literal.into, register_resource_ownership_owns, input.literal.type_of);
-            if (input.literal.value_.function_pointer.external)
+            function_pointer_value const function = value_as_function_pointer(input.literal.value_);
+            if (function.external)
             {
                 LPG_TO_DO();
             }
-            if (input.literal.value_.function_pointer.capture_count > 0)
+            if (function.capture_count > 0)
             {
-                tuple_type const captures =
-                    state->program->functions[input.literal.value_.function_pointer.code].signature->captures;
+                tuple_type const captures = state->program->functions[function.code].signature->captures;
                 LPG_TRY(generate_type(type_from_tuple_type(captures), &state->standard_library, state->definitions,
                                       state->program, additional_memory, c_output));
                 LPG_TRY(stream_writer_write_string(c_output, " const "));
                 LPG_TRY(generate_register_name(input.literal.into, current_function, c_output));
                 LPG_TRY(stream_writer_write_string(c_output, " = "));
-                LPG_TRY(generate_value(
-                    value_from_tuple(value_tuple_create(input.literal.value_.function_pointer.captures,
-                                                        input.literal.value_.function_pointer.capture_count)),
-                    type_from_tuple_type(captures), state, c_output));
+                LPG_TRY(generate_value(value_from_tuple(value_tuple_create(function.captures, function.capture_count)),
+                                       type_from_tuple_type(captures), state, c_output));
                 LPG_TRY(stream_writer_write_string(c_output, ";\n"));
             }
             else
             {
                 LPG_TRY(generate_c_function_pointer(
-                    type_from_function_pointer(
-                        state->program->functions[input.literal.value_.function_pointer.code].signature),
+                    type_from_function_pointer(state->program->functions[function.code].signature),
                     &state->standard_library, state->definitions, state->program, additional_memory, c_output));
                 LPG_TRY(stream_writer_write_string(c_output, " const "));
                 LPG_TRY(generate_register_name(input.literal.into, current_function, c_output));
@@ -2666,12 +2950,13 @@ static success_indicator generate_instruction(c_backend_state *state, checked_fu
                 LPG_TRY(stream_writer_write_string(c_output, ";\n"));
             }
             return success_yes;
+        }
 
         case value_kind_tuple:
             set_register_variable(
                 state, input.literal.into, register_resource_ownership_borrows, input.literal.type_of);
             ASSUME(input.literal.type_of.kind == type_kind_tuple);
-            ASSUME(input.literal.value_.tuple_.element_count == input.literal.type_of.tuple_.length);
+            ASSUME(value_as_tuple(input.literal.value_).element_count == input.literal.type_of.tuple_.length);
             LPG_TRY(generate_type(input.literal.type_of, &state->standard_library, state->definitions, state->program,
                                   additional_memory, c_output));
             LPG_TRY(stream_writer_write_string(c_output, " const "));
@@ -2684,24 +2969,22 @@ static success_indicator generate_instruction(c_backend_state *state, checked_fu
         case value_kind_structure:
             ASSUME(input.literal.type_of.kind == type_kind_structure);
             return generate_structure_variable(state, current_function, input.literal.type_of.structure_,
-                                               input.literal.value_.structure, input.literal.into, additional_memory,
-                                               c_output);
+                                               value_as_structure(input.literal.value_), input.literal.into,
+                                               additional_memory, c_output);
 
         case value_kind_type_erased:
         {
             set_register_variable(state, input.literal.into, register_resource_ownership_owns, input.literal.type_of);
             ASSUME(input.literal.type_of.kind == type_kind_interface);
             memory_writer self = {NULL, 0, 0};
-            ASSUME(input.literal.value_.type_erased.self);
-            value const self_value = *input.literal.value_.type_erased.self;
-            type const self_type =
-                implementation_ref_resolve(state->program->interfaces, input.literal.value_.type_erased.impl)->self;
+            type_erased_value const erased = value_as_type_erased(input.literal.value_);
+            value const self_value = *erased.self;
+            type const self_type = implementation_ref_resolve(state->program->interfaces, erased.impl)->self;
             ASSUME(value_conforms_to_type(self_value, self_type));
             LPG_TRY(generate_value(self_value, self_type, state, memory_writer_erase(&self)));
             LPG_TRY(generate_erase_type(&state->standard_library, state->definitions, state->program,
-                                        input.literal.into, input.literal.value_.type_erased.impl,
-                                        unicode_view_create(self.data, self.used), false, current_function, indentation,
-                                        additional_memory, c_output));
+                                        input.literal.into, erased.impl, unicode_view_create(self.data, self.used),
+                                        false, current_function, indentation, additional_memory, c_output));
             memory_writer_free(&self);
             return success_yes;
         }
@@ -2789,139 +3072,8 @@ static success_indicator generate_instruction(c_backend_state *state, checked_fu
     }
 
     case instruction_match:
-    {
-        set_register_variable(state, input.match.result, register_resource_ownership_owns, input.match.result_type);
-        LPG_TRY(indent(indentation, c_output));
-        LPG_TRY(generate_type(input.match.result_type, &state->standard_library, state->definitions, state->program,
-                              additional_memory, c_output));
-        LPG_TRY(stream_writer_write_string(c_output, " "));
-        LPG_TRY(generate_register_name(input.match.result, current_function, c_output));
-        LPG_TRY(stream_writer_write_string(c_output, ";\n"));
-        for (size_t i = 0; i < input.match.count; ++i)
-        {
-            LPG_TRY(indent(indentation, c_output));
-            if (i > 0)
-            {
-                LPG_TRY(stream_writer_write_string(c_output, "else"));
-            }
-            if (i != (input.match.count - 1))
-            {
-                if (i > 0)
-                {
-                    LPG_TRY(stream_writer_write_string(c_output, " "));
-                }
-                LPG_TRY(stream_writer_write_string(c_output, "if ("));
-                ASSUME(state->registers[input.match.key].type_of.is_set);
-                type const key_type = state->registers[input.match.key].type_of.value;
-                if ((key_type.kind == type_kind_enumeration) &&
-                    has_stateful_element(state->program->enums[key_type.enum_]))
-                {
-                    LPG_TRY(generate_c_read_access(state, current_function, input.match.key, c_output));
-                    LPG_TRY(stream_writer_write_string(c_output, ".which == "));
-                    switch (input.match.cases[i].kind)
-                    {
-                    case match_instruction_case_kind_default:
-                        LPG_TO_DO();
-
-                    case match_instruction_case_kind_value:
-                        LPG_TRY(
-                            generate_c_read_access(state, current_function, input.match.cases[i].key_value, c_output));
-                        LPG_TRY(stream_writer_write_string(c_output, ".which"));
-                        break;
-
-                    case match_instruction_case_kind_stateful_enum:
-                        LPG_TRY(stream_writer_write_integer(
-                            c_output, integer_create(0, input.match.cases[i].stateful_enum.element)));
-                        break;
-                    }
-                }
-                else
-                {
-                    ASSUME(input.match.cases[i].kind == match_instruction_case_kind_value);
-                    if (key_type.kind == type_kind_string)
-                    {
-                        state->standard_library.using_string = true;
-                        LPG_TRY(stream_writer_write_string(c_output, "string_equals("));
-                        LPG_TRY(generate_c_read_access(state, current_function, input.match.key, c_output));
-                        LPG_TRY(stream_writer_write_string(c_output, ", "));
-                        LPG_TRY(
-                            generate_c_read_access(state, current_function, input.match.cases[i].key_value, c_output));
-                        LPG_TRY(stream_writer_write_string(c_output, ")"));
-                    }
-                    else
-                    {
-                        LPG_TRY(generate_c_read_access(state, current_function, input.match.key, c_output));
-                        LPG_TRY(stream_writer_write_string(c_output, " == "));
-                        LPG_TRY(
-                            generate_c_read_access(state, current_function, input.match.cases[i].key_value, c_output));
-                    }
-                }
-                LPG_TRY(stream_writer_write_string(c_output, ")"));
-            }
-            LPG_TRY(stream_writer_write_string(c_output, "\n"));
-
-            LPG_TRY(indent(indentation, c_output));
-            LPG_TRY(stream_writer_write_string(c_output, "{\n"));
-            size_t const previous_register_count = state->active_register_count;
-            switch (input.match.cases[i].kind)
-            {
-            case match_instruction_case_kind_stateful_enum:
-            {
-                ASSUME(state->registers[input.match.key].type_of.is_set);
-                ASSUME(state->registers[input.match.key].type_of.value.kind == type_kind_enumeration);
-                enumeration const enum_ = state->program->enums[state->registers[input.match.key].type_of.value.enum_];
-                optional_type const maybe_state_type = enum_.elements[input.match.cases[i].stateful_enum.element].state;
-                ASSUME(maybe_state_type.is_set);
-                type const state_type = maybe_state_type.value;
-                set_register_variable(
-                    state, input.match.cases[i].stateful_enum.where, register_resource_ownership_owns, state_type);
-                LPG_TRY(indent(indentation + 1, c_output));
-                LPG_TRY(generate_type(state_type, &state->standard_library, state->definitions, state->program,
-                                      additional_memory, c_output));
-                LPG_TRY(stream_writer_write_string(c_output, " const "));
-                LPG_TRY(generate_register_name(input.match.cases[i].stateful_enum.where, current_function, c_output));
-                LPG_TRY(stream_writer_write_string(c_output, " = "));
-                LPG_TRY(generate_c_read_access(state, current_function, input.match.key, c_output));
-                LPG_TRY(stream_writer_write_string(c_output, "."));
-                LPG_TRY(generate_struct_member_name(
-                    unicode_view_from_string(enum_.elements[input.match.cases[i].stateful_enum.element].name),
-                    c_output));
-                LPG_TRY(stream_writer_write_string(c_output, ";\n"));
-                LPG_TRY(generate_add_reference_to_register(state, current_function,
-                                                           input.match.cases[i].stateful_enum.where, state_type,
-                                                           indentation + 1, state->program, c_output));
-                ASSUME(state->active_register_count == (previous_register_count + 1));
-                break;
-            }
-
-            case match_instruction_case_kind_default:
-            case match_instruction_case_kind_value:
-                break;
-            }
-            LPG_TRY(generate_sequence(state, current_function, current_function_id, input.match.cases[i].action,
-                                      (indentation + 1), additional_memory, c_output));
-
-            LPG_TRY(free_registers(
-                state, previous_register_count, indentation + 1, current_function, ~(register_id)0, c_output));
-
-            if (input.match.cases[i].value.is_set)
-            {
-                LPG_TRY(indent(indentation + 1, c_output));
-                LPG_TRY(generate_register_name(input.match.result, current_function, c_output));
-                LPG_TRY(stream_writer_write_string(c_output, " = "));
-                LPG_TRY(generate_c_read_access(state, current_function, input.match.cases[i].value.value, c_output));
-                LPG_TRY(stream_writer_write_string(c_output, ";\n"));
-            }
-
-            LPG_TRY(generate_add_reference_to_register(state, current_function, input.match.result,
-                                                       input.match.result_type, indentation + 1, state->program,
-                                                       c_output));
-
-            LPG_TRY(indent(indentation, c_output));
-            LPG_TRY(stream_writer_write_string(c_output, "}\n"));
-        }
-        return success_yes;
-    }
+        /*generate_sequence knows the instructions in front of the match which are needed to generate it*/
+        LPG_UNREACHABLE();
 
     case instruction_get_captures:
         set_register_meaning(state, input.captures,
@@ -3087,8 +3239,19 @@ static success_indicator generate_sequence(c_backend_state *state, checked_funct
     size_t const previously_active_registers = state->active_register_count;
     for (size_t i = 0; i < sequence.length; ++i)
     {
-        LPG_TRY(generate_instruction(state, current_function, current_function_id, sequence.elements[i], indentation,
-                                     additional_memory, c_output));
+        instruction const element = sequence.elements[i];
+        if (element.type == instruction_match)
+        {
+            match_table const table = match_table_create(element.match, sequence.elements, i);
+            success_indicator const generated = generate_match(state, current_function, current_function_id,
+                                                               element.match, &table, indentation, additional_memory,
+                                                               c_output);
+            match_table_free(table);
+            LPG_TRY(generated);
+            continue;
+        }
+        LPG_TRY(generate_instruction(
+            state, current_function, current_function_id, element, indentation, additional_memory, c_output));
     }
     return free_registers(state, previously_active_registers, indentation, current_function, ~(register_id)0, c_output);
 }
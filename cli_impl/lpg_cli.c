@@ -5,10 +5,13 @@
 #include "lpg_allocate.h"
 #include "lpg_check.h"
 #include "lpg_ecmascript_backend.h"
+#include "lpg_file_watcher.h"
 #include "lpg_find_next_token.h"
 #include "lpg_interpret.h"
 #include "lpg_optimize.h"
 #include "lpg_path.h"
+#include "lpg_prefetch_modules.h"
+#include "lpg_program_cache.h"
 #include "lpg_read_file.h"
 #include "lpg_save_expression.h"
 #include "lpg_standard_library.h"
@@ -267,6 +270,9 @@ static char const *semantic_error_text(semantic_error_type const error)
 
     case semantic_error_unused_generic_parameter:
         return "Self and/or the interface have to use generic parameters";
+
+    case semantic_error_deadline_reached:
+        return "Compile time deadline reached";
     }
     LPG_UNREACHABLE();
 }
@@ -304,6 +310,10 @@ static compiler_command parse_compiler_command(char const *const command, bool *
     {
         return compiler_command_web;
     }
+    else if (!strcmp(command, "watch"))
+    {
+        return compiler_command_watch;
+    }
 #ifdef LPG_NODEJS
     else if (!strcmp(command, "node"))
     {
@@ -317,25 +327,147 @@ static compiler_command parse_compiler_command(char const *const command, bool *
     return compiler_command_compile;
 }
 
-static compiler_arguments parse_compiler_arguments(int const argument_count, char **const arguments)
+static bool parse_budget_limit(char const *const text, uint64_t const maximum, uint64_t *const limit)
 {
-    compiler_arguments result = {false, compiler_command_compile, "", NULL};
-    if (argument_count < 3)
+    /*integer_parse expects a string of digits like the ones the tokenizer finds*/
+    size_t const length = strlen(text);
+    if ((length == 0) || (strspn(text, "0123456789") != length))
+    {
+        return false;
+    }
+    integer parsed;
+    if (!integer_parse(&parsed, unicode_view_from_c_str(text)) || (parsed.high != 0) || (parsed.low > maximum))
+    {
+        return false;
+    }
+    *limit = parsed.low;
+    return true;
+}
+
+/*parses options like --max-instructions=1000 or --compile-time-max-heap=100000*/
+static bool parse_budget_option(char const *option, compiler_arguments *const result)
+{
+    execution_budget *budget = &result->run_budget;
+    char const *const compile_time_prefix = "compile-time-";
+    if (!strncmp(option, compile_time_prefix, strlen(compile_time_prefix)))
+    {
+        budget = &result->compile_time_budget;
+        option += strlen(compile_time_prefix);
+    }
+    char const *const assignment = strchr(option, '=');
+    if (!assignment)
+    {
+        return false;
+    }
+    unicode_view const name = unicode_view_create(option, (size_t)(assignment - option));
+    char const *const limit_text = (assignment + 1);
+    uint64_t limit = 0;
+    if (unicode_view_equals_c_str(name, "max-instructions"))
+    {
+        return parse_budget_limit(limit_text, UINT64_MAX, &budget->max_executed_instructions);
+    }
+    if (unicode_view_equals_c_str(name, "max-milliseconds"))
+    {
+        return parse_budget_limit(limit_text, UINT64_MAX, &budget->max_duration.milliseconds);
+    }
+    if (!parse_budget_limit(limit_text, SIZE_MAX, &limit))
+    {
+        return false;
+    }
+    if (unicode_view_equals_c_str(name, "max-recursion"))
+    {
+        budget->max_recursion = (size_t)limit;
+        return true;
+    }
+    if (unicode_view_equals_c_str(name, "max-frame-memory"))
+    {
+        budget->max_frame_memory = (size_t)limit;
+        return true;
+    }
+    if (unicode_view_equals_c_str(name, "max-heap"))
+    {
+        budget->max_heap_size = (size_t)limit;
+        return true;
+    }
+    return false;
+}
+
+compiler_arguments parse_compiler_arguments(int const argument_count, char **const arguments)
+{
+    compiler_arguments result = {
+        false,
+        compiler_command_compile,
+        compiler_command_run,
+        "",
+        NULL,
+        execution_budget_create(UINT64_MAX, 200, interpreter_default_max_frame_memory, SIZE_MAX,
+                                duration_from_milliseconds(execution_budget_no_deadline)),
+        default_compile_time_budget(100000),
+        false,
+        NULL,
+        NULL,
+        NULL,
+        default_parse_threads};
+    char *positional[4];
+    size_t positional_count = 0;
+    for (int i = 1; i < argument_count; ++i)
+    {
+        char *const argument = arguments[i];
+        if (strncmp(argument, "--", 2))
+        {
+            if (positional_count == LPG_ARRAY_SIZE(positional))
+            {
+                return result;
+            }
+            positional[positional_count] = argument;
+            ++positional_count;
+        }
+        else if (!strcmp(argument, "--report-usage"))
+        {
+            result.report_usage = true;
+        }
+        else if (!strncmp(argument, "--profile-folded=", strlen("--profile-folded=")))
+        {
+            result.profile_folded_file_name = argument + strlen("--profile-folded=");
+        }
+        else if (!strncmp(argument, "--profile-json=", strlen("--profile-json=")))
+        {
+            result.profile_json_file_name = argument + strlen("--profile-json=");
+        }
+        else if (!strncmp(argument, "--cache=", strlen("--cache=")))
+        {
+            result.cache_directory = argument + strlen("--cache=");
+        }
+        else if (!strncmp(argument, "--parse-threads=", strlen("--parse-threads=")))
+        {
+            uint64_t threads = 0;
+            if (!parse_budget_limit(argument + strlen("--parse-threads="), SIZE_MAX, &threads) || (threads == 0))
+            {
+                return result;
+            }
+            result.parse_threads = (size_t)threads;
+        }
+        else if (!parse_budget_option(argument + 2, &result))
+        {
+            return result;
+        }
+    }
+    if (positional_count < 2)
     {
         result.valid = false;
         return result;
     }
 
     bool valid = true;
-    result.command = parse_compiler_command(arguments[1], &valid);
-    result.file_name = arguments[2];
+    result.command = parse_compiler_command(positional[0], &valid);
+    result.file_name = positional[1];
     result.valid = valid;
     switch (result.command)
     {
     case compiler_command_compile:
     case compiler_command_format:
     case compiler_command_run:
-        if (argument_count != 3)
+        if (positional_count != 2)
         {
             result.valid = false;
             return result;
@@ -343,17 +475,54 @@ static compiler_arguments parse_compiler_arguments(int const argument_count, cha
         break;
 
     case compiler_command_web:
-        if (argument_count != 4)
+        if (positional_count != 3)
         {
             result.valid = false;
             return result;
         }
-        result.output_file_name = arguments[3];
+        result.output_file_name = positional[2];
+        break;
+
+    case compiler_command_watch:
+        if (positional_count == 2)
+        {
+            break;
+        }
+        result.watched_command = parse_compiler_command(positional[2], &valid);
+        if (!valid)
+        {
+            result.valid = false;
+            return result;
+        }
+        switch (result.watched_command)
+        {
+        case compiler_command_run:
+            result.valid = (positional_count == 3);
+            break;
+
+        case compiler_command_web:
+            if (positional_count != 4)
+            {
+                result.valid = false;
+                return result;
+            }
+            result.output_file_name = positional[3];
+            break;
+
+        case compiler_command_compile:
+        case compiler_command_format:
+        case compiler_command_watch:
+#ifdef LPG_NODEJS
+        case compiler_command_node:
+#endif
+            result.valid = false;
+            break;
+        }
         break;
 
 #ifdef LPG_NODEJS
     case compiler_command_node:
-        if (argument_count != 3)
+        if (positional_count != 2)
         {
             result.valid = false;
             return result;
@@ -364,22 +533,221 @@ static compiler_arguments parse_compiler_arguments(int const argument_count, cha
     return result;
 }
 
-bool run_cli(int const argc, char **const argv, stream_writer const diagnostics, unicode_view const current_directory,
-             unicode_view const module_directory)
+static void write_number(stream_writer const diagnostics, uint64_t const number)
 {
-#ifndef LPG_NODEJS
-    (void)current_directory;
-#endif
-    compiler_arguments arguments = parse_compiler_arguments(argc, argv);
+    char buffer[64];
+    unicode_view const formatted =
+        integer_format(integer_create(0, number), lower_case_digits, 10, buffer, sizeof(buffer));
+    ASSERT(formatted.begin);
+    ASSERT(success_yes == stream_writer_write_unicode_view(diagnostics, formatted));
+}
 
-    if (!arguments.valid)
+static void save_profile(stream_writer const diagnostics, char const *const file_name, profile const recorded,
+                         profile_symbols const symbols,
+                         success_indicator (*const write)(profile, profile_symbols, stream_writer))
+{
+    if (!file_name)
     {
-        ASSERT(success_yes == stream_writer_write_string(diagnostics, "Arguments: [run|format|compile|web] "
-                                                                      "filename [web output file]\n"));
-        return true;
+        return;
+    }
+    memory_writer buffer = {NULL, 0, 0};
+    if ((write(recorded, symbols, memory_writer_erase(&buffer)) != success_yes) ||
+        (write_file(unicode_view_from_c_str(file_name), memory_writer_content(buffer)) != success_yes))
+    {
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, "Could not write the profile\n"));
     }
+    memory_writer_free(&buffer);
+}
 
-    blob_or_error const source_or_error = read_file(arguments.file_name);
+static void report_usage(stream_writer const diagnostics, char const *const phase, execution_usage const usage,
+                         garbage_collector_statistics const heap, duration const elapsed)
+{
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, phase));
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, " usage: "));
+    write_number(diagnostics, usage.executed_instructions);
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, " instructions, recursion depth "));
+    write_number(diagnostics, usage.peak_recursion);
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, ", "));
+    write_number(diagnostics, usage.peak_frame_memory);
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, " bytes of frames, "));
+    write_number(diagnostics, heap.peak_heap_size);
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, " bytes of heap, "));
+    write_number(diagnostics, heap.collections);
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, " collections, "));
+    write_number(diagnostics, elapsed.milliseconds);
+    ASSERT(success_yes == stream_writer_write_string(diagnostics, " ms\n"));
+    if (usage.memoizable_calls > 0)
+    {
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, phase));
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, " calls: "));
+        write_number(diagnostics, usage.memoized_calls);
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, " of "));
+        write_number(diagnostics, usage.memoizable_calls);
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, " answered from the cache\n"));
+    }
+}
+
+/*returns NULL if the program has run successfully*/
+static char const *describe_run_failure(external_function_result_code const code)
+{
+    switch (code)
+    {
+    case external_function_result_success:
+        return NULL;
+
+    case external_function_result_unavailable:
+        return "The program failed at run time\n";
+
+    case external_function_result_out_of_memory:
+        return "Run time memory limit reached\n";
+
+    case external_function_result_stack_overflow:
+        return "Call stack overflow at run time\n";
+
+    case external_function_result_instruction_limit_reached:
+        return "Executed too many instructions at run time\n";
+
+    case external_function_result_deadline_reached:
+        return "Run time deadline reached\n";
+    }
+    LPG_UNREACHABLE();
+}
+
+/*returns whether the program has failed or has been stopped for exceeding its budget*/
+static bool run_checked_program(compiler_arguments const *const arguments, checked_program const checked,
+                                value const *const globals_values, stream_writer const diagnostics)
+{
+    garbage_collector gc = garbage_collector_create_collecting(arguments->run_budget.max_heap_size, 1024 * 1024);
+    execution_usage usage = execution_usage_create();
+    bool const is_profiling = (arguments->profile_folded_file_name || arguments->profile_json_file_name);
+    profile recorder = profile_create(checked.function_count);
+    duration const started_at = read_monotonic_clock();
+    external_function_result const result =
+        interpret(checked, globals_values, &gc, arguments->run_budget, &usage, is_profiling ? &recorder : NULL);
+    duration const finished_at = read_monotonic_clock();
+    char const *const failure = describe_run_failure(result.code);
+    if (failure)
+    {
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, failure));
+    }
+    if (is_profiling)
+    {
+        /*the profile of a run that has been stopped early would look complete without being complete*/
+        if (failure)
+        {
+            ASSERT(success_yes == stream_writer_write_string(
+                                      diagnostics, "The profile has not been written because the run failed\n"));
+        }
+        else
+        {
+            profile_symbols const symbols = profile_symbols_create(checked);
+            save_profile(diagnostics, arguments->profile_folded_file_name, recorder, symbols, profile_write_folded);
+            save_profile(diagnostics, arguments->profile_json_file_name, recorder, symbols, profile_write_json);
+            profile_symbols_free(symbols);
+        }
+    }
+    profile_free(recorder);
+    if (arguments->report_usage)
+    {
+        report_usage(
+            diagnostics, "Run time", usage, gc.statistics, absolute_duration_difference(started_at, finished_at));
+    }
+    garbage_collector_free(gc);
+    return (failure != NULL);
+}
+
+/*a failed assertion stops the program like a call of fail*/
+static external_function_result run_time_assert_impl(value const *const captures, void *environment,
+                                                     optional_value const self, value *const arguments,
+                                                     interpreter *const context)
+{
+    (void)captures;
+    (void)environment;
+    (void)self;
+    (void)context;
+    ASSUME(arguments[0].kind == value_kind_enum_element);
+    if (value_as_enum_element(arguments[0]).which == 1)
+    {
+        return external_function_result_from_success(value_from_unit());
+    }
+    return external_function_result_create_unavailable();
+}
+
+static external_function_result run_time_fail_impl(value const *const captures, void *environment,
+                                                   optional_value const self, value *const arguments,
+                                                   interpreter *const context)
+{
+    (void)captures;
+    (void)environment;
+    (void)self;
+    (void)arguments;
+    (void)context;
+    return external_function_result_create_unavailable();
+}
+
+static void initialize_globals(standard_library_description const *const standard_library, value *const globals_values)
+{
+    ASSUME(standard_library_element_count == standard_library->globals.count);
+    for (size_t i = 0; i < standard_library_element_count; ++i)
+    {
+        optional_value const compile_time_value = standard_library->globals.members[i].compile_time_value;
+        globals_values[i] = compile_time_value.is_set ? compile_time_value.value_ : value_from_unit();
+    }
+    /*side_effect has no compile time value so that calls to it are not evaluated at compile time*/
+    globals_values[0] = value_from_function_pointer(
+        function_pointer_value_from_external(
+            side_effect_impl, NULL, NULL, *standard_library->globals.members[0].what.function_pointer_),
+        &standard_library->stable->memory);
+    /*assert and fail are only available at run time*/
+    globals_values[4] = value_from_function_pointer(
+        function_pointer_value_from_external(
+            run_time_assert_impl, NULL, NULL, *standard_library->globals.members[4].what.function_pointer_),
+        &standard_library->stable->memory);
+    globals_values[12] = value_from_function_pointer(
+        function_pointer_value_from_external(
+            run_time_fail_impl, NULL, NULL, *standard_library->globals.members[12].what.function_pointer_),
+        &standard_library->stable->memory);
+}
+
+/*Runs the program from the cache if the cache is up to date. Returns false if the program has to be checked.*/
+static bool run_from_cache(compiler_arguments const *const arguments, unicode_view const cache_file,
+                           stream_writer const diagnostics, bool *const has_error)
+{
+    standard_library_description const standard_library = describe_standard_library();
+    duration const load_started_at = read_monotonic_clock();
+    optional_checked_program const cached = program_cache_load(cache_file, standard_library.globals);
+    if (!cached.is_set)
+    {
+        standard_library_description_free(&standard_library);
+        return false;
+    }
+    if (arguments->report_usage)
+    {
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, "Loaded the checked program from the cache in "));
+        write_number(diagnostics, absolute_duration_difference(load_started_at, read_monotonic_clock()).milliseconds);
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, " ms\n"));
+    }
+    value globals_values[standard_library_element_count];
+    initialize_globals(&standard_library, globals_values);
+    *has_error = run_checked_program(arguments, cached.value, globals_values, diagnostics);
+    checked_program_free(&cached.value);
+    standard_library_description_free(&standard_library);
+    return true;
+}
+
+/*Checks the file once and does what the command of the arguments says. The standard library and the module cache are
+ * only created for this build if they are NULL. A resident session keeps the modules that have not changed since its
+ * previous check. It requires the resident library and modules, and the program cache is not used with it because the
+ * session does not read the files of the modules that it keeps.*/
+static bool build(compiler_arguments const *const arguments, stream_writer const diagnostics,
+                  unicode_view const current_directory, unicode_view const module_directory,
+                  standard_library_description const *const resident_library, module_cache *const resident_modules,
+                  check_session *const resident_session)
+{
+#ifndef LPG_NODEJS
+    (void)current_directory;
+#endif
+    blob_or_error const source_or_error = read_file(arguments->file_name);
     if (source_or_error.error)
     {
         ASSERT(success_yes == stream_writer_write_string(diagnostics, source_or_error.error));
@@ -395,20 +763,38 @@ bool run_cli(int const argc, char **const argv, stream_writer const diagnostics,
     }
 
     source_file_lines_owning const lines = source_file_lines_owning_scan(unicode_view_from_string(source));
+    unicode_string const cache_file =
+        ((arguments->command == compiler_command_run) && arguments->cache_directory && !resident_session)
+            ? program_cache_file_name(unicode_view_from_c_str(arguments->cache_directory), current_directory,
+                                      module_directory, unicode_view_from_c_str(arguments->file_name),
+                                      arguments->compile_time_budget)
+            : unicode_string_from_c_str("");
+    if (cache_file.length > 0)
+    {
+        bool has_error = false;
+        if (run_from_cache(arguments, unicode_view_from_string(cache_file), diagnostics, &has_error))
+        {
+            unicode_string_free(&cache_file);
+            source_file_lines_owning_free(lines);
+            unicode_string_free(&source);
+            return has_error;
+        }
+    }
     cli_parser_user user = {diagnostics, false};
     expression_pool pool = expression_pool_create();
-    optional_sequence const root = parse(user, unicode_view_from_c_str(arguments.file_name),
+    optional_sequence const root = parse(user, unicode_view_from_c_str(arguments->file_name),
                                          unicode_view_from_string(source), source_file_lines_from_owning(lines), &pool);
     if (!root.has_value)
     {
         sequence_free(&root.value);
         expression_pool_free(pool);
+        unicode_string_free(&cache_file);
         unicode_string_free(&source);
         source_file_lines_owning_free(lines);
         return true;
     }
 
-    switch (arguments.command)
+    switch (arguments->command)
     {
     case compiler_command_format:
     {
@@ -429,7 +815,7 @@ bool run_cli(int const argc, char **const argv, stream_writer const diagnostics,
         expression_pool_free(pool);
 
         unicode_string temporary = write_temporary_file(format_buffer.data);
-        if (!rename_file(unicode_view_from_string(temporary), unicode_view_from_c_str(arguments.file_name)))
+        if (!rename_file(unicode_view_from_string(temporary), unicode_view_from_c_str(arguments->file_name)))
         {
             ASSERT(success_yes == stream_writer_write_string(diagnostics, "Could not write formatted file\n"));
             memory_writer_free(&format_buffer);
@@ -453,42 +839,80 @@ bool run_cli(int const argc, char **const argv, stream_writer const diagnostics,
 #endif
     case compiler_command_web:
         break;
+
+    case compiler_command_watch:
+        LPG_UNREACHABLE();
     }
 
-    standard_library_description const standard_library = describe_standard_library();
+    standard_library_description const standard_library =
+        resident_library ? *resident_library : describe_standard_library();
     value globals_values[standard_library_element_count];
-    for (size_t i = 0; i < LPG_ARRAY_SIZE(globals_values); ++i)
-    {
-        globals_values[i] = value_from_unit();
-    }
-    ASSUME(LPG_ARRAY_SIZE(globals_values) == standard_library.globals.count);
+    initialize_globals(&standard_library, globals_values);
     semantic_error_context context = {diagnostics, false};
     module_loader loader = module_loader_create(module_directory, handle_parse_error, &user);
-    unicode_view const source_file_path = unicode_view_from_c_str(arguments.file_name);
-    checked_program checked = check(
-        root.value, standard_library.globals, handle_semantic_error, &loader,
-        source_file_create(source_file_path, unicode_view_from_string(source), source_file_lines_from_owning(lines)),
-        path_remove_leaf(source_file_path), 100000, &context);
+    unicode_view const source_file_path = unicode_view_from_c_str(arguments->file_name);
+    module_cache local_modules = module_cache_create();
+    loader.cache = resident_modules ? resident_modules : &local_modules;
+    program_cache_dependencies dependencies = program_cache_dependencies_create();
+    if (cache_file.length > 0)
+    {
+        program_cache_dependencies_add(&dependencies, source_file_path, unicode_view_from_string(source));
+        loader.on_module_read = program_cache_record_module;
+        loader.on_module_read_user = &dependencies;
+        loader.on_module_missing = program_cache_record_missing_module;
+        loader.on_module_missing_user = &dependencies;
+    }
+    execution_usage compile_time_usage = execution_usage_create();
+    duration const check_started_at = read_monotonic_clock();
+    prefetch_modules(&loader, root.value, path_remove_leaf(source_file_path), arguments->parse_threads);
+    /*optimize changes the program, so a web site is generated from a program of its own*/
+    check_session *const session = (arguments->command == compiler_command_web) ? NULL : resident_session;
+    source_file const main_source =
+        source_file_create(source_file_path, unicode_view_from_string(source), source_file_lines_from_owning(lines));
+    checked_program own_program = {NULL, 0, NULL, 0, {0}, NULL, 0, NULL, 0, {NULL, 0, 0, {NULL, 0, 0}}};
+    checked_program const *checked = &own_program;
+    if (session)
+    {
+        checked = check_session_check(session, root.value, handle_semantic_error, &loader, main_source,
+                                      path_remove_leaf(source_file_path), &compile_time_usage, &context);
+    }
+    else
+    {
+        own_program = check(root.value, standard_library.globals, handle_semantic_error, &loader, main_source,
+                            path_remove_leaf(source_file_path), arguments->compile_time_budget, &compile_time_usage,
+                            &context);
+    }
+    if (arguments->report_usage)
+    {
+        report_usage(diagnostics, "Compile time", compile_time_usage, checked->memory.statistics,
+                     absolute_duration_difference(check_started_at, read_monotonic_clock()));
+    }
     sequence_free(&root.value);
     expression_pool_free(pool);
-    switch (arguments.command)
+    module_cache_free(local_modules);
+    switch (arguments->command)
     {
     case compiler_command_run:
         if (!context.has_error)
         {
-            garbage_collector gc = garbage_collector_create(SIZE_MAX);
-            interpret(checked, globals_values, &gc);
-            garbage_collector_free(gc);
+            /*the cache is only an optimization, so failing to write it is not an error*/
+            if ((cache_file.length > 0) &&
+                (program_cache_store(unicode_view_from_string(cache_file), dependencies, checked,
+                                     standard_library.globals) != success_yes))
+            {
+                ASSERT(success_yes == stream_writer_write_string(diagnostics, "Could not write the cache file\n"));
+            }
+            context.has_error = run_checked_program(arguments, *checked, globals_values, diagnostics);
         }
         break;
 
     case compiler_command_web:
         if (!context.has_error)
         {
-            optimize(&checked);
-            unicode_view const output_file_name = unicode_view_from_c_str(arguments.output_file_name);
-            unicode_string const template = generate_template(diagnostics, arguments.file_name);
-            generate_ecmascript_web_site(checked, unicode_view_from_string(template), output_file_name);
+            optimize(&own_program);
+            unicode_view const output_file_name = unicode_view_from_c_str(arguments->output_file_name);
+            unicode_string const template = generate_template(diagnostics, arguments->file_name);
+            generate_ecmascript_web_site(own_program, unicode_view_from_string(template), output_file_name);
             unicode_string_free(&template);
         }
         break;
@@ -497,6 +921,7 @@ bool run_cli(int const argc, char **const argv, stream_writer const diagnostics,
         break;
 
     case compiler_command_format:
+    case compiler_command_watch:
         LPG_UNREACHABLE();
 
 #ifdef LPG_NODEJS
@@ -509,15 +934,15 @@ bool run_cli(int const argc, char **const argv, stream_writer const diagnostics,
         }
         {
             enum_encoding_strategy_cache strategy_cache =
-                enum_encoding_strategy_cache_create(checked.enums, checked.enum_count);
+                enum_encoding_strategy_cache_create(checked->enums, checked->enum_count);
             unicode_string const builtins = load_ecmascript_builtins();
             if (success_yes !=
-                generate_ecmascript(checked, &strategy_cache, unicode_view_from_string(builtins), &generated))
+                generate_ecmascript(*checked, &strategy_cache, unicode_view_from_string(builtins), &generated))
             {
                 LPG_TO_DO();
             }
             unicode_string_free(&builtins);
-            if (success_yes != generate_host_class(&strategy_cache, get_host_interface(checked), checked.interfaces,
+            if (success_yes != generate_host_class(&strategy_cache, get_host_interface(*checked), checked->interfaces,
                                                    memory_writer_erase(&generated)))
             {
                 LPG_TO_DO();
@@ -568,8 +993,88 @@ bool run_cli(int const argc, char **const argv, stream_writer const diagnostics,
 #endif
     }
     source_file_lines_owning_free(lines);
-    checked_program_free(&checked);
-    standard_library_description_free(&standard_library);
+    if (!session)
+    {
+        checked_program_free(&own_program);
+    }
+    program_cache_dependencies_free(dependencies);
+    if (!resident_library)
+    {
+        standard_library_description_free(&standard_library);
+    }
+    unicode_string_free(&cache_file);
     unicode_string_free(&source);
     return context.has_error;
 }
+
+bool run_watch(compiler_arguments const *const arguments, stream_writer const diagnostics,
+               unicode_view const current_directory, unicode_view const module_directory,
+               watch_build_handler *const on_build, void *const on_build_user)
+{
+    compiler_arguments watched = *arguments;
+    watched.command = arguments->watched_command;
+    standard_library_description const standard_library = describe_standard_library();
+    module_cache modules = module_cache_create();
+    check_session *const session = check_session_create(standard_library.globals, arguments->compile_time_budget);
+    file_watcher watcher = file_watcher_create();
+    /*the directories are watched before the first build, so that no change gets lost*/
+    {
+        unicode_view const file_directory = path_remove_leaf(unicode_view_from_c_str(arguments->file_name));
+        file_watcher_add_directory(
+            &watcher, (file_directory.length > 0) ? file_directory : unicode_view_from_c_str("."));
+        file_watcher_add_directory(&watcher, module_directory);
+    }
+    size_t builds = 0;
+    bool has_error = false;
+    for (;;)
+    {
+        has_error =
+            build(&watched, diagnostics, current_directory, module_directory, &standard_library, &modules, session);
+        ++builds;
+        for (size_t i = 0; i < modules.count; ++i)
+        {
+            file_watcher_add_directory(
+                &watcher, path_remove_leaf(unicode_view_from_string(modules.entries[i]->source.name)));
+        }
+        if (on_build && !on_build(builds, has_error, on_build_user))
+        {
+            break;
+        }
+        if (!file_watcher_is_available(watcher))
+        {
+            ASSERT(success_yes ==
+                   stream_writer_write_string(diagnostics, "Watching files is not supported on this system\n"));
+            break;
+        }
+        /*The next build parses only the changed modules. The session checks them and the modules that import them
+         * again, unless a web site is generated, which needs a program of its own.*/
+        if (!file_watcher_wait(&watcher, unicode_view_from_c_str(".lpg"), duration_from_milliseconds(50)))
+        {
+            break;
+        }
+    }
+    file_watcher_free(watcher);
+    check_session_free(session);
+    module_cache_free(modules);
+    standard_library_description_free(&standard_library);
+    return has_error;
+}
+
+bool run_cli(int const argc, char **const argv, stream_writer const diagnostics, unicode_view const current_directory,
+             unicode_view const module_directory)
+{
+    compiler_arguments const arguments = parse_compiler_arguments(argc, argv);
+    if (!arguments.valid)
+    {
+        ASSERT(success_yes == stream_writer_write_string(diagnostics, "Arguments: [run|format|compile|web] "
+                                                                      "filename [web output file]\n"
+                                                                      "       or: watch filename "
+                                                                      "[run|web output file]\n"));
+        return true;
+    }
+    if (arguments.command == compiler_command_watch)
+    {
+        return run_watch(&arguments, diagnostics, current_directory, module_directory, NULL, NULL);
+    }
+    return build(&arguments, diagnostics, current_directory, module_directory, NULL, NULL, NULL);
+}
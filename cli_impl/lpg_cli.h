@@ -1,5 +1,6 @@
 #pragma once
 #include "lpg_expression_pool.h"
+#include "lpg_interpret.h"
 #include "lpg_source_file.h"
 #include "lpg_stream_writer.h"
 #include <stdbool.h>
@@ -23,20 +24,54 @@ typedef enum compiler_command {
     compiler_command_run = 1,
     compiler_command_compile,
     compiler_command_format,
-    compiler_command_web
+    compiler_command_web,
+    compiler_command_watch
 #ifdef LPG_NODEJS
     ,
     compiler_command_node
 #endif
 } compiler_command;
 
+/*how many threads parse the imported modules unless --parse-threads is given*/
+static size_t const default_parse_threads = 4;
+
 typedef struct compiler_arguments
 {
     bool valid;
     compiler_command command;
+    /*what lpg watch does after every change: compiler_command_run or compiler_command_web*/
+    compiler_command watched_command;
     char *file_name;
     char const *output_file_name;
+    /*limits lpg run*/
+    execution_budget run_budget;
+    /*limits the evaluation of compile time expressions by every command that checks the program*/
+    execution_budget compile_time_budget;
+    /*print the resources that were used at compile time and at run time*/
+    bool report_usage;
+    /*where lpg run saves the profile of the program in the folded stack format, NULL if not wanted*/
+    char const *profile_folded_file_name;
+    /*where lpg run saves the profile of the program as JSON, NULL if not wanted*/
+    char const *profile_json_file_name;
+    /*where lpg run keeps checked programs so that it does not have to check unchanged sources again, NULL if not
+     * wanted*/
+    char const *cache_directory;
+    /*how many threads parse the imported modules before the program is checked*/
+    size_t parse_threads;
 } compiler_arguments;
 
+compiler_arguments parse_compiler_arguments(int const argument_count, LPG_NON_NULL(char **const arguments))
+    LPG_USE_RESULT;
+
 bool run_cli(int const argc, LPG_NON_NULL(char **const argv), stream_writer const diagnostics,
              unicode_view const current_directory, unicode_view const module_directory);
+
+/*called after every build of lpg watch with the number of builds so far. Returns whether to continue watching.*/
+typedef bool watch_build_handler(size_t const builds, bool const has_error, void *user);
+
+/*Builds the file with the watched command of the arguments again whenever a source file has changed. The standard
+ * library and the parsed modules are kept between the builds. on_build is optional. Returns whether the last build
+ * had an error.*/
+bool run_watch(LPG_NON_NULL(compiler_arguments const *const arguments), stream_writer const diagnostics,
+               unicode_view const current_directory, unicode_view const module_directory,
+               watch_build_handler *const on_build, void *const on_build_user);
@@ -0,0 +1,300 @@
+#include "lpg_program_cache.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_hash.h"
+#include "lpg_map_file.h"
+#include "lpg_path.h"
+#include "lpg_rename_file.h"
+#include "lpg_write_file.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/stat.h>
+#endif
+
+program_cache_dependencies program_cache_dependencies_create(void)
+{
+    program_cache_dependencies const result = {NULL, 0};
+    return result;
+}
+
+void program_cache_dependencies_free(program_cache_dependencies const freed)
+{
+    for (size_t i = 0; i < freed.count; ++i)
+    {
+        unicode_string_free(&freed.elements[i].path);
+    }
+    if (freed.elements)
+    {
+        deallocate(freed.elements);
+    }
+}
+
+static void add_dependency(program_cache_dependencies *const dependencies, program_cache_dependency const added)
+{
+    dependencies->elements =
+        reallocate_array(dependencies->elements, (dependencies->count + 1), sizeof(*dependencies->elements));
+    dependencies->elements[dependencies->count] = added;
+    ++dependencies->count;
+}
+
+void program_cache_dependencies_add(program_cache_dependencies *const dependencies, unicode_view const path,
+                                    unicode_view const content)
+{
+    program_cache_dependency const added = {
+        unicode_view_copy(path), true, hash_bytes(hash_seed, content.begin, content.length)};
+    add_dependency(dependencies, added);
+}
+
+void program_cache_dependencies_add_missing(program_cache_dependencies *const dependencies, unicode_view const path)
+{
+    for (size_t i = 0; i < dependencies->count; ++i)
+    {
+        if (!dependencies->elements[i].exists &&
+            unicode_view_equals(unicode_view_from_string(dependencies->elements[i].path), path))
+        {
+            return;
+        }
+    }
+    program_cache_dependency const added = {unicode_view_copy(path), false, 0};
+    add_dependency(dependencies, added);
+}
+
+void program_cache_record_module(unicode_view path, unicode_view content, callback_user user)
+{
+    program_cache_dependencies_add(user, path, content);
+}
+
+void program_cache_record_missing_module(unicode_view path, callback_user user)
+{
+    program_cache_dependencies_add_missing(user, path);
+}
+
+static uint64_t hash_number(uint64_t const previous, uint64_t const number)
+{
+    return hash_bytes(previous, (char const *)&number, sizeof(number));
+}
+
+static uint64_t hash_view(uint64_t const previous, unicode_view const hashed)
+{
+    return hash_bytes(hash_number(previous, hashed.length), hashed.begin, hashed.length);
+}
+
+/*Identifies the executable by its location, size and modification time. Hashing the whole executable on every start
+ * would cost more than loading a typical program from the cache.*/
+static bool identify_compiler(uint64_t *const identity)
+{
+#ifdef __linux__
+    struct stat executable;
+    if (stat("/proc/self/exe", &executable) != 0)
+    {
+        return false;
+    }
+    uint64_t result = hash_seed;
+    result = hash_number(result, (uint64_t)executable.st_dev);
+    result = hash_number(result, (uint64_t)executable.st_ino);
+    result = hash_number(result, (uint64_t)executable.st_size);
+    result = hash_number(result, (uint64_t)executable.st_mtim.tv_sec);
+    result = hash_number(result, (uint64_t)executable.st_mtim.tv_nsec);
+    *identity = hash_number(result, saved_program_format_version);
+    return true;
+#else
+    (void)identity;
+    return false;
+#endif
+}
+
+static char const hex_digits[] = "0123456789abcdef";
+
+/*takes the place of the content hash of a path that did not exist*/
+static char const missing_marker[16] = {'-', '-', '-', '-', '-', '-', '-', '-', '-', '-', '-', '-', '-', '-', '-', '-'};
+
+static void format_hash(uint64_t const hash, char *const into)
+{
+    for (size_t i = 0; i < 16; ++i)
+    {
+        into[i] = hex_digits[(hash >> ((15 - i) * 4)) & 0xfu];
+    }
+}
+
+static bool parse_hash(char const *const from, uint64_t *const hash)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < 16; ++i)
+    {
+        char const *const digit = memchr(hex_digits, from[i], 16);
+        if (!digit)
+        {
+            return false;
+        }
+        result = (result << 4u) | (uint64_t)(digit - hex_digits);
+    }
+    *hash = result;
+    return true;
+}
+
+unicode_string program_cache_file_name(unicode_view const cache_directory, unicode_view const current_directory,
+                                       unicode_view const module_directory, unicode_view const source_file_path,
+                                       execution_budget const compile_time_budget)
+{
+    uint64_t key = 0;
+    if (!identify_compiler(&key))
+    {
+        return unicode_string_from_c_str("");
+    }
+    key = hash_view(key, current_directory);
+    key = hash_view(key, module_directory);
+    key = hash_view(key, source_file_path);
+    key = hash_number(key, compile_time_budget.max_executed_instructions);
+    key = hash_number(key, compile_time_budget.max_recursion);
+    key = hash_number(key, compile_time_budget.max_frame_memory);
+    key = hash_number(key, compile_time_budget.max_heap_size);
+    key = hash_number(key, compile_time_budget.max_duration.milliseconds);
+    char file_name[16 + 5] = {0};
+    format_hash(key, file_name);
+    memcpy(file_name + 16, ".lpgc", 5);
+    unicode_view const pieces[] = {cache_directory, unicode_view_create(file_name, sizeof(file_name))};
+    return path_combine(pieces, LPG_ARRAY_SIZE(pieces));
+}
+
+static bool has_content_hash(unicode_view const path, uint64_t const expected)
+{
+    mapped_file_or_error const mapped = map_file(path);
+    if (mapped.error)
+    {
+        return false;
+    }
+    bool const result = (hash_bytes(hash_seed, mapped.success.data, mapped.success.length) == expected);
+    unmap_file(mapped.success);
+    return result;
+}
+
+/*The file starts with one line for every dependency that consists of the hexadecimal content hash and the path. The
+ * line of a path that did not exist has 16 dashes instead of the hash. An empty line separates the dependencies from
+ * the saved program.*/
+static optional_checked_program load_if_up_to_date(unicode_view const content, structure const globals)
+{
+    optional_checked_program const outdated = {
+        false, {NULL, 0, NULL, 0, {0}, NULL, 0, NULL, 0, {NULL, 0, 0, {NULL, 0, 0}}}};
+    size_t position = 0;
+    for (;;)
+    {
+        char const *const line_end = memchr(content.begin + position, '\n', content.length - position);
+        if (!line_end)
+        {
+            return outdated;
+        }
+        size_t const line_length = (size_t)(line_end - (content.begin + position));
+        if (line_length == 0)
+        {
+            ++position;
+            break;
+        }
+        if ((line_length < 18) || (content.begin[position + 16] != ' '))
+        {
+            return outdated;
+        }
+        unicode_view const path = unicode_view_create(content.begin + position + 17, line_length - 17);
+        if (!memcmp(content.begin + position, missing_marker, sizeof(missing_marker)))
+        {
+            if (file_exists(path))
+            {
+                return outdated;
+            }
+        }
+        else
+        {
+            uint64_t expected = 0;
+            if (!parse_hash(content.begin + position, &expected) || !has_content_hash(path, expected))
+            {
+                return outdated;
+            }
+        }
+        position += (line_length + 1);
+    }
+    return load_checked_program(unicode_view_cut(content, position, content.length), globals);
+}
+
+optional_checked_program program_cache_load(unicode_view const cache_file, structure const globals)
+{
+    optional_checked_program const missing = {
+        false, {NULL, 0, NULL, 0, {0}, NULL, 0, NULL, 0, {NULL, 0, 0, {NULL, 0, 0}}}};
+    mapped_file_or_error const mapped = map_file(cache_file);
+    if (mapped.error)
+    {
+        return missing;
+    }
+    optional_checked_program const result =
+        load_if_up_to_date(unicode_view_create(mapped.success.data, mapped.success.length), globals);
+    unmap_file(mapped.success);
+    return result;
+}
+
+/*Compilers that store the same cache file at the same time must not write into the same temporary file. The process id
+ * distinguishes them because a compiler stores at most one program at a time.*/
+static unicode_string temporary_file_name(unicode_view const cache_file)
+{
+#ifdef _WIN32
+    unsigned long long const process = (unsigned long long)_getpid();
+#else
+    unsigned long long const process = (unsigned long long)getpid();
+#endif
+    char suffix[32];
+    int const length = snprintf(suffix, sizeof(suffix), ".%llu.tmp", process);
+    ASSUME(length > 0);
+    ASSUME((size_t)length < sizeof(suffix));
+    return unicode_view_concat(cache_file, unicode_view_create(suffix, (size_t)length));
+}
+
+success_indicator program_cache_store(unicode_view const cache_file, program_cache_dependencies const dependencies,
+                                      checked_program const *const program, structure const globals)
+{
+    memory_writer content = {NULL, 0, 0};
+    for (size_t i = 0; i < dependencies.count; ++i)
+    {
+        unicode_view const path = unicode_view_from_string(dependencies.elements[i].path);
+        if ((path.length == 0) || memchr(path.begin, '\n', path.length))
+        {
+            memory_writer_free(&content);
+            return success_no;
+        }
+        char hash[17];
+        if (dependencies.elements[i].exists)
+        {
+            format_hash(dependencies.elements[i].content_hash, hash);
+        }
+        else
+        {
+            memcpy(hash, missing_marker, sizeof(missing_marker));
+        }
+        hash[16] = ' ';
+        ASSERT(success_yes == memory_writer_write(&content, hash, sizeof(hash)));
+        ASSERT(success_yes == memory_writer_write(&content, path.begin, path.length));
+        ASSERT(success_yes == memory_writer_write(&content, "\n", 1));
+    }
+    ASSERT(success_yes == memory_writer_write(&content, "\n", 1));
+    if (save_checked_program(program, globals, memory_writer_erase(&content)) != success_yes)
+    {
+        memory_writer_free(&content);
+        return success_no;
+    }
+    unicode_string temporary = temporary_file_name(cache_file);
+    success_indicator result = write_file(unicode_view_from_string(temporary), memory_writer_content(content));
+    if ((result == success_yes) && !rename_file(unicode_view_from_string(temporary), cache_file))
+    {
+        result = success_no;
+    }
+    if (result != success_yes)
+    {
+        /*the temporary file may not even have been created*/
+        (void)remove(unicode_string_c_str(&temporary));
+    }
+    unicode_string_free(&temporary);
+    memory_writer_free(&content);
+    return result;
+}
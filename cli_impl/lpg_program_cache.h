@@ -0,0 +1,51 @@
+#pragma once
+#include "lpg_interpret.h"
+#include "lpg_load_module.h"
+#include "lpg_save_program.h"
+
+/*a source file that a checked program has been compiled from or a path where an import looked for a module file that
+ * did not exist*/
+typedef struct program_cache_dependency
+{
+    unicode_string path;
+    bool exists;
+    /*only meaningful if exists is true*/
+    uint64_t content_hash;
+} program_cache_dependency;
+
+typedef struct program_cache_dependencies
+{
+    program_cache_dependency *elements;
+    size_t count;
+} program_cache_dependencies;
+
+program_cache_dependencies program_cache_dependencies_create(void) LPG_USE_RESULT;
+void program_cache_dependencies_free(program_cache_dependencies const freed);
+void program_cache_dependencies_add(LPG_NON_NULL(program_cache_dependencies *const dependencies),
+                                    unicode_view const path, unicode_view const content);
+/*ignores paths that have already been recorded as missing*/
+void program_cache_dependencies_add_missing(LPG_NON_NULL(program_cache_dependencies *const dependencies),
+                                            unicode_view const path);
+
+/*a module_read_handler that expects a program_cache_dependencies as the user*/
+void program_cache_record_module(unicode_view path, unicode_view content, callback_user user);
+
+/*a module_missing_handler that expects a program_cache_dependencies as the user*/
+void program_cache_record_missing_module(unicode_view path, callback_user user);
+
+/*Names the file in the cache directory that holds the program checked from the given source file. The name depends on
+ * everything besides the content of the sources that influences the result of check, including the executable of the
+ * compiler itself. Returns an empty string if the compiler cannot identify its executable, which disables the cache.*/
+unicode_string program_cache_file_name(unicode_view const cache_directory, unicode_view const current_directory,
+                                       unicode_view const module_directory, unicode_view const source_file_path,
+                                       execution_budget const compile_time_budget) LPG_USE_RESULT;
+
+/*Returns the cached program if the cache file exists, every source file it depends on still has the same content and
+ * none of the paths where an import did not find a module file exists now.*/
+optional_checked_program program_cache_load(unicode_view const cache_file, structure const globals) LPG_USE_RESULT;
+
+/*Replaces the cache file atomically so that concurrent compilers never read a half written file. Every process writes
+ * to its own temporary file next to the cache file.*/
+success_indicator program_cache_store(unicode_view const cache_file, program_cache_dependencies const dependencies,
+                                      LPG_NON_NULL(checked_program const *const program),
+                                      structure const globals) LPG_USE_RESULT;
@@ -188,7 +188,7 @@ static success_indicator generate_array_value(checked_function const *const curr
         {
             LPG_TRY(stream_writer_write_string(ecmascript_output, ", "));
         }
-        LPG_TRY(generate_value(current_function, strategy_cache, generated.elements[i], generated.element_type,
+        LPG_TRY(generate_value(current_function, strategy_cache, array_value_load(generated, i), generated.element_type,
                                all_functions, function_count, all_interfaces, all_structs, all_enums,
                                ecmascript_output));
     }
@@ -215,31 +215,30 @@ success_indicator generate_value(checked_function const *const current_function,
         LPG_TO_DO();
 
     case value_kind_type_erased:
+    {
+        type_erased_value const erased = value_as_type_erased(generated);
         LPG_TRY(stream_writer_write_string(ecmascript_output, "new "));
-        LPG_TRY(generate_implementation_name(
-            generated.type_erased.impl.target, generated.type_erased.impl.implementation_index, ecmascript_output));
+        LPG_TRY(generate_implementation_name(erased.impl.target, erased.impl.implementation_index, ecmascript_output));
         LPG_TRY(stream_writer_write_string(ecmascript_output, "("));
-        LPG_TRY(generate_value(current_function, strategy_cache, *generated.type_erased.self,
-                               all_interfaces[generated.type_erased.impl.target]
-                                   .implementations[generated.type_erased.impl.implementation_index]
-                                   .self,
-                               all_functions, function_count, all_interfaces, all_structs, all_enums,
-                               ecmascript_output));
+        type const self = all_interfaces[erased.impl.target].implementations[erased.impl.implementation_index].self;
+        LPG_TRY(generate_value(current_function, strategy_cache, *erased.self, self, all_functions, function_count,
+                               all_interfaces, all_structs, all_enums, ecmascript_output));
         LPG_TRY(stream_writer_write_string(ecmascript_output, ")"));
         return success_yes;
+    }
 
     case value_kind_integer:
     {
         uint64_t const max_ecmascript_int = 9007199254740991;
-        if (integer_less(integer_create(0, max_ecmascript_int), generated.integer_))
+        if (integer_less(integer_create(0, max_ecmascript_int), value_as_integer(generated)))
         {
-            if (generated.integer_.high > 0)
+            if (value_as_integer(generated).high > 0)
             {
                 LPG_TO_DO();
             }
             else
             {
-                uint64_t const low = generated.integer_.low;
+                uint64_t const low = value_as_integer(generated).low;
                 LPG_TRY(stream_writer_write_string(ecmascript_output, "["));
                 uint32_t const bits_per_element = 32;
                 LPG_TRY(stream_writer_write_integer(ecmascript_output, integer_create(0, (low >> bits_per_element))));
@@ -249,22 +248,24 @@ success_indicator generate_value(checked_function const *const current_function,
                 return stream_writer_write_string(ecmascript_output, "]");
             }
         }
-        return stream_writer_write_integer(ecmascript_output, generated.integer_);
+        return stream_writer_write_integer(ecmascript_output, value_as_integer(generated));
     }
 
     case value_kind_string:
-        return encode_string_literal(generated.string, ecmascript_output);
+        return encode_string_literal(value_as_string(generated), ecmascript_output);
 
     case value_kind_function_pointer:
-        ASSUME(!generated.function_pointer.external);
-        if (generated.function_pointer.capture_count > 0)
+    {
+        function_pointer_value const function = value_as_function_pointer(generated);
+        ASSUME(!function.external);
+        if (function.capture_count > 0)
         {
-            return generate_lambda_value_from_values(
-                current_function, strategy_cache, all_functions, function_count, all_interfaces, all_structs,
-                generated.function_pointer.code, generated.function_pointer.captures,
-                generated.function_pointer.capture_count, all_enums, ecmascript_output);
+            return generate_lambda_value_from_values(current_function, strategy_cache, all_functions, function_count,
+                                                     all_interfaces, all_structs, function.code, function.captures,
+                                                     function.capture_count, all_enums, ecmascript_output);
         }
-        return generate_function_name(generated.function_pointer.code, function_count, ecmascript_output);
+        return generate_function_name(function.code, function_count, ecmascript_output);
+    }
 
     case value_kind_generic_interface:
         return stream_writer_write_string(ecmascript_output, "/*generic interface*/ undefined");
@@ -280,7 +281,7 @@ success_indicator generate_value(checked_function const *const current_function,
 
     case value_kind_enum_element:
         ASSUME(type_of.kind == type_kind_enumeration);
-        return generate_enum_element(current_function, strategy_cache, generated.enum_element,
+        return generate_enum_element(current_function, strategy_cache, value_as_enum_element(generated),
                                      all_enums + type_of.enum_, all_functions, function_count, all_interfaces,
                                      all_structs, all_enums, ecmascript_output);
 
@@ -295,14 +296,14 @@ success_indicator generate_value(checked_function const *const current_function,
         LPG_TRY(stream_writer_write_string(ecmascript_output, "["));
         ASSUME(type_of.kind == type_kind_structure);
         structure const object = all_structs[type_of.structure_];
-        ASSUME(generated.structure.count == object.count);
+        ASSUME(value_as_structure(generated).count == object.count);
         for (size_t i = 0; i < object.count; ++i)
         {
             if (i > 0)
             {
                 LPG_TRY(stream_writer_write_string(ecmascript_output, ", "));
             }
-            LPG_TRY(generate_value(current_function, strategy_cache, generated.structure.members[i],
+            LPG_TRY(generate_value(current_function, strategy_cache, value_as_structure(generated).members[i],
                                    object.members[i].what, all_functions, function_count, all_interfaces, all_structs,
                                    all_enums, ecmascript_output));
         }
@@ -314,14 +315,14 @@ success_indicator generate_value(checked_function const *const current_function,
     {
         LPG_TRY(stream_writer_write_string(ecmascript_output, "["));
         ASSUME(type_of.kind == type_kind_tuple);
-        ASSUME(generated.tuple_.element_count == type_of.tuple_.length);
-        for (size_t i = 0; i < generated.tuple_.element_count; ++i)
+        ASSUME(value_as_tuple(generated).element_count == type_of.tuple_.length);
+        for (size_t i = 0; i < value_as_tuple(generated).element_count; ++i)
         {
             if (i > 0)
             {
                 LPG_TRY(stream_writer_write_string(ecmascript_output, ", "));
             }
-            LPG_TRY(generate_value(current_function, strategy_cache, generated.tuple_.elements[i],
+            LPG_TRY(generate_value(current_function, strategy_cache, value_as_tuple(generated).elements[i],
                                    type_of.tuple_.elements[i], all_functions, function_count, all_interfaces,
                                    all_structs, all_enums, ecmascript_output));
         }
@@ -388,7 +389,7 @@ success_indicator generate_register_read(function_generation *const state, regis
                               state->all_enums, ecmascript_output);
 
     case value_kind_function_pointer:
-        if (info.known_value.value_.function_pointer.capture_count > 0)
+        if (value_as_function_pointer(info.known_value.value_).capture_count > 0)
         {
             mark_register_as_used(state, id);
             return generate_register_name(state->current_function, id, ecmascript_output);
@@ -991,7 +992,7 @@ static success_indicator generate_new_array(function_generation *const state, ne
         state->strategy_cache, enum_constructor_type_create(load.result.enum_, 0), ecmascript_output));
     LPG_TRY(stream_writer_write_string(ecmascript_output, ", "));
     LPG_TRY(generate_enum_element(state->current_function, state->strategy_cache,
-                                  enum_element_value_create(1, NULL, type_from_unit()),
+                                  enum_element_value_create(1, NULL),
                                   state->all_enums + load.result.enum_, state->all_functions, state->function_count,
                                   state->all_interfaces, state->all_structs, state->all_enums, ecmascript_output));
     LPG_TRY(stream_writer_write_string(ecmascript_output, ");"));
@@ -1328,7 +1329,10 @@ lpg_interface make_array_interface(method_description array_methods[6])
         method_description_create(wrap_c_str_in_unicode_string("clear"), tuple_type_create(NULL, 0), type_from_unit());
     array_methods[5] =
         method_description_create(wrap_c_str_in_unicode_string("pop"), tuple_type_create(NULL, 0), type_from_unit());
-    lpg_interface const array_interface = interface_create(array_methods, 6, NULL, 0);
+    /*only used to generate the method names, so there is no index that would have to be freed*/
+    lpg_interface array_interface = interface_create(NULL, 0, NULL, 0);
+    array_interface.methods = array_methods;
+    array_interface.method_count = 6;
     return array_interface;
 }
 
@@ -176,8 +176,10 @@ success_indicator generate_enum_element(checked_function const *const current_fu
     enum_encoding_element const strategy_element = strategy->elements[element.which];
     if (element.state)
     {
+        optional_type const state_type = enum_->elements[element.which].state;
+        ASSUME(state_type.is_set);
         LPG_TRY(enum_construct_stateful_begin(strategy_element.stateful, element.which, ecmascript_output));
-        LPG_TRY(generate_value(current_function, strategy_cache, *element.state, element.state_type, all_functions,
+        LPG_TRY(generate_value(current_function, strategy_cache, *element.state, state_type.value, all_functions,
                                function_count, all_interfaces, all_structs, all_enums, ecmascript_output));
         LPG_TRY(enum_construct_stateful_end(strategy_element.stateful, ecmascript_output));
         return success_yes;
@@ -39,7 +39,8 @@ void ParserTypeCheckerFuzzTarget(uint8_t const *const data, size_t const size)
         checked_program checked =
             check(result.value, standard_library.globals, ignore_semantic_errors, &loader,
                   source_file_create(unicode_view_from_c_str("fuzzing"), source, source_file_lines_from_owning(lines)),
-                  unicode_view_from_c_str(LPG_FUZZ_MODULE_DIRECTORY), 100000, NULL);
+                  unicode_view_from_c_str(LPG_FUZZ_MODULE_DIRECTORY), default_compile_time_budget(100000), NULL,
+                  NULL);
         checked_program_free(&checked);
         standard_library_description_free(&standard_library);
     }
@@ -0,0 +1,145 @@
+#include "lpg_arena.h"
+#include "lpg_allocate.h"
+#include "lpg_arithmetic.h"
+#include "lpg_assert.h"
+#include <string.h>
+
+enum
+{
+    block_size = 1024 * 8,
+    alignment = 16
+};
+
+arena arena_create(void)
+{
+    arena const result = {NULL};
+    return result;
+}
+
+static void free_blocks(arena_block *block)
+{
+    while (block)
+    {
+        arena_block *const next = block->next;
+        deallocate(block);
+        block = next;
+    }
+}
+
+void arena_free(arena const freed)
+{
+    free_blocks(freed.blocks);
+}
+
+void arena_reset(arena *const resetting)
+{
+    if (!resetting->blocks)
+    {
+        return;
+    }
+    free_blocks(resetting->blocks->next);
+    resetting->blocks->next = NULL;
+    resetting->blocks->used = 0;
+}
+
+void *arena_allocate_array(arena *const from, size_t const length, size_t const element)
+{
+    optional_size const bytes = size_multiply(length, element);
+    ASSERT(bytes.state == optional_set);
+    if (bytes.value_if_set == 0)
+    {
+        return NULL;
+    }
+    size_t const remaining_in_block = from->blocks ? (from->blocks->size - from->blocks->used) : 0u;
+    if (remaining_in_block < bytes.value_if_set)
+    {
+        size_t const new_block_size = (bytes.value_if_set > block_size) ? bytes.value_if_set : block_size;
+        arena_block *const new_block = allocate(sizeof(*new_block) + new_block_size);
+        new_block->next = from->blocks;
+        new_block->used = 0;
+        new_block->size = new_block_size;
+        from->blocks = new_block;
+    }
+    void *const result = (from->blocks->data + from->blocks->used);
+    from->blocks->used += bytes.value_if_set;
+    from->blocks->used += (alignment - 1u);
+    from->blocks->used &= ~(size_t)(alignment - 1u);
+    if (from->blocks->used > from->blocks->size)
+    {
+        from->blocks->used = from->blocks->size;
+    }
+    memset(result, 0, bytes.value_if_set);
+    return result;
+}
+
+void *arena_reallocate_array_exponentially(arena *const from, void *array, size_t const new_size,
+                                           size_t const element, size_t const current_size, size_t *const capacity)
+{
+    size_t const old_capacity = *capacity;
+    ASSUME(current_size <= old_capacity);
+    if (old_capacity >= new_size)
+    {
+        return array;
+    }
+    optional_size new_capacity = size_multiply(old_capacity, 2);
+    ASSERT(new_capacity.state == optional_set);
+    if (new_capacity.value_if_set < new_size)
+    {
+        new_capacity.value_if_set = new_size;
+    }
+    void *const result = arena_allocate_array(from, new_capacity.value_if_set, element);
+    if (current_size > 0)
+    {
+        memcpy(result, array, (current_size * element));
+    }
+    *capacity = new_capacity.value_if_set;
+    return result;
+}
+
+arena_pool arena_pool_create(void)
+{
+    arena_pool const result = {NULL, 0, NULL, 0};
+    return result;
+}
+
+void arena_pool_free(arena_pool const freed)
+{
+    for (size_t i = 0; i < freed.arena_count; ++i)
+    {
+        arena_free(*freed.arenas[i]);
+        deallocate(freed.arenas[i]);
+    }
+    if (freed.arenas)
+    {
+        deallocate(freed.arenas);
+    }
+    if (freed.unused)
+    {
+        deallocate(freed.unused);
+    }
+}
+
+arena *arena_pool_take(arena_pool *const from)
+{
+    if (from->unused_count > 0)
+    {
+        --from->unused_count;
+        return from->unused[from->unused_count];
+    }
+    arena *const created = allocate(sizeof(*created));
+    *created = arena_create();
+    from->arenas = reallocate_array(from->arenas, (from->arena_count + 1), sizeof(*from->arenas));
+    from->arenas[from->arena_count] = created;
+    ++from->arena_count;
+    /*every arena can be given back, so there is always room for all of them*/
+    from->unused = reallocate_array(from->unused, from->arena_count, sizeof(*from->unused));
+    return created;
+}
+
+void arena_pool_give_back(arena_pool *const to, arena *const returned)
+{
+    ASSUME(to->unused_count < to->arena_count);
+    arena_reset(returned);
+    to->unused[to->unused_count] = returned;
+    ++to->unused_count;
+}
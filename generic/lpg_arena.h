@@ -0,0 +1,53 @@
+#pragma once
+#include "lpg_non_null.h"
+#include "lpg_use_result.h"
+#include <stddef.h>
+
+typedef struct arena_block
+{
+    struct arena_block *next;
+    size_t used;
+    size_t size;
+    char data[
+#ifdef _MSC_VER
+        1
+#endif
+    ];
+} arena_block;
+
+/*Hands out memory for data that is only needed for a while. The memory is not freed individually, but all at once by
+ * arena_free or arena_reset. That saves a call of allocate for almost every allocation and the code that would free the
+ * data on every path.*/
+typedef struct arena
+{
+    /*the block that memory is currently taken from comes first*/
+    arena_block *blocks;
+} arena;
+
+arena arena_create(void) LPG_USE_RESULT;
+void arena_free(arena const freed);
+/*Makes all of the memory available again. The most recent block is kept for the next allocations.*/
+void arena_reset(LPG_NON_NULL(arena *const resetting));
+/*the memory is filled with zeros like with allocate_array*/
+void *arena_allocate_array(LPG_NON_NULL(arena *const from), size_t const length, size_t const element) LPG_USE_RESULT;
+/*Like reallocate_array_exponentially, but the old array is copied to the arena and remains there until it is reset.*/
+void *arena_reallocate_array_exponentially(LPG_NON_NULL(arena *const from), void *array, size_t const new_size,
+                                           size_t const element, size_t const current_size,
+                                           LPG_NON_NULL(size_t *const capacity)) LPG_USE_RESULT;
+
+/*Keeps the arenas that are not in use, so that a short-lived arena does not have to allocate its blocks again.*/
+typedef struct arena_pool
+{
+    /*every arena that the pool has created*/
+    arena **arenas;
+    size_t arena_count;
+    arena **unused;
+    size_t unused_count;
+} arena_pool;
+
+arena_pool arena_pool_create(void) LPG_USE_RESULT;
+void arena_pool_free(arena_pool const freed);
+/*The arena is owned by the pool, which frees it even if it has not been given back. It remains at the same address.*/
+arena *arena_pool_take(LPG_NON_NULL(arena_pool *const from)) LPG_USE_RESULT;
+/*resets the arena so that the next arena_pool_take can return it*/
+void arena_pool_give_back(LPG_NON_NULL(arena_pool *const to), LPG_NON_NULL(arena *const returned));
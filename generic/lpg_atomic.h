@@ -17,6 +17,12 @@ inline size_t atomic_size_load(size_t *atomic)
 {
     return *(size_t volatile *)atomic;
 }
+
+/*returns the value from before the increment*/
+inline size_t atomic_size_fetch_increment(size_t *atomic)
+{
+    return (InterlockedIncrementSizeT(atomic) - 1);
+}
 #else
 static inline void atomic_size_increment(size_t *atomic)
 {
@@ -34,4 +40,10 @@ static inline size_t atomic_size_load(size_t *atomic)
     __atomic_load(atomic, &result, __ATOMIC_RELAXED);
     return result;
 }
+
+/*returns the value from before the increment*/
+static inline size_t atomic_size_fetch_increment(size_t *atomic)
+{
+    return __atomic_fetch_add(atomic, 1, __ATOMIC_RELAXED);
+}
 #endif
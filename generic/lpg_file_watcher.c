@@ -0,0 +1,177 @@
+#include "lpg_file_watcher.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#ifdef __linux__
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+file_watcher file_watcher_create(void)
+{
+#ifdef __linux__
+    file_watcher const result = {inotify_init1(IN_CLOEXEC), NULL, 0};
+#else
+    file_watcher const result = {-1, NULL, 0};
+#endif
+    return result;
+}
+
+void file_watcher_free(file_watcher const freed)
+{
+    for (size_t i = 0; i < freed.directory_count; ++i)
+    {
+        unicode_string_free(&freed.directories[i]);
+    }
+    if (freed.directories)
+    {
+        deallocate(freed.directories);
+    }
+#ifdef __linux__
+    if (freed.handle >= 0)
+    {
+        ASSERT(close(freed.handle) == 0);
+    }
+#endif
+}
+
+bool file_watcher_is_available(file_watcher const watcher)
+{
+    return (watcher.handle >= 0);
+}
+
+void file_watcher_add_directory(file_watcher *const watcher, unicode_view const directory)
+{
+    if (!file_watcher_is_available(*watcher))
+    {
+        return;
+    }
+    for (size_t i = 0; i < watcher->directory_count; ++i)
+    {
+        if (unicode_view_equals(unicode_view_from_string(watcher->directories[i]), directory))
+        {
+            return;
+        }
+    }
+#ifdef __linux__
+    unicode_string const zero_terminated = unicode_view_zero_terminate(directory);
+    int const watch = inotify_add_watch(watcher->handle, zero_terminated.data,
+                                        IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+    unicode_string_free(&zero_terminated);
+    if (watch < 0)
+    {
+        return;
+    }
+#endif
+    watcher->directories =
+        reallocate_array(watcher->directories, (watcher->directory_count + 1), sizeof(*watcher->directories));
+    watcher->directories[watcher->directory_count] = unicode_view_copy(directory);
+    ++(watcher->directory_count);
+}
+
+#ifdef __linux__
+typedef enum watched_events {
+    watched_events_failed,
+    watched_events_timeout,
+    /*only files without the extension have changed*/
+    watched_events_other,
+    /*the last matching event left a file that is about to be written, like a file that has just been created*/
+    watched_events_matching_unfinished,
+    /*the last matching event completed a change, like a file that has been closed after writing*/
+    watched_events_matching_finished
+} watched_events;
+
+static watched_events read_events(int const handle, unicode_view const extension, int const timeout_milliseconds)
+{
+    struct pollfd polled = {handle, POLLIN, 0};
+    int const ready = poll(&polled, 1, timeout_milliseconds);
+    if (ready < 0)
+    {
+        return (errno == EINTR) ? watched_events_other : watched_events_failed;
+    }
+    if (ready == 0)
+    {
+        return watched_events_timeout;
+    }
+    _Alignas(struct inotify_event) char buffer[4096];
+    ssize_t const length = read(handle, buffer, sizeof(buffer));
+    if (length <= 0)
+    {
+        return watched_events_failed;
+    }
+    watched_events result = watched_events_other;
+    for (char const *next = buffer; next < (buffer + length);)
+    {
+        struct inotify_event const *const event = (struct inotify_event const *)next;
+        if (event->len > 0)
+        {
+            unicode_view const name = unicode_view_from_c_str(event->name);
+            if ((name.length >= extension.length) &&
+                unicode_view_equals(unicode_view_cut(name, (name.length - extension.length), name.length), extension))
+            {
+                result = (event->mask & (IN_CREATE | IN_MOVED_FROM)) ? watched_events_matching_unfinished
+                                                                     : watched_events_matching_finished;
+            }
+        }
+        next += (sizeof(*event) + event->len);
+    }
+    return result;
+}
+#endif
+
+bool file_watcher_wait(file_watcher *const watcher, unicode_view const extension, duration const quiet_period)
+{
+    if (!file_watcher_is_available(*watcher) || (watcher->directory_count == 0))
+    {
+        return false;
+    }
+#ifdef __linux__
+    bool is_finished = false;
+    for (;;)
+    {
+        watched_events const changed = read_events(watcher->handle, extension, -1);
+        if (changed == watched_events_failed)
+        {
+            return false;
+        }
+        if (changed == watched_events_matching_unfinished)
+        {
+            break;
+        }
+        if (changed == watched_events_matching_finished)
+        {
+            is_finished = true;
+            break;
+        }
+    }
+    /*An editor often writes a file in several steps. The quiet period only has to pass while a file is known to be in
+     * the middle of such steps. The events that have been queued already are collected in any case.*/
+    ASSUME(quiet_period.milliseconds <= INT_MAX);
+    for (;;)
+    {
+        switch (read_events(watcher->handle, extension, is_finished ? 0 : (int)quiet_period.milliseconds))
+        {
+        case watched_events_failed:
+        case watched_events_timeout:
+            return true;
+
+        case watched_events_other:
+            break;
+
+        case watched_events_matching_unfinished:
+            is_finished = false;
+            break;
+
+        case watched_events_matching_finished:
+            is_finished = true;
+            break;
+        }
+    }
+#else
+    (void)extension;
+    (void)quiet_period;
+    LPG_UNREACHABLE();
+#endif
+}
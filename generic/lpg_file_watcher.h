@@ -0,0 +1,26 @@
+#pragma once
+#include "lpg_monotonic_clock.h"
+#include "lpg_unicode_string.h"
+#include "lpg_unicode_view.h"
+
+/*Reports changes of the files in a set of directories. Directories are watched instead of files because many editors
+ * replace a file instead of writing to it. Only Linux is supported for now.*/
+typedef struct file_watcher
+{
+    /*the inotify instance or -1 if files cannot be watched*/
+    int handle;
+    unicode_string *directories;
+    size_t directory_count;
+} file_watcher;
+
+file_watcher file_watcher_create(void) LPG_USE_RESULT;
+void file_watcher_free(file_watcher const freed);
+bool file_watcher_is_available(file_watcher const watcher) LPG_USE_RESULT;
+/*does nothing if the directory is already being watched*/
+void file_watcher_add_directory(LPG_NON_NULL(file_watcher *const watcher), unicode_view const directory);
+/*Blocks until a file whose name ends with the extension has been written, created, renamed or removed in one of the
+ * directories. Changes that are already queued are reported together. The quiet period is only waited for while the
+ * last change left a file that has yet to be written, like a file that has just been created or renamed away. Returns
+ * false if the files cannot be watched.*/
+bool file_watcher_wait(LPG_NON_NULL(file_watcher *const watcher), unicode_view const extension,
+                       duration const quiet_period) LPG_USE_RESULT;
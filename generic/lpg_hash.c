@@ -0,0 +1,12 @@
+#include "lpg_hash.h"
+
+uint64_t hash_bytes(uint64_t const previous, char const *const data, size_t const length)
+{
+    uint64_t hash = previous;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (uint8_t)data[i];
+        hash *= UINT64_C(1099511628211);
+    }
+    return hash;
+}
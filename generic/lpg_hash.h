@@ -0,0 +1,11 @@
+#pragma once
+#include "lpg_use_result.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*the initial state of hash_bytes*/
+static uint64_t const hash_seed = UINT64_C(14695981039346656037);
+
+/*Continues the 64 bit FNV-1a hash of a sequence of bytes. The hash is not suitable against malicious input, but it is
+ * good enough to tell whether a file has changed.*/
+uint64_t hash_bytes(uint64_t const previous, char const *const data, size_t const length) LPG_USE_RESULT;
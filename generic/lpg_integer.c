@@ -126,6 +126,15 @@ bool integer_difference_equals(integer_difference const left, integer_difference
 
 integer_difference integer_subtract(integer minuend, integer subtrahend)
 {
+    if (integer_is_small(minuend) && integer_is_small(subtrahend))
+    {
+        uint64_t difference = 0;
+        if (integer_subtract_small(minuend.low, subtrahend.low, &difference))
+        {
+            return integer_difference_create(integer_create(0, difference));
+        }
+        return integer_difference_negative();
+    }
     if (integer_less(minuend, subtrahend))
     {
         return integer_difference_negative();
@@ -185,6 +194,15 @@ bool integer_multiply(integer *left, integer right)
 
 bool integer_add(integer *left, integer right)
 {
+    if (integer_is_small(*left) && integer_is_small(right))
+    {
+        uint64_t sum = 0;
+        if (integer_add_small(left->low, right.low, &sum))
+        {
+            left->low = sum;
+            return 1;
+        }
+    }
     uint64_t const low = (left->low + right.low);
     uint64_t high = left->high;
     if (low < right.low)
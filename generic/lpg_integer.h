@@ -30,6 +30,36 @@ integer integer_minimum(integer const first, integer const second);
 
 bool integer_add(LPG_NON_NULL(integer *left), integer right) LPG_USE_RESULT;
 
+/*Most integers in a program fit into 64 bits. Their high half is zero, so they can be computed with native 64 bit
+ * instructions. The 128 bit algorithms are only needed when an operand or a result does not fit.*/
+static inline bool integer_is_small(integer const checked)
+{
+    return (checked.high == 0);
+}
+
+/*returns false on overflow*/
+static inline bool integer_add_small(uint64_t const left, uint64_t const right, LPG_NON_NULL(uint64_t *const sum))
+{
+#ifdef __GNUC__
+    return !__builtin_add_overflow(left, right, sum);
+#else
+    *sum = (left + right);
+    return (*sum >= left);
+#endif
+}
+
+/*returns false if the difference would be negative*/
+static inline bool integer_subtract_small(uint64_t const minuend, uint64_t const subtrahend,
+                                          LPG_NON_NULL(uint64_t *const difference))
+{
+#ifdef __GNUC__
+    return !__builtin_sub_overflow(minuend, subtrahend, difference);
+#else
+    *difference = (minuend - subtrahend);
+    return (subtrahend <= minuend);
+#endif
+}
+
 typedef struct integer_difference
 {
     bool is_positive;
@@ -0,0 +1,93 @@
+#ifndef _MSC_VER
+#define _FILE_OFFSET_BITS 64
+#endif
+#include "lpg_map_file.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_unicode_string.h"
+#ifdef _WIN32
+#include "lpg_read_file.h"
+#else
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static mapped_file_or_error make_mapped_file_error(char const *const error)
+{
+    mapped_file_or_error const result = {error, {NULL, 0, NULL}};
+    return result;
+}
+
+#ifdef _WIN32
+mapped_file_or_error map_file(unicode_view const name)
+{
+    blob_or_error const read = read_file_unicode_view_name(name);
+    if (read.error)
+    {
+        return make_mapped_file_error(read.error);
+    }
+    /*the buffer is released like any other allocation*/
+    mapped_file_or_error const result = {NULL, {read.success.data, read.success.length, read.success.data}};
+    return result;
+}
+
+void unmap_file(mapped_file const unmapped)
+{
+    if (unmapped.mapping)
+    {
+        deallocate(unmapped.mapping);
+    }
+}
+#else
+mapped_file_or_error map_file(unicode_view const name)
+{
+    unicode_string const zero_name = unicode_view_zero_terminate(name);
+    int const file = open(zero_name.data, O_RDONLY);
+    unicode_string_free(&zero_name);
+    if (file < 0)
+    {
+        return make_mapped_file_error("Could not open file\n");
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0)
+    {
+        close(file);
+        return make_mapped_file_error("Could not determine size of file\n");
+    }
+#if (SIZE_MAX < UINT64_MAX)
+    if ((uint64_t)status.st_size > SIZE_MAX)
+    {
+        close(file);
+        return make_mapped_file_error("File does not fit into memory\n");
+    }
+#endif
+    size_t const length = (size_t)status.st_size;
+    if (length == 0)
+    {
+        /*mmap does not accept empty mappings*/
+        close(file);
+        mapped_file_or_error const empty = {NULL, {"", 0, NULL}};
+        return empty;
+    }
+    void *const mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, file, 0);
+    /*the mapping stays valid after the file has been closed*/
+    close(file);
+    if (mapping == MAP_FAILED)
+    {
+        return make_mapped_file_error("Could not map file into memory\n");
+    }
+    mapped_file_or_error const result = {NULL, {mapping, length, mapping}};
+    return result;
+}
+
+void unmap_file(mapped_file const unmapped)
+{
+    if (unmapped.mapping)
+    {
+        ASSERT(munmap(unmapped.mapping, unmapped.length) == 0);
+    }
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+#include "lpg_non_null.h"
+#include "lpg_unicode_view.h"
+#include "lpg_use_result.h"
+
+/*the read-only content of a whole file*/
+typedef struct mapped_file
+{
+    char const *data;
+    size_t length;
+    /*how the memory has to be released*/
+    void *mapping;
+} mapped_file;
+
+typedef struct mapped_file_or_error
+{
+    char const *error;
+    mapped_file success;
+} mapped_file_or_error;
+
+/*Maps the file into memory where the operating system supports it so that only the pages that are actually read are
+ * loaded. Reads the file into an allocated buffer otherwise.*/
+mapped_file_or_error map_file(unicode_view const name) LPG_USE_RESULT;
+void unmap_file(mapped_file const unmapped);
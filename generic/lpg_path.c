@@ -7,6 +7,7 @@
 #include <Windows.h>
 #else
 #include <errno.h>
+#include <stdlib.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
@@ -119,6 +120,45 @@ unicode_string get_current_executable_path(void)
 #endif
 }
 
+unicode_string path_canonicalize(unicode_view const path)
+{
+#ifdef _WIN32
+    win32_string const path_argument = to_win32_path(path);
+    DWORD const length = GetFullPathNameW(path_argument.c_str, 0, NULL, NULL);
+    if (length == 0)
+    {
+        win32_string_free(path_argument);
+        return unicode_view_copy(path);
+    }
+    wchar_t *const buffer = allocate_array(length, sizeof(*buffer));
+    DWORD const written = GetFullPathNameW(path_argument.c_str, length, buffer, NULL);
+    win32_string_free(path_argument);
+    ASSERT(written < length);
+    win32_string const full = win32_string_create(buffer, written);
+    unicode_string result = from_win32_string(full);
+    win32_string_free(full);
+#else
+    unicode_string const zero_terminated_path = unicode_view_zero_terminate(path);
+    char *const resolved = realpath(zero_terminated_path.data, NULL);
+    unicode_string_free(&zero_terminated_path);
+    if (!resolved)
+    {
+        return unicode_view_copy(path);
+    }
+    unicode_string result = unicode_string_from_c_str(resolved);
+    /*realpath uses malloc directly, so the result cannot be passed to deallocate*/
+    free(resolved);
+#endif
+    for (size_t i = 0; i < result.length; ++i)
+    {
+        if (result.data[i] == '\\')
+        {
+            result.data[i] = '/';
+        }
+    }
+    return result;
+}
+
 bool directory_exists(unicode_view const path)
 {
 #ifdef _WIN32
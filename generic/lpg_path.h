@@ -5,6 +5,9 @@
 unicode_view path_remove_leaf(unicode_view const full) LPG_USE_RESULT;
 unicode_string path_combine(unicode_view const *begin, size_t count) LPG_USE_RESULT;
 unicode_string get_current_executable_path(void) LPG_USE_RESULT;
+/*An absolute path without symbolic links or relative pieces which is the same for every way to reach an existing file.
+ * The path is returned unchanged if it cannot be resolved.*/
+unicode_string path_canonicalize(unicode_view const path) LPG_USE_RESULT;
 bool directory_exists(unicode_view const path) LPG_USE_RESULT;
 bool file_exists(unicode_view const path) LPG_USE_RESULT;
 success_indicator create_directory(unicode_view const path) LPG_USE_RESULT;
@@ -0,0 +1,68 @@
+#include "lpg_position_index.h"
+#include "lpg_allocate.h"
+
+position_index position_index_create(void)
+{
+    position_index const result = {NULL, 0, 0};
+    return result;
+}
+
+void position_index_free(position_index const freed)
+{
+    if (freed.slots)
+    {
+        deallocate(freed.slots);
+    }
+}
+
+static void insert_slot(position_index *const index, hashed_position const inserted)
+{
+    size_t slot = (size_t)(inserted.hash & (index->capacity - 1u));
+    while (index->slots[slot].position)
+    {
+        slot = ((slot + 1) & (index->capacity - 1u));
+    }
+    index->slots[slot] = inserted;
+    ++(index->count);
+}
+
+void position_index_insert(position_index *const index, uint64_t const hash, size_t const position)
+{
+    if (((index->count + 1) * 2) > index->capacity)
+    {
+        position_index const old = *index;
+        index->capacity = ((old.capacity == 0) ? 16 : (old.capacity * 2));
+        index->slots = allocate_array(index->capacity, sizeof(*index->slots));
+        index->count = 0;
+        for (size_t i = 0; i < old.capacity; ++i)
+        {
+            if (old.slots[i].position)
+            {
+                insert_slot(index, old.slots[i]);
+            }
+        }
+        position_index_free(old);
+    }
+    hashed_position const inserted = {hash, (position + 1)};
+    insert_slot(index, inserted);
+}
+
+optional_size position_index_find(position_index const index, uint64_t const hash, position_index_matches *matches,
+                                  void const *user)
+{
+    if (index.count == 0)
+    {
+        return optional_size_empty;
+    }
+    size_t slot = (size_t)(hash & (index.capacity - 1u));
+    while (index.slots[slot].position)
+    {
+        hashed_position const candidate = index.slots[slot];
+        if ((candidate.hash == hash) && matches(user, (candidate.position - 1)))
+        {
+            return make_optional_size(candidate.position - 1);
+        }
+        slot = ((slot + 1) & (index.capacity - 1u));
+    }
+    return optional_size_empty;
+}
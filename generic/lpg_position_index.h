@@ -0,0 +1,30 @@
+#pragma once
+#include "lpg_arithmetic.h"
+#include "lpg_non_null.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct hashed_position
+{
+    uint64_t hash;
+    /*the position plus one or 0 if the slot is unused*/
+    size_t position;
+} hashed_position;
+
+/*An open addressing hash table of positions in an array that is owned by somebody else. The owner hashes and compares
+ * the elements.*/
+typedef struct position_index
+{
+    hashed_position *slots;
+    size_t capacity;
+    size_t count;
+} position_index;
+
+typedef bool position_index_matches(void const *user, size_t const position);
+
+position_index position_index_create(void) LPG_USE_RESULT;
+void position_index_free(position_index const freed);
+void position_index_insert(LPG_NON_NULL(position_index *const index), uint64_t const hash, size_t const position);
+/*returns a position with the hash for which matches returns true*/
+optional_size position_index_find(position_index const index, uint64_t const hash,
+                                  LPG_NON_NULL(position_index_matches *matches), void const *user) LPG_USE_RESULT;
@@ -0,0 +1,66 @@
+#include "lpg_worker_pool.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_atomic.h"
+#include "lpg_thread.h"
+
+typedef struct worker_pool
+{
+    worker_pool_job run_job;
+    void *user;
+    size_t job_count;
+    /*the index of the next job that no worker has taken yet*/
+    size_t next_job;
+} worker_pool;
+
+typedef struct worker
+{
+    worker_pool *pool;
+    size_t index;
+} worker;
+
+static void work(void *argument)
+{
+    worker const *const self = argument;
+    for (;;)
+    {
+        size_t const job = atomic_size_fetch_increment(&self->pool->next_job);
+        if (job >= self->pool->job_count)
+        {
+            return;
+        }
+        self->pool->run_job(self->pool->user, job, self->index);
+    }
+}
+
+void worker_pool_run(worker_pool_job run_job, void *user, size_t const job_count, size_t const worker_count)
+{
+    ASSUME(worker_count >= 1);
+    worker_pool pool = {run_job, user, job_count, 0};
+    worker *const workers = allocate_array(worker_count, sizeof(*workers));
+    lpg_thread *const threads = allocate_array(worker_count, sizeof(*threads));
+    for (size_t i = 0; i < worker_count; ++i)
+    {
+        workers[i].pool = &pool;
+        workers[i].index = i;
+        threads[i] = NULL;
+    }
+    for (size_t i = 1; i < worker_count; ++i)
+    {
+        create_thread_result const created = create_thread(work, &workers[i]);
+        if (created.is_success == success_yes)
+        {
+            threads[i] = created.success;
+        }
+    }
+    work(&workers[0]);
+    for (size_t i = 1; i < worker_count; ++i)
+    {
+        if (threads[i])
+        {
+            join_thread(threads[i]);
+        }
+    }
+    deallocate(threads);
+    deallocate(workers);
+}
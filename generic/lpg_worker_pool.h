@@ -0,0 +1,13 @@
+#pragma once
+#include "lpg_non_null.h"
+#include <stddef.h>
+
+/*does the job with the given index. The worker is the index of the thread that does the job, so that every thread can
+ * have its own state.*/
+typedef void (*worker_pool_job)(void *user, size_t const job, size_t const worker);
+
+/*Does all the jobs with worker_count threads including the calling thread and returns when every job has been done.
+ * A worker takes the next job as soon as it has finished the previous one. If a thread can not be created, the other
+ * workers do its share of the jobs.*/
+void worker_pool_run(LPG_NON_NULL(worker_pool_job run_job), void *user, size_t const job_count,
+                     size_t const worker_count);
@@ -0,0 +1,588 @@
+#include "lpg_bytecode.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_standard_library.h"
+
+typedef struct register_reads
+{
+    size_t total;
+    /*reads by call instructions that call the value of the register*/
+    size_t as_callee;
+} register_reads;
+
+typedef struct bytecode_builder
+{
+    bytecode result;
+    size_t operation_capacity;
+    size_t match_capacity;
+    /*how many instructions read each register*/
+    register_reads *reads;
+    /*the bind_method operation that writes to a register, or no_operation*/
+    size_t *bound_methods;
+    /*the builtin that a lookup_builtin operation has found for a register*/
+    bytecode_builtin *builtins;
+} bytecode_builder;
+
+static size_t const no_operation = ~(size_t)0;
+
+static void count_read(register_reads *const reads, register_id const read)
+{
+    reads[read].total += 1;
+}
+
+static void count_register_reads(instruction_sequence const from, register_reads *const reads)
+{
+    for (size_t i = 0; i < from.length; ++i)
+    {
+        instruction const *const current = from.elements + i;
+        switch (current->type)
+        {
+        case instruction_get_method:
+            count_read(reads, current->get_method.from);
+            break;
+
+        case instruction_call:
+            count_read(reads, current->call.callee);
+            reads[current->call.callee].as_callee += 1;
+            for (size_t j = 0; j < current->call.argument_count; ++j)
+            {
+                count_read(reads, current->call.arguments[j]);
+            }
+            break;
+
+        case instruction_return:
+            count_read(reads, current->return_.returned_value);
+            break;
+
+        case instruction_loop:
+            count_register_reads(current->loop.body, reads);
+            break;
+
+        case instruction_read_struct:
+            count_read(reads, current->read_struct.from_object);
+            break;
+
+        case instruction_break:
+            if (current->break_.loop_result.is_set)
+            {
+                count_read(reads, current->break_.loop_result.value);
+            }
+            break;
+
+        case instruction_current_function:
+        case instruction_new_array:
+        case instruction_global:
+        case instruction_literal:
+        case instruction_get_captures:
+            break;
+
+        case instruction_tuple:
+            for (size_t j = 0; j < current->tuple_.element_count; ++j)
+            {
+                count_read(reads, current->tuple_.elements[j]);
+            }
+            break;
+
+        case instruction_instantiate_struct:
+            for (size_t j = 0; j < current->instantiate_struct.argument_count; ++j)
+            {
+                count_read(reads, current->instantiate_struct.arguments[j]);
+            }
+            break;
+
+        case instruction_enum_construct:
+            count_read(reads, current->enum_construct.state);
+            break;
+
+        case instruction_match:
+            count_read(reads, current->match.key);
+            for (size_t j = 0; j < current->match.count; ++j)
+            {
+                match_instruction_case const *const this_case = current->match.cases + j;
+                switch (this_case->kind)
+                {
+                case match_instruction_case_kind_stateful_enum:
+                case match_instruction_case_kind_default:
+                    break;
+
+                case match_instruction_case_kind_value:
+                    count_read(reads, this_case->key_value);
+                    break;
+                }
+                count_register_reads(this_case->action, reads);
+                if (this_case->value.is_set)
+                {
+                    count_read(reads, this_case->value.value);
+                }
+            }
+            break;
+
+        case instruction_lambda_with_captures:
+            for (size_t j = 0; j < current->lambda_with_captures.capture_count; ++j)
+            {
+                count_read(reads, current->lambda_with_captures.captures[j]);
+            }
+            break;
+
+        case instruction_erase_type:
+            count_read(reads, current->erase_type.self);
+            break;
+        }
+    }
+}
+
+/*operations whose target is not known yet*/
+typedef struct pending_jumps
+{
+    size_t *operations;
+    size_t count;
+    size_t capacity;
+} pending_jumps;
+
+static void pending_jumps_add(pending_jumps *const to, size_t const operation)
+{
+    to->operations = reallocate_array_exponentially(
+        to->operations, (to->count + 1), sizeof(*to->operations), to->count, &to->capacity);
+    to->operations[to->count] = operation;
+    ++(to->count);
+}
+
+static void pending_jumps_resolve(pending_jumps const jumps, bytecode *const code, size_t const target)
+{
+    for (size_t i = 0; i < jumps.count; ++i)
+    {
+        code->operations[jumps.operations[i]].target = target;
+    }
+    if (jumps.operations)
+    {
+        deallocate(jumps.operations);
+    }
+}
+
+static size_t emit(bytecode_builder *const builder, bytecode_opcode const opcode, instruction const *const original)
+{
+    bytecode *const code = &builder->result;
+    code->operations =
+        reallocate_array_exponentially(code->operations, (code->operation_count + 1), sizeof(*code->operations),
+                                       code->operation_count, &builder->operation_capacity);
+    size_t const index = code->operation_count;
+    code->operations[index].opcode = opcode;
+    code->operations[index].target = 0;
+    code->operations[index].original = original;
+    code->operations[index].finished_case = NULL;
+    code->operations[index].is_tail_call = false;
+    code->operations[index].builtin = bytecode_builtin_none;
+    ++(code->operation_count);
+    return index;
+}
+
+static size_t add_match(bytecode_builder *const builder, match_instruction const *const original,
+                        match_table const table, size_t const case_count)
+{
+    bytecode *const code = &builder->result;
+    code->matches = reallocate_array_exponentially(
+        code->matches, (code->match_count + 1), sizeof(*code->matches), code->match_count, &builder->match_capacity);
+    size_t const index = code->match_count;
+    code->matches[index].original = original;
+    code->matches[index].table = table;
+    code->matches[index].case_targets = allocate_array(case_count, sizeof(*code->matches[index].case_targets));
+    ++(code->match_count);
+    return index;
+}
+
+static bytecode_opcode simple_opcode(instruction_type const from)
+{
+    switch (from)
+    {
+    case instruction_global:
+        return bytecode_opcode_global;
+
+    case instruction_read_struct:
+        return bytecode_opcode_read_struct;
+
+    case instruction_literal:
+        return bytecode_opcode_literal;
+
+    case instruction_tuple:
+        return bytecode_opcode_tuple;
+
+    case instruction_enum_construct:
+        return bytecode_opcode_enum_construct;
+
+    case instruction_get_captures:
+        return bytecode_opcode_get_captures;
+
+    case instruction_lambda_with_captures:
+        return bytecode_opcode_lambda_with_captures;
+
+    case instruction_erase_type:
+        return bytecode_opcode_erase_type;
+
+    case instruction_return:
+        return bytecode_opcode_return;
+
+    case instruction_instantiate_struct:
+        return bytecode_opcode_instantiate_struct;
+
+    case instruction_new_array:
+        return bytecode_opcode_new_array;
+
+    case instruction_current_function:
+        return bytecode_opcode_current_function;
+
+    case instruction_call:
+    case instruction_get_method:
+    case instruction_loop:
+    case instruction_break:
+    case instruction_match:
+        LPG_UNREACHABLE();
+    }
+    LPG_UNREACHABLE();
+}
+
+static bytecode_builtin find_builtin(read_struct_instruction const read_struct)
+{
+    switch (read_struct.member)
+    {
+    case standard_library_integer_less:
+        return bytecode_builtin_integer_less;
+
+    case standard_library_integer_equals:
+        return bytecode_builtin_integer_equals;
+
+    case standard_library_string_equals:
+        return bytecode_builtin_string_equals;
+
+    case standard_library_subtract:
+        return bytecode_builtin_subtract_integers;
+
+    case standard_library_add:
+        return bytecode_builtin_add_integers;
+
+    default:
+        return bytecode_builtin_none;
+    }
+}
+
+/*a global that is only read to call one of the builtins, so neither the globals nor the function have to be stored in
+ * registers*/
+static bytecode_builtin find_builtin_lookup(bytecode_builder const *const builder, instruction_sequence const sequence,
+                                            size_t const global)
+{
+    if ((global + 1) == sequence.length)
+    {
+        return bytecode_builtin_none;
+    }
+    register_id const globals = sequence.elements[global].global_into;
+    instruction const *const following = sequence.elements + global + 1;
+    if ((following->type != instruction_read_struct) || (following->read_struct.from_object != globals) ||
+        (builder->reads[globals].total != 1))
+    {
+        return bytecode_builtin_none;
+    }
+    register_reads const function_reads = builder->reads[following->read_struct.into];
+    if ((function_reads.total != 1) || (function_reads.as_callee != 1))
+    {
+        return bytecode_builtin_none;
+    }
+    return find_builtin(following->read_struct);
+}
+
+/*Finds the match that uses the result of a call as its key if nothing else reads the result. Only literals (the keys of
+ * the cases) may come between the call and the match. Returns no_operation if there is no such match.*/
+static size_t find_match_of_result(bytecode_builder const *const builder, size_t const call,
+                                   instruction_sequence const sequence, register_id const result)
+{
+    if (builder->reads[result].total != 1)
+    {
+        return no_operation;
+    }
+    for (size_t i = (call + 1); i < sequence.length; ++i)
+    {
+        instruction const *const following = sequence.elements + i;
+        if (following->type == instruction_literal)
+        {
+            continue;
+        }
+        if ((following->type == instruction_match) && (following->match.key == result))
+        {
+            return i;
+        }
+        return no_operation;
+    }
+    return no_operation;
+}
+
+static void compile_sequence(bytecode_builder *const builder, instruction_sequence const sequence,
+                             pending_jumps *const breaks);
+
+/*compiles the cases of the match at index of the sequence. match_operation selects the case.*/
+static void compile_match(bytecode_builder *const builder, instruction_sequence const sequence, size_t const index,
+                          size_t const match_operation, pending_jumps *const breaks)
+{
+    instruction const *const element = sequence.elements + index;
+    size_t const match_index =
+        add_match(builder, &element->match, match_table_create(element->match, sequence.elements, index),
+                  element->match.count);
+    builder->result.operations[match_operation].target = match_index;
+    pending_jumps case_ends = {NULL, 0, 0};
+    for (size_t j = 0; j < element->match.count; ++j)
+    {
+        match_instruction_case const *const this_case = element->match.cases + j;
+        builder->result.matches[match_index].case_targets[j] = builder->result.operation_count;
+        compile_sequence(builder, this_case->action, breaks);
+        size_t const end = emit(builder, bytecode_opcode_end_match_case, element);
+        builder->result.operations[end].finished_case = this_case;
+        pending_jumps_add(&case_ends, end);
+    }
+    pending_jumps_resolve(case_ends, &builder->result, builder->result.operation_count);
+}
+
+static bool is_returned(size_t const next, instruction_sequence const sequence, register_id const result)
+{
+    if (next == sequence.length)
+    {
+        return false;
+    }
+    instruction const *const following = sequence.elements + next;
+    return (following->type == instruction_return) && (following->return_.returned_value == result);
+}
+
+static void compile_sequence(bytecode_builder *const builder, instruction_sequence const sequence,
+                             pending_jumps *const breaks)
+{
+    if (sequence.length == 0)
+    {
+        emit(builder, bytecode_opcode_empty_sequence, NULL);
+        return;
+    }
+    for (size_t i = 0; i < sequence.length; ++i)
+    {
+        instruction const *const element = sequence.elements + i;
+        switch (element->type)
+        {
+        case instruction_loop:
+        {
+            emit(builder, bytecode_opcode_loop, element);
+            size_t const body_begin = builder->result.operation_count;
+            pending_jumps loop_breaks = {NULL, 0, 0};
+            compile_sequence(builder, element->loop.body, &loop_breaks);
+            size_t const back_edge = emit(builder, bytecode_opcode_continue_loop, element);
+            builder->result.operations[back_edge].target = body_begin;
+            pending_jumps_resolve(loop_breaks, &builder->result, builder->result.operation_count);
+            break;
+        }
+
+        case instruction_break:
+            /*a break outside of a loop would end the function in the tree walker, which is not supported there
+             * either*/
+            ASSUME(breaks);
+            pending_jumps_add(breaks, emit(builder, bytecode_opcode_break, element));
+            break;
+
+        case instruction_match:
+            compile_match(builder, sequence, i, emit(builder, bytecode_opcode_match, element), breaks);
+            break;
+
+        case instruction_get_method:
+        {
+            register_reads const reads = builder->reads[element->get_method.into];
+            if ((reads.total == 1) && (reads.as_callee == 1))
+            {
+                /*a method is usually read only to be called right away*/
+                builder->bound_methods[element->get_method.into] =
+                    emit(builder, bytecode_opcode_bind_method, element);
+            }
+            else
+            {
+                emit(builder, bytecode_opcode_get_method, element);
+            }
+            break;
+        }
+
+        case instruction_call:
+        {
+            bytecode_builtin const builtin = builder->builtins[element->call.callee];
+            if (builtin != bytecode_builtin_none)
+            {
+                ASSUME(element->call.argument_count == 2);
+                size_t const match = find_match_of_result(builder, i, sequence, element->call.result);
+                if (match != no_operation)
+                {
+                    /*the builtins have no side effects, so the literals can be loaded before the call*/
+                    for (size_t j = (i + 1); j < match; ++j)
+                    {
+                        emit(builder, bytecode_opcode_literal, sequence.elements + j);
+                    }
+                    size_t const call = emit(builder, bytecode_opcode_call_builtin_and_match, element);
+                    builder->result.operations[call].builtin = builtin;
+                    i = match;
+                    compile_match(builder, sequence, i, call, breaks);
+                }
+                else
+                {
+                    size_t const call = emit(builder, bytecode_opcode_call_builtin, element);
+                    builder->result.operations[call].builtin = builtin;
+                }
+                break;
+            }
+            size_t const bound_method = builder->bound_methods[element->call.callee];
+            size_t const call = emit(
+                builder, (bound_method == no_operation) ? bytecode_opcode_call : bytecode_opcode_call_method, element);
+            if (bound_method != no_operation)
+            {
+                builder->result.operations[call].target = bound_method;
+            }
+            builder->result.operations[call].is_tail_call = is_returned((i + 1), sequence, element->call.result);
+            break;
+        }
+
+        case instruction_global:
+        {
+            bytecode_builtin const builtin = find_builtin_lookup(builder, sequence, i);
+            if (builtin == bytecode_builtin_none)
+            {
+                emit(builder, simple_opcode(element->type), element);
+                break;
+            }
+            size_t const lookup = emit(builder, bytecode_opcode_lookup_builtin, element);
+            builder->result.operations[lookup].builtin = builtin;
+            ++i;
+            builder->builtins[sequence.elements[i].read_struct.into] = builtin;
+            break;
+        }
+
+        case instruction_read_struct:
+        case instruction_literal:
+        case instruction_tuple:
+        case instruction_enum_construct:
+        case instruction_get_captures:
+        case instruction_lambda_with_captures:
+        case instruction_erase_type:
+        case instruction_return:
+        case instruction_instantiate_struct:
+        case instruction_new_array:
+        case instruction_current_function:
+            emit(builder, simple_opcode(element->type), element);
+            break;
+        }
+    }
+}
+
+bytecode bytecode_compile(instruction_sequence const body, size_t const register_count)
+{
+    bytecode_builder builder = {{NULL, 0, NULL, 0},
+                                0,
+                                0,
+                                allocate_array(register_count, sizeof(*builder.reads)),
+                                allocate_array(register_count, sizeof(*builder.bound_methods)),
+                                allocate_array(register_count, sizeof(*builder.builtins))};
+    for (size_t i = 0; i < register_count; ++i)
+    {
+        builder.reads[i].total = 0;
+        builder.reads[i].as_callee = 0;
+        builder.bound_methods[i] = no_operation;
+        builder.builtins[i] = bytecode_builtin_none;
+    }
+    count_register_reads(body, builder.reads);
+    compile_sequence(&builder, body, NULL);
+    emit(&builder, bytecode_opcode_end_of_function, NULL);
+    deallocate(builder.reads);
+    deallocate(builder.bound_methods);
+    deallocate(builder.builtins);
+    return builder.result;
+}
+
+void bytecode_free(bytecode const *freed)
+{
+    if (freed->operations)
+    {
+        deallocate(freed->operations);
+    }
+    for (size_t i = 0; i < freed->match_count; ++i)
+    {
+        match_table_free(freed->matches[i].table);
+        deallocate(freed->matches[i].case_targets);
+    }
+    if (freed->matches)
+    {
+        deallocate(freed->matches);
+    }
+}
+
+bytecode_cache bytecode_cache_create(void)
+{
+    bytecode_cache const result = {NULL, 0, false};
+    return result;
+}
+
+void bytecode_cache_free(bytecode_cache const freed)
+{
+    for (size_t i = 0; i < freed.entry_count; ++i)
+    {
+        if (freed.entries[i].is_compiled)
+        {
+            bytecode_free(&freed.entries[i].code);
+        }
+    }
+    if (freed.entries)
+    {
+        deallocate(freed.entries);
+    }
+}
+
+void bytecode_cache_truncate(bytecode_cache *const cache, function_id const function_count)
+{
+    ASSUME(!cache->is_complete);
+    for (size_t i = function_count; i < cache->entry_count; ++i)
+    {
+        if (cache->entries[i].is_compiled)
+        {
+            bytecode_free(&cache->entries[i].code);
+            cache->entries[i].is_compiled = false;
+        }
+    }
+}
+
+bytecode const *bytecode_cache_get(bytecode_cache *const cache, function_id const function,
+                                   instruction_sequence const body, size_t const register_count)
+{
+    ASSUME(!cache->is_complete || (function < cache->entry_count));
+    if (function >= cache->entry_count)
+    {
+        size_t const new_count = ((size_t)function + 1);
+        cache->entries = reallocate_array(cache->entries, new_count, sizeof(*cache->entries));
+        for (size_t i = cache->entry_count; i < new_count; ++i)
+        {
+            cache->entries[i].is_compiled = false;
+        }
+        cache->entry_count = new_count;
+    }
+    bytecode_cache_entry *const entry = cache->entries + function;
+    if (entry->is_compiled)
+    {
+        if ((entry->compiled_elements == body.elements) && (entry->compiled_length == body.length))
+        {
+            return &entry->code;
+        }
+        bytecode_free(&entry->code);
+    }
+    ASSUME(!cache->is_complete);
+    entry->is_compiled = true;
+    entry->compiled_elements = body.elements;
+    entry->compiled_length = body.length;
+    entry->code = bytecode_compile(body, register_count);
+    return &entry->code;
+}
+
+void bytecode_cache_compile_all(bytecode_cache *const cache, checked_function const *const functions,
+                                function_id const function_count)
+{
+    for (function_id i = 0; i < function_count; ++i)
+    {
+        bytecode const *const compiled =
+            bytecode_cache_get(cache, i, functions[i].body, functions[i].number_of_registers);
+        (void)compiled;
+    }
+    cache->is_complete = true;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include "lpg_checked_function.h"
+#include "lpg_function_id.h"
+#include "lpg_instruction.h"
+#include "lpg_match_table.h"
+#include "lpg_use_result.h"
+
+typedef enum bytecode_opcode {
+    bytecode_opcode_call,
+    bytecode_opcode_loop,
+    bytecode_opcode_continue_loop,
+    bytecode_opcode_global,
+    bytecode_opcode_read_struct,
+    bytecode_opcode_break,
+    bytecode_opcode_literal,
+    bytecode_opcode_tuple,
+    bytecode_opcode_enum_construct,
+    bytecode_opcode_match,
+    bytecode_opcode_end_match_case,
+    bytecode_opcode_get_captures,
+    bytecode_opcode_lambda_with_captures,
+    bytecode_opcode_get_method,
+    bytecode_opcode_bind_method,
+    bytecode_opcode_call_method,
+    bytecode_opcode_erase_type,
+    bytecode_opcode_return,
+    bytecode_opcode_instantiate_struct,
+    bytecode_opcode_new_array,
+    bytecode_opcode_current_function,
+    bytecode_opcode_empty_sequence,
+    bytecode_opcode_end_of_function,
+    bytecode_opcode_lookup_builtin,
+    bytecode_opcode_call_builtin,
+    bytecode_opcode_call_builtin_and_match
+} bytecode_opcode;
+
+enum
+{
+    bytecode_opcode_count = (bytecode_opcode_call_builtin_and_match + 1)
+};
+
+/*functions of the standard library which are executed inline by the interpreter*/
+typedef enum bytecode_builtin {
+    bytecode_builtin_none,
+    bytecode_builtin_integer_less,
+    bytecode_builtin_integer_equals,
+    bytecode_builtin_string_equals,
+    bytecode_builtin_subtract_integers,
+    bytecode_builtin_add_integers
+} bytecode_builtin;
+
+/*The operands are not copied. An operation refers to the instruction it was created from, so the bytecode must not
+ * outlive the function body.*/
+typedef struct bytecode_operation
+{
+    bytecode_opcode opcode;
+    /*continue_loop, break, end_match_case: index of the next operation
+     * match, call_builtin_and_match: index in bytecode::matches
+     * call_method: index of the bind_method operation of the callee*/
+    size_t target;
+    /*the match instruction in case of end_match_case, the global instruction in case of lookup_builtin, the call in
+     * case of call_builtin and call_builtin_and_match, NULL for empty_sequence and end_of_function*/
+    instruction const *original;
+    /*end_match_case only*/
+    match_instruction_case const *finished_case;
+    /*call and call_method: the next operation returns the result of the call, so the frame of the caller is not needed
+     * anymore when an interpreted function is called*/
+    bool is_tail_call;
+    /*lookup_builtin, call_builtin and call_builtin_and_match only*/
+    bytecode_builtin builtin;
+} bytecode_operation;
+
+typedef struct bytecode_match
+{
+    match_instruction const *original;
+    match_table table;
+    /*for each case the index of the first operation of its action*/
+    size_t *case_targets;
+} bytecode_match;
+
+/*A function body with the nested sequences of loops and matches flattened into a single array of operations. Control
+ * flow is expressed as absolute jumps within that array. Every operation that corresponds to an instruction (and every
+ * empty sequence) counts as one executed instruction, exactly like in the tree walking interpreter.
+ *
+ * A get_method whose result is only ever used as the callee of a single call becomes a bind_method which creates no
+ * value at all. The call becomes a call_method which invokes the method on the object directly.
+ *
+ * Arithmetic and comparisons are calls of standard library functions which are read from the globals right before.
+ * Such a global and read_struct pair becomes a lookup_builtin which only counts the two instructions. The call becomes
+ * a call_builtin which computes the result inline. If the result of the call is only used as the key of the match
+ * that follows, call_builtin_and_match jumps to the matching case without creating the enum value. The literals
+ * between such a call and its match are loaded before the call, which is possible because the builtins have no side
+ * effects.*/
+typedef struct bytecode
+{
+    bytecode_operation *operations;
+    size_t operation_count;
+    bytecode_match *matches;
+    size_t match_count;
+} bytecode;
+
+bytecode bytecode_compile(instruction_sequence const body, size_t const register_count) LPG_USE_RESULT;
+void bytecode_free(LPG_NON_NULL(bytecode const *freed));
+
+typedef struct bytecode_cache_entry
+{
+    bool is_compiled;
+    instruction const *compiled_elements;
+    size_t compiled_length;
+    bytecode code;
+} bytecode_cache_entry;
+
+/*Compiles the functions of a program lazily on their first call. Bodies of functions can be replaced while the
+ * program is being checked, so an entry is only reused if the body still looks the same. A pointer returned by
+ * bytecode_cache_get is only valid until the next call unless the cache is complete.*/
+typedef struct bytecode_cache
+{
+    bytecode_cache_entry *entries;
+    size_t entry_count;
+    /*every function has been compiled by bytecode_cache_compile_all. A complete cache is never changed, so any number
+     * of threads can use it at the same time.*/
+    bool is_complete;
+} bytecode_cache;
+
+bytecode_cache bytecode_cache_create(void) LPG_USE_RESULT;
+void bytecode_cache_free(bytecode_cache const freed);
+bytecode const *bytecode_cache_get(LPG_NON_NULL(bytecode_cache *const cache), function_id const function,
+                                   instruction_sequence const body, size_t const register_count) LPG_USE_RESULT;
+/*forgets the functions from function_count on, so that their ids can be given to new functions*/
+void bytecode_cache_truncate(LPG_NON_NULL(bytecode_cache *const cache), function_id const function_count);
+/*makes the cache complete. The functions must not change afterwards.*/
+void bytecode_cache_compile_all(LPG_NON_NULL(bytecode_cache *const cache), checked_function const *const functions,
+                                function_id const function_count);
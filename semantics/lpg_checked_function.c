@@ -1,14 +1,22 @@
 #include "lpg_checked_function.h"
 #include "lpg_allocate.h"
 
-checked_function checked_function_create(function_pointer *signature, instruction_sequence body,
+checked_function checked_function_create(function_pointer const *signature, instruction_sequence body,
                                          unicode_string *register_debug_names, register_id number_of_registers)
 {
     ASSUME((number_of_registers > 0) || (register_debug_names == NULL));
-    checked_function const result = {signature, body, register_debug_names, number_of_registers};
+    checked_function const result = {
+        signature, body, register_debug_names, number_of_registers, unicode_string_from_c_str(""), 0};
     return result;
 }
 
+void checked_function_set_definition(checked_function *function, unicode_view const file, line_number const line)
+{
+    unicode_string_free(&function->definition_file);
+    function->definition_file = unicode_view_copy(file);
+    function->definition_line = line;
+}
+
 void checked_function_free(checked_function const *function)
 {
     for (register_id i = 0; i < function->number_of_registers; ++i)
@@ -23,9 +31,8 @@ void checked_function_free(checked_function const *function)
     {
         ASSUME(!function->register_debug_names);
     }
+    unicode_string_free(&function->definition_file);
     instruction_sequence_free(&function->body);
-    function_pointer_free(function->signature);
-    deallocate(function->signature);
 }
 
 optional_type get_return_type(type const callee, checked_function const *const all_functions,
@@ -1,6 +1,7 @@
 #pragma once
 #include "lpg_instruction_sequence.h"
 #include "lpg_register.h"
+#include "lpg_source_location.h"
 #include "lpg_type.h"
 #include "lpg_unicode_string.h"
 #include <lpg_non_null.h>
@@ -9,14 +10,21 @@ typedef struct function_pointer function_pointer;
 
 typedef struct checked_function
 {
-    function_pointer *signature;
+    /*interned in the memory of the program, which owns it*/
+    function_pointer const *signature;
     instruction_sequence body;
     unicode_string *register_debug_names;
     register_id number_of_registers;
+    /*the file of the module where the function is defined, empty if it is unknown*/
+    unicode_string definition_file;
+    /*the line of the definition counting from 1, or 0 if it is unknown*/
+    line_number definition_line;
 } checked_function;
 
-checked_function checked_function_create(LPG_NON_NULL(function_pointer *signature), instruction_sequence body,
+checked_function checked_function_create(LPG_NON_NULL(function_pointer const *signature), instruction_sequence body,
                                          unicode_string *register_debug_names, register_id number_of_registers);
+void checked_function_set_definition(LPG_NON_NULL(checked_function *function), unicode_view const file,
+                                     line_number const line);
 void checked_function_free(LPG_NON_NULL(checked_function const *function));
 
 optional_type get_return_type(type const callee, checked_function const *const all_functions,
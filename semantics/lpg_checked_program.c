@@ -36,5 +36,6 @@ void checked_program_free(checked_program const *program)
     {
         deallocate(program->enums);
     }
+    type_interner_free(program->types);
     garbage_collector_free(program->memory);
 }
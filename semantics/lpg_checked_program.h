@@ -5,6 +5,7 @@
 #include "lpg_garbage_collector.h"
 #include "lpg_interface_id.h"
 #include "lpg_struct_id.h"
+#include "lpg_type_interner.h"
 
 typedef struct checked_program
 {
@@ -17,6 +18,8 @@ typedef struct checked_program
     function_id function_count;
     enumeration *enums;
     enum_id enum_count;
+    /*function pointer and tuple types are allocated in memory only once*/
+    type_interner types;
 } checked_program;
 
 void checked_program_free(LPG_NON_NULL(checked_program const *program));
@@ -0,0 +1,219 @@
+#include "lpg_collect_garbage.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+
+/*values whose content still has to be marked*/
+typedef struct mark_stack
+{
+    value *elements;
+    size_t count;
+    size_t capacity;
+} mark_stack;
+
+static void mark_stack_push(mark_stack *const stack, value const pushed)
+{
+    stack->elements = reallocate_array_exponentially(
+        stack->elements, (stack->count + 1), sizeof(*stack->elements), stack->count, &stack->capacity);
+    stack->elements[stack->count] = pushed;
+    ++(stack->count);
+}
+
+static void mark_type(garbage_collector *const gc, type const marked);
+
+static void mark_tuple_type(garbage_collector *const gc, tuple_type const marked)
+{
+    if (!garbage_collector_mark(gc, marked.elements))
+    {
+        return;
+    }
+    for (size_t i = 0; i < marked.length; ++i)
+    {
+        mark_type(gc, marked.elements[i]);
+    }
+}
+
+static void mark_optional_type(garbage_collector *const gc, optional_type const marked)
+{
+    if (marked.is_set)
+    {
+        mark_type(gc, marked.value);
+    }
+}
+
+static void mark_function_pointer_type(garbage_collector *const gc, function_pointer const marked)
+{
+    mark_optional_type(gc, marked.result);
+    mark_tuple_type(gc, marked.parameters);
+    mark_tuple_type(gc, marked.captures);
+    mark_optional_type(gc, marked.self);
+}
+
+static void mark_type(garbage_collector *const gc, type const marked)
+{
+    switch (marked.kind)
+    {
+    case type_kind_function_pointer:
+        if (garbage_collector_mark(gc, marked.function_pointer_))
+        {
+            mark_function_pointer_type(gc, *marked.function_pointer_);
+        }
+        break;
+
+    case type_kind_tuple:
+        mark_tuple_type(gc, marked.tuple_);
+        break;
+
+    case type_kind_enum_constructor:
+        garbage_collector_mark(gc, marked.enum_constructor);
+        break;
+
+    case type_kind_structure:
+    case type_kind_unit:
+    case type_kind_string:
+    case type_kind_enumeration:
+    case type_kind_type:
+    case type_kind_integer_range:
+    case type_kind_lambda:
+    case type_kind_interface:
+    case type_kind_method_pointer:
+    case type_kind_generic_enum:
+    case type_kind_generic_interface:
+    case type_kind_generic_lambda:
+    case type_kind_host_value:
+    case type_kind_generic_struct:
+        break;
+    }
+}
+
+static void mark_values(garbage_collector *const gc, mark_stack *const pending, value const *const values,
+                        size_t const count)
+{
+    if (!garbage_collector_mark(gc, values))
+    {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        mark_stack_push(pending, values[i]);
+    }
+}
+
+static void mark_value(garbage_collector *const gc, mark_stack *const pending, value const marked)
+{
+    if (!value_is_valid(marked))
+    {
+        // registers that have not been written yet
+        return;
+    }
+    switch (marked.kind)
+    {
+    case value_kind_string:
+        garbage_collector_mark(gc, marked.string_begin);
+        break;
+
+    case value_kind_function_pointer:
+    {
+        function_pointer_value const *const box = marked.boxed_function;
+        if (!box)
+        {
+            break;
+        }
+        // the box of a method of an implementation is not owned by the garbage collector, but its captures may be
+        garbage_collector_mark(gc, box);
+        mark_values(gc, pending, box->captures, box->capture_count);
+        // the environment of an external function is opaque
+        garbage_collector_mark(gc, box->external_environment);
+        if (box->external)
+        {
+            mark_function_pointer_type(gc, box->external_signature);
+        }
+        break;
+    }
+
+    case value_kind_structure:
+        mark_values(gc, pending, marked.structure_members, marked.count);
+        break;
+
+    case value_kind_type:
+        garbage_collector_mark(gc, marked.boxed_type);
+        mark_type(gc, *marked.boxed_type);
+        break;
+
+    case value_kind_enum_element:
+        if (marked.enum_state)
+        {
+            mark_values(gc, pending, marked.enum_state, 1);
+        }
+        break;
+
+    case value_kind_tuple:
+        mark_values(gc, pending, marked.tuple_elements, marked.count);
+        break;
+
+    case value_kind_type_erased:
+        if (garbage_collector_mark(gc, marked.type_erased))
+        {
+            mark_stack_push(pending, marked.type_erased->self);
+        }
+        break;
+
+    case value_kind_array:
+        if (garbage_collector_mark(gc, marked.array))
+        {
+            mark_type(gc, marked.array->element_type);
+            if (marked.array->storage == array_storage_values)
+            {
+                mark_values(gc, pending, marked.array->elements, marked.array->count);
+            }
+            else
+            {
+                garbage_collector_mark(gc, marked.array->elements);
+            }
+        }
+        break;
+
+    case value_kind_integer:
+        if (marked.is_big)
+        {
+            garbage_collector_mark(gc, marked.big_integer);
+        }
+        break;
+
+    case value_kind_unit:
+    case value_kind_enum_constructor:
+    case value_kind_pattern:
+    case value_kind_generic_enum:
+    case value_kind_generic_interface:
+    case value_kind_generic_lambda:
+    case value_kind_generic_struct:
+        break;
+    }
+}
+
+void collect_garbage(garbage_collector *const gc, value_stack const *const stack, value const *const globals,
+                     size_t const global_count)
+{
+    ASSUME(gc->is_collecting);
+    mark_stack pending = {NULL, 0, 0};
+    for (value_stack_segment const *segment = stack->top; segment; segment = segment->previous)
+    {
+        for (size_t i = 0; i < segment->used; ++i)
+        {
+            mark_stack_push(&pending, segment->elements[i]);
+        }
+    }
+    for (size_t i = 0; i < global_count; ++i)
+    {
+        mark_stack_push(&pending, globals[i]);
+    }
+    while (pending.count > 0)
+    {
+        --pending.count;
+        mark_value(gc, &pending, pending.elements[pending.count]);
+    }
+    if (pending.elements)
+    {
+        deallocate(pending.elements);
+    }
+    garbage_collector_sweep(gc);
+}
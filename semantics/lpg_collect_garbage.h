@@ -0,0 +1,9 @@
+#pragma once
+#include "lpg_value.h"
+#include "lpg_value_stack.h"
+
+/*Marks everything that can be reached from the values on the stack and from the globals and frees the rest of the
+ * heap. Memory that was not allocated by the heap is assumed to be immutable, so values in there can not refer to
+ * memory of the heap and are not traced any further.*/
+void collect_garbage(LPG_NON_NULL(garbage_collector *const gc), LPG_NON_NULL(value_stack const *const stack),
+                     value const *const globals, size_t const global_count);
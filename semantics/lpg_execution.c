@@ -0,0 +1,149 @@
+#include "lpg_execution.h"
+#include "lpg_allocate.h"
+#include "lpg_worker_pool.h"
+#include <string.h>
+
+shared_program shared_program_create(checked_program const *const program, value const *const globals)
+{
+    shared_program result = {program, globals, bytecode_cache_create()};
+    bytecode_cache_compile_all(&result.compiled_functions, program->functions, program->function_count);
+    return result;
+}
+
+void shared_program_free(shared_program const freed)
+{
+    bytecode_cache_free(freed.compiled_functions);
+}
+
+execution_context execution_context_create(size_t const max_heap_size)
+{
+    execution_context const result = {
+        garbage_collector_create_collecting(max_heap_size, 1024 * 1024), value_stack_create(), execution_usage_create()};
+    return result;
+}
+
+void execution_context_free(execution_context const freed)
+{
+    value_stack_free(freed.stack);
+    garbage_collector_free(freed.gc);
+}
+
+external_function_result execute(shared_program const *const program, execution_context *const context,
+                                 execution_budget const budget)
+{
+    function_id const entry_point_id = 0;
+    context->usage = execution_usage_create();
+    /*the interpreter never changes a complete cache*/
+    interpreter running =
+        interpreter_create(program->globals, &context->gc, &context->stack,
+                           (bytecode_cache *)&program->compiled_functions, &program->program->functions,
+                           &program->program->interfaces, budget, &context->usage);
+    return call_checked_function(program->program->functions[entry_point_id],
+                                 optional_function_id_create(entry_point_id), NULL, optional_value_empty, NULL,
+                                 &running);
+}
+
+execution_task *execution_task_create(shared_program const *const program, execution_budget const budget)
+{
+    function_id const entry_point_id = 0;
+    execution_task *const result = allocate(sizeof(*result));
+    result->context = execution_context_create(budget.max_heap_size);
+    /*the interpreter has constant members, so it cannot be assigned*/
+    interpreter const running =
+        interpreter_create(program->globals, &result->context.gc, &result->context.stack,
+                           (bytecode_cache *)&program->compiled_functions, &program->program->functions,
+                           &program->program->interfaces, budget, &result->context.usage);
+    memcpy(&result->running, &running, sizeof(running));
+    result->call = resumable_call_create(entry_point_id, NULL, optional_value_empty, NULL, &result->running);
+    result->result = result->call ? external_function_result_create_unavailable()
+                                  : external_function_result_create_stack_overflow();
+    return result;
+}
+
+void execution_task_free(execution_task *const freed)
+{
+    if (freed->call)
+    {
+        resumable_call_free(freed->call, &freed->running);
+    }
+    execution_context_free(freed->context);
+    deallocate(freed);
+}
+
+bool execution_task_run(execution_task *const task, uint64_t const slice)
+{
+    if (!task->call)
+    {
+        return true;
+    }
+    if (!resumable_call_run(task->call, slice, &task->running, &task->result))
+    {
+        return false;
+    }
+    resumable_call_free(task->call, &task->running);
+    task->call = NULL;
+    return true;
+}
+
+void execute_round_robin(shared_program const *const program, execution_budget const budget,
+                         size_t const execution_count, uint64_t const slice, execution_result *const results)
+{
+    execution_task **const tasks = allocate_array(execution_count, sizeof(*tasks));
+    for (size_t i = 0; i < execution_count; ++i)
+    {
+        tasks[i] = execution_task_create(program, budget);
+    }
+    size_t unfinished = execution_count;
+    while (unfinished > 0)
+    {
+        for (size_t i = 0; i < execution_count; ++i)
+        {
+            execution_task *const task = tasks[i];
+            if (!task || !execution_task_run(task, slice))
+            {
+                continue;
+            }
+            results[i].code = task->result.code;
+            results[i].usage = task->context.usage;
+            execution_task_free(task);
+            tasks[i] = NULL;
+            --unfinished;
+        }
+    }
+    deallocate(tasks);
+}
+
+typedef struct parallel_executions
+{
+    shared_program const *program;
+    execution_budget budget;
+    execution_context *contexts;
+    execution_result *results;
+} parallel_executions;
+
+static void run_execution(void *user, size_t const job, size_t const worker)
+{
+    parallel_executions *const executions = user;
+    execution_context *const context = &executions->contexts[worker];
+    external_function_result const result = execute(executions->program, context, executions->budget);
+    execution_result *const reported = &executions->results[job];
+    reported->code = result.code;
+    reported->usage = context->usage;
+}
+
+void execute_in_parallel(shared_program const *const program, execution_budget const budget,
+                         size_t const execution_count, size_t const thread_count, execution_result *const results)
+{
+    execution_context *const contexts = allocate_array(thread_count, sizeof(*contexts));
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        contexts[i] = execution_context_create(budget.max_heap_size);
+    }
+    parallel_executions executions = {program, budget, contexts, results};
+    worker_pool_run(run_execution, &executions, execution_count, thread_count);
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        execution_context_free(contexts[i]);
+    }
+    deallocate(contexts);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "lpg_interpret.h"
+
+/*What every execution of a checked program reads and nothing writes to. The checked_program (including its memory,
+ * which is only allocated from by check) and the globals are borrowed. The bytecode is compiled completely up front
+ * so that the executions do not have to fill the cache lazily.*/
+typedef struct shared_program
+{
+    checked_program const *program;
+    value const *globals;
+    bytecode_cache compiled_functions;
+} shared_program;
+
+shared_program shared_program_create(LPG_NON_NULL(checked_program const *const program),
+                                     LPG_NON_NULL(value const *const globals)) LPG_USE_RESULT;
+void shared_program_free(shared_program const freed);
+
+/*everything that a single execution of a shared_program writes to. A context must only be used by one thread at a
+ * time, but it can be reused for any number of executions one after another.*/
+typedef struct execution_context
+{
+    garbage_collector gc;
+    value_stack stack;
+    execution_usage usage;
+} execution_context;
+
+execution_context execution_context_create(size_t const max_heap_size) LPG_USE_RESULT;
+void execution_context_free(execution_context const freed);
+
+/*Runs the entry point of the program. The result can refer to the heap of the context, so it is only valid until the
+ * next execution in the same context. The usage of the context is reset before the execution.*/
+external_function_result execute(LPG_NON_NULL(shared_program const *const program),
+                                 LPG_NON_NULL(execution_context *const context),
+                                 execution_budget const budget) LPG_USE_RESULT;
+
+typedef struct execution_result
+{
+    external_function_result_code code;
+    execution_usage usage;
+} execution_result;
+
+/*Runs the entry point of the program execution_count times distributed over thread_count threads. Each thread has its
+ * own execution_context with a heap of at most budget.max_heap_size bytes. results must have room for execution_count
+ * elements.*/
+void execute_in_parallel(LPG_NON_NULL(shared_program const *const program), execution_budget const budget,
+                         size_t const execution_count, size_t const thread_count, execution_result *const results);
+
+/*An execution of the entry point that runs a slice of instructions at a time, so that a single thread can take turns
+ * between any number of executions. A task is allocated on the heap because its interpreter refers to its context. The
+ * deadline of the budget counts from the creation of the task.*/
+typedef struct execution_task
+{
+    execution_context context;
+    interpreter running;
+    /*NULL once the execution has finished*/
+    resumable_call *call;
+    external_function_result result;
+} execution_task;
+
+execution_task *execution_task_create(LPG_NON_NULL(shared_program const *const program),
+                                      execution_budget const budget) LPG_USE_RESULT;
+void execution_task_free(LPG_NON_NULL(execution_task *const freed));
+
+/*Continues the execution for about slice instructions (see resumable_call_run). Returns true once the execution has
+ * finished. The result of the task can refer to its heap.*/
+bool execution_task_run(LPG_NON_NULL(execution_task *const task), uint64_t const slice) LPG_USE_RESULT;
+
+/*Runs the entry point of the program execution_count times on the calling thread. The executions take turns after
+ * every slice, so an execution that never finishes only delays the others by one slice per turn. results must have
+ * room for execution_count elements.*/
+void execute_round_robin(LPG_NON_NULL(shared_program const *const program), execution_budget const budget,
+                         size_t const execution_count, uint64_t const slice, execution_result *const results);
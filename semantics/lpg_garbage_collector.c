@@ -9,12 +9,130 @@ enum
     alignment = 16
 };
 
+LPG_STATIC_ASSERT((sizeof(allocation_header) % alignment) == 0)
+
 garbage_collector garbage_collector_create(size_t max_heap_size)
 {
-    garbage_collector const result = {max_heap_size, 0, NULL};
+    garbage_collector const result = {
+        max_heap_size, 0, NULL, false, NULL, {NULL, 0, 0}, SIZE_MAX, SIZE_MAX, {0, 0, 0, 0, 0}};
+    return result;
+}
+
+garbage_collector garbage_collector_create_collecting(size_t max_heap_size, size_t minimum_collection_threshold)
+{
+    garbage_collector const result = {max_heap_size,
+                                      0,
+                                      NULL,
+                                      true,
+                                      NULL,
+                                      {NULL, 0, 0},
+                                      minimum_collection_threshold,
+                                      minimum_collection_threshold,
+                                      {0, 0, 0, 0, 0}};
     return result;
 }
 
+static size_t hash_address(void const *const address, size_t const capacity)
+{
+    uint64_t const mixed = ((uint64_t)(uintptr_t)address * UINT64_C(0x9E3779B97F4A7C15));
+    return (size_t)(mixed >> 32u) & (capacity - 1u);
+}
+
+static void allocation_set_insert(allocation_set *const set, allocation_header *const inserted);
+
+static void allocation_set_reserve(allocation_set *const set, size_t const count)
+{
+    if ((count * 2) <= set->capacity)
+    {
+        return;
+    }
+    allocation_set const old = *set;
+    set->capacity = ((old.capacity == 0) ? 64 : (old.capacity * 2));
+    while ((count * 2) > set->capacity)
+    {
+        set->capacity *= 2;
+    }
+    set->entries = allocate_array(set->capacity, sizeof(*set->entries));
+    for (size_t i = 0; i < set->capacity; ++i)
+    {
+        set->entries[i] = NULL;
+    }
+    set->count = 0;
+    for (size_t i = 0; i < old.capacity; ++i)
+    {
+        if (old.entries[i])
+        {
+            allocation_set_insert(set, old.entries[i]);
+        }
+    }
+    if (old.entries)
+    {
+        deallocate(old.entries);
+    }
+}
+
+static void allocation_set_insert(allocation_set *const set, allocation_header *const inserted)
+{
+    allocation_set_reserve(set, set->count + 1);
+    size_t index = hash_address(inserted, set->capacity);
+    while (set->entries[index])
+    {
+        index = ((index + 1) & (set->capacity - 1u));
+    }
+    set->entries[index] = inserted;
+    ++(set->count);
+}
+
+static allocation_header *allocation_set_find(allocation_set const set, allocation_header const *const searched)
+{
+    if (set.count == 0)
+    {
+        return NULL;
+    }
+    size_t index = hash_address(searched, set.capacity);
+    while (set.entries[index])
+    {
+        if (set.entries[index] == searched)
+        {
+            return set.entries[index];
+        }
+        index = ((index + 1) & (set.capacity - 1u));
+    }
+    return NULL;
+}
+
+static void allocation_set_clear(allocation_set *const set)
+{
+    for (size_t i = 0; i < set->capacity; ++i)
+    {
+        set->entries[i] = NULL;
+    }
+    set->count = 0;
+}
+
+static void update_heap_size(garbage_collector *const gc, size_t const new_heap_size, size_t const allocated)
+{
+    gc->current_heap_size = new_heap_size;
+    if (new_heap_size > gc->statistics.peak_heap_size)
+    {
+        gc->statistics.peak_heap_size = new_heap_size;
+    }
+    gc->statistics.allocated_bytes += allocated;
+}
+
+static void *try_allocate_collected(garbage_collector *const gc, size_t const bytes, size_t const new_heap_size)
+{
+    allocation_header *const header = allocate(sizeof(*header) + bytes);
+    header->next = gc->allocations;
+    header->size = bytes;
+    header->is_marked = 0;
+    header->padding = 0;
+    gc->allocations = header;
+    allocation_set_insert(&gc->owned, header);
+    update_heap_size(gc, new_heap_size, bytes);
+    return (header + 1);
+}
+
 void *garbage_collector_try_allocate(LPG_NON_NULL(garbage_collector *const gc), size_t const bytes)
 {
     if (bytes == 0)
@@ -30,6 +148,10 @@ void *garbage_collector_try_allocate(LPG_NON_NULL(garbage_collector *const gc),
     {
         return NULL;
     }
+    if (gc->is_collecting)
+    {
+        return try_allocate_collected(gc, bytes, new_heap_size.value_if_set);
+    }
     {
         size_t const remaining_in_block = gc->blocks ? (gc->blocks->size - gc->blocks->used) : 0u;
         if (remaining_in_block < bytes)
@@ -55,7 +177,7 @@ void *garbage_collector_try_allocate(LPG_NON_NULL(garbage_collector *const gc),
     {
         gc->blocks->used = gc->blocks->size;
     }
-    gc->current_heap_size = new_heap_size.value_if_set;
+    update_heap_size(gc, new_heap_size.value_if_set, bytes);
     return result;
 }
 
@@ -91,4 +213,69 @@ void garbage_collector_free(garbage_collector const gc)
         deallocate(i);
         i = next;
     }
+    allocation_header *k = gc.allocations;
+    while (k)
+    {
+        allocation_header *const next = k->next;
+        deallocate(k);
+        k = next;
+    }
+    if (gc.owned.entries)
+    {
+        deallocate(gc.owned.entries);
+    }
+}
+
+bool garbage_collector_is_collection_due(garbage_collector const *const gc)
+{
+    return gc->is_collecting && (gc->current_heap_size >= gc->next_collection);
+}
+
+bool garbage_collector_mark(garbage_collector *const gc, void const *const memory)
+{
+    if (!memory || !gc->is_collecting)
+    {
+        return false;
+    }
+    allocation_header *const header = allocation_set_find(gc->owned, (allocation_header const *)memory - 1);
+    if (!header || header->is_marked)
+    {
+        return false;
+    }
+    header->is_marked = 1;
+    return true;
+}
+
+void garbage_collector_sweep(garbage_collector *const gc)
+{
+    ASSUME(gc->is_collecting);
+    allocation_set_clear(&gc->owned);
+    allocation_header **previous = &gc->allocations;
+    allocation_header *current = gc->allocations;
+    while (current)
+    {
+        allocation_header *const next = current->next;
+        if (current->is_marked)
+        {
+            current->is_marked = 0;
+            allocation_set_insert(&gc->owned, current);
+            previous = &current->next;
+        }
+        else
+        {
+            ASSUME(gc->current_heap_size >= current->size);
+            gc->current_heap_size -= current->size;
+            gc->statistics.collected_bytes += current->size;
+            *previous = next;
+            deallocate(current);
+        }
+        current = next;
+    }
+    gc->statistics.live_bytes_after_collection = gc->current_heap_size;
+    gc->statistics.collections += 1;
+    gc->next_collection = gc->current_heap_size * 2;
+    if (gc->next_collection < gc->minimum_collection_threshold)
+    {
+        gc->next_collection = gc->minimum_collection_threshold;
+    }
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <lpg_non_null.h>
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef void (*garbage_collector_destructor)(void *);
 
@@ -16,15 +18,59 @@ typedef struct memory_block
     ];
 } memory_block;
 
+/*precedes every allocation of a collecting heap*/
+typedef struct allocation_header
+{
+    struct allocation_header *next;
+    size_t size;
+    size_t is_marked;
+    size_t padding;
+} allocation_header;
+
+/*open addressing hash set of the addresses returned by a collecting heap*/
+typedef struct allocation_set
+{
+    allocation_header **entries;
+    size_t capacity;
+    size_t count;
+} allocation_set;
+
+typedef struct garbage_collector_statistics
+{
+    /*sum of the sizes of all allocations ever made*/
+    uint64_t allocated_bytes;
+    /*sum of the sizes of all allocations that have been freed by a collection*/
+    uint64_t collected_bytes;
+    /*bytes that survived the most recent collection*/
+    size_t live_bytes_after_collection;
+    /*the largest current_heap_size so far*/
+    size_t peak_heap_size;
+    size_t collections;
+} garbage_collector_statistics;
+
 typedef struct garbage_collector
 {
     size_t max_heap_size;
     size_t current_heap_size;
+    /*a heap that does not collect hands out memory from these blocks and frees it all at once*/
     memory_block *blocks;
+    bool is_collecting;
+    allocation_header *allocations;
+    allocation_set owned;
+    /*a collection is due when the heap has grown to this size*/
+    size_t next_collection;
+    size_t minimum_collection_threshold;
+    garbage_collector_statistics statistics;
 } garbage_collector;
 
+/*The memory of this heap is only freed by garbage_collector_free. The type checker keeps types and compile time values
+ * in such a heap.*/
 garbage_collector garbage_collector_create(size_t max_heap_size);
 
+/*The memory of this heap can be collected by tracing the values that are still reachable (see collect_garbage). The
+ * first collection becomes due when the heap reaches minimum_collection_threshold bytes.*/
+garbage_collector garbage_collector_create_collecting(size_t max_heap_size, size_t minimum_collection_threshold);
+
 void *garbage_collector_allocate(LPG_NON_NULL(garbage_collector *const gc), size_t const bytes);
 void *garbage_collector_try_allocate(LPG_NON_NULL(garbage_collector *const gc), size_t const bytes);
 
@@ -34,3 +80,12 @@ void *garbage_collector_try_allocate_array(LPG_NON_NULL(garbage_collector *const
                                            size_t const element);
 
 void garbage_collector_free(garbage_collector const gc);
+
+bool garbage_collector_is_collection_due(LPG_NON_NULL(garbage_collector const *const gc));
+
+/*returns true if the memory was allocated by this heap and has not been marked since the last sweep. The caller is
+ * then responsible for marking everything the memory refers to.*/
+bool garbage_collector_mark(LPG_NON_NULL(garbage_collector *const gc), void const *const memory);
+
+/*frees all unmarked allocations and clears the marks of the others*/
+void garbage_collector_sweep(LPG_NON_NULL(garbage_collector *const gc));
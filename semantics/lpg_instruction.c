@@ -208,9 +208,10 @@ bool loop_instruction_equals(loop_instruction const left, loop_instruction const
     return instruction_sequence_equals(&left.body, &right.body) && (left.unit_goes_into == right.unit_goes_into);
 }
 
-new_array_instruction new_array_instruction_create(interface_id result_type, register_id into, type element_type)
+new_array_instruction new_array_instruction_create(interface_id result_type, register_id into, type element_type,
+                                                   array_storage storage)
 {
-    new_array_instruction const result = {result_type, into, element_type};
+    new_array_instruction const result = {result_type, into, element_type, storage};
     return result;
 }
 
@@ -222,7 +223,7 @@ void new_array_instruction_free(new_array_instruction const freed)
 bool new_array_instruction_equals(new_array_instruction const left, new_array_instruction const right)
 {
     return (left.result_type == right.result_type) && (left.into == right.into) &&
-           type_equals(left.element_type, right.element_type);
+           type_equals(left.element_type, right.element_type) && (left.storage == right.storage);
 }
 
 current_function_instruction current_function_instruction_create(register_id into)
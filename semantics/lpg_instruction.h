@@ -175,9 +175,11 @@ typedef struct new_array_instruction
     interface_id result_type;
     register_id into;
     type element_type;
+    array_storage storage;
 } new_array_instruction;
 
-new_array_instruction new_array_instruction_create(interface_id result_type, register_id into, type element_type);
+new_array_instruction new_array_instruction_create(interface_id result_type, register_id into, type element_type,
+                                                   array_storage storage);
 void new_array_instruction_free(new_array_instruction const freed);
 bool new_array_instruction_equals(new_array_instruction const left, new_array_instruction const right);
 
@@ -1,6 +1,7 @@
 #include "lpg_interpret.h"
 #include "lpg_allocate.h"
 #include "lpg_assert.h"
+#include "lpg_collect_garbage.h"
 #include "lpg_for.h"
 #include "lpg_instruction.h"
 #include "lpg_optional_function_id.h"
@@ -19,52 +20,203 @@ typedef enum run_sequence_result {
     run_sequence_result_unavailable_at_this_time,
     run_sequence_result_out_of_memory,
     run_sequence_result_stack_overflow,
-    run_sequence_result_instruction_limit_reached
+    run_sequence_result_instruction_limit_reached,
+    run_sequence_result_deadline_reached
 } run_sequence_result;
 
-interpreter interpreter_create(value const *globals, garbage_collector *const gc,
-                               checked_function *const *const all_functions, lpg_interface *const *const all_interfaces,
-                               size_t max_recursion, size_t *current_recursion, uint64_t max_executed_instructions,
-                               uint64_t *executed_instructions)
+execution_budget execution_budget_create(uint64_t max_executed_instructions, size_t max_recursion,
+                                         size_t max_frame_memory, size_t max_heap_size, duration max_duration)
 {
+    execution_budget const result = {
+        max_executed_instructions, max_recursion, max_frame_memory, max_heap_size, max_duration};
+    return result;
+}
+
+execution_usage execution_usage_create(void)
+{
+    execution_usage const result = {0, 0, 0, 0, 0, 0, 0};
+    return result;
+}
+
+static duration find_deadline(execution_budget const budget)
+{
+    duration deadline = duration_from_milliseconds(execution_budget_no_deadline);
+    if (budget.max_duration.milliseconds != execution_budget_no_deadline)
+    {
+        uint64_t const now = read_monotonic_clock().milliseconds;
+        deadline.milliseconds = ((budget.max_duration.milliseconds < (execution_budget_no_deadline - now))
+                                     ? (now + budget.max_duration.milliseconds)
+                                     : execution_budget_no_deadline);
+    }
+    return deadline;
+}
+
+interpreter interpreter_create(value const *globals, garbage_collector *const gc, value_stack *const stack,
+                               bytecode_cache *const compiled_functions, checked_function *const *const all_functions,
+                               lpg_interface *const *const all_interfaces, execution_budget const budget,
+                               execution_usage *const usage)
+{
+    /*the budget is checked before the first instruction*/
+    uint64_t const next_budget_check = usage->executed_instructions;
     interpreter const result = {globals,
                                 gc,
+                                stack,
+                                compiled_functions,
                                 all_functions,
                                 all_interfaces,
-                                max_recursion,
-                                current_recursion,
-                                max_executed_instructions,
-                                executed_instructions};
+                                budget,
+                                find_deadline(budget),
+                                next_budget_check,
+                                usage,
+                                NULL};
     return result;
 }
 
+void interpreter_renew_budget(interpreter *const renewed, execution_usage *const usage)
+{
+    renewed->deadline = find_deadline(renewed->budget);
+    renewed->next_budget_check = usage->executed_instructions;
+    renewed->usage = usage;
+}
+
+enum
+{
+    /*how many instructions are executed between two readings of the clock*/
+    deadline_check_interval = 4096
+};
+
+static run_sequence_result check_execution_budget(interpreter *const context)
+{
+    uint64_t const executed = context->usage->executed_instructions;
+    uint64_t const max_executed = context->budget.max_executed_instructions;
+    if (executed >= max_executed)
+    {
+        return run_sequence_result_instruction_limit_reached;
+    }
+    if (context->budget.max_duration.milliseconds == execution_budget_no_deadline)
+    {
+        context->next_budget_check = max_executed;
+        return run_sequence_result_continue;
+    }
+    if (read_monotonic_clock().milliseconds >= context->deadline.milliseconds)
+    {
+        return run_sequence_result_deadline_reached;
+    }
+    uint64_t const remaining = (max_executed - executed);
+    context->next_budget_check =
+        (executed + ((remaining < deadline_check_interval) ? remaining : deadline_check_interval));
+    return run_sequence_result_continue;
+}
+
+/*returns run_sequence_result_continue if there was budget left for one more instruction*/
+static run_sequence_result count_instruction(interpreter *const context)
+{
+    if (context->usage->executed_instructions >= context->next_budget_check)
+    {
+        run_sequence_result const checked = check_execution_budget(context);
+        if (checked != run_sequence_result_continue)
+        {
+            return checked;
+        }
+    }
+    context->usage->executed_instructions += 1;
+    return run_sequence_result_continue;
+}
+
+/*returns false if the interpreter must not recurse any deeper*/
+static bool enter_recursion(interpreter *const context)
+{
+    execution_usage *const usage = context->usage;
+    if (usage->current_recursion == context->budget.max_recursion)
+    {
+        return false;
+    }
+    usage->current_recursion += 1;
+    if (usage->current_recursion > usage->peak_recursion)
+    {
+        usage->peak_recursion = usage->current_recursion;
+    }
+    return true;
+}
+
+static void leave_recursion(interpreter *const context)
+{
+    ASSUME(context->usage->current_recursion > 0);
+    context->usage->current_recursion -= 1;
+}
+
+static void charge_frame_memory(interpreter *const context, size_t const bytes)
+{
+    execution_usage *const usage = context->usage;
+    usage->used_frame_memory += bytes;
+    if (usage->used_frame_memory > usage->peak_frame_memory)
+    {
+        usage->peak_frame_memory = usage->used_frame_memory;
+    }
+}
+
+static void release_frame_memory(interpreter *const context, size_t const bytes)
+{
+    ASSUME(context->usage->used_frame_memory >= bytes);
+    context->usage->used_frame_memory -= bytes;
+}
+
+static void profile_call(interpreter *const context, function_id const entered)
+{
+    if (context->recorder)
+    {
+        profile_enter(
+            context->recorder, entered, context->usage->executed_instructions, context->gc->statistics.allocated_bytes);
+    }
+}
+
+static void profile_return(interpreter *const context)
+{
+    if (context->recorder)
+    {
+        profile_leave(
+            context->recorder, context->usage->executed_instructions, context->gc->statistics.allocated_bytes);
+    }
+}
+
+/*Garbage is only collected at calls and at the back edges of loops. At these points every value that is still in use
+ * is in a register, in an argument window, in a capture of a function in a register or in a global.*/
+static void collect_garbage_if_due(interpreter *const context)
+{
+    if (garbage_collector_is_collection_due(context->gc))
+    {
+        collect_garbage(context->gc, context->stack, context->globals, standard_library_element_count);
+    }
+}
+
 external_function_result call_function(function_pointer_value const callee, optional_value const self,
                                        value *const arguments, interpreter *const context)
 {
     ASSUME(context);
     if (callee.external)
     {
-        if (*context->current_recursion == context->max_recursion)
+        if (!enter_recursion(context))
         {
             return external_function_result_create_stack_overflow();
         }
-        *context->current_recursion += 1;
         external_function_result const return_value =
             callee.external(callee.captures, callee.external_environment, self, arguments, context);
-        *context->current_recursion -= 1;
-        if (!callee.external_signature.result.is_set)
-        {
-            LPG_TO_DO();
-        }
+        leave_recursion(context);
         switch (return_value.code)
         {
         case external_function_result_out_of_memory:
         case external_function_result_unavailable:
         case external_function_result_stack_overflow:
         case external_function_result_instruction_limit_reached:
+        case external_function_result_deadline_reached:
             break;
 
         case external_function_result_success:
+            /*functions without a result like fail never return successfully*/
+            if (!callee.external_signature.result.is_set)
+            {
+                LPG_TO_DO();
+            }
             ASSUME(value_conforms_to_type(return_value.if_success, callee.external_signature.result.value));
             break;
         }
@@ -97,8 +249,8 @@ static external_function_result invoke_method(value const *const captures, void
 
     case value_kind_type_erased:
     {
-        implementation *const impl =
-            &implementation_ref_resolve(*context->all_interfaces, from.type_erased.impl)->target;
+        type_erased_value const erased = value_as_type_erased(from);
+        implementation *const impl = &implementation_ref_resolve(*context->all_interfaces, erased.impl)->target;
         ASSUME(impl);
         ASSUME(parameters->method < impl->method_count);
         size_t const method_parameter_count = parameters->parameter_count;
@@ -106,7 +258,7 @@ static external_function_result invoke_method(value const *const captures, void
         ASSUME(method_parameter_count < SIZE_MAX);
         ASSUME(!self.is_set);
         external_function_result const result =
-            call_function(*function, optional_value_create(*from.type_erased.self), arguments, context);
+            call_function(*function, optional_value_create(*erased.self), arguments, context);
         return result;
     }
 
@@ -115,33 +267,31 @@ static external_function_result invoke_method(value const *const captures, void
         switch (parameters->method)
         {
         case 0: // size
-            return external_function_result_from_success(value_from_integer(integer_create(0, from.array->count)));
+            return external_function_result_from_success(value_from_small_integer(from.array->count));
 
         case 1: // load
         {
             value const index = arguments[0];
             ASSUME(index.kind == value_kind_integer);
-            if (integer_less(index.integer_, integer_create(0, from.array->count)))
+            if (integer_less(value_as_integer(index), integer_create(0, from.array->count)))
             {
                 value *const state = garbage_collector_allocate(context->gc, sizeof(*state));
-                *state = from.array->elements[index.integer_.low];
-                return external_function_result_from_success(
-                    value_from_enum_element(0, from.array->element_type, state));
+                *state = array_value_load(*from.array, index.small_integer);
+                return external_function_result_from_success(value_from_enum_element(0, state));
             }
-            return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+            return external_function_result_from_success(value_from_enum_element(1, NULL));
         }
 
         case 2: // store
         {
             value const index = arguments[0];
             ASSUME(index.kind == value_kind_integer);
-            if (!integer_less(index.integer_, integer_create(0, from.array->count)))
+            if (!integer_less(value_as_integer(index), integer_create(0, from.array->count)))
             {
-                return external_function_result_from_success(value_from_enum_element(0, type_from_unit(), NULL));
+                return external_function_result_from_success(value_from_enum_element(0, NULL));
             }
-            value const new_element = arguments[1];
-            from.array->elements[index.integer_.low] = new_element;
-            return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+            array_value_store(from.array, index.small_integer, arguments[1]);
+            return external_function_result_from_success(value_from_enum_element(1, NULL));
         }
 
         case 3: // append
@@ -155,26 +305,22 @@ static external_function_result invoke_method(value const *const captures, void
                 {
                     new_capacity = 1;
                 }
-                value *const new_elements =
-                    garbage_collector_try_allocate_array(context->gc, new_capacity, sizeof(*new_elements));
+                size_t const element_size = array_storage_element_size(from.array->storage);
+                void *const new_elements = garbage_collector_try_allocate_array(context->gc, new_capacity, element_size);
                 if (!new_elements)
                 {
                     return external_function_result_create_out_of_memory();
                 }
                 if (from.array->count > 0)
                 {
-                    memcpy(new_elements, from.array->elements, sizeof(*new_elements) * from.array->count);
+                    memcpy(new_elements, from.array->elements, element_size * from.array->count);
                 }
                 from.array->elements = new_elements;
                 from.array->allocated = new_capacity;
             }
-            from.array->elements[from.array->count] = new_element;
             from.array->count += 1;
-            for (size_t i = 0; i < from.array->count; ++i)
-            {
-                ASSUME(value_is_valid(from.array->elements[i]));
-            }
-            return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+            array_value_store(from.array, (from.array->count - 1), new_element);
+            return external_function_result_from_success(value_from_enum_element(1, NULL));
         }
 
         case 4: // clear
@@ -188,12 +334,12 @@ static external_function_result invoke_method(value const *const captures, void
             ASSUME(from.array->count > 0);
             value const count = arguments[0];
             ASSUME(count.kind == value_kind_integer);
-            if (integer_less(integer_create(0, from.array->count), count.integer_))
+            if (integer_less(integer_create(0, from.array->count), value_as_integer(count)))
             {
-                return external_function_result_from_success(value_from_enum_element(0, type_from_unit(), NULL));
+                return external_function_result_from_success(value_from_enum_element(0, NULL));
             }
-            from.array->count -= (size_t)count.integer_.low;
-            return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+            from.array->count -= (size_t)count.small_integer;
+            return external_function_result_from_success(value_from_enum_element(1, NULL));
         }
 
         default:
@@ -225,7 +371,7 @@ static run_sequence_result run_sequence(instruction_sequence const sequence, val
 static void run_new_array(new_array_instruction const new_array, garbage_collector *const gc, value *const registers)
 {
     array_value *const array = garbage_collector_allocate(gc, sizeof(*array));
-    *array = array_value_create(NULL, 0, 0, new_array.element_type);
+    *array = array_value_create_empty(new_array.storage, new_array.element_type);
     registers[new_array.into] = value_from_array(array);
 }
 
@@ -248,7 +394,8 @@ static void run_get_method(get_method_instruction const get_method, garbage_coll
     registers[get_method.into] = value_from_function_pointer(function_pointer_value_from_external(
         invoke_method, parameters, pseudo_captures,
         function_pointer_create(optional_type_create_set(method.result), method.parameters,
-                                tuple_type_create(pseudo_capture_types, capture_count), optional_type_create_empty())));
+                                tuple_type_create(pseudo_capture_types, capture_count), optional_type_create_empty())),
+        gc);
 }
 
 static bool LPG_USE_RESULT run_erase_type(erase_type_instruction const erase_type, garbage_collector *const gc,
@@ -264,12 +411,186 @@ static bool LPG_USE_RESULT run_erase_type(erase_type_instruction const erase_typ
         // this can happen during compile time evaluation in the body of the impl itself
         return false;
     }
-    value *const self = garbage_collector_allocate(gc, sizeof(*self));
-    *self = registers[erase_type.self];
-    registers[erase_type.into] = value_from_type_erased(type_erased_value_create(erase_type.impl, self));
+    registers[erase_type.into] = value_from_type_erased(erase_type.impl, registers[erase_type.self], gc);
     return true;
 }
 
+static run_sequence_result store_call_result(external_function_result const result, register_id const into,
+                                             value *const registers)
+{
+    switch (result.code)
+    {
+    case external_function_result_out_of_memory:
+        return run_sequence_result_out_of_memory;
+
+    case external_function_result_success:
+        ASSUME(value_is_valid(result.if_success));
+        registers[into] = result.if_success;
+        return run_sequence_result_continue;
+
+    case external_function_result_unavailable:
+        return run_sequence_result_unavailable_at_this_time;
+
+    case external_function_result_stack_overflow:
+        return run_sequence_result_stack_overflow;
+
+    case external_function_result_instruction_limit_reached:
+        return run_sequence_result_instruction_limit_reached;
+
+    case external_function_result_deadline_reached:
+        return run_sequence_result_deadline_reached;
+    }
+    LPG_UNREACHABLE();
+}
+
+/*the result of a builtin as an enum element (boolean, subtract_result or add_result)*/
+typedef struct builtin_result
+{
+    /*false if the builtin has to be called like any other function*/
+    bool is_computed;
+    enum_element_id which;
+    /*the integer of subtract_result.ok and add_result.ok*/
+    bool has_state;
+    uint64_t state;
+} builtin_result;
+
+static builtin_result builtin_result_create(enum_element_id const which, bool const has_state, uint64_t const state)
+{
+    builtin_result const result = {true, which, has_state, state};
+    return result;
+}
+
+static builtin_result const builtin_result_not_computed = {false, 0, false, 0};
+
+static size_t builtin_global(bytecode_builtin const builtin)
+{
+    switch (builtin)
+    {
+    case bytecode_builtin_none:
+        LPG_UNREACHABLE();
+
+    case bytecode_builtin_integer_less:
+        return standard_library_integer_less;
+
+    case bytecode_builtin_integer_equals:
+        return standard_library_integer_equals;
+
+    case bytecode_builtin_string_equals:
+        return standard_library_string_equals;
+
+    case bytecode_builtin_subtract_integers:
+        return standard_library_subtract;
+
+    case bytecode_builtin_add_integers:
+        return standard_library_add;
+    }
+    LPG_UNREACHABLE();
+}
+
+static bytecode_builtin find_external_builtin(external_function *const external)
+{
+    if (external == integer_less_impl)
+    {
+        return bytecode_builtin_integer_less;
+    }
+    if (external == integer_equals_impl)
+    {
+        return bytecode_builtin_integer_equals;
+    }
+    if (external == string_equals_impl)
+    {
+        return bytecode_builtin_string_equals;
+    }
+    if (external == subtract_impl)
+    {
+        return bytecode_builtin_subtract_integers;
+    }
+    if (external == add_impl)
+    {
+        return bytecode_builtin_add_integers;
+    }
+    return bytecode_builtin_none;
+}
+
+/*Integers are computed with native 64 bit arithmetic. The 128 bit cases are left to the implementations in the
+ * standard library.*/
+static builtin_result compute_builtin(bytecode_builtin const builtin, value const left, value const right)
+{
+    if (builtin == bytecode_builtin_string_equals)
+    {
+        ASSUME(left.kind == value_kind_string);
+        ASSUME(right.kind == value_kind_string);
+        return builtin_result_create(unicode_view_equals(value_as_string(left), value_as_string(right)), false, 0);
+    }
+    ASSUME(left.kind == value_kind_integer);
+    ASSUME(right.kind == value_kind_integer);
+    if (left.is_big || right.is_big)
+    {
+        return builtin_result_not_computed;
+    }
+    uint64_t content = 0;
+    switch (builtin)
+    {
+    case bytecode_builtin_none:
+    case bytecode_builtin_string_equals:
+        LPG_UNREACHABLE();
+
+    case bytecode_builtin_integer_less:
+        return builtin_result_create((left.small_integer < right.small_integer), false, 0);
+
+    case bytecode_builtin_integer_equals:
+        return builtin_result_create((left.small_integer == right.small_integer), false, 0);
+
+    case bytecode_builtin_subtract_integers:
+        if (integer_subtract_small(left.small_integer, right.small_integer, &content))
+        {
+            return builtin_result_create(0, true, content);
+        }
+        return builtin_result_create(1, false, 0);
+
+    case bytecode_builtin_add_integers:
+        if (integer_add_small(left.small_integer, right.small_integer, &content))
+        {
+            return builtin_result_create(0, true, content);
+        }
+        /*the sum needs more than 64 bits*/
+        return builtin_result_not_computed;
+    }
+    LPG_UNREACHABLE();
+}
+
+/*whether the program runs with the function of the standard library for the builtin*/
+static bool is_standard_builtin(bytecode_builtin const builtin, interpreter const *const context)
+{
+    value const function = context->globals[builtin_global(builtin)];
+    return (function.kind == value_kind_function_pointer) && value_function_is_external(function) &&
+           (find_external_builtin(function.boxed_function->external) == builtin);
+}
+
+/*computes the builtin unless the program runs with globals that are not the ones of the standard library*/
+static builtin_result compute_global_builtin(bytecode_builtin const builtin, call_instruction const call,
+                                             value const *const registers, interpreter const *const context)
+{
+    if (!is_standard_builtin(builtin, context))
+    {
+        return builtin_result_not_computed;
+    }
+    ASSUME(call.argument_count == 2);
+    return compute_builtin(builtin, registers[call.arguments[0]], registers[call.arguments[1]]);
+}
+
+static value builtin_result_to_value(builtin_result const result, garbage_collector *const gc)
+{
+    ASSUME(result.is_computed);
+    if (!result.has_state)
+    {
+        return value_from_enum_element(result.which, NULL);
+    }
+    value *const state = garbage_collector_allocate(gc, sizeof(*state));
+    *state = value_from_small_integer(result.state);
+    return value_from_enum_element(result.which, state);
+}
+
 static run_sequence_result run_call(call_instruction const call, value *const registers, interpreter *const context)
 {
     value const callee = registers[call.callee];
@@ -278,7 +599,24 @@ static run_sequence_result run_call(call_instruction const call, value *const re
     {
         return run_sequence_result_unavailable_at_this_time;
     }
-    value *const arguments = allocate_array(call.argument_count, sizeof(*arguments));
+    if ((callee.kind == value_kind_function_pointer) && value_function_is_external(callee))
+    {
+        /*The builtins are executed right here without an argument array. They do not call anything, so they are not
+         * counted as a level of recursion.*/
+        bytecode_builtin const builtin = find_external_builtin(callee.boxed_function->external);
+        if (builtin != bytecode_builtin_none)
+        {
+            ASSUME(call.argument_count == 2);
+            builtin_result const computed =
+                compute_builtin(builtin, registers[call.arguments[0]], registers[call.arguments[1]]);
+            if (computed.is_computed)
+            {
+                registers[call.result] = builtin_result_to_value(computed, context->gc);
+                return run_sequence_result_continue;
+            }
+        }
+    }
+    value *const arguments = value_stack_push(context->stack, call.argument_count);
     LPG_FOR(size_t, j, call.argument_count)
     {
         arguments[j] = registers[call.arguments[j]];
@@ -289,28 +627,9 @@ static run_sequence_result run_call(call_instruction const call, value *const re
     case value_kind_function_pointer:
     {
         external_function_result const result =
-            call_function(callee.function_pointer, optional_value_empty, arguments, context);
-        deallocate(arguments);
-        switch (result.code)
-        {
-        case external_function_result_out_of_memory:
-            return run_sequence_result_out_of_memory;
-
-        case external_function_result_success:
-            ASSUME(value_is_valid(result.if_success));
-            registers[call.result] = result.if_success;
-            break;
-
-        case external_function_result_unavailable:
-            return run_sequence_result_unavailable_at_this_time;
-
-        case external_function_result_stack_overflow:
-            return run_sequence_result_stack_overflow;
-
-        case external_function_result_instruction_limit_reached:
-            return run_sequence_result_instruction_limit_reached;
-        }
-        break;
+            call_function(value_as_function_pointer(callee), optional_value_empty, arguments, context);
+        value_stack_pop(context->stack, call.argument_count);
+        return store_call_result(result, call.result, registers);
     }
 
     case value_kind_type_erased:
@@ -332,7 +651,54 @@ static run_sequence_result run_call(call_instruction const call, value *const re
     case value_kind_array:
         LPG_TO_DO();
     }
-    return run_sequence_result_continue;
+    LPG_UNREACHABLE();
+}
+
+/*calls a builtin like any other global function*/
+static run_sequence_result run_builtin_call(bytecode_builtin const builtin, call_instruction const call,
+                                            value *const registers, interpreter *const context)
+{
+    registers[call.callee] = context->globals[builtin_global(builtin)];
+    return run_call(call, registers, context);
+}
+
+/*computes the builtin inline if possible and calls the global function otherwise*/
+static run_sequence_result run_call_builtin(bytecode_builtin const builtin, call_instruction const call,
+                                            value *const registers, interpreter *const context)
+{
+    builtin_result const computed = compute_global_builtin(builtin, call, registers, context);
+    if (computed.is_computed)
+    {
+        registers[call.result] = builtin_result_to_value(computed, context->gc);
+        return run_sequence_result_continue;
+    }
+    return run_builtin_call(builtin, call, registers, context);
+}
+
+/*calls the method that get_method would have bound to a function pointer without creating that function pointer*/
+static run_sequence_result run_call_method(get_method_instruction const get_method, call_instruction const call,
+                                           value *const registers, interpreter *const context)
+{
+    value *const arguments = value_stack_push(context->stack, call.argument_count);
+    LPG_FOR(size_t, j, call.argument_count)
+    {
+        arguments[j] = registers[call.arguments[j]];
+        ASSUME(value_is_valid(arguments[j]));
+    }
+    /*the recursion is counted like for the external function that get_method creates*/
+    if (!enter_recursion(context))
+    {
+        value_stack_pop(context->stack, call.argument_count);
+        return run_sequence_result_stack_overflow;
+    }
+    lpg_interface const *const interface_ = &(*context->all_interfaces)[get_method.interface_];
+    ASSUME(get_method.method < interface_->method_count);
+    invoke_method_parameters parameters = {get_method.method, interface_->methods[get_method.method].parameters.length};
+    external_function_result const result =
+        invoke_method(registers + get_method.from, &parameters, optional_value_empty, arguments, context);
+    leave_recursion(context);
+    value_stack_pop(context->stack, call.argument_count);
+    return store_call_result(result, call.result, registers);
 }
 
 static run_sequence_result run_loop(loop_instruction const loop, value *const return_value, value *const registers,
@@ -350,6 +716,7 @@ static run_sequence_result run_loop(loop_instruction const loop, value *const re
             break;
 
         case run_sequence_result_continue:
+            collect_garbage_if_due(context);
             break;
 
         case run_sequence_result_unavailable_at_this_time:
@@ -366,23 +733,32 @@ static run_sequence_result run_loop(loop_instruction const loop, value *const re
 
         case run_sequence_result_instruction_limit_reached:
             return run_sequence_result_instruction_limit_reached;
+
+        case run_sequence_result_deadline_reached:
+            return run_sequence_result_deadline_reached;
         }
     }
     return run_sequence_result_continue;
 }
 
+static void run_read_struct(read_struct_instruction const read_struct, value *const registers)
+{
+    structure_value const from = value_as_structure(registers[read_struct.from_object]);
+    ASSUME(read_struct.member < from.count);
+    value const member = from.members[read_struct.member];
+    ASSUME(value_is_valid(member));
+    registers[read_struct.into] = member;
+}
+
 static void run_tuple(tuple_instruction const tuple_, garbage_collector *const gc, value *const registers)
 {
-    value new_tuple;
-    new_tuple.kind = value_kind_tuple;
     value *values = garbage_collector_allocate_array(gc, tuple_.element_count, sizeof(*values));
     for (size_t j = 0; j < tuple_.element_count; ++j)
     {
         values[j] = registers[*(tuple_.elements + j)];
         ASSUME(value_is_valid(values[j]));
     }
-    new_tuple.tuple_ = value_tuple_create(values, tuple_.element_count);
-    registers[tuple_.result] = new_tuple;
+    registers[tuple_.result] = value_from_tuple(value_tuple_create(values, tuple_.element_count));
 }
 
 static void run_instantiate_struct(instantiate_struct_instruction const instantiate_struct, garbage_collector *const gc,
@@ -404,30 +780,27 @@ static void run_enum_construct(enum_construct_instruction const enum_construct,
     value *const state = garbage_collector_allocate(gc, sizeof(*state));
     *state = registers[enum_construct.state];
     ASSUME(value_is_valid(*state));
-    registers[enum_construct.into] =
-        value_from_enum_element(enum_construct.which.which, enum_construct.state_type, state);
+    registers[enum_construct.into] = value_from_enum_element(enum_construct.which.which, state);
 }
 
-static run_sequence_result run_match(match_instruction const match, value *const return_value, value *const registers,
-                                     structure_value const captures, optional_function_id const current_function,
-                                     interpreter *const context)
+static match_instruction_case const *find_matching_case(match_instruction const match, value *const registers)
 {
     value const key = registers[match.key];
     ASSUME(value_is_valid(key));
-    match_instruction_case *matching_case = NULL;
-    match_instruction_case *default_case = NULL;
+    match_instruction_case const *matching_case = NULL;
+    match_instruction_case const *default_case = NULL;
     for (size_t j = 0; j < match.count; ++j)
     {
-        match_instruction_case *const this_case = match.cases + j;
+        match_instruction_case const *const this_case = match.cases + j;
         bool matches = false;
         switch (this_case->kind)
         {
         case match_instruction_case_kind_stateful_enum:
             ASSUME(key.kind == value_kind_enum_element);
-            matches = (key.enum_element.which == this_case->stateful_enum.element);
+            matches = (key.which == this_case->stateful_enum.element);
             if (matches)
             {
-                registers[this_case->stateful_enum.where] = value_or_unit(key.enum_element.state);
+                registers[this_case->stateful_enum.where] = value_or_unit(key.enum_state);
             }
             break;
 
@@ -451,6 +824,43 @@ static run_sequence_result run_match(match_instruction const match, value *const
         matching_case = default_case;
     }
     ASSUME(matching_case);
+    return matching_case;
+}
+
+static size_t select_match_case(match_instruction const match, match_table const *const table,
+                                value *const registers)
+{
+    if (table->kind == match_table_kind_linear)
+    {
+        return (size_t)(find_matching_case(match, registers) - match.cases);
+    }
+    value const key = registers[match.key];
+    ASSUME(value_is_valid(key));
+    size_t const selected = match_table_find(table, key);
+    match_instruction_case const *const selected_case = match.cases + selected;
+    if (selected_case->kind == match_instruction_case_kind_stateful_enum)
+    {
+        registers[selected_case->stateful_enum.where] = value_or_unit(key.enum_state);
+    }
+    return selected;
+}
+
+static void finish_match_case(match_instruction const match, match_instruction_case const *const finished,
+                              value *const registers)
+{
+    if (finished->value.is_set)
+    {
+        ASSUME(value_is_valid(registers[finished->value.value]));
+        ASSUME(value_conforms_to_type(registers[finished->value.value], match.result_type));
+        registers[match.result] = registers[finished->value.value];
+    }
+}
+
+static run_sequence_result run_match(match_instruction const match, value *const return_value, value *const registers,
+                                     structure_value const captures, optional_function_id const current_function,
+                                     interpreter *const context)
+{
+    match_instruction_case const *const matching_case = find_matching_case(match, registers);
     switch (run_sequence(matching_case->action, return_value, registers, captures, current_function, context))
     {
     case run_sequence_result_break:
@@ -473,13 +883,11 @@ static run_sequence_result run_match(match_instruction const match, value *const
 
     case run_sequence_result_instruction_limit_reached:
         return run_sequence_result_instruction_limit_reached;
+
+    case run_sequence_result_deadline_reached:
+        return run_sequence_result_deadline_reached;
     }
-    if (matching_case->value.is_set)
-    {
-        ASSUME(value_is_valid(registers[matching_case->value.value]));
-        ASSUME(value_conforms_to_type(registers[matching_case->value.value], match.result_type));
-        registers[match.result] = registers[matching_case->value.value];
-    }
+    finish_match_case(match, matching_case, registers);
     return run_sequence_result_continue;
 }
 
@@ -494,8 +902,9 @@ static void run_lambda_with_captures(lambda_with_captures_instruction const lamb
         inner_captures[j] = capture;
         ASSUME(value_is_valid(capture));
     }
-    registers[lambda_with_captures.into] = value_from_function_pointer(function_pointer_value_from_internal(
-        lambda_with_captures.lambda, inner_captures, lambda_with_captures.capture_count));
+    function_pointer_value const created = function_pointer_value_from_internal(
+        lambda_with_captures.lambda, inner_captures, lambda_with_captures.capture_count);
+    registers[lambda_with_captures.into] = value_from_function_pointer(created, gc);
 }
 
 static void run_current_function(current_function_instruction const current_function_instr,
@@ -511,18 +920,20 @@ static void run_current_function(current_function_instruction const current_func
     }
     ASSUME(current_function.is_set);
     registers[current_function_instr.into] = value_from_function_pointer(
-        function_pointer_value_from_internal(current_function.value, inner_captures, captures.count));
+        function_pointer_value_from_internal(current_function.value, inner_captures, captures.count), gc);
 }
 
 static run_sequence_result run_instruction(value *const return_value, value *const registers,
                                            structure_value const captures, optional_function_id const current_function,
                                            instruction const element, interpreter *const context)
 {
-    if (*context->executed_instructions == context->max_executed_instructions)
     {
-        return run_sequence_result_instruction_limit_reached;
+        run_sequence_result const counted = count_instruction(context);
+        if (counted != run_sequence_result_continue)
+        {
+            return counted;
+        }
     }
-    *context->executed_instructions += 1;
     switch (element.type)
     {
     case instruction_new_array:
@@ -558,14 +969,8 @@ static run_sequence_result run_instruction(value *const return_value, value *con
         break;
 
     case instruction_read_struct:
-    {
-        structure_value const from = registers[element.read_struct.from_object].structure;
-        ASSUME(element.read_struct.member < from.count);
-        value const member = from.members[element.read_struct.member];
-        ASSUME(value_is_valid(member));
-        registers[element.read_struct.into] = member;
+        run_read_struct(element.read_struct, registers);
         break;
-    }
 
     case instruction_break:
         registers[element.break_.unit_goes_into] = value_from_unit();
@@ -616,13 +1021,13 @@ static run_sequence_result run_sequence(instruction_sequence const sequence, val
 {
     if (sequence.length == 0)
     {
-        if (*context->executed_instructions == context->max_executed_instructions)
-        {
-            return run_sequence_result_instruction_limit_reached;
-        }
         // empty sequences count as one instructions each so that we can detect infinite, empty loops in compile time
         // evaluation
-        *context->executed_instructions += 1;
+        run_sequence_result const counted = count_instruction(context);
+        if (counted != run_sequence_result_continue)
+        {
+            return counted;
+        }
     }
     LPG_FOR(size_t, i, sequence.length)
     {
@@ -649,11 +1054,682 @@ static run_sequence_result run_sequence(instruction_sequence const sequence, val
 
         case run_sequence_result_instruction_limit_reached:
             return run_sequence_result_instruction_limit_reached;
+
+        case run_sequence_result_deadline_reached:
+            return run_sequence_result_deadline_reached;
+        }
+    }
+    return run_sequence_result_continue;
+}
+
+#if defined(__GNUC__)
+#define LPG_COMPUTED_GOTO 1
+#else
+#define LPG_COMPUTED_GOTO 0
+#endif
+
+enum
+{
+    /*run_bytecode_from has stopped at a safepoint and can be resumed*/
+    bytecode_run_suspended = (run_sequence_result_deadline_reached + 1)
+};
+
+#if LPG_COMPUTED_GOTO
+/*labels as values are a GNU extension*/
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define LPG_DISPATCH() goto *dispatch_table[current->opcode]
+#define LPG_OPCODE(name) label_##name
+#else
+#define LPG_DISPATCH() goto dispatch
+#define LPG_OPCODE(name) case name
+#endif
+
+/*the state of a function that is being executed by run_bytecode*/
+typedef struct call_frame
+{
+    bytecode code;
+    bytecode_operation const *current;
+    value *registers;
+    /*the number of values this frame occupies on the value stack. The frame that run_bytecode was called for does not
+     * own any.*/
+    size_t window_size;
+    structure_value captures;
+    optional_function_id current_function;
+    /*the register of the caller that receives the return value*/
+    register_id result;
+    /*The return instructions of the callers that this frame has replaced with tail calls. They are counted when this
+     * frame returns, so the instruction count is the same as without tail calls.*/
+    size_t deferred_returns;
+} call_frame;
+
+/*the callers of the active frame of run_bytecode*/
+typedef struct call_frame_stack
+{
+    call_frame *elements;
+    size_t count;
+    size_t capacity;
+} call_frame_stack;
+
+enum
+{
+    /*a tail call has to copy the arguments somewhere while the frame of the caller is being replaced*/
+    max_tail_call_arguments = 16
+};
+
+static size_t frame_memory(size_t const window_size)
+{
+    return (window_size * sizeof(value)) + sizeof(call_frame);
+}
+
+static bool is_frame_memory_available(interpreter const *const context, size_t const freed, size_t const needed)
+{
+    return (needed <= ((context->budget.max_frame_memory - context->usage->used_frame_memory) + freed));
+}
+
+/*Makes an interpreted function the active frame. The caller becomes suspended unless this is a tail call, in which case
+ * the caller is replaced.*/
+static run_sequence_result enter_function(call_frame_stack *const frames, call_frame *const active,
+                                          bytecode_operation const *const resume, value const callee,
+                                          optional_value const self, call_instruction const call,
+                                          bool const is_tail_call, interpreter *const context)
+{
+    ASSUME(!value_function_is_external(callee));
+    function_id const code = value_function_code(callee);
+    value *const function_captures = (callee.boxed_function ? callee.boxed_function->captures : NULL);
+    checked_function const *const entered = &(*context->all_functions)[code];
+    /*there has to be at least one register for the return value, even if it is unit*/
+    ASSUME(entered->number_of_registers >= 1);
+    ASSUME(entered->signature->self.is_set == self.is_set);
+    ASSUME(entered->signature->parameters.length == call.argument_count);
+    /*the called function is kept in the first value of the window so that the garbage collector finds its captures*/
+    size_t const window_size = (1 + entered->number_of_registers);
+    size_t const self_count = (self.is_set ? 1u : 0u);
+    bool const replaces_active =
+        is_tail_call && (frames->count > 0) && ((self_count + call.argument_count) <= max_tail_call_arguments);
+    if (!is_frame_memory_available(
+            context, (replaces_active ? frame_memory(active->window_size) : 0), frame_memory(window_size)))
+    {
+        return run_sequence_result_stack_overflow;
+    }
+    value parameters[max_tail_call_arguments];
+    value const *arguments = parameters;
+    if (replaces_active)
+    {
+        for (size_t i = 0; i < call.argument_count; ++i)
+        {
+            parameters[i] = active->registers[call.arguments[i]];
+        }
+        value_stack_pop(context->stack, active->window_size);
+        release_frame_memory(context, frame_memory(active->window_size));
+        active->deferred_returns += 1;
+        profile_return(context);
+    }
+    else
+    {
+        frames->elements = reallocate_array_exponentially(
+            frames->elements, (frames->count + 1), sizeof(*frames->elements), frames->count, &frames->capacity);
+        active->current = resume;
+        frames->elements[frames->count] = *active;
+        ++(frames->count);
+        active->result = call.result;
+        active->deferred_returns = 0;
+    }
+    value *const window = value_stack_push(context->stack, window_size);
+    charge_frame_memory(context, frame_memory(window_size));
+    memset(window, 0, sizeof(*window) * window_size);
+    window[0] = callee;
+    value *const registers = (window + 1);
+    register_id next_register = 0;
+    if (self.is_set)
+    {
+        registers[next_register] = self.value_;
+        ++next_register;
+    }
+    for (size_t i = 0; i < call.argument_count; ++i)
+    {
+        value const argument = (replaces_active ? arguments[i] : frames->elements[frames->count - 1]
+                                                                       .registers[call.arguments[i]]);
+        ASSUME(value_conforms_to_type(argument, entered->signature->parameters.elements[i]));
+        registers[next_register] = argument;
+        ++next_register;
+    }
+    active->code = *bytecode_cache_get(
+        context->compiled_functions, code, entered->body, entered->number_of_registers);
+    active->current = active->code.operations;
+    active->registers = registers;
+    active->window_size = window_size;
+    active->captures = structure_value_create(function_captures, entered->signature->captures.length);
+    active->current_function = optional_function_id_create(code);
+    profile_call(context, code);
+    collect_garbage_if_due(context);
+    return run_sequence_result_continue;
+}
+
+/*Returns from the active frame to the most recently suspended frame.*/
+static run_sequence_result leave_function(call_frame_stack *const frames, call_frame *const active,
+                                          value const returned, interpreter *const context)
+{
+    ASSUME(frames->count > 0);
+    for (size_t i = 0; i < active->deferred_returns; ++i)
+    {
+        run_sequence_result const counted = count_instruction(context);
+        if (counted != run_sequence_result_continue)
+        {
+            return counted;
         }
     }
+    ASSUME(active->current_function.is_set);
+    checked_function const *const left = &(*context->all_functions)[active->current_function.value];
+    if (!left->signature->result.is_set)
+    {
+        LPG_TO_DO();
+    }
+    ASSUME(value_conforms_to_type(returned, left->signature->result.value));
+    value_stack_pop(context->stack, active->window_size);
+    release_frame_memory(context, frame_memory(active->window_size));
+    profile_return(context);
+    register_id const into = active->result;
+    --(frames->count);
+    *active = frames->elements[frames->count];
+    active->registers[into] = returned;
     return run_sequence_result_continue;
 }
 
+/*everything that run_bytecode_from needs to continue a call where it has been suspended*/
+typedef struct bytecode_run
+{
+    call_frame_stack frames;
+    call_frame active;
+    bytecode_operation const *current;
+} bytecode_run;
+
+static bytecode_run bytecode_run_create(bytecode const code, value *const registers, structure_value const captures,
+                                        optional_function_id const current_function)
+{
+    call_frame_stack const frames = {NULL, 0, 0};
+    call_frame const active = {code, code.operations, registers, 0, captures, current_function, 0, 0};
+    bytecode_run const result = {frames, active, code.operations};
+    return result;
+}
+
+/*releases all the frames that run_bytecode has created*/
+static void unwind_frames(call_frame_stack const frames, call_frame const *const active, interpreter *const context)
+{
+    if (frames.count == 0)
+    {
+        return;
+    }
+    value_stack_pop(context->stack, active->window_size);
+    release_frame_memory(context, frame_memory(active->window_size));
+    profile_return(context);
+    for (size_t i = frames.count; i > 1; --i)
+    {
+        size_t const window_size = frames.elements[i - 1].window_size;
+        value_stack_pop(context->stack, window_size);
+        release_frame_memory(context, frame_memory(window_size));
+        profile_return(context);
+    }
+}
+
+#define LPG_EXIT(result)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        exit_result = (result);                                                                                        \
+        goto finished;                                                                                                 \
+    } while (0)
+
+#define LPG_COUNT_INSTRUCTION()                                                                                        \
+    if (context->usage->executed_instructions >= context->next_budget_check)                                           \
+    {                                                                                                                  \
+        run_sequence_result const checked = check_execution_budget(context);                                           \
+        if (checked != run_sequence_result_continue)                                                                   \
+        {                                                                                                              \
+            LPG_EXIT(checked);                                                                                         \
+        }                                                                                                              \
+    }                                                                                                                  \
+    if (context->recorder && active.current_function.is_set)                                                          \
+    {                                                                                                                  \
+        profile_count_site(context->recorder, active.current_function.value,                                           \
+                           (size_t)(current - active.code.operations), active.code.operation_count);                   \
+    }                                                                                                                  \
+    context->usage->executed_instructions += 1
+
+/*A resumable call is only suspended where the garbage collector could run as well: when a function is entered or left
+ * and before the next iteration of a loop.*/
+#define LPG_SAFEPOINT()                                                                                                \
+    if (context->usage->executed_instructions >= suspend_at)                                                           \
+    {                                                                                                                  \
+        goto suspend;                                                                                                  \
+    }
+
+/*Calls of interpreted functions do not recurse on the C stack. The frames of the callers are kept in a separate stack
+ * instead. The bytecode is stored by value because a call can add entries to the cache it comes from, which moves the
+ * entries (but not the operations and matches they own). Returns bytecode_run_suspended at the first safepoint after
+ * suspend_at instructions have been executed, in which case the run keeps its frames and can be continued later.
+ * Otherwise the frames are released and the result is a run_sequence_result.*/
+static int run_bytecode_from(bytecode_run *const run, uint64_t const suspend_at, value *const return_value,
+                             interpreter *const context)
+{
+    call_frame_stack frames = run->frames;
+    call_frame active = run->active;
+    run_sequence_result exit_result = run_sequence_result_continue;
+    bytecode_operation const *current = run->current;
+#if LPG_COMPUTED_GOTO
+    static void *const dispatch_table[bytecode_opcode_count] = {
+        [bytecode_opcode_call] = &&label_bytecode_opcode_call,
+        [bytecode_opcode_loop] = &&label_bytecode_opcode_loop,
+        [bytecode_opcode_continue_loop] = &&label_bytecode_opcode_continue_loop,
+        [bytecode_opcode_global] = &&label_bytecode_opcode_global,
+        [bytecode_opcode_read_struct] = &&label_bytecode_opcode_read_struct,
+        [bytecode_opcode_break] = &&label_bytecode_opcode_break,
+        [bytecode_opcode_literal] = &&label_bytecode_opcode_literal,
+        [bytecode_opcode_tuple] = &&label_bytecode_opcode_tuple,
+        [bytecode_opcode_enum_construct] = &&label_bytecode_opcode_enum_construct,
+        [bytecode_opcode_match] = &&label_bytecode_opcode_match,
+        [bytecode_opcode_end_match_case] = &&label_bytecode_opcode_end_match_case,
+        [bytecode_opcode_get_captures] = &&label_bytecode_opcode_get_captures,
+        [bytecode_opcode_lambda_with_captures] = &&label_bytecode_opcode_lambda_with_captures,
+        [bytecode_opcode_get_method] = &&label_bytecode_opcode_get_method,
+        [bytecode_opcode_bind_method] = &&label_bytecode_opcode_bind_method,
+        [bytecode_opcode_call_method] = &&label_bytecode_opcode_call_method,
+        [bytecode_opcode_erase_type] = &&label_bytecode_opcode_erase_type,
+        [bytecode_opcode_return] = &&label_bytecode_opcode_return,
+        [bytecode_opcode_instantiate_struct] = &&label_bytecode_opcode_instantiate_struct,
+        [bytecode_opcode_new_array] = &&label_bytecode_opcode_new_array,
+        [bytecode_opcode_current_function] = &&label_bytecode_opcode_current_function,
+        [bytecode_opcode_empty_sequence] = &&label_bytecode_opcode_empty_sequence,
+        [bytecode_opcode_end_of_function] = &&label_bytecode_opcode_end_of_function,
+        [bytecode_opcode_lookup_builtin] = &&label_bytecode_opcode_lookup_builtin,
+        [bytecode_opcode_call_builtin] = &&label_bytecode_opcode_call_builtin,
+        [bytecode_opcode_call_builtin_and_match] = &&label_bytecode_opcode_call_builtin_and_match};
+    LPG_DISPATCH();
+#else
+dispatch:
+    switch (current->opcode)
+#endif
+    {
+        LPG_OPCODE(bytecode_opcode_call):
+        {
+            LPG_COUNT_INSTRUCTION();
+            call_instruction const call = current->original->call;
+            value const callee = active.registers[call.callee];
+            if ((callee.kind == value_kind_function_pointer) && !value_function_is_external(callee))
+            {
+                run_sequence_result const result = enter_function(&frames, &active, (current + 1), callee,
+                                                                  optional_value_empty, call, current->is_tail_call,
+                                                                  context);
+                if (result != run_sequence_result_continue)
+                {
+                    LPG_EXIT(result);
+                }
+                current = active.current;
+                LPG_SAFEPOINT();
+                LPG_DISPATCH();
+            }
+            run_sequence_result const result = run_call(call, active.registers, context);
+            if (result != run_sequence_result_continue)
+            {
+                LPG_EXIT(result);
+            }
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_loop):
+        {
+            LPG_COUNT_INSTRUCTION();
+            active.registers[current->original->loop.unit_goes_into] = value_from_unit();
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_continue_loop):
+        {
+            collect_garbage_if_due(context);
+            current = active.code.operations + current->target;
+            LPG_SAFEPOINT();
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_global):
+        {
+            LPG_COUNT_INSTRUCTION();
+            active.registers[current->original->global_into] =
+                value_from_structure(structure_value_create(context->globals, standard_library_element_count));
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_read_struct):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_read_struct(current->original->read_struct, active.registers);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_break):
+        {
+            LPG_COUNT_INSTRUCTION();
+            active.registers[current->original->break_.unit_goes_into] = value_from_unit();
+            if (current->original->break_.loop_result.is_set)
+            {
+                LPG_TO_DO();
+            }
+            current = active.code.operations + current->target;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_literal):
+        {
+            LPG_COUNT_INSTRUCTION();
+            ASSUME(value_is_valid(current->original->literal.value_));
+            active.registers[current->original->literal.into] = current->original->literal.value_;
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_tuple):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_tuple(current->original->tuple_, context->gc, active.registers);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_enum_construct):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_enum_construct(current->original->enum_construct, context->gc, active.registers);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_match):
+        {
+            LPG_COUNT_INSTRUCTION();
+            bytecode_match const *const compiled = active.code.matches + current->target;
+            current = active.code.operations + compiled->case_targets[select_match_case(
+                                       current->original->match, &compiled->table, active.registers)];
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_end_match_case):
+        {
+            finish_match_case(current->original->match, current->finished_case, active.registers);
+            current = active.code.operations + current->target;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_get_captures):
+        {
+            LPG_COUNT_INSTRUCTION();
+            active.registers[current->original->captures] = value_from_structure(active.captures);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_lambda_with_captures):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_lambda_with_captures(current->original->lambda_with_captures, context->gc, active.registers);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_get_method):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_get_method(current->original->get_method, context->gc, active.registers, *context->all_interfaces);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_bind_method):
+        {
+            // the method is bound when it is called by call_method
+            LPG_COUNT_INSTRUCTION();
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_call_method):
+        {
+            LPG_COUNT_INSTRUCTION();
+            get_method_instruction const get_method = active.code.operations[current->target].original->get_method;
+            call_instruction const call = current->original->call;
+            value const from = active.registers[get_method.from];
+            if (from.kind == value_kind_type_erased)
+            {
+                implementation const *const impl =
+                    &implementation_ref_resolve(*context->all_interfaces, value_as_type_erased(from).impl)->target;
+                ASSUME(get_method.method < impl->method_count);
+                function_pointer_value const method = impl->methods[get_method.method];
+                if (!method.external)
+                {
+                    run_sequence_result const result = enter_function(
+                        &frames, &active, (current + 1), value_from_function_pointer(method, context->gc),
+                        optional_value_create(from.type_erased->self), call, current->is_tail_call, context);
+                    if (result != run_sequence_result_continue)
+                    {
+                        LPG_EXIT(result);
+                    }
+                    current = active.current;
+                    LPG_SAFEPOINT();
+                    LPG_DISPATCH();
+                }
+            }
+            run_sequence_result const result = run_call_method(get_method, call, active.registers, context);
+            if (result != run_sequence_result_continue)
+            {
+                LPG_EXIT(result);
+            }
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_erase_type):
+        {
+            LPG_COUNT_INSTRUCTION();
+            if (!run_erase_type(current->original->erase_type, context->gc, active.registers, *context->all_interfaces))
+            {
+                LPG_EXIT(run_sequence_result_unavailable_at_this_time);
+            }
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_return):
+        {
+            LPG_COUNT_INSTRUCTION();
+            value const returned = active.registers[current->original->return_.returned_value];
+            ASSUME(value_is_valid(returned));
+            active.registers[current->original->return_.unit_goes_into] = value_from_unit();
+            if (frames.count == 0)
+            {
+                *return_value = returned;
+                LPG_EXIT(run_sequence_result_return);
+            }
+            run_sequence_result const result = leave_function(&frames, &active, returned, context);
+            if (result != run_sequence_result_continue)
+            {
+                LPG_EXIT(result);
+            }
+            current = active.current;
+            LPG_SAFEPOINT();
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_instantiate_struct):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_instantiate_struct(current->original->instantiate_struct, context->gc, active.registers);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_new_array):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_new_array(current->original->new_array, context->gc, active.registers);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_current_function):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_current_function(current->original->current_function, active.captures, active.registers, context->gc,
+                                 active.current_function);
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_empty_sequence):
+        {
+            // empty sequences count as one instruction, see run_sequence
+            LPG_COUNT_INSTRUCTION();
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_end_of_function):
+        {
+            if (frames.count > 0)
+            {
+                // missing return instruction
+                abort();
+            }
+            LPG_EXIT(run_sequence_result_continue);
+        }
+
+        LPG_OPCODE(bytecode_opcode_lookup_builtin):
+        {
+            /*the global and the read_struct instruction*/
+            LPG_COUNT_INSTRUCTION();
+            LPG_COUNT_INSTRUCTION();
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_call_builtin):
+        {
+            LPG_COUNT_INSTRUCTION();
+            run_sequence_result const result =
+                run_call_builtin(current->builtin, current->original->call, active.registers, context);
+            if (result != run_sequence_result_continue)
+            {
+                LPG_EXIT(result);
+            }
+            ++current;
+            LPG_DISPATCH();
+        }
+
+        LPG_OPCODE(bytecode_opcode_call_builtin_and_match):
+        {
+            /*the call*/
+            LPG_COUNT_INSTRUCTION();
+            call_instruction const call = current->original->call;
+            bytecode_match const *const compiled = active.code.matches + current->target;
+            match_instruction const match = *compiled->original;
+            builtin_result const computed = compute_global_builtin(current->builtin, call, active.registers, context);
+            if (!computed.is_computed || (compiled->table.kind == match_table_kind_linear))
+            {
+                if (computed.is_computed)
+                {
+                    active.registers[call.result] = builtin_result_to_value(computed, context->gc);
+                }
+                else
+                {
+                    run_sequence_result const result =
+                        run_builtin_call(current->builtin, call, active.registers, context);
+                    if (result != run_sequence_result_continue)
+                    {
+                        LPG_EXIT(result);
+                    }
+                }
+                /*the match*/
+                LPG_COUNT_INSTRUCTION();
+                current = active.code.operations +
+                          compiled->case_targets[select_match_case(match, &compiled->table, active.registers)];
+                LPG_DISPATCH();
+            }
+            /*the match*/
+            LPG_COUNT_INSTRUCTION();
+            size_t const selected =
+                match_table_find(&compiled->table, value_from_enum_element(computed.which, NULL));
+            match_instruction_case const *const selected_case = match.cases + selected;
+            if (selected_case->kind == match_instruction_case_kind_stateful_enum)
+            {
+                active.registers[selected_case->stateful_enum.where] =
+                    computed.has_state ? value_from_small_integer(computed.state) : value_from_unit();
+            }
+            current = active.code.operations + compiled->case_targets[selected];
+            LPG_DISPATCH();
+        }
+    }
+    LPG_UNREACHABLE();
+
+suspend:
+    run->frames = frames;
+    run->active = active;
+    run->current = current;
+    return bytecode_run_suspended;
+
+finished:
+    unwind_frames(frames, &active, context);
+    if (frames.elements)
+    {
+        deallocate(frames.elements);
+    }
+    run->frames.elements = NULL;
+    run->frames.count = 0;
+    run->frames.capacity = 0;
+    return exit_result;
+}
+
+static run_sequence_result run_bytecode(bytecode const code, value *const return_value, value *const registers,
+                                        structure_value const captures, optional_function_id const current_function,
+                                        interpreter *const context)
+{
+    bytecode_run run = bytecode_run_create(code, registers, captures, current_function);
+    int const result = run_bytecode_from(&run, UINT64_MAX, return_value, context);
+    ASSUME(result != bytecode_run_suspended);
+    return (run_sequence_result)result;
+}
+
+#undef LPG_SAFEPOINT
+#undef LPG_COUNT_INSTRUCTION
+#undef LPG_EXIT
+#undef LPG_OPCODE
+#undef LPG_DISPATCH
+#if LPG_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+#undef LPG_COMPUTED_GOTO
+
+static run_sequence_result run_function_body(checked_function const callee, optional_function_id const callee_id,
+                                             value *const return_value, value *const registers,
+                                             structure_value const captures, interpreter *const context)
+{
+    if (!context->compiled_functions)
+    {
+        return run_sequence(callee.body, return_value, registers, captures, callee_id, context);
+    }
+    if (callee_id.is_set)
+    {
+        bytecode const compiled =
+            *bytecode_cache_get(context->compiled_functions, callee_id.value, callee.body, callee.number_of_registers);
+        return run_bytecode(compiled, return_value, registers, captures, callee_id, context);
+    }
+    // functions without an id (like the bodies of modules) are only run once
+    bytecode const code = bytecode_compile(callee.body, callee.number_of_registers);
+    run_sequence_result const result = run_bytecode(code, return_value, registers, captures, callee_id, context);
+    bytecode_free(&code);
+    return result;
+}
+
 external_function_result call_checked_function(checked_function const callee, optional_function_id const callee_id,
                                                value const *const captures, optional_value const self,
                                                value *const arguments, interpreter *const context)
@@ -661,19 +1737,26 @@ external_function_result call_checked_function(checked_function const callee, op
     return call_interpreted_function(callee, callee_id, captures, self, arguments, context);
 }
 
-static external_function_result call_interpreted_function(checked_function const callee,
-                                                          optional_function_id const callee_id,
-                                                          value const *const captures, optional_value const self,
-                                                          value *const arguments, interpreter *const context)
+/*Pushes the registers of the callee with the arguments in them. Returns NULL if the callee cannot be called because
+ * the interpreter is already too deep or out of frame memory.*/
+static value *begin_interpreted_call(checked_function const callee, optional_function_id const callee_id,
+                                     optional_value const self, value *const arguments, interpreter *const context)
 {
     /*there has to be at least one register for the return value, even if it is
      * unit*/
     ASSUME(callee.number_of_registers >= 1);
-    if (*context->current_recursion == context->max_recursion)
+    size_t const needed_frame_memory = frame_memory(callee.number_of_registers);
+    if (!is_frame_memory_available(context, 0, needed_frame_memory))
     {
-        return external_function_result_create_stack_overflow();
+        return NULL;
+    }
+    if (!enter_recursion(context))
+    {
+        return NULL;
     }
-    value *const registers = allocate_array(callee.number_of_registers, sizeof(*registers));
+    charge_frame_memory(context, needed_frame_memory);
+    value *const registers = value_stack_push(context->stack, callee.number_of_registers);
+    memset(registers, 0, sizeof(*registers) * callee.number_of_registers);
     register_id next_register = 0;
     if (callee.signature->self.is_set)
     {
@@ -692,12 +1775,33 @@ static external_function_result call_interpreted_function(checked_function const
         registers[next_register] = arguments[i];
         ++next_register;
     }
-    value return_value = value_create_invalid();
-    *context->current_recursion += 1;
-    run_sequence_result const result =
-        run_sequence(callee.body, &return_value, registers,
-                     structure_value_create(captures, callee.signature->captures.length), callee_id, context);
-    *context->current_recursion -= 1;
+    collect_garbage_if_due(context);
+    if (callee_id.is_set)
+    {
+        profile_call(context, callee_id.value);
+    }
+    return registers;
+}
+
+/*pops what begin_interpreted_call has pushed*/
+static void release_interpreted_call(checked_function const callee, optional_function_id const callee_id,
+                                     interpreter *const context)
+{
+    if (callee_id.is_set)
+    {
+        profile_return(context);
+    }
+    leave_recursion(context);
+    release_frame_memory(context, frame_memory(callee.number_of_registers));
+    value_stack_pop(context->stack, callee.number_of_registers);
+}
+
+static external_function_result finish_interpreted_call(checked_function const callee,
+                                                        optional_function_id const callee_id,
+                                                        run_sequence_result const result, value const return_value,
+                                                        interpreter *const context)
+{
+    release_interpreted_call(callee, callee_id, context);
     switch (result)
     {
     case run_sequence_result_break:
@@ -705,7 +1809,6 @@ static external_function_result call_interpreted_function(checked_function const
 
     case run_sequence_result_continue:
     case run_sequence_result_return:
-        deallocate(registers);
         if (!callee.signature->result.is_set)
         {
             LPG_TO_DO();
@@ -719,33 +1822,116 @@ static external_function_result call_interpreted_function(checked_function const
         return external_function_result_from_success(return_value);
 
     case run_sequence_result_unavailable_at_this_time:
-        deallocate(registers);
         return external_function_result_create_unavailable();
 
     case run_sequence_result_out_of_memory:
-        deallocate(registers);
         return external_function_result_create_out_of_memory();
 
     case run_sequence_result_stack_overflow:
-        deallocate(registers);
         return external_function_result_create_stack_overflow();
 
     case run_sequence_result_instruction_limit_reached:
-        deallocate(registers);
         return external_function_result_create_instruction_limit_reached();
+
+    case run_sequence_result_deadline_reached:
+        return external_function_result_create_deadline_reached();
     }
     LPG_UNREACHABLE();
 }
 
-void interpret(checked_program const program, value const *globals, garbage_collector *const gc)
+static external_function_result call_interpreted_function(checked_function const callee,
+                                                          optional_function_id const callee_id,
+                                                          value const *const captures, optional_value const self,
+                                                          value *const arguments, interpreter *const context)
+{
+    value *const registers = begin_interpreted_call(callee, callee_id, self, arguments, context);
+    if (!registers)
+    {
+        return external_function_result_create_stack_overflow();
+    }
+    value return_value = value_create_invalid();
+    run_sequence_result const result =
+        run_function_body(callee, callee_id, &return_value, registers,
+                          structure_value_create(captures, callee.signature->captures.length), context);
+    return finish_interpreted_call(callee, callee_id, result, return_value, context);
+}
+
+struct resumable_call
+{
+    checked_function callee;
+    function_id callee_id;
+    bytecode_run run;
+    value return_value;
+    bool is_finished;
+};
+
+resumable_call *resumable_call_create(function_id const callee_id, value const *const captures,
+                                      optional_value const self, value *const arguments, interpreter *const context)
+{
+    ASSUME(context->compiled_functions);
+    checked_function const callee = (*context->all_functions)[callee_id];
+    optional_function_id const id = optional_function_id_create(callee_id);
+    value *const registers = begin_interpreted_call(callee, id, self, arguments, context);
+    if (!registers)
+    {
+        return NULL;
+    }
+    resumable_call *const result = allocate(sizeof(*result));
+    result->callee = callee;
+    result->callee_id = callee_id;
+    result->run = bytecode_run_create(
+        *bytecode_cache_get(context->compiled_functions, callee_id, callee.body, callee.number_of_registers), registers,
+        structure_value_create(captures, callee.signature->captures.length), id);
+    result->return_value = value_create_invalid();
+    result->is_finished = false;
+    return result;
+}
+
+bool resumable_call_run(resumable_call *const call, uint64_t const slice, interpreter *const context,
+                        external_function_result *const result)
+{
+    ASSUME(!call->is_finished);
+    ASSUME(slice > 0);
+    uint64_t const executed = context->usage->executed_instructions;
+    uint64_t const suspend_at = ((slice < (UINT64_MAX - executed)) ? (executed + slice) : UINT64_MAX);
+    int const exit_code = run_bytecode_from(&call->run, suspend_at, &call->return_value, context);
+    if (exit_code == bytecode_run_suspended)
+    {
+        return false;
+    }
+    call->is_finished = true;
+    *result = finish_interpreted_call(call->callee, optional_function_id_create(call->callee_id),
+                                      (run_sequence_result)exit_code, call->return_value, context);
+    return true;
+}
+
+void resumable_call_free(resumable_call *const freed, interpreter *const context)
+{
+    if (!freed->is_finished)
+    {
+        unwind_frames(freed->run.frames, &freed->run.active, context);
+        if (freed->run.frames.elements)
+        {
+            deallocate(freed->run.frames.elements);
+        }
+        release_interpreted_call(freed->callee, optional_function_id_create(freed->callee_id), context);
+    }
+    deallocate(freed);
+}
+
+external_function_result interpret(checked_program const program, value const *globals, garbage_collector *const gc,
+                                   execution_budget const budget, execution_usage *const usage, profile *const recorder)
 {
     function_id const entry_point_id = 0;
-    size_t current_recursion = 0;
-    size_t const max_recursion = 200;
-    uint64_t const max_executed_instructions = 10000;
-    uint64_t executed_instructions = 0;
-    interpreter context = interpreter_create(globals, gc, &program.functions, &program.interfaces, max_recursion,
-                                             &current_recursion, max_executed_instructions, &executed_instructions);
-    call_interpreted_function(program.functions[entry_point_id], optional_function_id_create(entry_point_id), NULL,
-                              optional_value_empty, NULL, &context);
+    value_stack stack = value_stack_create();
+    bytecode_cache compiled_functions = bytecode_cache_create();
+    interpreter context = interpreter_create(
+        globals, gc, &stack, &compiled_functions, &program.functions, &program.interfaces, budget, usage);
+    context.recorder = recorder;
+    external_function_result const result =
+        call_interpreted_function(program.functions[entry_point_id], optional_function_id_create(entry_point_id),
+                                  NULL, optional_value_empty, NULL, &context);
+    bytecode_cache_free(compiled_functions);
+    value_stack_free(stack);
+    return result;
 }
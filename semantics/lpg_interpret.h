@@ -1,24 +1,80 @@
 #pragma once
+#include "lpg_bytecode.h"
 #include "lpg_checked_program.h"
+#include "lpg_monotonic_clock.h"
 #include "lpg_optional_function_id.h"
+#include "lpg_profile.h"
 #include "lpg_value.h"
+#include "lpg_value_stack.h"
+
+/*limits the resources that a program may use while it is being interpreted*/
+typedef struct execution_budget
+{
+    uint64_t max_executed_instructions;
+    /*limits how deeply the interpreter itself recurses on the C stack. The bytecode interpreter only recurses for calls
+     * that go through external functions, the tree walker recurses for every call.*/
+    size_t max_recursion;
+    /*limits the memory used for the registers and the bookkeeping of the functions that are being executed*/
+    size_t max_frame_memory;
+    /*The heap is owned by the garbage_collector, so this is only a hint for the code that creates it.*/
+    size_t max_heap_size;
+    /*execution stops after running for this long, unless it is execution_budget_no_deadline*/
+    duration max_duration;
+} execution_budget;
+
+static uint64_t const execution_budget_no_deadline = UINT64_MAX;
+
+/*a budget for the frames of the interpreter that allows for deep recursion without being unbounded*/
+static size_t const interpreter_default_max_frame_memory = (64 * 1024 * 1024);
+
+execution_budget execution_budget_create(uint64_t max_executed_instructions, size_t max_recursion,
+                                         size_t max_frame_memory, size_t max_heap_size,
+                                         duration max_duration) LPG_USE_RESULT;
+
+/*how much of its execution_budget an interpreter has used so far*/
+typedef struct execution_usage
+{
+    uint64_t executed_instructions;
+    size_t current_recursion;
+    size_t peak_recursion;
+    size_t used_frame_memory;
+    size_t peak_frame_memory;
+    /*calls that the type checker could have answered from its cache of compile time call results*/
+    uint64_t memoizable_calls;
+    /*the part of memoizable_calls that the cache actually answered*/
+    uint64_t memoized_calls;
+} execution_usage;
+
+execution_usage execution_usage_create(void) LPG_USE_RESULT;
 
 typedef struct interpreter
 {
     value const *globals;
     garbage_collector *const gc;
+    value_stack *const stack;
+    /*NULL selects the tree walking interpreter which serves as a reference for the bytecode interpreter*/
+    bytecode_cache *const compiled_functions;
     checked_function *const *all_functions;
     lpg_interface *const *all_interfaces;
-    size_t max_recursion;
-    size_t *current_recursion;
-    uint64_t max_executed_instructions;
-    uint64_t *executed_instructions;
+    execution_budget budget;
+    /*the value of read_monotonic_clock at which execution stops*/
+    duration deadline;
+    /*Reading the clock is too expensive to do for every instruction, so the deadline and the instruction limit are only
+     * checked when the number of executed instructions reaches this value.*/
+    uint64_t next_budget_check;
+    execution_usage *usage;
+    /*NULL unless the program is being profiled*/
+    profile *recorder;
 } interpreter;
 
-interpreter interpreter_create(value const *globals, garbage_collector *const gc,
-                               checked_function *const *const all_functions, lpg_interface *const *const all_interfaces,
-                               size_t max_recursion, size_t *current_recursion, uint64_t max_executed_instructions,
-                               uint64_t *executed_instructions) LPG_USE_RESULT;
+interpreter interpreter_create(value const *globals, garbage_collector *const gc, value_stack *const stack,
+                               bytecode_cache *const compiled_functions, checked_function *const *const all_functions,
+                               lpg_interface *const *const all_interfaces, execution_budget const budget,
+                               LPG_NON_NULL(execution_usage *const usage)) LPG_USE_RESULT;
+
+/*Lets an interpreter that is used again start over with its whole budget. The instructions, recursion and frame memory
+ * are counted in the new usage and the deadline is measured from now.*/
+void interpreter_renew_budget(LPG_NON_NULL(interpreter *const renewed), LPG_NON_NULL(execution_usage *const usage));
 
 external_function_result call_function(function_pointer_value const callee, optional_value const self,
                                        value *const arguments, interpreter *const context);
@@ -27,4 +83,29 @@ external_function_result call_checked_function(checked_function const callee, op
                                                value const *const captures, optional_value const self,
                                                value *const arguments, interpreter *const context);
 
-void interpret(checked_program const program, value const *globals, LPG_NON_NULL(garbage_collector *const gc));
+/*A call of an interpreted function that runs in slices. Its frames are kept on the heap and on the value stack of the
+ * interpreter instead of the C stack, so it can be suspended after any number of instructions and resumed later. The
+ * value stack must not be used for anything else while the call is unfinished. Only the bytecode interpreter can do
+ * this.*/
+typedef struct resumable_call resumable_call;
+
+/*Returns NULL if the interpreter has no frame memory or recursion left for the call. The captures have to outlive the
+ * call.*/
+resumable_call *resumable_call_create(function_id const callee_id, value const *const captures,
+                                      optional_value const self, value *const arguments,
+                                      LPG_NON_NULL(interpreter *const context)) LPG_USE_RESULT;
+
+/*Runs the call until it finishes or until it reaches a safepoint after slice instructions. Safepoints are where a
+ * function is entered or left and where a loop continues, so a slice can be exceeded by the instructions between two
+ * of them. Returns true and sets the result when the call has finished. Budget violations finish the call as well.*/
+bool resumable_call_run(LPG_NON_NULL(resumable_call *const call), uint64_t const slice,
+                        LPG_NON_NULL(interpreter *const context),
+                        LPG_NON_NULL(external_function_result *const result)) LPG_USE_RESULT;
+
+/*releases the frames of an unfinished call as well*/
+void resumable_call_free(LPG_NON_NULL(resumable_call *const freed), LPG_NON_NULL(interpreter *const context));
+
+/*runs the entry point of the program. The budget limits the whole run and the usage is reported even if it fails.*/
+external_function_result interpret(checked_program const program, value const *globals,
+                                   LPG_NON_NULL(garbage_collector *const gc), execution_budget const budget,
+                                   LPG_NON_NULL(execution_usage *const usage), profile *const recorder);
@@ -0,0 +1,282 @@
+#include "lpg_match_table.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include <stdlib.h>
+
+enum
+{
+    /*a dense table may have this many entries per case before a sorted table is used instead*/
+    max_dense_entries_per_case = 4
+};
+
+static match_table match_table_create_linear(void)
+{
+    match_table const result = {
+        match_table_kind_linear, match_key_kind_integer, NULL, 0, NULL, 0, 0, NULL, 0, match_table_no_case};
+    return result;
+}
+
+static literal_instruction const *find_literal(register_id const into, instruction const *const preceding,
+                                               size_t const preceding_count)
+{
+    for (size_t i = preceding_count; i > 0; --i)
+    {
+        instruction const *const candidate = preceding + (i - 1);
+        if ((candidate->type == instruction_literal) && (candidate->literal.into == into))
+        {
+            return &candidate->literal;
+        }
+    }
+    return NULL;
+}
+
+static bool find_case_key(match_instruction_case const *const from, instruction const *const preceding,
+                          size_t const preceding_count, match_key_kind *const key_kind, uint64_t *const key)
+{
+    switch (from->kind)
+    {
+    case match_instruction_case_kind_stateful_enum:
+        *key_kind = match_key_kind_enum_element;
+        *key = from->stateful_enum.element;
+        return true;
+
+    case match_instruction_case_kind_value:
+    {
+        literal_instruction const *const literal = find_literal(from->key_value, preceding, preceding_count);
+        if (!literal)
+        {
+            return false;
+        }
+        switch (literal->value_.kind)
+        {
+        case value_kind_integer:
+            if (literal->value_.is_big)
+            {
+                return false;
+            }
+            *key_kind = match_key_kind_integer;
+            *key = literal->value_.small_integer;
+            return true;
+
+        case value_kind_enum_element:
+            if (literal->value_.enum_state)
+            {
+                return false;
+            }
+            *key_kind = match_key_kind_enum_element;
+            *key = literal->value_.which;
+            return true;
+
+        case value_kind_string:
+        case value_kind_function_pointer:
+        case value_kind_structure:
+        case value_kind_type:
+        case value_kind_unit:
+        case value_kind_tuple:
+        case value_kind_enum_constructor:
+        case value_kind_type_erased:
+        case value_kind_pattern:
+        case value_kind_generic_enum:
+        case value_kind_generic_interface:
+        case value_kind_generic_struct:
+        case value_kind_generic_lambda:
+        case value_kind_array:
+            return false;
+        }
+        LPG_UNREACHABLE();
+    }
+
+    case match_instruction_case_kind_default:
+        LPG_UNREACHABLE();
+    }
+    LPG_UNREACHABLE();
+}
+
+static int compare_entries(void const *const left, void const *const right)
+{
+    match_table_entry const *const left_entry = left;
+    match_table_entry const *const right_entry = right;
+    if (left_entry->key < right_entry->key)
+    {
+        return -1;
+    }
+    if (left_entry->key > right_entry->key)
+    {
+        return 1;
+    }
+    /*the first case with a key wins like in a linear scan*/
+    if (left_entry->case_index < right_entry->case_index)
+    {
+        return -1;
+    }
+    if (left_entry->case_index > right_entry->case_index)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+match_table match_table_create(match_instruction const match, instruction const *const preceding,
+                               size_t const preceding_count)
+{
+    match_table result = match_table_create_linear();
+    result.case_keys = allocate_array(match.count, sizeof(*result.case_keys));
+    result.case_count = match.count;
+    match_table_entry *const entries = allocate_array(match.count, sizeof(*entries));
+    size_t entry_count = 0;
+    bool has_key_kind = false;
+    for (size_t i = 0; i < match.count; ++i)
+    {
+        match_instruction_case const *const this_case = match.cases + i;
+        result.case_keys[i] = 0;
+        if (this_case->kind == match_instruction_case_kind_default)
+        {
+            result.default_case = i;
+            continue;
+        }
+        match_key_kind key_kind;
+        uint64_t key;
+        if (!find_case_key(this_case, preceding, preceding_count, &key_kind, &key) ||
+            (has_key_kind && (key_kind != result.key_kind)))
+        {
+            deallocate(entries);
+            match_table_free(result);
+            return match_table_create_linear();
+        }
+        has_key_kind = true;
+        result.key_kind = key_kind;
+        result.case_keys[i] = key;
+        entries[entry_count].key = key;
+        entries[entry_count].case_index = i;
+        ++entry_count;
+    }
+    if (entry_count == 0)
+    {
+        deallocate(entries);
+        match_table_free(result);
+        return match_table_create_linear();
+    }
+    qsort(entries, entry_count, sizeof(*entries), compare_entries);
+    size_t unique_count = 0;
+    for (size_t i = 0; i < entry_count; ++i)
+    {
+        if ((unique_count > 0) && (entries[unique_count - 1].key == entries[i].key))
+        {
+            continue;
+        }
+        entries[unique_count] = entries[i];
+        ++unique_count;
+    }
+    uint64_t const span = (entries[unique_count - 1].key - entries[0].key);
+    if (span < (uint64_t)(unique_count * max_dense_entries_per_case))
+    {
+        result.kind = match_table_kind_dense;
+        result.minimum_key = entries[0].key;
+        result.dense_length = (size_t)span + 1;
+        result.case_by_key = allocate_array(result.dense_length, sizeof(*result.case_by_key));
+        for (size_t i = 0; i < result.dense_length; ++i)
+        {
+            result.case_by_key[i] = match_table_no_case;
+        }
+        for (size_t i = 0; i < unique_count; ++i)
+        {
+            result.case_by_key[entries[i].key - result.minimum_key] = entries[i].case_index;
+        }
+        deallocate(entries);
+        return result;
+    }
+    result.kind = match_table_kind_sparse;
+    result.sorted_keys = entries;
+    result.sorted_key_count = unique_count;
+    return result;
+}
+
+void match_table_free(match_table const freed)
+{
+    if (freed.case_keys)
+    {
+        deallocate(freed.case_keys);
+    }
+    if (freed.case_by_key)
+    {
+        deallocate(freed.case_by_key);
+    }
+    if (freed.sorted_keys)
+    {
+        deallocate(freed.sorted_keys);
+    }
+}
+
+static size_t find_key(match_table const *const table, uint64_t const key)
+{
+    switch (table->kind)
+    {
+    case match_table_kind_linear:
+        LPG_UNREACHABLE();
+
+    case match_table_kind_dense:
+    {
+        if (key < table->minimum_key)
+        {
+            return match_table_no_case;
+        }
+        uint64_t const index = (key - table->minimum_key);
+        if (index >= table->dense_length)
+        {
+            return match_table_no_case;
+        }
+        return table->case_by_key[index];
+    }
+
+    case match_table_kind_sparse:
+    {
+        size_t begin = 0;
+        size_t end = table->sorted_key_count;
+        while (begin < end)
+        {
+            size_t const middle = (begin + ((end - begin) / 2));
+            match_table_entry const entry = table->sorted_keys[middle];
+            if (entry.key == key)
+            {
+                return entry.case_index;
+            }
+            if (entry.key < key)
+            {
+                begin = (middle + 1);
+            }
+            else
+            {
+                end = middle;
+            }
+        }
+        return match_table_no_case;
+    }
+    }
+    LPG_UNREACHABLE();
+}
+
+size_t match_table_find(match_table const *const table, value const key)
+{
+    size_t found = match_table_no_case;
+    switch (table->key_kind)
+    {
+    case match_key_kind_integer:
+        ASSUME(key.kind == value_kind_integer);
+        if (!key.is_big)
+        {
+            found = find_key(table, key.small_integer);
+        }
+        break;
+
+    case match_key_kind_enum_element:
+        ASSUME(key.kind == value_kind_enum_element);
+        found = find_key(table, key.which);
+        break;
+    }
+    if (found == match_table_no_case)
+    {
+        ASSUME(table->default_case != match_table_no_case);
+        return table->default_case;
+    }
+    return found;
+}
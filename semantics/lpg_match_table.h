@@ -0,0 +1,53 @@
+#pragma once
+#include "lpg_instruction.h"
+#include "lpg_use_result.h"
+
+typedef enum match_table_kind {
+    /*the cases have to be compared one after another*/
+    match_table_kind_linear = 1,
+    /*case_by_key is indexed by the key minus minimum_key*/
+    match_table_kind_dense,
+    /*sorted_keys can be searched with a binary search*/
+    match_table_kind_sparse
+} match_table_kind;
+
+typedef enum match_key_kind {
+    match_key_kind_integer = 1,
+    match_key_kind_enum_element
+} match_key_kind;
+
+typedef struct match_table_entry
+{
+    uint64_t key;
+    size_t case_index;
+} match_table_entry;
+
+/*Describes how the case of a match instruction can be selected without comparing the key to every case. A table can
+ * be built if the keys of all cases are integers or enum elements that are known before the match is executed.*/
+typedef struct match_table
+{
+    match_table_kind kind;
+    match_key_kind key_kind;
+    /*the key of every case that is not the default case*/
+    uint64_t *case_keys;
+    size_t case_count;
+    /*match_table_no_case for keys that do not belong to any case*/
+    size_t *case_by_key;
+    uint64_t minimum_key;
+    size_t dense_length;
+    match_table_entry *sorted_keys;
+    size_t sorted_key_count;
+    /*match_table_no_case if there is no default case*/
+    size_t default_case;
+} match_table;
+
+static size_t const match_table_no_case = ~(size_t)0;
+
+/*preceding are the instructions in front of the match in the same sequence. The literals that define the keys of the
+ * cases are found there.*/
+match_table match_table_create(match_instruction const match, instruction const *const preceding,
+                               size_t const preceding_count) LPG_USE_RESULT;
+void match_table_free(match_table const freed);
+
+/*returns the index of the case for the key, or the default case. The table must not be linear.*/
+size_t match_table_find(LPG_NON_NULL(match_table const *const table), value const key) LPG_USE_RESULT;
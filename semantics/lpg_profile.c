@@ -0,0 +1,453 @@
+#include "lpg_profile.h"
+#include "lpg_assert.h"
+#include "lpg_for.h"
+#include "lpg_instruction.h"
+
+enum
+{
+    root_node = 0
+};
+
+static size_t const no_node = SIZE_MAX;
+
+static profile_node profile_node_create(function_id const function, size_t const parent)
+{
+    profile_node const result = {function, parent, no_node, no_node, 0, 0};
+    return result;
+}
+
+profile profile_create(function_id const function_count)
+{
+    profile result = {allocate_array(function_count, sizeof(*result.functions)),
+                      function_count,
+                      allocate_array(1, sizeof(*result.nodes)),
+                      1,
+                      1,
+                      NULL,
+                      0,
+                      0};
+    LPG_FOR(function_id, i, function_count)
+    {
+        profile_function const empty = {0, 0, 0, 0, 0, NULL, 0, 0};
+        result.functions[i] = empty;
+    }
+    result.nodes[root_node] = profile_node_create(0, no_node);
+    return result;
+}
+
+void profile_free(profile const freed)
+{
+    LPG_FOR(function_id, i, freed.function_count)
+    {
+        if (freed.functions[i].site_executions)
+        {
+            deallocate(freed.functions[i].site_executions);
+        }
+    }
+    if (freed.functions)
+    {
+        deallocate(freed.functions);
+    }
+    deallocate(freed.nodes);
+    if (freed.frames)
+    {
+        deallocate(freed.frames);
+    }
+}
+
+static size_t find_or_add_child(profile *const recorder, size_t const parent, function_id const function)
+{
+    for (size_t child = recorder->nodes[parent].first_child; child != no_node;
+         child = recorder->nodes[child].next_sibling)
+    {
+        if (recorder->nodes[child].function == function)
+        {
+            return child;
+        }
+    }
+    recorder->nodes = reallocate_array_exponentially(recorder->nodes, (recorder->node_count + 1),
+                                                     sizeof(*recorder->nodes), recorder->node_count,
+                                                     &recorder->node_capacity);
+    size_t const added = recorder->node_count;
+    ++(recorder->node_count);
+    recorder->nodes[added] = profile_node_create(function, parent);
+    recorder->nodes[added].next_sibling = recorder->nodes[parent].first_child;
+    recorder->nodes[parent].first_child = added;
+    return added;
+}
+
+void profile_enter(profile *const recorder, function_id const entered, uint64_t const executed_instructions,
+                   uint64_t const allocated_bytes)
+{
+    ASSUME(entered < recorder->function_count);
+    size_t const parent = (recorder->frame_count > 0) ? recorder->frames[recorder->frame_count - 1].node : root_node;
+    size_t const node = find_or_add_child(recorder, parent, entered);
+    recorder->nodes[node].calls += 1;
+    profile_function *const function = &recorder->functions[entered];
+    function->calls += 1;
+    function->active_calls += 1;
+    recorder->frames = reallocate_array_exponentially(recorder->frames, (recorder->frame_count + 1),
+                                                      sizeof(*recorder->frames), recorder->frame_count,
+                                                      &recorder->frame_capacity);
+    profile_frame const frame = {node, executed_instructions, allocated_bytes, 0, 0};
+    recorder->frames[recorder->frame_count] = frame;
+    ++(recorder->frame_count);
+}
+
+void profile_leave(profile *const recorder, uint64_t const executed_instructions, uint64_t const allocated_bytes)
+{
+    ASSUME(recorder->frame_count > 0);
+    --(recorder->frame_count);
+    profile_frame const left = recorder->frames[recorder->frame_count];
+    ASSUME(executed_instructions >= left.instructions_at_entry);
+    ASSUME(allocated_bytes >= left.allocated_bytes_at_entry);
+    uint64_t const inclusive_instructions = (executed_instructions - left.instructions_at_entry);
+    uint64_t const inclusive_allocated_bytes = (allocated_bytes - left.allocated_bytes_at_entry);
+    uint64_t const exclusive_instructions = (inclusive_instructions - left.callee_instructions);
+    profile_node *const node = &recorder->nodes[left.node];
+    node->exclusive_instructions += exclusive_instructions;
+    profile_function *const function = &recorder->functions[node->function];
+    function->exclusive_instructions += exclusive_instructions;
+    function->exclusive_allocated_bytes += (inclusive_allocated_bytes - left.callee_allocated_bytes);
+    ASSUME(function->active_calls > 0);
+    function->active_calls -= 1;
+    if (function->active_calls == 0)
+    {
+        function->inclusive_instructions += inclusive_instructions;
+        function->inclusive_allocated_bytes += inclusive_allocated_bytes;
+    }
+    if (recorder->frame_count > 0)
+    {
+        profile_frame *const caller = &recorder->frames[recorder->frame_count - 1];
+        caller->callee_instructions += inclusive_instructions;
+        caller->callee_allocated_bytes += inclusive_allocated_bytes;
+    }
+}
+
+static void name_function(unicode_string *const names, function_id const named, checked_function const *const owner,
+                          register_id const where)
+{
+    if (names[named].length > 0)
+    {
+        return;
+    }
+    ASSUME(where < owner->number_of_registers);
+    unicode_string const *const debug_name = &owner->register_debug_names[where];
+    if (debug_name->length == 0)
+    {
+        return;
+    }
+    unicode_string_free(names + named);
+    names[named] = unicode_view_copy(unicode_view_from_string(*debug_name));
+}
+
+static void name_functions_in_sequence(unicode_string *const names, checked_function const *const owner,
+                                       instruction_sequence const sequence)
+{
+    LPG_FOR(size_t, i, sequence.length)
+    {
+        instruction const element = sequence.elements[i];
+        switch (element.type)
+        {
+        case instruction_literal:
+            if ((element.literal.value_.kind == value_kind_function_pointer) &&
+                !value_function_is_external(element.literal.value_))
+            {
+                name_function(names, value_function_code(element.literal.value_), owner, element.literal.into);
+            }
+            break;
+
+        case instruction_lambda_with_captures:
+            name_function(names, element.lambda_with_captures.lambda, owner, element.lambda_with_captures.into);
+            break;
+
+        case instruction_loop:
+            name_functions_in_sequence(names, owner, element.loop.body);
+            break;
+
+        case instruction_match:
+            LPG_FOR(size_t, j, element.match.count)
+            {
+                name_functions_in_sequence(names, owner, element.match.cases[j].action);
+            }
+            break;
+
+        case instruction_call:
+        case instruction_global:
+        case instruction_read_struct:
+        case instruction_break:
+        case instruction_tuple:
+        case instruction_enum_construct:
+        case instruction_get_captures:
+        case instruction_get_method:
+        case instruction_erase_type:
+        case instruction_return:
+        case instruction_instantiate_struct:
+        case instruction_new_array:
+        case instruction_current_function:
+            break;
+        }
+    }
+}
+
+profile_symbols profile_symbols_create(checked_program const program)
+{
+    profile_symbols const result = {allocate_array(program.function_count, sizeof(*result.names)),
+                                    allocate_array(program.function_count, sizeof(*result.files)),
+                                    allocate_array(program.function_count, sizeof(*result.lines)),
+                                    program.function_count};
+    LPG_FOR(function_id, i, program.function_count)
+    {
+        result.names[i] = unicode_string_from_c_str("");
+        result.files[i] = unicode_view_copy(unicode_view_from_string(program.functions[i].definition_file));
+        result.lines[i] = program.functions[i].definition_line;
+    }
+    if (program.function_count > 0)
+    {
+        unicode_string_free(result.names);
+        result.names[0] = unicode_string_from_c_str("main");
+    }
+    LPG_FOR(function_id, i, program.function_count)
+    {
+        name_functions_in_sequence(result.names, &program.functions[i], program.functions[i].body);
+    }
+    LPG_FOR(interface_id, i, program.interface_count)
+    {
+        lpg_interface const *const interface_ = &program.interfaces[i];
+        LPG_FOR(size_t, j, interface_->implementation_count)
+        {
+            implementation const *const impl = &interface_->implementations[j].target;
+            LPG_FOR(size_t, k, impl->method_count)
+            {
+                function_id const method = impl->methods[k].code;
+                if (!impl->methods[k].external && (result.names[method].length == 0))
+                {
+                    unicode_string_free(result.names + method);
+                    result.names[method] = unicode_view_copy(unicode_view_from_string(interface_->methods[k].name));
+                }
+            }
+        }
+    }
+    LPG_FOR(function_id, i, program.function_count)
+    {
+        if (result.names[i].length == 0)
+        {
+            char buffer[64];
+            unicode_view const id = integer_format(integer_create(0, i), lower_case_digits, 10, buffer, sizeof(buffer));
+            unicode_string_free(result.names + i);
+            result.names[i] = unicode_view_concat(unicode_view_from_c_str("lambda_"), id);
+        }
+    }
+    return result;
+}
+
+void profile_symbols_free(profile_symbols const freed)
+{
+    LPG_FOR(function_id, i, freed.count)
+    {
+        unicode_string_free(freed.names + i);
+        unicode_string_free(freed.files + i);
+    }
+    if (freed.names)
+    {
+        deallocate(freed.names);
+    }
+    if (freed.files)
+    {
+        deallocate(freed.files);
+    }
+    if (freed.lines)
+    {
+        deallocate(freed.lines);
+    }
+}
+
+static success_indicator write_number(stream_writer const destination, uint64_t const number)
+{
+    return stream_writer_write_integer(destination, integer_create(0, number));
+}
+
+static success_indicator write_stack(profile const recorded, profile_symbols const symbols, size_t const node,
+                                     stream_writer const destination)
+{
+    size_t const parent = recorded.nodes[node].parent;
+    if (parent != root_node)
+    {
+        LPG_TRY(write_stack(recorded, symbols, parent, destination));
+        LPG_TRY(stream_writer_write_string(destination, ";"));
+    }
+    return stream_writer_write_unicode_view(
+        destination, unicode_view_from_string(symbols.names[recorded.nodes[node].function]));
+}
+
+success_indicator profile_write_folded(profile const recorded, profile_symbols const symbols,
+                                       stream_writer const destination)
+{
+    ASSUME(symbols.count == recorded.function_count);
+    for (size_t i = (root_node + 1); i < recorded.node_count; ++i)
+    {
+        if (recorded.nodes[i].exclusive_instructions == 0)
+        {
+            continue;
+        }
+        LPG_TRY(write_stack(recorded, symbols, i, destination));
+        LPG_TRY(stream_writer_write_string(destination, " "));
+        LPG_TRY(write_number(destination, recorded.nodes[i].exclusive_instructions));
+        LPG_TRY(stream_writer_write_string(destination, "\n"));
+    }
+    return success_yes;
+}
+
+static success_indicator write_json_field(stream_writer const destination, char const *const name,
+                                          uint64_t const number)
+{
+    LPG_TRY(stream_writer_write_string(destination, ", \""));
+    LPG_TRY(stream_writer_write_string(destination, name));
+    LPG_TRY(stream_writer_write_string(destination, "\": "));
+    return write_number(destination, number);
+}
+
+/*file names are the only strings in the profile which can contain quotes or backslashes*/
+static success_indicator write_json_string(stream_writer const destination, unicode_view const content)
+{
+    LPG_TRY(stream_writer_write_string(destination, "\""));
+    size_t written = 0;
+    LPG_FOR(size_t, i, content.length)
+    {
+        char const c = content.begin[i];
+        if ((c != '"') && (c != '\\'))
+        {
+            continue;
+        }
+        LPG_TRY(stream_writer_write_unicode_view(destination, unicode_view_cut(content, written, i)));
+        LPG_TRY(stream_writer_write_string(destination, "\\"));
+        written = i;
+    }
+    LPG_TRY(stream_writer_write_unicode_view(destination, unicode_view_cut(content, written, content.length)));
+    return stream_writer_write_string(destination, "\"");
+}
+
+static success_indicator write_json_function(profile const recorded, profile_symbols const symbols,
+                                             function_id const id, stream_writer const destination)
+{
+    profile_function const function = recorded.functions[id];
+    LPG_TRY(stream_writer_write_string(destination, "{\"id\": "));
+    LPG_TRY(write_number(destination, id));
+    LPG_TRY(stream_writer_write_string(destination, ", \"name\": \""));
+    LPG_TRY(stream_writer_write_unicode_view(destination, unicode_view_from_string(symbols.names[id])));
+    LPG_TRY(stream_writer_write_string(destination, "\", \"file\": "));
+    if (symbols.files[id].length == 0)
+    {
+        LPG_TRY(stream_writer_write_string(destination, "null"));
+    }
+    else
+    {
+        LPG_TRY(write_json_string(destination, unicode_view_from_string(symbols.files[id])));
+    }
+    LPG_TRY(stream_writer_write_string(destination, ", \"line\": "));
+    if (symbols.lines[id] == 0)
+    {
+        LPG_TRY(stream_writer_write_string(destination, "null"));
+    }
+    else
+    {
+        LPG_TRY(write_number(destination, symbols.lines[id]));
+    }
+    LPG_TRY(write_json_field(destination, "calls", function.calls));
+    LPG_TRY(write_json_field(destination, "inclusive_instructions", function.inclusive_instructions));
+    LPG_TRY(write_json_field(destination, "exclusive_instructions", function.exclusive_instructions));
+    LPG_TRY(write_json_field(destination, "inclusive_allocated_bytes", function.inclusive_allocated_bytes));
+    LPG_TRY(write_json_field(destination, "exclusive_allocated_bytes", function.exclusive_allocated_bytes));
+    LPG_TRY(stream_writer_write_string(destination, ", \"sites\": ["));
+    bool is_first = true;
+    LPG_FOR(size_t, i, function.site_count)
+    {
+        if (function.site_executions[i] == 0)
+        {
+            continue;
+        }
+        LPG_TRY(stream_writer_write_string(destination, is_first ? "{\"operation\": " : ", {\"operation\": "));
+        is_first = false;
+        LPG_TRY(write_number(destination, i));
+        LPG_TRY(write_json_field(destination, "executions", function.site_executions[i]));
+        LPG_TRY(stream_writer_write_string(destination, "}"));
+    }
+    return stream_writer_write_string(destination, "]}");
+}
+
+typedef struct call_edge
+{
+    function_id caller;
+    function_id callee;
+    uint64_t calls;
+} call_edge;
+
+static success_indicator write_json_calls(profile const recorded, stream_writer const destination)
+{
+    call_edge *edges = NULL;
+    size_t edge_count = 0;
+    size_t edge_capacity = 0;
+    for (size_t i = (root_node + 1); i < recorded.node_count; ++i)
+    {
+        profile_node const node = recorded.nodes[i];
+        if (node.parent == root_node)
+        {
+            continue;
+        }
+        function_id const caller = recorded.nodes[node.parent].function;
+        size_t found = 0;
+        while ((found < edge_count) && ((edges[found].caller != caller) || (edges[found].callee != node.function)))
+        {
+            ++found;
+        }
+        if (found == edge_count)
+        {
+            edges = reallocate_array_exponentially(
+                edges, (edge_count + 1), sizeof(*edges), edge_count, &edge_capacity);
+            call_edge const added = {caller, node.function, 0};
+            edges[edge_count] = added;
+            ++edge_count;
+        }
+        edges[found].calls += node.calls;
+    }
+    success_indicator result = success_yes;
+    LPG_FOR(size_t, i, edge_count)
+    {
+        LPG_TRY_GOTO(stream_writer_write_string(destination, (i == 0) ? "\n    {\"caller\": " : ",\n    {\"caller\": "),
+                     fail);
+        LPG_TRY_GOTO(write_number(destination, edges[i].caller), fail);
+        LPG_TRY_GOTO(write_json_field(destination, "callee", edges[i].callee), fail);
+        LPG_TRY_GOTO(write_json_field(destination, "calls", edges[i].calls), fail);
+        LPG_TRY_GOTO(stream_writer_write_string(destination, "}"), fail);
+    }
+    goto finish;
+fail:
+    result = success_no;
+finish:
+    if (edges)
+    {
+        deallocate(edges);
+    }
+    return result;
+}
+
+success_indicator profile_write_json(profile const recorded, profile_symbols const symbols,
+                                     stream_writer const destination)
+{
+    ASSUME(symbols.count == recorded.function_count);
+    LPG_TRY(stream_writer_write_string(destination, "{\n  \"functions\": ["));
+    bool is_first = true;
+    LPG_FOR(function_id, i, recorded.function_count)
+    {
+        if (recorded.functions[i].calls == 0)
+        {
+            continue;
+        }
+        LPG_TRY(stream_writer_write_string(destination, is_first ? "\n    " : ",\n    "));
+        is_first = false;
+        LPG_TRY(write_json_function(recorded, symbols, i, destination));
+    }
+    LPG_TRY(stream_writer_write_string(destination, "\n  ],\n  \"calls\": ["));
+    LPG_TRY(write_json_calls(recorded, destination));
+    return stream_writer_write_string(destination, "\n  ]\n}\n");
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "lpg_allocate.h"
+#include "lpg_checked_program.h"
+#include "lpg_function_id.h"
+#include "lpg_source_location.h"
+#include "lpg_stream_writer.h"
+#include <string.h>
+
+/*what the profile knows about one function over the whole run*/
+typedef struct profile_function
+{
+    uint64_t calls;
+    /*instructions executed by the function and by everything it called. A recursive call is only counted once.*/
+    uint64_t inclusive_instructions;
+    /*instructions executed by the function itself*/
+    uint64_t exclusive_instructions;
+    uint64_t inclusive_allocated_bytes;
+    uint64_t exclusive_allocated_bytes;
+    /*how often each operation of the bytecode of the function has been executed*/
+    uint64_t *site_executions;
+    size_t site_count;
+    /*calls of this function that have not returned yet*/
+    size_t active_calls;
+} profile_function;
+
+/*a node of the calling context tree. Every distinct call stack has its own node.*/
+typedef struct profile_node
+{
+    function_id function;
+    size_t parent;
+    size_t first_child;
+    size_t next_sibling;
+    uint64_t calls;
+    uint64_t exclusive_instructions;
+} profile_node;
+
+typedef struct profile_frame
+{
+    size_t node;
+    uint64_t instructions_at_entry;
+    uint64_t allocated_bytes_at_entry;
+    /*what the functions called from this frame have used (inclusively)*/
+    uint64_t callee_instructions;
+    uint64_t callee_allocated_bytes;
+} profile_frame;
+
+/*Collects the information for a profile of an interpreted program. The interpreter reports every call, every return
+ * and every executed bytecode operation when it has a profile.*/
+typedef struct profile
+{
+    profile_function *functions;
+    function_id function_count;
+    /*the first node is the root and does not belong to any function*/
+    profile_node *nodes;
+    size_t node_count;
+    size_t node_capacity;
+    profile_frame *frames;
+    size_t frame_count;
+    size_t frame_capacity;
+} profile;
+
+profile profile_create(function_id const function_count) LPG_USE_RESULT;
+void profile_free(profile const freed);
+
+void profile_enter(LPG_NON_NULL(profile *const recorder), function_id const entered,
+                   uint64_t const executed_instructions, uint64_t const allocated_bytes);
+void profile_leave(LPG_NON_NULL(profile *const recorder), uint64_t const executed_instructions,
+                   uint64_t const allocated_bytes);
+
+static inline void profile_count_site(profile *const recorder, function_id const function, size_t const site,
+                                      size_t const site_count)
+{
+    profile_function *const counted = &recorder->functions[function];
+    if (!counted->site_executions)
+    {
+        counted->site_executions = allocate_array(site_count, sizeof(*counted->site_executions));
+        memset(counted->site_executions, 0, site_count * sizeof(*counted->site_executions));
+        counted->site_count = site_count;
+    }
+    counted->site_executions[site] += 1;
+}
+
+/*human readable names for the functions of a program*/
+typedef struct profile_symbols
+{
+    unicode_string *names;
+    /*the file of the module where the function is defined, empty if it is unknown*/
+    unicode_string *files;
+    /*the line where the function is defined counting from 1, or 0 if it is unknown*/
+    line_number *lines;
+    function_id count;
+} profile_symbols;
+
+/*A function is named after the register its value is stored in by the function that creates it (see
+ * register_debug_names), or after the interface method it implements. The file and the line are where the checker
+ * found the definition of the function in its own module.*/
+profile_symbols profile_symbols_create(checked_program const program) LPG_USE_RESULT;
+void profile_symbols_free(profile_symbols const freed);
+
+/*one line per call stack with the number of instructions executed by the innermost function in that stack, the input
+ * format of flamegraph.pl*/
+success_indicator profile_write_folded(profile const recorded, profile_symbols const symbols,
+                                       stream_writer const destination) LPG_USE_RESULT;
+
+success_indicator profile_write_json(profile const recorded, profile_symbols const symbols,
+                                     stream_writer const destination) LPG_USE_RESULT;
@@ -0,0 +1,1500 @@
+#include "lpg_save_program.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_hash.h"
+#include "lpg_instruction.h"
+#include "lpg_structure_member.h"
+#include <string.h>
+
+static char const saved_program_magic[4] = {'L', 'P', 'G', 'P'};
+
+typedef struct program_saver
+{
+    memory_writer content;
+    structure globals;
+    /*false after something has been found that cannot be saved*/
+    bool is_saveable;
+} program_saver;
+
+static void save_number(program_saver *const saver, uint64_t number)
+{
+    char encoded[10];
+    size_t length = 0;
+    do
+    {
+        uint8_t byte = (number & 0x7fu);
+        number >>= 7u;
+        if (number != 0)
+        {
+            byte |= 0x80u;
+        }
+        encoded[length] = (char)byte;
+        ++length;
+    } while (number != 0);
+    ASSERT(success_yes == memory_writer_write(&saver->content, encoded, length));
+}
+
+static void save_bool(program_saver *const saver, bool const saved)
+{
+    save_number(saver, saved ? 1 : 0);
+}
+
+static void save_string(program_saver *const saver, unicode_view const saved)
+{
+    save_number(saver, saved.length);
+    ASSERT(success_yes == memory_writer_write(&saver->content, saved.begin, saved.length));
+}
+
+static void save_integer(program_saver *const saver, integer const saved)
+{
+    save_number(saver, saved.high);
+    save_number(saver, saved.low);
+}
+
+static void save_optional_register_id(program_saver *const saver, optional_register_id const saved)
+{
+    save_bool(saver, saved.is_set);
+    if (saved.is_set)
+    {
+        save_number(saver, saved.value);
+    }
+}
+
+static void save_registers(program_saver *const saver, register_id const *const registers, size_t const count)
+{
+    save_number(saver, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        save_number(saver, registers[i]);
+    }
+}
+
+static void save_type(program_saver *const saver, type const saved);
+
+static void save_optional_type(program_saver *const saver, optional_type const saved)
+{
+    save_bool(saver, saved.is_set);
+    if (saved.is_set)
+    {
+        save_type(saver, saved.value);
+    }
+}
+
+static void save_tuple_type(program_saver *const saver, tuple_type const saved)
+{
+    save_number(saver, saved.length);
+    for (size_t i = 0; i < saved.length; ++i)
+    {
+        save_type(saver, saved.elements[i]);
+    }
+}
+
+static void save_function_pointer(program_saver *const saver, function_pointer const saved)
+{
+    save_optional_type(saver, saved.result);
+    save_tuple_type(saver, saved.parameters);
+    save_tuple_type(saver, saved.captures);
+    save_optional_type(saver, saved.self);
+}
+
+static void save_type(program_saver *const saver, type const saved)
+{
+    save_number(saver, saved.kind);
+    switch (saved.kind)
+    {
+    case type_kind_structure:
+        save_number(saver, saved.structure_);
+        break;
+
+    case type_kind_function_pointer:
+        save_function_pointer(saver, *saved.function_pointer_);
+        break;
+
+    case type_kind_unit:
+    case type_kind_string:
+    case type_kind_type:
+    case type_kind_generic_enum:
+    case type_kind_generic_interface:
+    case type_kind_generic_lambda:
+    case type_kind_host_value:
+    case type_kind_generic_struct:
+        break;
+
+    case type_kind_enumeration:
+        save_number(saver, saved.enum_);
+        break;
+
+    case type_kind_tuple:
+        save_tuple_type(saver, saved.tuple_);
+        break;
+
+    case type_kind_integer_range:
+        save_integer(saver, saved.integer_range_.minimum);
+        save_integer(saver, saved.integer_range_.maximum);
+        break;
+
+    case type_kind_enum_constructor:
+        save_number(saver, saved.enum_constructor->enumeration);
+        save_number(saver, saved.enum_constructor->which);
+        break;
+
+    case type_kind_lambda:
+        save_number(saver, saved.lambda.lambda);
+        break;
+
+    case type_kind_interface:
+        save_number(saver, saved.interface_);
+        break;
+
+    case type_kind_method_pointer:
+        save_number(saver, saved.method_pointer.interface_);
+        save_number(saver, saved.method_pointer.method_index);
+        break;
+    }
+}
+
+/*returns globals.count if the function is not the compile time value of any global*/
+static struct_member_id find_external_global(structure const globals, function_pointer_value const searched)
+{
+    for (struct_member_id i = 0; i < globals.count; ++i)
+    {
+        optional_value const compile_time_value = globals.members[i].compile_time_value;
+        if (!compile_time_value.is_set || (compile_time_value.value_.kind != value_kind_function_pointer) ||
+            !value_function_is_external(compile_time_value.value_))
+        {
+            continue;
+        }
+        function_pointer_value const candidate = *compile_time_value.value_.boxed_function;
+        if ((candidate.external == searched.external) &&
+            (candidate.external_environment == searched.external_environment))
+        {
+            return i;
+        }
+    }
+    return globals.count;
+}
+
+static void save_value(program_saver *const saver, value const saved);
+
+static void save_values(program_saver *const saver, value const *const saved, size_t const count)
+{
+    save_number(saver, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        save_value(saver, saved[i]);
+    }
+}
+
+static void save_function_pointer_value(program_saver *const saver, function_pointer_value const saved)
+{
+    save_bool(saver, (saved.external != NULL));
+    if (saved.external)
+    {
+        struct_member_id const global = find_external_global(saver->globals, saved);
+        if (global == saver->globals.count)
+        {
+            saver->is_saveable = false;
+        }
+        save_number(saver, global);
+        return;
+    }
+    save_number(saver, saved.code);
+    save_values(saver, saved.captures, saved.capture_count);
+}
+
+static void save_array(program_saver *const saver, array_value const saved)
+{
+    save_number(saver, saved.storage);
+    save_type(saver, saved.element_type);
+    save_number(saver, saved.count);
+    for (size_t i = 0; i < saved.count; ++i)
+    {
+        switch (saved.storage)
+        {
+        case array_storage_values:
+            save_value(saver, saved.elements[i]);
+            break;
+
+        case array_storage_integers:
+            save_number(saver, saved.integers[i]);
+            break;
+
+        case array_storage_enum_elements:
+            save_number(saver, saved.enum_elements[i]);
+            break;
+        }
+    }
+}
+
+static void save_value(program_saver *const saver, value const saved)
+{
+    save_number(saver, saved.kind);
+    switch (saved.kind)
+    {
+    case value_kind_integer:
+        save_integer(saver, value_as_integer(saved));
+        break;
+
+    case value_kind_string:
+        save_string(saver, value_as_string(saved));
+        break;
+
+    case value_kind_function_pointer:
+        save_bool(saver, (saved.boxed_function != NULL));
+        if (saved.boxed_function)
+        {
+            save_function_pointer_value(saver, *saved.boxed_function);
+        }
+        else
+        {
+            save_number(saver, saved.code);
+        }
+        break;
+
+    case value_kind_structure:
+        save_values(saver, saved.structure_members, saved.count);
+        break;
+
+    case value_kind_type:
+        save_type(saver, value_as_type(saved));
+        break;
+
+    case value_kind_enum_element:
+        save_number(saver, saved.which);
+        save_bool(saver, (saved.enum_state != NULL));
+        if (saved.enum_state)
+        {
+            save_value(saver, *saved.enum_state);
+        }
+        break;
+
+    case value_kind_unit:
+    case value_kind_enum_constructor:
+        break;
+
+    case value_kind_tuple:
+        save_values(saver, saved.tuple_elements, saved.count);
+        break;
+
+    case value_kind_type_erased:
+        save_number(saver, saved.interface_);
+        save_number(saver, saved.type_erased->implementation_index);
+        save_value(saver, saved.type_erased->self);
+        break;
+
+    case value_kind_pattern:
+        saver->is_saveable = false;
+        break;
+
+    case value_kind_generic_enum:
+        save_number(saver, saved.generic_enum);
+        break;
+
+    case value_kind_generic_interface:
+        save_number(saver, saved.generic_interface);
+        break;
+
+    case value_kind_array:
+        save_array(saver, *saved.array);
+        break;
+
+    case value_kind_generic_lambda:
+        save_number(saver, saved.generic_lambda);
+        break;
+
+    case value_kind_generic_struct:
+        save_number(saver, saved.generic_struct);
+        break;
+    }
+}
+
+static void save_optional_value(program_saver *const saver, optional_value const saved)
+{
+    save_bool(saver, saved.is_set);
+    if (saved.is_set)
+    {
+        save_value(saver, saved.value_);
+    }
+}
+
+static void save_instruction_sequence(program_saver *const saver, instruction_sequence const saved);
+
+static void save_match_case(program_saver *const saver, match_instruction_case const saved)
+{
+    save_number(saver, saved.kind);
+    switch (saved.kind)
+    {
+    case match_instruction_case_kind_value:
+        save_number(saver, saved.key_value);
+        break;
+
+    case match_instruction_case_kind_stateful_enum:
+        save_number(saver, saved.stateful_enum.element);
+        save_number(saver, saved.stateful_enum.where);
+        break;
+
+    case match_instruction_case_kind_default:
+        break;
+    }
+    save_instruction_sequence(saver, saved.action);
+    save_optional_register_id(saver, saved.value);
+}
+
+static void save_instruction(program_saver *const saver, instruction const saved)
+{
+    save_number(saver, saved.type);
+    switch (saved.type)
+    {
+    case instruction_call:
+        save_number(saver, saved.call.callee);
+        save_registers(saver, saved.call.arguments, saved.call.argument_count);
+        save_number(saver, saved.call.result);
+        break;
+
+    case instruction_loop:
+        save_number(saver, saved.loop.unit_goes_into);
+        save_instruction_sequence(saver, saved.loop.body);
+        break;
+
+    case instruction_global:
+        save_number(saver, saved.global_into);
+        break;
+
+    case instruction_read_struct:
+        save_number(saver, saved.read_struct.from_object);
+        save_number(saver, saved.read_struct.member);
+        save_number(saver, saved.read_struct.into);
+        break;
+
+    case instruction_break:
+        save_number(saver, saved.break_.unit_goes_into);
+        save_optional_register_id(saver, saved.break_.loop_result);
+        break;
+
+    case instruction_literal:
+        save_number(saver, saved.literal.into);
+        save_value(saver, saved.literal.value_);
+        save_type(saver, saved.literal.type_of);
+        break;
+
+    case instruction_tuple:
+        save_registers(saver, saved.tuple_.elements, saved.tuple_.element_count);
+        save_number(saver, saved.tuple_.result);
+        save_tuple_type(saver, saved.tuple_.result_type);
+        break;
+
+    case instruction_enum_construct:
+        save_number(saver, saved.enum_construct.into);
+        save_number(saver, saved.enum_construct.which.enumeration);
+        save_number(saver, saved.enum_construct.which.which);
+        save_number(saver, saved.enum_construct.state);
+        save_type(saver, saved.enum_construct.state_type);
+        break;
+
+    case instruction_match:
+        save_number(saver, saved.match.key);
+        save_number(saver, saved.match.count);
+        for (size_t i = 0; i < saved.match.count; ++i)
+        {
+            save_match_case(saver, saved.match.cases[i]);
+        }
+        save_number(saver, saved.match.result);
+        save_type(saver, saved.match.result_type);
+        break;
+
+    case instruction_get_captures:
+        save_number(saver, saved.captures);
+        break;
+
+    case instruction_lambda_with_captures:
+        save_number(saver, saved.lambda_with_captures.into);
+        save_number(saver, saved.lambda_with_captures.lambda);
+        save_registers(saver, saved.lambda_with_captures.captures, saved.lambda_with_captures.capture_count);
+        break;
+
+    case instruction_get_method:
+        save_number(saver, saved.get_method.interface_);
+        save_number(saver, saved.get_method.from);
+        save_number(saver, saved.get_method.method);
+        save_number(saver, saved.get_method.into);
+        break;
+
+    case instruction_erase_type:
+        save_number(saver, saved.erase_type.self);
+        save_number(saver, saved.erase_type.into);
+        save_number(saver, saved.erase_type.impl.target);
+        save_number(saver, saved.erase_type.impl.implementation_index);
+        break;
+
+    case instruction_return:
+        save_number(saver, saved.return_.returned_value);
+        save_number(saver, saved.return_.unit_goes_into);
+        break;
+
+    case instruction_instantiate_struct:
+        save_number(saver, saved.instantiate_struct.into);
+        save_number(saver, saved.instantiate_struct.instantiated);
+        save_registers(saver, saved.instantiate_struct.arguments, saved.instantiate_struct.argument_count);
+        break;
+
+    case instruction_new_array:
+        save_number(saver, saved.new_array.result_type);
+        save_number(saver, saved.new_array.into);
+        save_type(saver, saved.new_array.element_type);
+        save_number(saver, saved.new_array.storage);
+        break;
+
+    case instruction_current_function:
+        save_number(saver, saved.current_function.into);
+        break;
+    }
+}
+
+static void save_instruction_sequence(program_saver *const saver, instruction_sequence const saved)
+{
+    save_number(saver, saved.length);
+    for (size_t i = 0; i < saved.length; ++i)
+    {
+        save_instruction(saver, saved.elements[i]);
+    }
+}
+
+static void save_function(program_saver *const saver, checked_function const saved)
+{
+    save_function_pointer(saver, *saved.signature);
+    save_instruction_sequence(saver, saved.body);
+    save_number(saver, saved.number_of_registers);
+    for (register_id i = 0; i < saved.number_of_registers; ++i)
+    {
+        save_string(saver, unicode_view_from_string(saved.register_debug_names[i]));
+    }
+    save_string(saver, unicode_view_from_string(saved.definition_file));
+    save_number(saver, saved.definition_line);
+}
+
+static void save_interface(program_saver *const saver, lpg_interface const saved)
+{
+    save_number(saver, saved.method_count);
+    for (function_id i = 0; i < saved.method_count; ++i)
+    {
+        method_description const method = saved.methods[i];
+        save_string(saver, unicode_view_from_string(method.name));
+        save_tuple_type(saver, method.parameters);
+        save_type(saver, method.result);
+    }
+    save_number(saver, saved.implementation_count);
+    for (size_t i = 0; i < saved.implementation_count; ++i)
+    {
+        implementation_entry const entry = saved.implementations[i];
+        save_type(saver, entry.self);
+        save_number(saver, entry.target.method_count);
+        for (size_t k = 0; k < entry.target.method_count; ++k)
+        {
+            save_function_pointer_value(saver, entry.target.methods[k]);
+        }
+    }
+}
+
+static void save_structure(program_saver *const saver, structure const saved)
+{
+    save_number(saver, saved.count);
+    for (struct_member_id i = 0; i < saved.count; ++i)
+    {
+        structure_member const member = saved.members[i];
+        save_type(saver, member.what);
+        save_string(saver, unicode_view_from_string(member.name));
+        save_optional_value(saver, member.compile_time_value);
+    }
+}
+
+static void save_enumeration(program_saver *const saver, enumeration const saved)
+{
+    save_number(saver, saved.size);
+    for (enum_element_id i = 0; i < saved.size; ++i)
+    {
+        save_string(saver, unicode_view_from_string(saved.elements[i].name));
+        save_optional_type(saver, saved.elements[i].state);
+    }
+}
+
+success_indicator save_checked_program(checked_program const *const program, structure const globals,
+                                       stream_writer const destination)
+{
+    program_saver saver = {{NULL, 0, 0}, globals, true};
+    save_number(&saver, program->memory.max_heap_size);
+    save_number(&saver, program->function_count);
+    for (function_id i = 0; i < program->function_count; ++i)
+    {
+        save_function(&saver, program->functions[i]);
+    }
+    save_number(&saver, program->interface_count);
+    for (interface_id i = 0; i < program->interface_count; ++i)
+    {
+        save_interface(&saver, program->interfaces[i]);
+    }
+    save_number(&saver, program->struct_count);
+    for (struct_id i = 0; i < program->struct_count; ++i)
+    {
+        save_structure(&saver, program->structs[i]);
+    }
+    save_number(&saver, program->enum_count);
+    for (enum_id i = 0; i < program->enum_count; ++i)
+    {
+        save_enumeration(&saver, program->enums[i]);
+    }
+    if (!saver.is_saveable)
+    {
+        memory_writer_free(&saver.content);
+        return success_no;
+    }
+
+    program_saver header = {{NULL, 0, 0}, globals, true};
+    ASSERT(success_yes == memory_writer_write(&header.content, saved_program_magic, sizeof(saved_program_magic)));
+    save_number(&header, saved_program_format_version);
+    save_number(&header, saver.content.used);
+    save_number(&header, hash_bytes(hash_seed, saver.content.data, saver.content.used));
+    success_indicator const result =
+        ((stream_writer_write_bytes(destination, header.content.data, header.content.used) == success_yes) &&
+         (stream_writer_write_bytes(destination, saver.content.data, saver.content.used) == success_yes))
+            ? success_yes
+            : success_no;
+    memory_writer_free(&header.content);
+    memory_writer_free(&saver.content);
+    return result;
+}
+
+typedef struct program_loader
+{
+    char const *position;
+    char const *end;
+    structure globals;
+    garbage_collector *memory;
+    /*the interner of the program that is being loaded*/
+    type_interner *types;
+    /*Once the data turns out to be damaged, the loader keeps going with harmless defaults so that everything that has
+     * been loaded so far can be freed the usual way.*/
+    bool is_damaged;
+} program_loader;
+
+static uint64_t load_number(program_loader *const loader)
+{
+    uint64_t result = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (loader->position == loader->end)
+        {
+            loader->is_damaged = true;
+            return 0;
+        }
+        uint8_t const byte = (uint8_t)*loader->position;
+        ++loader->position;
+        result |= ((uint64_t)(byte & 0x7fu) << shift);
+        if (!(byte & 0x80u))
+        {
+            return result;
+        }
+    }
+    loader->is_damaged = true;
+    return 0;
+}
+
+static uint32_t load_id(program_loader *const loader)
+{
+    uint64_t const loaded = load_number(loader);
+    if (loaded > UINT32_MAX)
+    {
+        loader->is_damaged = true;
+        return 0;
+    }
+    return (uint32_t)loaded;
+}
+
+static bool load_bool(program_loader *const loader)
+{
+    uint64_t const loaded = load_number(loader);
+    if (loaded > 1)
+    {
+        loader->is_damaged = true;
+        return false;
+    }
+    return (loaded == 1);
+}
+
+/*Every element takes at least one byte, so a count can not be larger than the rest of the data. This keeps damaged
+ * data from causing huge allocations.*/
+static size_t load_count(program_loader *const loader)
+{
+    uint64_t const loaded = load_number(loader);
+    if (loaded > (uint64_t)(loader->end - loader->position))
+    {
+        loader->is_damaged = true;
+        return 0;
+    }
+    return (size_t)loaded;
+}
+
+/*returns the value of an enum like type_kind if it is between first and last*/
+static uint64_t load_kind(program_loader *const loader, uint64_t const first, uint64_t const last)
+{
+    uint64_t const loaded = load_number(loader);
+    if ((loaded < first) || (loaded > last))
+    {
+        loader->is_damaged = true;
+        return first;
+    }
+    return loaded;
+}
+
+static void *load_allocate(program_loader *const loader, size_t const count, size_t const element)
+{
+    if (count == 0)
+    {
+        return NULL;
+    }
+    void *const result = garbage_collector_try_allocate_array(loader->memory, count, element);
+    if (!result)
+    {
+        loader->is_damaged = true;
+    }
+    return result;
+}
+
+static unicode_view load_bytes(program_loader *const loader)
+{
+    size_t const length = load_count(loader);
+    unicode_view const result = unicode_view_create(loader->position, length);
+    loader->position += length;
+    return result;
+}
+
+static unicode_string load_string(program_loader *const loader)
+{
+    unicode_view const loaded = load_bytes(loader);
+    return unicode_string_from_range(loaded.begin, loaded.length);
+}
+
+static integer load_integer(program_loader *const loader)
+{
+    uint64_t const high = load_number(loader);
+    uint64_t const low = load_number(loader);
+    return integer_create(high, low);
+}
+
+static optional_register_id load_optional_register_id(program_loader *const loader)
+{
+    if (load_bool(loader))
+    {
+        return optional_register_id_create_set(load_id(loader));
+    }
+    return optional_register_id_create_empty();
+}
+
+/*the array is always allocated because some of the instructions free it unconditionally*/
+static register_id *load_registers(program_loader *const loader, size_t *const count)
+{
+    *count = load_count(loader);
+    register_id *const result = allocate_array(*count, sizeof(*result));
+    for (size_t i = 0; i < *count; ++i)
+    {
+        result[i] = load_id(loader);
+    }
+    return result;
+}
+
+static type load_type(program_loader *const loader);
+
+static optional_type load_optional_type(program_loader *const loader)
+{
+    if (load_bool(loader))
+    {
+        return optional_type_create_set(load_type(loader));
+    }
+    return optional_type_create_empty();
+}
+
+/*The elements are allocated with allocate_array. Tuples that become types are interned, which copies them into the
+ * memory of the program.*/
+static tuple_type load_tuple_type(program_loader *const loader)
+{
+    size_t const length = load_count(loader);
+    type *const elements = allocate_array(length, sizeof(*elements));
+    for (size_t i = 0; i < length; ++i)
+    {
+        elements[i] = load_type(loader);
+    }
+    return tuple_type_create(elements, length);
+}
+
+static function_pointer load_function_pointer(program_loader *const loader)
+{
+    optional_type const result = load_optional_type(loader);
+    tuple_type const parameters = load_tuple_type(loader);
+    tuple_type const captures = load_tuple_type(loader);
+    optional_type const self = load_optional_type(loader);
+    return function_pointer_create(result, parameters, captures, self);
+}
+
+/*takes the place of a type that did not fit into the memory of the program*/
+static type load_interned(program_loader *const loader, type const loaded)
+{
+    optional_type const interned = type_interner_try_intern(loader->types, loader->memory, loaded);
+    if (!interned.is_set)
+    {
+        loader->is_damaged = true;
+        return type_from_unit();
+    }
+    return interned.value;
+}
+
+static type load_type(program_loader *const loader)
+{
+    type_kind const kind = (type_kind)load_kind(loader, type_kind_structure, type_kind_generic_struct);
+    switch (kind)
+    {
+    case type_kind_structure:
+        return type_from_struct(load_id(loader));
+
+    case type_kind_function_pointer:
+    {
+        function_pointer const loaded = load_function_pointer(loader);
+        type const result = load_interned(loader, type_from_function_pointer(&loaded));
+        function_pointer_free(&loaded);
+        return result;
+    }
+
+    case type_kind_unit:
+        return type_from_unit();
+
+    case type_kind_string:
+        return type_from_string();
+
+    case type_kind_enumeration:
+        return type_from_enumeration(load_id(loader));
+
+    case type_kind_tuple:
+    {
+        tuple_type const loaded = load_tuple_type(loader);
+        type const result = load_interned(loader, type_from_tuple_type(loaded));
+        if (loaded.elements)
+        {
+            deallocate(loaded.elements);
+        }
+        return result;
+    }
+
+    case type_kind_type:
+        return type_from_type();
+
+    case type_kind_integer_range:
+    {
+        integer const minimum = load_integer(loader);
+        integer const maximum = load_integer(loader);
+        return type_from_integer_range(integer_range_create(minimum, maximum));
+    }
+
+    case type_kind_enum_constructor:
+    {
+        enum_id const constructed = load_id(loader);
+        enum_element_id const which = load_id(loader);
+        enum_constructor_type *const box = load_allocate(loader, 1, sizeof(*box));
+        if (!box)
+        {
+            return type_from_unit();
+        }
+        *box = enum_constructor_type_create(constructed, which);
+        return type_from_enum_constructor(box);
+    }
+
+    case type_kind_lambda:
+        return type_from_lambda(lambda_type_create(load_id(loader)));
+
+    case type_kind_interface:
+        return type_from_interface(load_id(loader));
+
+    case type_kind_method_pointer:
+    {
+        interface_id const interface_ = load_id(loader);
+        size_t const method_index = (size_t)load_id(loader);
+        return type_from_method_pointer(method_pointer_type_create(interface_, method_index));
+    }
+
+    case type_kind_generic_enum:
+        return type_from_generic_enum();
+
+    case type_kind_generic_interface:
+        return type_from_generic_interface();
+
+    case type_kind_generic_lambda:
+        return type_from_generic_lambda();
+
+    case type_kind_host_value:
+        return type_from_host_value();
+
+    case type_kind_generic_struct:
+        return type_from_generic_struct();
+    }
+    LPG_UNREACHABLE();
+}
+
+static value load_value(program_loader *const loader);
+
+static value *load_values(program_loader *const loader, size_t *const count)
+{
+    *count = load_count(loader);
+    value *const result = load_allocate(loader, *count, sizeof(*result));
+    if (!result)
+    {
+        *count = 0;
+        return NULL;
+    }
+    for (size_t i = 0; i < *count; ++i)
+    {
+        result[i] = load_value(loader);
+    }
+    return result;
+}
+
+static function_pointer_value load_function_pointer_value(program_loader *const loader)
+{
+    if (load_bool(loader))
+    {
+        struct_member_id const global = load_id(loader);
+        if (global < loader->globals.count)
+        {
+            optional_value const compile_time_value = loader->globals.members[global].compile_time_value;
+            if (compile_time_value.is_set && (compile_time_value.value_.kind == value_kind_function_pointer) &&
+                value_function_is_external(compile_time_value.value_))
+            {
+                return *compile_time_value.value_.boxed_function;
+            }
+        }
+        loader->is_damaged = true;
+        return function_pointer_value_from_internal(0, NULL, 0);
+    }
+    function_id const code = load_id(loader);
+    size_t capture_count = 0;
+    value *const captures = load_values(loader, &capture_count);
+    return function_pointer_value_from_internal(code, captures, capture_count);
+}
+
+static array_value *load_array(program_loader *const loader)
+{
+    array_storage const storage =
+        (array_storage)load_kind(loader, array_storage_values, array_storage_enum_elements);
+    type const element_type = load_type(loader);
+    size_t const count = load_count(loader);
+    array_value *const result = load_allocate(loader, 1, sizeof(*result));
+    if (!result)
+    {
+        return NULL;
+    }
+    *result = array_value_create_empty(storage, element_type);
+    void *const elements = load_allocate(loader, count, array_storage_element_size(storage));
+    if (!elements)
+    {
+        return result;
+    }
+    switch (storage)
+    {
+    case array_storage_values:
+        result->elements = elements;
+        break;
+
+    case array_storage_integers:
+        result->integers = elements;
+        break;
+
+    case array_storage_enum_elements:
+        result->enum_elements = elements;
+        break;
+    }
+    result->count = count;
+    result->allocated = count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        switch (storage)
+        {
+        case array_storage_values:
+            result->elements[i] = load_value(loader);
+            break;
+
+        case array_storage_integers:
+            result->integers[i] = load_number(loader);
+            break;
+
+        case array_storage_enum_elements:
+        {
+            uint64_t const which = load_number(loader);
+            if (which > UINT8_MAX)
+            {
+                loader->is_damaged = true;
+            }
+            result->enum_elements[i] = (uint8_t)which;
+            break;
+        }
+        }
+    }
+    return result;
+}
+
+static value load_value(program_loader *const loader)
+{
+    value_kind const kind = (value_kind)load_kind(loader, value_kind_integer, value_kind_generic_struct);
+    switch (kind)
+    {
+    case value_kind_integer:
+    {
+        integer const loaded = load_integer(loader);
+        if (integer_is_small(loaded))
+        {
+            return value_from_small_integer(loaded.low);
+        }
+        integer *const box = load_allocate(loader, 1, sizeof(*box));
+        if (!box)
+        {
+            return value_from_unit();
+        }
+        *box = loaded;
+        value result;
+        result.kind = value_kind_integer;
+        result.is_big = 1;
+        result.big_integer = box;
+        return result;
+    }
+
+    case value_kind_string:
+    {
+        unicode_view const loaded = load_bytes(loader);
+        if (loaded.length > value_max_string_length)
+        {
+            loader->is_damaged = true;
+            return value_from_unit();
+        }
+        char *const copy = load_allocate(loader, loaded.length, 1);
+        if (copy)
+        {
+            memcpy(copy, loaded.begin, loaded.length);
+        }
+        return value_from_string(unicode_view_create(copy, copy ? loaded.length : 0));
+    }
+
+    case value_kind_function_pointer:
+    {
+        if (!load_bool(loader))
+        {
+            return value_from_internal_function(load_id(loader));
+        }
+        function_pointer_value const loaded = load_function_pointer_value(loader);
+        function_pointer_value *const box = load_allocate(loader, 1, sizeof(*box));
+        if (!box)
+        {
+            return value_from_unit();
+        }
+        *box = loaded;
+        value result;
+        result.kind = value_kind_function_pointer;
+        result.code = loaded.code;
+        result.boxed_function = box;
+        return result;
+    }
+
+    case value_kind_structure:
+    {
+        size_t count = 0;
+        value *const members = load_values(loader, &count);
+        if (count > UINT32_MAX)
+        {
+            loader->is_damaged = true;
+            return value_from_unit();
+        }
+        return value_from_structure(structure_value_create(members, count));
+    }
+
+    case value_kind_type:
+    {
+        type const loaded = load_type(loader);
+        type *const box = load_allocate(loader, 1, sizeof(*box));
+        if (!box)
+        {
+            return value_from_unit();
+        }
+        *box = loaded;
+        value result;
+        result.kind = value_kind_type;
+        result.count = 0;
+        result.boxed_type = box;
+        return result;
+    }
+
+    case value_kind_enum_element:
+    {
+        enum_element_id const which = load_id(loader);
+        if (!load_bool(loader))
+        {
+            return value_from_enum_element(which, NULL);
+        }
+        value const state = load_value(loader);
+        value *const box = load_allocate(loader, 1, sizeof(*box));
+        if (!box)
+        {
+            return value_from_unit();
+        }
+        *box = state;
+        return value_from_enum_element(which, box);
+    }
+
+    case value_kind_unit:
+        return value_from_unit();
+
+    case value_kind_tuple:
+    {
+        size_t count = 0;
+        value *const elements = load_values(loader, &count);
+        if (count > UINT32_MAX)
+        {
+            loader->is_damaged = true;
+            return value_from_unit();
+        }
+        return value_from_tuple(value_tuple_create(elements, count));
+    }
+
+    case value_kind_enum_constructor:
+        return value_from_enum_constructor();
+
+    case value_kind_type_erased:
+    {
+        interface_id const interface_ = load_id(loader);
+        size_t const implementation_index = (size_t)load_number(loader);
+        value const self = load_value(loader);
+        type_erased_box *const box = load_allocate(loader, 1, sizeof(*box));
+        if (!box)
+        {
+            return value_from_unit();
+        }
+        box->implementation_index = implementation_index;
+        box->self = self;
+        value result;
+        result.kind = value_kind_type_erased;
+        result.interface_ = interface_;
+        result.type_erased = box;
+        return result;
+    }
+
+    case value_kind_pattern:
+        /*patterns are never saved*/
+        loader->is_damaged = true;
+        return value_from_unit();
+
+    case value_kind_generic_enum:
+        return value_from_generic_enum(load_id(loader));
+
+    case value_kind_generic_interface:
+        return value_from_generic_interface(load_id(loader));
+
+    case value_kind_array:
+    {
+        array_value *const loaded = load_array(loader);
+        if (!loaded)
+        {
+            return value_from_unit();
+        }
+        return value_from_array(loaded);
+    }
+
+    case value_kind_generic_lambda:
+        return value_from_generic_lambda(load_id(loader));
+
+    case value_kind_generic_struct:
+        return value_from_generic_struct(load_id(loader));
+    }
+    LPG_UNREACHABLE();
+}
+
+static optional_value load_optional_value(program_loader *const loader)
+{
+    if (load_bool(loader))
+    {
+        return optional_value_create(load_value(loader));
+    }
+    return optional_value_empty;
+}
+
+static instruction_sequence load_instruction_sequence(program_loader *const loader);
+
+static match_instruction_case load_match_case(program_loader *const loader)
+{
+    match_instruction_case_kind const kind = (match_instruction_case_kind)load_kind(
+        loader, match_instruction_case_kind_value, match_instruction_case_kind_default);
+    switch (kind)
+    {
+    case match_instruction_case_kind_value:
+    {
+        register_id const key_value = load_id(loader);
+        instruction_sequence const action = load_instruction_sequence(loader);
+        return match_instruction_case_create_value(key_value, action, load_optional_register_id(loader));
+    }
+
+    case match_instruction_case_kind_stateful_enum:
+    {
+        enum_element_id const element = load_id(loader);
+        register_id where = load_id(loader);
+        if (where == ~(register_id)0)
+        {
+            loader->is_damaged = true;
+            where = 0;
+        }
+        instruction_sequence const action = load_instruction_sequence(loader);
+        return match_instruction_case_create_stateful_enum(
+            match_instruction_case_stateful_enum_create(element, where), action, load_optional_register_id(loader));
+    }
+
+    case match_instruction_case_kind_default:
+    {
+        instruction_sequence const action = load_instruction_sequence(loader);
+        return match_instruction_case_create_default(action, load_optional_register_id(loader));
+    }
+    }
+    LPG_UNREACHABLE();
+}
+
+/*literal_instruction_create expects the same things*/
+static bool is_valid_literal(value const value_, type const type_of)
+{
+    if ((type_of.kind == type_kind_host_value) || (type_of.kind == type_kind_method_pointer))
+    {
+        return false;
+    }
+    return !value_is_mutable(value_) && value_conforms_to_type(value_, type_of);
+}
+
+static instruction load_instruction(program_loader *const loader)
+{
+    instruction_type const loaded =
+        (instruction_type)load_kind(loader, instruction_call, instruction_current_function);
+    switch (loaded)
+    {
+    case instruction_call:
+    {
+        register_id const callee = load_id(loader);
+        size_t argument_count = 0;
+        register_id *const arguments = load_registers(loader, &argument_count);
+        return instruction_create_call(call_instruction_create(callee, arguments, argument_count, load_id(loader)));
+    }
+
+    case instruction_loop:
+    {
+        register_id const unit_goes_into = load_id(loader);
+        return instruction_create_loop(loop_instruction_create(unit_goes_into, load_instruction_sequence(loader)));
+    }
+
+    case instruction_global:
+        return instruction_create_global(load_id(loader));
+
+    case instruction_read_struct:
+    {
+        register_id const from_object = load_id(loader);
+        struct_member_id const member = load_id(loader);
+        return instruction_create_read_struct(read_struct_instruction_create(from_object, member, load_id(loader)));
+    }
+
+    case instruction_break:
+    {
+        register_id const unit_goes_into = load_id(loader);
+        return instruction_create_break(break_instruction_create(unit_goes_into, load_optional_register_id(loader)));
+    }
+
+    case instruction_literal:
+    {
+        register_id const into = load_id(loader);
+        value const value_ = load_value(loader);
+        type const type_of = load_type(loader);
+        if (!is_valid_literal(value_, type_of))
+        {
+            loader->is_damaged = true;
+            return instruction_create_global(into);
+        }
+        return instruction_create_literal(literal_instruction_create(into, value_, type_of));
+    }
+
+    case instruction_tuple:
+    {
+        size_t element_count = 0;
+        register_id *const elements = load_registers(loader, &element_count);
+        register_id const result = load_id(loader);
+        return instruction_create_tuple(
+            tuple_instruction_create(elements, element_count, result, load_tuple_type(loader)));
+    }
+
+    case instruction_enum_construct:
+    {
+        register_id const into = load_id(loader);
+        enum_id const constructed = load_id(loader);
+        enum_element_id const which = load_id(loader);
+        register_id const state = load_id(loader);
+        return instruction_create_enum_construct(enum_construct_instruction_create(
+            into, enum_constructor_type_create(constructed, which), state, load_type(loader)));
+    }
+
+    case instruction_match:
+    {
+        register_id const key = load_id(loader);
+        size_t const count = load_count(loader);
+        match_instruction_case *const cases = allocate_array(count, sizeof(*cases));
+        for (size_t i = 0; i < count; ++i)
+        {
+            cases[i] = load_match_case(loader);
+        }
+        register_id const result = load_id(loader);
+        return instruction_create_match(match_instruction_create(key, cases, count, result, load_type(loader)));
+    }
+
+    case instruction_get_captures:
+        return instruction_create_get_captures(load_id(loader));
+
+    case instruction_lambda_with_captures:
+    {
+        register_id const into = load_id(loader);
+        function_id const lambda = load_id(loader);
+        size_t capture_count = 0;
+        register_id *const captures = load_registers(loader, &capture_count);
+        return instruction_create_lambda_with_captures(
+            lambda_with_captures_instruction_create(into, lambda, captures, capture_count));
+    }
+
+    case instruction_get_method:
+    {
+        interface_id const interface_ = load_id(loader);
+        register_id const from = load_id(loader);
+        function_id const method = load_id(loader);
+        return instruction_create_get_method(get_method_instruction_create(interface_, from, method, load_id(loader)));
+    }
+
+    case instruction_erase_type:
+    {
+        register_id const self = load_id(loader);
+        register_id const into = load_id(loader);
+        interface_id const target = load_id(loader);
+        size_t const implementation_index = (size_t)load_number(loader);
+        return instruction_create_erase_type(
+            erase_type_instruction_create(self, into, implementation_ref_create(target, implementation_index)));
+    }
+
+    case instruction_return:
+    {
+        register_id const returned_value = load_id(loader);
+        return instruction_create_return(return_instruction_create(returned_value, load_id(loader)));
+    }
+
+    case instruction_instantiate_struct:
+    {
+        register_id const into = load_id(loader);
+        struct_id const instantiated = load_id(loader);
+        size_t argument_count = 0;
+        register_id *const arguments = load_registers(loader, &argument_count);
+        return instruction_create_instantiate_struct(
+            instantiate_struct_instruction_create(into, instantiated, arguments, argument_count));
+    }
+
+    case instruction_new_array:
+    {
+        interface_id const result_type = load_id(loader);
+        register_id const into = load_id(loader);
+        type const element_type = load_type(loader);
+        array_storage const storage =
+            (array_storage)load_kind(loader, array_storage_values, array_storage_enum_elements);
+        return instruction_create_new_array(new_array_instruction_create(result_type, into, element_type, storage));
+    }
+
+    case instruction_current_function:
+        return instruction_create_current_function(current_function_instruction_create(load_id(loader)));
+    }
+    LPG_UNREACHABLE();
+}
+
+static instruction_sequence load_instruction_sequence(program_loader *const loader)
+{
+    size_t const length = load_count(loader);
+    instruction *const elements = (length > 0) ? allocate_array(length, sizeof(*elements)) : NULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        elements[i] = load_instruction(loader);
+    }
+    return instruction_sequence_create(elements, length, length);
+}
+
+/*the signature of the functions that did not fit into the memory of the program*/
+static function_pointer const damaged_signature = {{false, {0}}, {NULL, 0}, {NULL, 0}, {false, {0}}};
+
+static checked_function load_function(program_loader *const loader)
+{
+    function_pointer const loaded_signature = load_function_pointer(loader);
+    type const interned = load_interned(loader, type_from_function_pointer(&loaded_signature));
+    function_pointer_free(&loaded_signature);
+    function_pointer const *const signature =
+        (interned.kind == type_kind_function_pointer) ? interned.function_pointer_ : &damaged_signature;
+    instruction_sequence const body = load_instruction_sequence(loader);
+    size_t const register_count = load_count(loader);
+    if (register_count > UINT32_MAX)
+    {
+        loader->is_damaged = true;
+        return checked_function_create(signature, body, NULL, 0);
+    }
+    unicode_string *const register_debug_names =
+        (register_count > 0) ? allocate_array(register_count, sizeof(*register_debug_names)) : NULL;
+    for (size_t i = 0; i < register_count; ++i)
+    {
+        register_debug_names[i] = load_string(loader);
+    }
+    checked_function result =
+        checked_function_create(signature, body, register_debug_names, (register_id)register_count);
+    unicode_string const definition_file = load_string(loader);
+    checked_function_set_definition(&result, unicode_view_from_string(definition_file), load_count(loader));
+    unicode_string_free(&definition_file);
+    return result;
+}
+
+static lpg_interface load_interface(program_loader *const loader)
+{
+    size_t const method_count = load_count(loader);
+    if (method_count > UINT32_MAX)
+    {
+        loader->is_damaged = true;
+        return interface_create(NULL, 0, NULL, 0);
+    }
+    method_description *const methods = allocate_array(method_count, sizeof(*methods));
+    for (size_t i = 0; i < method_count; ++i)
+    {
+        unicode_string const name = load_string(loader);
+        tuple_type const parameters = load_tuple_type(loader);
+        methods[i] = method_description_create(name, parameters, load_type(loader));
+    }
+    size_t const implementation_count = load_count(loader);
+    implementation_entry *const implementations = allocate_array(implementation_count, sizeof(*implementations));
+    for (size_t i = 0; i < implementation_count; ++i)
+    {
+        type const self = load_type(loader);
+        size_t const implementation_method_count = load_count(loader);
+        function_pointer_value *const implementation_methods =
+            allocate_array(implementation_method_count, sizeof(*implementation_methods));
+        for (size_t k = 0; k < implementation_method_count; ++k)
+        {
+            implementation_methods[k] = load_function_pointer_value(loader);
+        }
+        implementations[i] = implementation_entry_create(
+            self, implementation_create(implementation_methods, implementation_method_count));
+    }
+    return interface_create(methods, (function_id)method_count, implementations, implementation_count);
+}
+
+static structure load_structure(program_loader *const loader)
+{
+    size_t const count = load_count(loader);
+    if (count > UINT32_MAX)
+    {
+        loader->is_damaged = true;
+        return structure_create(NULL, 0);
+    }
+    structure_member *const members = allocate_array(count, sizeof(*members));
+    for (size_t i = 0; i < count; ++i)
+    {
+        type const what = load_type(loader);
+        unicode_string const name = load_string(loader);
+        members[i] = structure_member_create(what, name, load_optional_value(loader));
+    }
+    return structure_create(members, (struct_member_id)count);
+}
+
+static enumeration load_enumeration(program_loader *const loader)
+{
+    size_t const size = load_count(loader);
+    if (size > UINT32_MAX)
+    {
+        loader->is_damaged = true;
+        return enumeration_create(NULL, 0);
+    }
+    enumeration_element *const elements = allocate_array(size, sizeof(*elements));
+    for (size_t i = 0; i < size; ++i)
+    {
+        unicode_string const name = load_string(loader);
+        elements[i] = enumeration_element_create(name, load_optional_type(loader));
+    }
+    return enumeration_create(elements, (enum_element_id)size);
+}
+
+/*returns the number of elements to load or 0 if the count is damaged*/
+static uint32_t load_table_size(program_loader *const loader)
+{
+    size_t const count = load_count(loader);
+    if (count > UINT32_MAX)
+    {
+        loader->is_damaged = true;
+        return 0;
+    }
+    return (uint32_t)count;
+}
+
+static checked_program load_program(program_loader *const loader, garbage_collector const memory)
+{
+    checked_program result = {NULL, 0, NULL, 0, memory, NULL, 0, NULL, 0, type_interner_create()};
+    loader->memory = &result.memory;
+    loader->types = &result.types;
+    function_id const function_count = load_table_size(loader);
+    result.functions = allocate_array(function_count, sizeof(*result.functions));
+    for (; result.function_count < function_count; ++result.function_count)
+    {
+        result.functions[result.function_count] = load_function(loader);
+    }
+    interface_id const interface_count = load_table_size(loader);
+    result.interfaces = allocate_array(interface_count, sizeof(*result.interfaces));
+    for (; result.interface_count < interface_count; ++result.interface_count)
+    {
+        result.interfaces[result.interface_count] = load_interface(loader);
+    }
+    struct_id const struct_count = load_table_size(loader);
+    result.structs = allocate_array(struct_count, sizeof(*result.structs));
+    for (; result.struct_count < struct_count; ++result.struct_count)
+    {
+        result.structs[result.struct_count] = load_structure(loader);
+    }
+    enum_id const enum_count = load_table_size(loader);
+    result.enums = allocate_array(enum_count, sizeof(*result.enums));
+    for (; result.enum_count < enum_count; ++result.enum_count)
+    {
+        result.enums[result.enum_count] = load_enumeration(loader);
+    }
+    loader->memory = NULL;
+    loader->types = NULL;
+    return result;
+}
+
+optional_checked_program load_checked_program(unicode_view const data, structure const globals)
+{
+    optional_checked_program const nothing = {
+        false, {NULL, 0, NULL, 0, {0}, NULL, 0, NULL, 0, {NULL, 0, 0, {NULL, 0, 0}}}};
+    if ((data.length < sizeof(saved_program_magic)) ||
+        memcmp(data.begin, saved_program_magic, sizeof(saved_program_magic)))
+    {
+        return nothing;
+    }
+    program_loader header = {
+        (data.begin + sizeof(saved_program_magic)), (data.begin + data.length), globals, NULL, NULL, false};
+    uint64_t const format_version = load_number(&header);
+    uint64_t const content_length = load_number(&header);
+    uint64_t const checksum = load_number(&header);
+    if (header.is_damaged || (format_version != saved_program_format_version) ||
+        (content_length != (uint64_t)(header.end - header.position)) ||
+        (checksum != hash_bytes(hash_seed, header.position, (size_t)content_length)))
+    {
+        return nothing;
+    }
+    program_loader loader = {header.position, header.end, globals, NULL, NULL, false};
+    size_t const max_heap_size = (size_t)load_number(&loader);
+    checked_program const loaded = load_program(&loader, garbage_collector_create(max_heap_size));
+    if (loader.is_damaged || (loader.position != loader.end))
+    {
+        checked_program_free(&loaded);
+        return nothing;
+    }
+    optional_checked_program const result = {true, loaded};
+    return result;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "lpg_checked_program.h"
+#include "lpg_stream_writer.h"
+#include "lpg_unicode_view.h"
+
+/*Increment this whenever the binary format of a checked program changes.*/
+static uint64_t const saved_program_format_version = 2;
+
+/*Writes a checked program in a compact binary format: a header with the format version and a checksum of the content
+ * followed by the functions, interfaces, structs, enums and every value that the instructions refer to. Numbers are
+ * stored in LEB128 so that most ids and counts take a single byte. An external function can only be saved if it is the
+ * compile time value of one of the globals, so it is stored as the index of that global. Fails if the program contains
+ * anything else that cannot be saved.*/
+success_indicator save_checked_program(LPG_NON_NULL(checked_program const *const program), structure const globals,
+                                       stream_writer const destination) LPG_USE_RESULT;
+
+typedef struct optional_checked_program
+{
+    bool is_set;
+    checked_program value;
+} optional_checked_program;
+
+/*Reads a program written by save_checked_program with the same globals. The data is only read and does not have to
+ * outlive the result, so it can be a mapped file. Returns nothing if the data has been damaged or is in a different
+ * format. The content is not checked any further, so the data has to come from save_checked_program.*/
+optional_checked_program load_checked_program(unicode_view const data, structure const globals) LPG_USE_RESULT;
@@ -1,5 +1,6 @@
 #include "lpg_standard_library.h"
 #include "lpg_allocate.h"
+#include "lpg_arithmetic.h"
 #include "lpg_assert.h"
 #include <string.h>
 
@@ -25,6 +26,7 @@ static void standard_library_stable_free(standard_library_stable *stable)
     function_pointer_free(&stable->not_u64);
     function_pointer_free(&stable->shift_left_u64);
     function_pointer_free(&stable->shift_right_u64);
+    garbage_collector_free(stable->memory);
 }
 
 external_function_result not_impl(value const *const captures, void *environment, optional_value const self,
@@ -34,8 +36,8 @@ external_function_result not_impl(value const *const captures, void *environment
     (void)context;
     (void)environment;
     (void)captures;
-    enum_element_id const argument = arguments[0].enum_element.which;
-    return external_function_result_from_success(value_from_enum_element(!argument, type_from_unit(), NULL));
+    enum_element_id const argument = value_as_enum_element(arguments[0]).which;
+    return external_function_result_from_success(value_from_enum_element(!argument, NULL));
 }
 
 external_function_result concat_impl(value const *const captures, void *environment, optional_value const self,
@@ -44,9 +46,14 @@ external_function_result concat_impl(value const *const captures, void *environm
     (void)self;
     (void)environment;
     (void)captures;
-    unicode_view const left = arguments[0].string;
-    unicode_view const right = arguments[1].string;
-    size_t const result_length = left.length + right.length;
+    unicode_view const left = value_as_string(arguments[0]);
+    unicode_view const right = value_as_string(arguments[1]);
+    optional_size const sum = size_add(left.length, right.length);
+    if ((sum.state == optional_empty) || (sum.value_if_set > value_max_string_length))
+    {
+        return external_function_result_create_out_of_memory();
+    }
+    size_t const result_length = sum.value_if_set;
     char *const result = garbage_collector_try_allocate(context->gc, result_length);
     if (!result)
     {
@@ -64,10 +71,9 @@ external_function_result string_equals_impl(value const *const captures, void *e
     (void)context;
     (void)environment;
     (void)captures;
-    unicode_view const left = arguments[0].string;
-    unicode_view const right = arguments[1].string;
-    return external_function_result_from_success(
-        value_from_enum_element(unicode_view_equals(left, right), type_from_unit(), NULL));
+    unicode_view const left = value_as_string(arguments[0]);
+    unicode_view const right = value_as_string(arguments[1]);
+    return external_function_result_from_success(value_from_enum_element(unicode_view_equals(left, right), NULL));
 }
 
 external_function_result type_equals_impl(value const *const captures, void *environment, optional_value const self,
@@ -77,28 +83,26 @@ external_function_result type_equals_impl(value const *const captures, void *env
     (void)context;
     (void)environment;
     (void)captures;
-    type const left = arguments[0].type_;
-    type const right = arguments[1].type_;
-    return external_function_result_from_success(
-        value_from_enum_element(type_equals(left, right), type_from_unit(), NULL));
+    type const left = value_as_type(arguments[0]);
+    type const right = value_as_type(arguments[1]);
+    return external_function_result_from_success(value_from_enum_element(type_equals(left, right), NULL));
 }
 
 external_function_result int_impl(value const *const captures, void *environment, optional_value const self,
                                   value *const arguments, interpreter *const context)
 {
     (void)self;
-    (void)context;
     (void)environment;
     (void)captures;
-    integer const first = arguments[0].integer_;
-    integer const second = arguments[1].integer_;
+    integer const first = value_as_integer(arguments[0]);
+    integer const second = value_as_integer(arguments[1]);
     if (integer_less(first, second))
     {
         return external_function_result_from_success(
-            value_from_type(type_from_integer_range(integer_range_create(first, second))));
+            value_from_type(type_from_integer_range(integer_range_create(first, second)), context->gc));
     }
     return external_function_result_from_success(
-        value_from_type(type_from_integer_range(integer_range_create(second, first))));
+        value_from_type(type_from_integer_range(integer_range_create(second, first)), context->gc));
 }
 
 external_function_result fail_impl(value const *const captures, void *environment, optional_value const self,
@@ -119,10 +123,9 @@ external_function_result integer_equals_impl(value const *const captures, void *
     (void)context;
     (void)environment;
     (void)captures;
-    integer const left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
-    return external_function_result_from_success(
-        value_from_enum_element(integer_equal(left, right), type_from_unit(), NULL));
+    integer const left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
+    return external_function_result_from_success(value_from_enum_element(integer_equal(left, right), NULL));
 }
 
 external_function_result integer_less_impl(value const *const captures, void *environment, optional_value const self,
@@ -132,10 +135,9 @@ external_function_result integer_less_impl(value const *const captures, void *en
     (void)context;
     (void)environment;
     (void)captures;
-    integer const left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
-    return external_function_result_from_success(
-        value_from_enum_element(integer_less(left, right), type_from_unit(), NULL));
+    integer const left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
+    return external_function_result_from_success(value_from_enum_element(integer_less(left, right), NULL));
 }
 
 external_function_result integer_to_string_impl(value const *const captures, void *environment,
@@ -146,12 +148,22 @@ external_function_result integer_to_string_impl(value const *const captures, voi
     (void)environment;
     (void)captures;
 
-    integer const left = arguments[0].integer_;
+    integer const left = value_as_integer(arguments[0]);
     const unsigned int printing_base = 10;
-    const size_t buffer_max_size = 20;
-    char *buffer = garbage_collector_allocate(context->gc, buffer_max_size);
-    unicode_view const buffer_begin = integer_format(left, lower_case_digits, printing_base, buffer, buffer_max_size);
-    return external_function_result_from_success(value_from_string(buffer_begin));
+    enum
+    {
+        buffer_max_size = 20
+    };
+    char buffer[buffer_max_size];
+    unicode_view const formatted = integer_format(left, lower_case_digits, printing_base, buffer, buffer_max_size);
+    /*the string has to start at the beginning of its allocation so that the garbage collector can find it*/
+    char *const result = garbage_collector_try_allocate(context->gc, formatted.length);
+    if (!result)
+    {
+        return external_function_result_create_out_of_memory();
+    }
+    memcpy(result, formatted.begin, formatted.length);
+    return external_function_result_from_success(value_from_string(unicode_view_create(result, formatted.length)));
 }
 
 external_function_result subtract_impl(value const *const captures, void *environment, optional_value const self,
@@ -160,17 +172,16 @@ external_function_result subtract_impl(value const *const captures, void *enviro
     (void)self;
     (void)environment;
     (void)captures;
-    integer const left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
+    integer const left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
     integer_difference const difference = integer_subtract(left, right);
     if (difference.is_positive)
     {
         value *const state = garbage_collector_allocate(context->gc, sizeof(*state));
-        *state = value_from_integer(difference.value_if_positive);
-        return external_function_result_from_success(
-            value_from_enum_element(0, type_from_integer_range(integer_range_max()), state));
+        *state = value_from_integer(difference.value_if_positive, context->gc);
+        return external_function_result_from_success(value_from_enum_element(0, state));
     }
-    return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+    return external_function_result_from_success(value_from_enum_element(1, NULL));
 }
 
 external_function_result add_impl(value const *const captures, void *environment, optional_value const self,
@@ -179,16 +190,15 @@ external_function_result add_impl(value const *const captures, void *environment
     (void)self;
     (void)environment;
     (void)captures;
-    integer left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
+    integer left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
     if (integer_add(&left, right))
     {
         value *const state = garbage_collector_allocate(context->gc, sizeof(*state));
-        *state = value_from_integer(left);
-        return external_function_result_from_success(
-            value_from_enum_element(0, type_from_integer_range(integer_range_max()), state));
+        *state = value_from_integer(left, context->gc);
+        return external_function_result_from_success(value_from_enum_element(0, state));
     }
-    return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+    return external_function_result_from_success(value_from_enum_element(1, NULL));
 }
 
 external_function_result add_u32_impl(value const *const captures, void *environment, optional_value const self,
@@ -197,16 +207,15 @@ external_function_result add_u32_impl(value const *const captures, void *environ
     (void)self;
     (void)environment;
     (void)captures;
-    integer left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
+    integer left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
     if (integer_add(&left, right) && integer_less_or_equals(left, integer_create(0, UINT32_MAX)))
     {
         value *const state = garbage_collector_allocate(context->gc, sizeof(*state));
-        *state = value_from_integer(left);
-        return external_function_result_from_success(
-            value_from_enum_element(0, type_from_integer_range(integer_range_max()), state));
+        *state = value_from_integer(left, context->gc);
+        return external_function_result_from_success(value_from_enum_element(0, state));
     }
-    return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+    return external_function_result_from_success(value_from_enum_element(1, NULL));
 }
 
 external_function_result add_u64_impl(value const *const captures, void *environment, optional_value const self,
@@ -215,16 +224,15 @@ external_function_result add_u64_impl(value const *const captures, void *environ
     (void)self;
     (void)environment;
     (void)captures;
-    integer left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
+    integer left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
     if (integer_add(&left, right) && integer_less_or_equals(left, integer_create(0, UINT64_MAX)))
     {
         value *const state = garbage_collector_allocate(context->gc, sizeof(*state));
-        *state = value_from_integer(left);
-        return external_function_result_from_success(
-            value_from_enum_element(0, type_from_integer_range(integer_range_max()), state));
+        *state = value_from_integer(left, context->gc);
+        return external_function_result_from_success(value_from_enum_element(0, state));
     }
-    return external_function_result_from_success(value_from_enum_element(1, type_from_unit(), NULL));
+    return external_function_result_from_success(value_from_enum_element(1, NULL));
 }
 
 static external_function_result and_u64_impl(value const *const captures, void *environment, optional_value const self,
@@ -234,9 +242,9 @@ static external_function_result and_u64_impl(value const *const captures, void *
     (void)environment;
     (void)captures;
     (void)context;
-    integer left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
-    return external_function_result_from_success(value_from_integer(integer_create(0, (right.low & left.low))));
+    integer left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
+    return external_function_result_from_success(value_from_small_integer((right.low & left.low)));
 }
 
 static external_function_result or_u64_impl(value const *const captures, void *environment, optional_value const self,
@@ -246,9 +254,9 @@ static external_function_result or_u64_impl(value const *const captures, void *e
     (void)environment;
     (void)captures;
     (void)context;
-    integer left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
-    return external_function_result_from_success(value_from_integer(integer_create(0, (right.low | left.low))));
+    integer left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
+    return external_function_result_from_success(value_from_small_integer((right.low | left.low)));
 }
 
 static external_function_result xor_u64_impl(value const *const captures, void *environment, optional_value const self,
@@ -258,9 +266,9 @@ static external_function_result xor_u64_impl(value const *const captures, void *
     (void)environment;
     (void)captures;
     (void)context;
-    integer left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
-    return external_function_result_from_success(value_from_integer(integer_create(0, (right.low ^ left.low))));
+    integer left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
+    return external_function_result_from_success(value_from_small_integer((right.low ^ left.low)));
 }
 
 static external_function_result not_u64_impl(value const *const captures, void *environment, optional_value const self,
@@ -270,8 +278,8 @@ static external_function_result not_u64_impl(value const *const captures, void *
     (void)environment;
     (void)captures;
     (void)context;
-    integer const input = arguments[0].integer_;
-    return external_function_result_from_success(value_from_integer(integer_create(0, ~input.low)));
+    integer const input = value_as_integer(arguments[0]);
+    return external_function_result_from_success(value_from_small_integer(~input.low));
 }
 
 static external_function_result shift_left_u64_impl(value const *const captures, void *environment,
@@ -282,10 +290,10 @@ static external_function_result shift_left_u64_impl(value const *const captures,
     (void)environment;
     (void)captures;
     (void)context;
-    integer const left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
+    integer const left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
     ASSUME(right.low < 64);
-    return external_function_result_from_success(value_from_integer(integer_create(0, (left.low << right.low))));
+    return external_function_result_from_success(value_from_small_integer((left.low << right.low)));
 }
 
 static external_function_result shift_right_u64_impl(value const *const captures, void *environment,
@@ -296,10 +304,10 @@ static external_function_result shift_right_u64_impl(value const *const captures
     (void)environment;
     (void)captures;
     (void)context;
-    integer const left = arguments[0].integer_;
-    integer const right = arguments[1].integer_;
+    integer const left = value_as_integer(arguments[0]);
+    integer const right = value_as_integer(arguments[1]);
     ASSUME(right.low < 64);
-    return external_function_result_from_success(value_from_integer(integer_create(0, (left.low >> right.low))));
+    return external_function_result_from_success(value_from_small_integer((left.low >> right.low)));
 }
 
 external_function_result side_effect_impl(value const *const captures, void *environment, optional_value const self,
@@ -313,9 +321,17 @@ external_function_result side_effect_impl(value const *const captures, void *env
     return external_function_result_from_success(value_from_unit());
 }
 
+static optional_value external_global(external_function *const function, function_pointer const signature,
+                                      garbage_collector *const boxes)
+{
+    return optional_value_create(
+        value_from_function_pointer(function_pointer_value_from_external(function, NULL, NULL, signature), boxes));
+}
+
 standard_library_description describe_standard_library(void)
 {
     standard_library_stable *const stable = allocate(sizeof(*stable));
+    stable->memory = garbage_collector_create(SIZE_MAX);
 
     type const boolean = type_from_enumeration(standard_library_enum_boolean);
     type const subtract_result = type_from_enumeration(standard_library_enum_subtract_result);
@@ -489,117 +505,100 @@ standard_library_description describe_standard_library(void)
 
     globals[1] = structure_member_create(
         type_from_function_pointer(&stable->integer_to_string), unicode_string_from_c_str("integer_to_string"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(integer_to_string_impl, NULL, NULL, stable->integer_to_string))));
+        external_global(integer_to_string_impl, stable->integer_to_string, &stable->memory));
 
     globals[2] = structure_member_create(
         type_from_function_pointer(&stable->type_equals), unicode_string_from_c_str("type_equals"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(type_equals_impl, NULL, NULL, stable->type_equals))));
+        external_global(type_equals_impl, stable->type_equals, &stable->memory));
 
-    globals[3] = structure_member_create(
-        type_from_type(), unicode_string_from_c_str("boolean"), optional_value_create(value_from_type(boolean)));
+    globals[3] = structure_member_create(type_from_type(), unicode_string_from_c_str("boolean"),
+                                         optional_value_create(value_from_type(boolean, &stable->memory)));
 
     globals[4] = structure_member_create(
         type_from_function_pointer(&stable->assert_), unicode_string_from_c_str("assert"), optional_value_empty);
 
-    globals[5] = structure_member_create(
+    globals[standard_library_integer_less] = structure_member_create(
         type_from_function_pointer(&stable->integer_less), unicode_string_from_c_str("integer_less"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(integer_less_impl, NULL, NULL, stable->integer_less))));
+        external_global(integer_less_impl, stable->integer_less, &stable->memory));
 
-    globals[6] = structure_member_create(
+    globals[standard_library_integer_equals] = structure_member_create(
         type_from_function_pointer(&stable->integer_equals), unicode_string_from_c_str("integer_equals"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(integer_equals_impl, NULL, NULL, stable->integer_equals))));
+        external_global(integer_equals_impl, stable->integer_equals, &stable->memory));
 
     globals[7] = structure_member_create(
         type_from_function_pointer(&stable->not_), unicode_string_from_c_str("not"),
-        optional_value_create(
-            value_from_function_pointer(function_pointer_value_from_external(not_impl, NULL, NULL, stable->not_))));
+        external_global(not_impl, stable->not_, &stable->memory));
 
-    globals[8] =
-        structure_member_create(type_from_function_pointer(&stable->concat), unicode_string_from_c_str("concat"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(concat_impl, NULL, NULL, stable->concat))));
+    globals[8] = structure_member_create(
+        type_from_function_pointer(&stable->concat), unicode_string_from_c_str("concat"),
+        external_global(concat_impl, stable->concat, &stable->memory));
 
-    globals[9] = structure_member_create(
+    globals[standard_library_string_equals] = structure_member_create(
         type_from_function_pointer(&stable->string_equals), unicode_string_from_c_str("string_equals"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(string_equals_impl, NULL, NULL, stable->string_equals))));
+        external_global(string_equals_impl, stable->string_equals, &stable->memory));
 
     globals[10] = structure_member_create(
         type_from_function_pointer(&stable->int_), unicode_string_from_c_str("int"),
-        optional_value_create(
-            value_from_function_pointer(function_pointer_value_from_external(int_impl, NULL, NULL, stable->int_))));
+        external_global(int_impl, stable->int_, &stable->memory));
 
-    globals[11] = structure_member_create(type_from_type(), unicode_string_from_c_str("host_value"),
-                                          optional_value_create(value_from_type(type_from_host_value())));
+    globals[11] =
+        structure_member_create(type_from_type(), unicode_string_from_c_str("host_value"),
+                                optional_value_create(value_from_type(type_from_host_value(), &stable->memory)));
 
     globals[12] = structure_member_create(
         type_from_function_pointer(&stable->fail), unicode_string_from_c_str("fail"), optional_value_empty);
 
     globals[13] = structure_member_create(type_from_type(), unicode_string_from_c_str("subtract_result"),
-                                          optional_value_create(value_from_type(subtract_result)));
+                                          optional_value_create(value_from_type(subtract_result, &stable->memory)));
 
-    globals[14] =
-        structure_member_create(type_from_function_pointer(&stable->subtract), unicode_string_from_c_str("subtract"),
-                                optional_value_create(value_from_function_pointer(function_pointer_value_from_external(
-                                    subtract_impl, NULL, NULL, stable->subtract))));
+    globals[standard_library_subtract] = structure_member_create(
+        type_from_function_pointer(&stable->subtract), unicode_string_from_c_str("subtract"),
+        external_global(subtract_impl, stable->subtract, &stable->memory));
 
-    globals[15] = structure_member_create(
-        type_from_type(), unicode_string_from_c_str("add_result"), optional_value_create(value_from_type(add_result)));
+    globals[15] = structure_member_create(type_from_type(), unicode_string_from_c_str("add_result"),
+                                          optional_value_create(value_from_type(add_result, &stable->memory)));
 
-    globals[16] = structure_member_create(
+    globals[standard_library_add] = structure_member_create(
         type_from_function_pointer(&stable->add), unicode_string_from_c_str("add"),
-        optional_value_create(
-            value_from_function_pointer(function_pointer_value_from_external(add_impl, NULL, NULL, stable->add))));
+        external_global(add_impl, stable->add, &stable->memory));
 
     globals[17] = structure_member_create(type_from_type(), unicode_string_from_c_str("add_u32_result"),
-                                          optional_value_create(value_from_type(add_u32_result)));
+                                          optional_value_create(value_from_type(add_u32_result, &stable->memory)));
 
-    globals[18] =
-        structure_member_create(type_from_function_pointer(&stable->add_u32), unicode_string_from_c_str("add_u32"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(add_u32_impl, NULL, NULL, stable->add_u32))));
+    globals[18] = structure_member_create(
+        type_from_function_pointer(&stable->add_u32), unicode_string_from_c_str("add_u32"),
+        external_global(add_u32_impl, stable->add_u32, &stable->memory));
 
     globals[19] = structure_member_create(type_from_type(), unicode_string_from_c_str("add_u64_result"),
-                                          optional_value_create(value_from_type(add_u64_result)));
+                                          optional_value_create(value_from_type(add_u64_result, &stable->memory)));
 
-    globals[20] =
-        structure_member_create(type_from_function_pointer(&stable->add_u64), unicode_string_from_c_str("add_u64"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(add_u64_impl, NULL, NULL, stable->add_u64))));
+    globals[20] = structure_member_create(
+        type_from_function_pointer(&stable->add_u64), unicode_string_from_c_str("add_u64"),
+        external_global(add_u64_impl, stable->add_u64, &stable->memory));
 
-    globals[21] =
-        structure_member_create(type_from_function_pointer(&stable->and_u64), unicode_string_from_c_str("and_u64"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(and_u64_impl, NULL, NULL, stable->and_u64))));
+    globals[21] = structure_member_create(
+        type_from_function_pointer(&stable->and_u64), unicode_string_from_c_str("and_u64"),
+        external_global(and_u64_impl, stable->and_u64, &stable->memory));
 
-    globals[22] =
-        structure_member_create(type_from_function_pointer(&stable->or_u64), unicode_string_from_c_str("or_u64"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(or_u64_impl, NULL, NULL, stable->or_u64))));
+    globals[22] = structure_member_create(
+        type_from_function_pointer(&stable->or_u64), unicode_string_from_c_str("or_u64"),
+        external_global(or_u64_impl, stable->or_u64, &stable->memory));
 
-    globals[23] =
-        structure_member_create(type_from_function_pointer(&stable->xor_u64), unicode_string_from_c_str("xor_u64"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(xor_u64_impl, NULL, NULL, stable->xor_u64))));
+    globals[23] = structure_member_create(
+        type_from_function_pointer(&stable->xor_u64), unicode_string_from_c_str("xor_u64"),
+        external_global(xor_u64_impl, stable->xor_u64, &stable->memory));
 
-    globals[24] =
-        structure_member_create(type_from_function_pointer(&stable->not_u64), unicode_string_from_c_str("not_u64"),
-                                optional_value_create(value_from_function_pointer(
-                                    function_pointer_value_from_external(not_u64_impl, NULL, NULL, stable->not_u64))));
+    globals[24] = structure_member_create(
+        type_from_function_pointer(&stable->not_u64), unicode_string_from_c_str("not_u64"),
+        external_global(not_u64_impl, stable->not_u64, &stable->memory));
 
     globals[25] = structure_member_create(
         type_from_function_pointer(&stable->shift_left_u64), unicode_string_from_c_str("shift_left_u64"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(shift_left_u64_impl, NULL, NULL, stable->shift_left_u64))));
+        external_global(shift_left_u64_impl, stable->shift_left_u64, &stable->memory));
 
     globals[26] = structure_member_create(
         type_from_function_pointer(&stable->shift_right_u64), unicode_string_from_c_str("shift_right_u64"),
-        optional_value_create(value_from_function_pointer(
-            function_pointer_value_from_external(shift_right_u64_impl, NULL, NULL, stable->shift_right_u64))));
+        external_global(shift_right_u64_impl, stable->shift_right_u64, &stable->memory));
 
     LPG_STATIC_ASSERT(standard_library_element_count == 27);
 
@@ -65,6 +65,8 @@ typedef struct standard_library_stable
     function_pointer not_u64;
     function_pointer shift_left_u64;
     function_pointer shift_right_u64;
+    /*the boxes of the values of the globals*/
+    garbage_collector memory;
 } standard_library_stable;
 
 enum
@@ -77,6 +79,16 @@ enum
     standard_library_element_count = 27
 };
 
+/*the globals that the bytecode calls as builtins (see bytecode_builtin)*/
+enum
+{
+    standard_library_integer_less = 5,
+    standard_library_integer_equals = 6,
+    standard_library_string_equals = 9,
+    standard_library_subtract = 14,
+    standard_library_add = 16
+};
+
 typedef struct standard_library_description
 {
     structure globals;
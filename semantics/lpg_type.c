@@ -3,6 +3,7 @@
 #include "lpg_assert.h"
 #include "lpg_expression.h"
 #include "lpg_for.h"
+#include "lpg_hash.h"
 #include "lpg_structure_member.h"
 
 structure structure_create(structure_member *members, struct_member_id count)
@@ -65,20 +66,38 @@ bool tuple_type_equals(tuple_type const left, tuple_type const right)
     {
         return false;
     }
-    for (size_t i = 0; i < left.length; ++i)
-    {
-        if (!type_equals(left.elements[i], right.elements[i]))
-        {
-            return false;
-        }
-    }
-    return true;
+    /*interned tuples share their elements*/
+    return (left.length == 0) || (left.elements == right.elements);
+}
+
+static uint64_t hash_method_name(unicode_view const name)
+{
+    return hash_bytes(hash_seed, name.begin, name.length);
+}
+
+static uint64_t hash_implementation_self(type const self)
+{
+    return type_hash(hash_seed, self);
 }
 
 lpg_interface interface_create(method_description *methods, function_id method_count,
                                implementation_entry *implementations, size_t implementation_count)
 {
-    lpg_interface const result = {methods, method_count, implementations, implementation_count};
+    lpg_interface result = {methods,
+                            method_count,
+                            implementations,
+                            implementation_count,
+                            implementation_count,
+                            position_index_create(),
+                            position_index_create()};
+    for (function_id i = 0; i < method_count; ++i)
+    {
+        position_index_insert(&result.method_index, hash_method_name(unicode_view_from_string(methods[i].name)), i);
+    }
+    for (size_t i = 0; i < implementation_count; ++i)
+    {
+        position_index_insert(&result.implementation_index, hash_implementation_self(implementations[i].self), i);
+    }
     return result;
 }
 
@@ -100,6 +119,89 @@ void interface_free(lpg_interface const freed)
     {
         deallocate(freed.implementations);
     }
+    position_index_free(freed.method_index);
+    position_index_free(freed.implementation_index);
+}
+
+void interface_define_methods(lpg_interface *const to, method_description *methods, function_id const method_count)
+{
+    ASSUME(to->method_count == 0);
+    to->methods = methods;
+    to->method_count = method_count;
+    for (function_id i = 0; i < method_count; ++i)
+    {
+        position_index_insert(&to->method_index, hash_method_name(unicode_view_from_string(methods[i].name)), i);
+    }
+}
+
+size_t interface_add_implementation(lpg_interface *const to, implementation_entry const added)
+{
+    size_t const id = to->implementation_count;
+    to->implementations = reallocate_array_exponentially(
+        to->implementations, (id + 1), sizeof(*to->implementations), id, &to->implementation_capacity);
+    to->implementations[id] = added;
+    to->implementation_count += 1;
+    position_index_insert(&to->implementation_index, hash_implementation_self(added.self), id);
+    return id;
+}
+
+void interface_truncate_implementations(lpg_interface *const truncated, size_t const count)
+{
+    ASSUME(count <= truncated->implementation_count);
+    if (count == truncated->implementation_count)
+    {
+        return;
+    }
+    for (size_t i = count; i < truncated->implementation_count; ++i)
+    {
+        implementation_entry_free(truncated->implementations[i]);
+    }
+    truncated->implementation_count = count;
+    /*the index cannot forget single positions*/
+    position_index_free(truncated->implementation_index);
+    truncated->implementation_index = position_index_create();
+    for (size_t i = 0; i < count; ++i)
+    {
+        position_index_insert(
+            &truncated->implementation_index, hash_implementation_self(truncated->implementations[i].self), i);
+    }
+}
+
+typedef struct method_search
+{
+    lpg_interface const *in;
+    unicode_view name;
+} method_search;
+
+static bool is_searched_method(void const *user, size_t const position)
+{
+    method_search const *const search = user;
+    return unicode_view_equals(unicode_view_from_string(search->in->methods[position].name), search->name);
+}
+
+optional_size interface_find_method(lpg_interface const *const in, unicode_view const name)
+{
+    method_search const search = {in, name};
+    return position_index_find(in->method_index, hash_method_name(name), is_searched_method, &search);
+}
+
+typedef struct implementation_search
+{
+    lpg_interface const *in;
+    type self;
+} implementation_search;
+
+static bool is_searched_implementation(void const *user, size_t const position)
+{
+    implementation_search const *const search = user;
+    return type_equals(search->in->implementations[position].self, search->self);
+}
+
+optional_size interface_find_implementation(lpg_interface const *const in, type const self)
+{
+    implementation_search const search = {in, self};
+    return position_index_find(
+        in->implementation_index, hash_implementation_self(self), is_searched_implementation, &search);
 }
 
 lambda_type lambda_type_create(function_id const function)
@@ -388,7 +490,8 @@ bool type_equals(type const left, type const right)
         return (enum_constructor_type_equals(*left.enum_constructor, *right.enum_constructor));
 
     case type_kind_function_pointer:
-        return function_pointer_equals(*left.function_pointer_, *right.function_pointer_);
+        /*an interned function pointer is only equal to itself*/
+        return (left.function_pointer_ == right.function_pointer_);
 
     case type_kind_enumeration:
         return (left.enum_ == right.enum_);
@@ -402,99 +505,75 @@ bool type_equals(type const left, type const right)
     LPG_UNREACHABLE();
 }
 
-type type_clone(type const original, garbage_collector *const clone_gc, function_id const *const new_function_ids)
+static uint64_t hash_number(uint64_t const previous, uint64_t const number)
 {
-    switch (original.kind)
-    {
-    case type_kind_generic_struct:
-        return type_from_generic_struct();
-
-    case type_kind_host_value:
-        return type_from_host_value();
-
-    case type_kind_generic_lambda:
-        return type_from_generic_lambda();
+    return hash_bytes(previous, (char const *)&number, sizeof(number));
+}
 
-    case type_kind_lambda:
-        ASSUME(new_function_ids[original.lambda.lambda] != ~(register_id)0);
-        return type_from_lambda(lambda_type_create(new_function_ids[original.lambda.lambda]));
+static uint64_t hash_address(uint64_t const previous, void const *const address)
+{
+    return hash_number(previous, (uint64_t)(uintptr_t)address);
+}
 
-    case type_kind_function_pointer:
+static uint64_t tuple_type_hash(uint64_t const previous, tuple_type const hashed)
+{
+    uint64_t const result = hash_number(previous, hashed.length);
+    if (hashed.length == 0)
     {
-        function_pointer *const copy = garbage_collector_allocate(clone_gc, sizeof(*copy));
-        type *const arguments = garbage_collector_allocate_array(
-            clone_gc, original.function_pointer_->parameters.length, sizeof(*arguments));
-        for (size_t i = 0; i < original.function_pointer_->parameters.length; ++i)
-        {
-            arguments[i] = type_clone(original.function_pointer_->parameters.elements[i], clone_gc, new_function_ids);
-        }
-        type *const captures =
-            garbage_collector_allocate_array(clone_gc, original.function_pointer_->captures.length, sizeof(*captures));
-        for (size_t i = 0; i < original.function_pointer_->captures.length; ++i)
-        {
-            captures[i] = type_clone(original.function_pointer_->captures.elements[i], clone_gc, new_function_ids);
-        }
-        *copy =
-            function_pointer_create(optional_type_clone(original.function_pointer_->result, clone_gc, new_function_ids),
-                                    tuple_type_create(arguments, original.function_pointer_->parameters.length),
-                                    tuple_type_create(captures, original.function_pointer_->captures.length),
-                                    optional_type_clone(original.function_pointer_->self, clone_gc, new_function_ids));
-        return type_from_function_pointer(copy);
+        return result;
     }
+    return hash_address(result, hashed.elements);
+}
 
+uint64_t type_hash(uint64_t const previous, type const hashed)
+{
+    uint64_t const result = hash_number(previous, hashed.kind);
+    switch (hashed.kind)
+    {
+    case type_kind_generic_struct:
+    case type_kind_host_value:
+    case type_kind_generic_lambda:
+    case type_kind_generic_enum:
+    case type_kind_generic_interface:
     case type_kind_unit:
     case type_kind_string:
-    case type_kind_enumeration:
+    case type_kind_type:
+        return result;
+
+    case type_kind_method_pointer:
+        return hash_number(hash_number(result, hashed.method_pointer.interface_), hashed.method_pointer.method_index);
+
     case type_kind_interface:
-    case type_kind_integer_range:
-        return original;
+        return hash_number(result, hashed.interface_);
 
-    case type_kind_tuple:
-    {
-        type *const elements = garbage_collector_allocate_array(clone_gc, original.tuple_.length, sizeof(*elements));
-        for (size_t i = 0; i < original.tuple_.length; ++i)
-        {
-            elements[i] = type_clone(original.tuple_.elements[i], clone_gc, new_function_ids);
-        }
-        return type_from_tuple_type(tuple_type_create(elements, original.tuple_.length));
-    }
+    case type_kind_lambda:
+        return hash_number(result, hashed.lambda.lambda);
 
-    case type_kind_type:
-        return type_from_type();
+    case type_kind_structure:
+        return hash_number(result, hashed.structure_);
 
     case type_kind_enum_constructor:
-    {
-        enum_constructor_type *const enum_constructor = garbage_collector_allocate(clone_gc, sizeof(*enum_constructor));
-        *enum_constructor =
-            enum_constructor_type_create(original.enum_constructor->enumeration, original.enum_constructor->which);
-        return type_from_enum_constructor(enum_constructor);
-    }
+        return hash_number(
+            hash_number(result, hashed.enum_constructor->enumeration), hashed.enum_constructor->which);
 
-    case type_kind_structure:
-        return type_from_struct(original.structure_);
+    case type_kind_function_pointer:
+        return hash_address(result, hashed.function_pointer_);
 
-    case type_kind_method_pointer:
-        LPG_TO_DO();
+    case type_kind_enumeration:
+        return hash_number(result, hashed.enum_);
 
-    case type_kind_generic_interface:
-        return type_from_generic_interface();
+    case type_kind_tuple:
+        return tuple_type_hash(result, hashed.tuple_);
 
-    case type_kind_generic_enum:
-        return type_from_generic_enum();
+    case type_kind_integer_range:
+        return hash_number(hash_number(hash_number(hash_number(result, hashed.integer_range_.minimum.high),
+                                                   hashed.integer_range_.minimum.low),
+                                       hashed.integer_range_.maximum.high),
+                           hashed.integer_range_.maximum.low);
     }
     LPG_UNREACHABLE();
 }
 
-optional_type optional_type_clone(optional_type const original, garbage_collector *const clone_gc,
-                                  function_id const *const new_function_ids)
-{
-    if (!original.is_set)
-    {
-        return original;
-    }
-    return optional_type_create_set(type_clone(original.value, clone_gc, new_function_ids));
-}
-
 bool type_is_valid(type const checked)
 {
     if ((checked.kind < type_kind_structure) || (checked.kind > type_kind_generic_struct))
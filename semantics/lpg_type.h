@@ -7,6 +7,7 @@
 #include "lpg_integer.h"
 #include "lpg_integer_range.h"
 #include "lpg_interface_id.h"
+#include "lpg_position_index.h"
 #include "lpg_struct_id.h"
 #include "lpg_struct_member_id.h"
 #include "lpg_unicode_string.h"
@@ -43,6 +44,8 @@ typedef struct tuple_type
 } tuple_type;
 
 tuple_type tuple_type_create(type *elements, size_t length);
+/*Interned tuples are equal exactly if they share their elements. Tuples that have not been interned are only equal to
+ * the tuples that share their elements, too.*/
 bool tuple_type_equals(tuple_type const left, tuple_type const right);
 
 typedef struct method_description method_description;
@@ -54,6 +57,11 @@ typedef struct lpg_interface
     function_id method_count;
     implementation_entry *implementations;
     size_t implementation_count;
+    size_t implementation_capacity;
+    /*finds methods by name*/
+    position_index method_index;
+    /*finds implementations by their self type*/
+    position_index implementation_index;
 } lpg_interface;
 
 lpg_interface interface_create(method_description *methods, function_id method_count,
@@ -100,6 +108,9 @@ typedef struct method_pointer_type
 method_pointer_type method_pointer_type_create(interface_id interface_, size_t method_index);
 bool method_pointer_type_equals(method_pointer_type const left, method_pointer_type const right);
 
+/*Every type is identified by its kind and its content: the id of a structure, enumeration, interface, lambda or method,
+ * the bounds of an integer range or the address of an interned function pointer or tuple (see type_interner). Types
+ * are never compared by their elements, so types with different identities are different.*/
 struct type
 {
     type_kind kind;
@@ -165,6 +176,18 @@ struct implementation_entry
 implementation_entry implementation_entry_create(type self, implementation target);
 void implementation_entry_free(implementation_entry const freed);
 
+/*the interface takes ownership of the methods*/
+void interface_define_methods(LPG_NON_NULL(lpg_interface *const to), method_description *methods,
+                              function_id const method_count);
+/*returns the index of the new implementation*/
+size_t interface_add_implementation(LPG_NON_NULL(lpg_interface *const to), implementation_entry const added);
+/*frees the implementations that have been added after the first count ones*/
+void interface_truncate_implementations(LPG_NON_NULL(lpg_interface *const truncated), size_t const count);
+optional_size interface_find_method(LPG_NON_NULL(lpg_interface const *const in), unicode_view const name)
+    LPG_USE_RESULT;
+optional_size interface_find_implementation(LPG_NON_NULL(lpg_interface const *const in), type const self)
+    LPG_USE_RESULT;
+
 struct enumeration_element
 {
     unicode_string name;
@@ -184,6 +207,8 @@ struct function_pointer
 
 function_pointer function_pointer_create(optional_type result, tuple_type parameters, tuple_type captures,
                                          optional_type self);
+/*compares the result, the parameters, the captures and self of two function pointers by their identities, so it finds
+ * an interned function pointer with the same interned parts*/
 bool function_pointer_equals(function_pointer const left, function_pointer const right);
 
 type type_from_function_pointer(function_pointer const *pointer);
@@ -205,9 +230,8 @@ type type_from_generic_struct(void);
 type type_from_host_value(void);
 type *type_allocate(type const content);
 bool type_equals(type const left, type const right);
-type type_clone(type const original, garbage_collector *const clone_gc, function_id const *const new_function_ids);
-optional_type optional_type_clone(optional_type const original, garbage_collector *const clone_gc,
-                                  function_id const *const new_function_ids);
+/*types that are equal according to type_equals have the same hash*/
+uint64_t type_hash(uint64_t const previous, type const hashed) LPG_USE_RESULT;
 bool type_is_valid(type const checked);
 
 void function_pointer_free(LPG_NON_NULL(function_pointer const *freed));
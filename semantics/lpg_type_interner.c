@@ -0,0 +1,229 @@
+#include "lpg_type_interner.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_hash.h"
+#include <string.h>
+
+type_interner type_interner_create(void)
+{
+    type_interner const result = {NULL, 0, 0, position_index_create()};
+    return result;
+}
+
+void type_interner_free(type_interner const freed)
+{
+    if (freed.types)
+    {
+        deallocate(freed.types);
+    }
+    position_index_free(freed.index);
+}
+
+/*The parts of a candidate are interned already, so comparing and hashing them by their identities finds the interned
+ * copy of the candidate.*/
+static bool has_same_parts(type const interned, type const candidate)
+{
+    if (interned.kind != candidate.kind)
+    {
+        return false;
+    }
+    if (interned.kind == type_kind_function_pointer)
+    {
+        return function_pointer_equals(*interned.function_pointer_, *candidate.function_pointer_);
+    }
+    ASSUME(interned.kind == type_kind_tuple);
+    if (interned.tuple_.length != candidate.tuple_.length)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < interned.tuple_.length; ++i)
+    {
+        if (!type_equals(interned.tuple_.elements[i], candidate.tuple_.elements[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t hash_optional_part(uint64_t const previous, optional_type const part)
+{
+    uint64_t const result = hash_bytes(previous, (char const *)&part.is_set, sizeof(part.is_set));
+    return part.is_set ? type_hash(result, part.value) : result;
+}
+
+static uint64_t hash_parts(type const candidate)
+{
+    uint64_t result = hash_bytes(hash_seed, (char const *)&candidate.kind, sizeof(candidate.kind));
+    if (candidate.kind == type_kind_function_pointer)
+    {
+        function_pointer const *const pointer = candidate.function_pointer_;
+        result = hash_optional_part(result, pointer->result);
+        result = type_hash(result, type_from_tuple_type(pointer->parameters));
+        result = type_hash(result, type_from_tuple_type(pointer->captures));
+        return hash_optional_part(result, pointer->self);
+    }
+    ASSUME(candidate.kind == type_kind_tuple);
+    for (size_t i = 0; i < candidate.tuple_.length; ++i)
+    {
+        result = type_hash(result, candidate.tuple_.elements[i]);
+    }
+    return result;
+}
+
+typedef struct type_comparison
+{
+    type_interner const *interner;
+    type candidate;
+} type_comparison;
+
+static bool is_equal_type(void const *user, size_t const position)
+{
+    type_comparison const *const comparison = user;
+    return has_same_parts(comparison->interner->types[position], comparison->candidate);
+}
+
+static bool try_intern(type_interner *const interner, garbage_collector *const memory, type const interned,
+                       type *const result);
+
+static bool try_intern_optional(type_interner *const interner, garbage_collector *const memory,
+                                optional_type const original, optional_type *const result)
+{
+    *result = original;
+    return !original.is_set || try_intern(interner, memory, original.value, &result->value);
+}
+
+static bool try_intern_tuple(type_interner *const interner, garbage_collector *const memory, tuple_type const original,
+                             tuple_type *const result)
+{
+    type interned;
+    if (!try_intern(interner, memory, type_from_tuple_type(original), &interned))
+    {
+        return false;
+    }
+    *result = interned.tuple_;
+    return true;
+}
+
+static bool find_or_insert(type_interner *const interner, garbage_collector *const memory, type const candidate,
+                           type *const result)
+{
+    uint64_t const hash = hash_parts(candidate);
+    type_comparison const comparison = {interner, candidate};
+    optional_size const found = position_index_find(interner->index, hash, is_equal_type, &comparison);
+    if (found.state == optional_set)
+    {
+        *result = interner->types[found.value_if_set];
+        return true;
+    }
+    if (candidate.kind == type_kind_function_pointer)
+    {
+        function_pointer *const copy = garbage_collector_try_allocate(memory, sizeof(*copy));
+        if (!copy)
+        {
+            return false;
+        }
+        *copy = *candidate.function_pointer_;
+        *result = type_from_function_pointer(copy);
+    }
+    else
+    {
+        type *const elements =
+            candidate.tuple_.length
+                ? garbage_collector_try_allocate_array(memory, candidate.tuple_.length, sizeof(*elements))
+                : NULL;
+        if (candidate.tuple_.length && !elements)
+        {
+            return false;
+        }
+        if (elements)
+        {
+            memcpy(elements, candidate.tuple_.elements, candidate.tuple_.length * sizeof(*elements));
+        }
+        *result = type_from_tuple_type(tuple_type_create(elements, candidate.tuple_.length));
+    }
+    interner->types = reallocate_array_exponentially(
+        interner->types, interner->count + 1, sizeof(*interner->types), interner->count, &interner->capacity);
+    interner->types[interner->count] = *result;
+    position_index_insert(&interner->index, hash, interner->count);
+    ++interner->count;
+    return true;
+}
+
+static bool try_intern(type_interner *const interner, garbage_collector *const memory, type const interned,
+                       type *const result)
+{
+    switch (interned.kind)
+    {
+    case type_kind_function_pointer:
+    {
+        /*the parameters and captures become interned tuples, so the tuple types of them are canonical, too*/
+        function_pointer candidate;
+        if (!try_intern_optional(interner, memory, interned.function_pointer_->result, &candidate.result) ||
+            !try_intern_tuple(interner, memory, interned.function_pointer_->parameters, &candidate.parameters) ||
+            !try_intern_tuple(interner, memory, interned.function_pointer_->captures, &candidate.captures) ||
+            !try_intern_optional(interner, memory, interned.function_pointer_->self, &candidate.self))
+        {
+            return false;
+        }
+        return find_or_insert(interner, memory, type_from_function_pointer(&candidate), result);
+    }
+
+    case type_kind_tuple:
+    {
+        if (interned.tuple_.length == 0)
+        {
+            return find_or_insert(interner, memory, interned, result);
+        }
+        type *const elements = allocate_array(interned.tuple_.length, sizeof(*elements));
+        bool success = true;
+        for (size_t i = 0; success && (i < interned.tuple_.length); ++i)
+        {
+            success = try_intern(interner, memory, interned.tuple_.elements[i], elements + i);
+        }
+        success = success && find_or_insert(interner, memory,
+                                            type_from_tuple_type(tuple_type_create(elements, interned.tuple_.length)),
+                                            result);
+        deallocate(elements);
+        return success;
+    }
+
+    case type_kind_structure:
+    case type_kind_unit:
+    case type_kind_string:
+    case type_kind_enumeration:
+    case type_kind_type:
+    case type_kind_integer_range:
+    case type_kind_enum_constructor:
+    case type_kind_lambda:
+    case type_kind_interface:
+    case type_kind_method_pointer:
+    case type_kind_generic_enum:
+    case type_kind_generic_interface:
+    case type_kind_generic_lambda:
+    case type_kind_host_value:
+    case type_kind_generic_struct:
+        /*these are identified by ids or by their value already*/
+        *result = interned;
+        return true;
+    }
+    LPG_UNREACHABLE();
+}
+
+type type_interner_intern(type_interner *const interner, garbage_collector *const memory, type const interned)
+{
+    type result;
+    ASSERT(try_intern(interner, memory, interned, &result));
+    return result;
+}
+
+optional_type type_interner_try_intern(type_interner *const interner, garbage_collector *const memory,
+                                       type const interned)
+{
+    type result;
+    if (try_intern(interner, memory, interned, &result))
+    {
+        return optional_type_create_set(result);
+    }
+    return optional_type_create_empty();
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "lpg_position_index.h"
+#include "lpg_type.h"
+
+/*Keeps a single copy of every function pointer and tuple type that is interned. Equal types of these kinds share their
+ * memory afterwards, and the address is the identity that type_equals compares. Every type of these kinds that is
+ * compared with another one has to be interned in the same interner first.*/
+typedef struct type_interner
+{
+    type *types;
+    size_t count;
+    size_t capacity;
+    position_index index;
+} type_interner;
+
+type_interner type_interner_create(void) LPG_USE_RESULT;
+void type_interner_free(type_interner const freed);
+/*Returns the copy of the type with the same elements. A function pointer or tuple type that has not been interned before
+ * is copied into the memory of the program. The parameters and captures of a function pointer are interned as tuples.
+ * Every other kind of type is returned as it is.*/
+type type_interner_intern(LPG_NON_NULL(type_interner *const interner), LPG_NON_NULL(garbage_collector *const memory),
+                          type const interned) LPG_USE_RESULT;
+/*Like type_interner_intern, but returns nothing if the memory of the program runs out*/
+optional_type type_interner_try_intern(LPG_NON_NULL(type_interner *const interner),
+                                       LPG_NON_NULL(garbage_collector *const memory), type const interned) LPG_USE_RESULT;
@@ -1,6 +1,7 @@
 #include "lpg_value.h"
 #include "lpg_allocate.h"
 #include "lpg_assert.h"
+#include "lpg_hash.h"
 
 implementation_ref implementation_ref_create(interface_id const target, size_t implementation_index)
 {
@@ -74,9 +75,9 @@ value_tuple value_tuple_create(struct value *elements, size_t element_count)
     return result;
 }
 
-enum_element_value enum_element_value_create(enum_element_id which, struct value *state, type state_type)
+enum_element_value enum_element_value_create(enum_element_id which, struct value *state)
 {
-    enum_element_value const result = {which, state, state_type};
+    enum_element_value const result = {which, state};
     return result;
 }
 
@@ -93,12 +94,82 @@ structure_value structure_value_create(struct value const *members, size_t count
     return result;
 }
 
+size_t array_storage_element_size(array_storage const storage)
+{
+    switch (storage)
+    {
+    case array_storage_values:
+        return sizeof(value);
+
+    case array_storage_integers:
+        return sizeof(uint64_t);
+
+    case array_storage_enum_elements:
+        return sizeof(uint8_t);
+    }
+    LPG_UNREACHABLE();
+}
+
 array_value array_value_create(struct value *elements, size_t count, size_t allocated, type element_type)
 {
-    array_value const result = {elements, count, allocated, element_type};
+    array_value result;
+    result.storage = array_storage_values;
+    result.elements = elements;
+    result.count = count;
+    result.allocated = allocated;
+    result.element_type = element_type;
+    return result;
+}
+
+array_value array_value_create_empty(array_storage const storage, type element_type)
+{
+    array_value result = array_value_create(NULL, 0, 0, element_type);
+    result.storage = storage;
     return result;
 }
 
+value array_value_load(array_value const from, size_t const index)
+{
+    ASSUME(index < from.count);
+    switch (from.storage)
+    {
+    case array_storage_values:
+        return from.elements[index];
+
+    case array_storage_integers:
+        return value_from_small_integer(from.integers[index]);
+
+    case array_storage_enum_elements:
+        return value_from_enum_element(from.enum_elements[index], NULL);
+    }
+    LPG_UNREACHABLE();
+}
+
+void array_value_store(array_value *const into, size_t const index, value const element)
+{
+    ASSUME(index < into->count);
+    switch (into->storage)
+    {
+    case array_storage_values:
+        into->elements[index] = element;
+        return;
+
+    case array_storage_integers:
+        ASSUME(element.kind == value_kind_integer);
+        ASSUME(!element.is_big);
+        into->integers[index] = element.small_integer;
+        return;
+
+    case array_storage_enum_elements:
+        ASSUME(element.kind == value_kind_enum_element);
+        ASSUME(element.which <= UINT8_MAX);
+        ASSUME(!element.enum_state);
+        into->enum_elements[index] = (uint8_t)element.which;
+        return;
+    }
+    LPG_UNREACHABLE();
+}
+
 bool array_value_equals(array_value const left, array_value const right)
 {
     if (left.count != right.count)
@@ -115,7 +186,7 @@ bool array_value_equals(array_value const left, array_value const right)
     }
     for (size_t i = 0; i < left.count; ++i)
     {
-        if (!value_equals(left.elements[i], right.elements[i]))
+        if (!value_equals(array_value_load(left, i), array_value_load(right, i)))
         {
             return false;
         }
@@ -123,53 +194,75 @@ bool array_value_equals(array_value const left, array_value const right)
     return true;
 }
 
-value value_from_function_pointer(function_pointer_value pointer)
+value value_from_function_pointer(function_pointer_value const pointer, garbage_collector *const gc)
 {
     value result;
     result.kind = value_kind_function_pointer;
-    result.function_pointer = pointer;
+    result.code = pointer.code;
+    if (!pointer.external && (pointer.capture_count == 0))
+    {
+        result.boxed_function = NULL;
+        return result;
+    }
+    function_pointer_value *const box = garbage_collector_allocate(gc, sizeof(*box));
+    *box = pointer;
+    result.boxed_function = box;
     return result;
 }
 
-value value_from_string(unicode_view const string)
+function_pointer_value value_as_function_pointer(value const from)
 {
-    value result;
-    result.kind = value_kind_string;
-    result.string = string;
-    return result;
+    ASSUME(from.kind == value_kind_function_pointer);
+    if (from.boxed_function)
+    {
+        return *from.boxed_function;
+    }
+    return function_pointer_value_from_internal(from.code, NULL, 0);
 }
 
-value value_from_type(type const type_)
+value value_from_string(unicode_view const string)
 {
+    ASSUME(string.length <= value_max_string_length);
     value result;
-    result.kind = value_kind_type;
-    result.type_ = type_;
+    result.kind = value_kind_string;
+    result.count = (uint32_t)string.length;
+    result.string_begin = string.begin;
     return result;
 }
 
-value value_from_enum_element(enum_element_id const element, type const state_type, value *const state)
+value value_from_type(type const type_, garbage_collector *const gc)
 {
+    type *const box = garbage_collector_allocate(gc, sizeof(*box));
+    *box = type_;
     value result;
-    result.kind = value_kind_enum_element;
-    result.enum_element.which = element;
-    result.enum_element.state = state;
-    result.enum_element.state_type = state_type;
+    result.kind = value_kind_type;
+    result.count = 0;
+    result.boxed_type = box;
     return result;
 }
 
-value value_from_integer(integer const content)
+value value_from_integer(integer const content, garbage_collector *const gc)
 {
+    if (integer_is_small(content))
+    {
+        return value_from_small_integer(content.low);
+    }
+    integer *const box = garbage_collector_allocate(gc, sizeof(*box));
+    *box = content;
     value result;
     result.kind = value_kind_integer;
-    result.integer_ = content;
+    result.is_big = 1;
+    result.big_integer = box;
     return result;
 }
 
 value value_from_tuple(value_tuple content)
 {
+    ASSUME(content.element_count <= UINT32_MAX);
     value result;
     result.kind = value_kind_tuple;
-    result.tuple_ = content;
+    result.count = (uint32_t)content.element_count;
+    result.tuple_elements = content.elements;
     return result;
 }
 
@@ -177,14 +270,20 @@ value value_from_enum_constructor(void)
 {
     value result;
     result.kind = value_kind_enum_constructor;
+    result.count = 0;
+    result.small_integer = 0;
     return result;
 }
 
-value value_from_type_erased(type_erased_value content)
+value value_from_type_erased(implementation_ref const impl, value const self, garbage_collector *const gc)
 {
+    type_erased_box *const box = garbage_collector_allocate(gc, sizeof(*box));
+    box->implementation_index = impl.implementation_index;
+    box->self = self;
     value result;
     result.kind = value_kind_type_erased;
-    result.type_erased = content;
+    result.interface_ = impl.target;
+    result.type_erased = box;
     return result;
 }
 
@@ -192,6 +291,8 @@ value value_from_generic_enum(generic_enum_id content)
 {
     value result;
     result.kind = value_kind_generic_enum;
+    result.count = 0;
+    result.small_integer = 0;
     result.generic_enum = content;
     return result;
 }
@@ -200,6 +301,8 @@ value value_from_generic_interface(generic_interface_id content)
 {
     value result;
     result.kind = value_kind_generic_interface;
+    result.count = 0;
+    result.small_integer = 0;
     result.generic_interface = content;
     return result;
 }
@@ -208,6 +311,7 @@ value value_from_array(array_value *content)
 {
     value result;
     result.kind = value_kind_array;
+    result.count = 0;
     result.array = content;
     return result;
 }
@@ -216,7 +320,9 @@ value value_from_generic_lambda(generic_lambda_id content)
 {
     value result;
     result.kind = value_kind_generic_lambda;
-    result.generic_interface = content;
+    result.count = 0;
+    result.small_integer = 0;
+    result.generic_lambda = content;
     return result;
 }
 
@@ -229,6 +335,8 @@ value value_from_generic_struct(generic_struct_id content)
 {
     value result;
     result.kind = value_kind_generic_struct;
+    result.count = 0;
+    result.small_integer = 0;
     result.generic_struct = content;
     return result;
 }
@@ -269,43 +377,37 @@ bool value_equals(value const left, value const right)
         LPG_TO_DO();
 
     case value_kind_integer:
-        return integer_equal(left.integer_, right.integer_);
+        return integer_equal(value_as_integer(left), value_as_integer(right));
 
     case value_kind_string:
-        return unicode_view_equals(left.string, right.string);
+        return unicode_view_equals(value_as_string(left), value_as_string(right));
 
     case value_kind_function_pointer:
-        return function_pointer_value_equals(left.function_pointer, right.function_pointer);
+        return function_pointer_value_equals(value_as_function_pointer(left), value_as_function_pointer(right));
 
     case value_kind_type:
-        return type_equals(left.type_, right.type_);
+        return type_equals(value_as_type(left), value_as_type(right));
 
     case value_kind_enum_element:
     {
-        if (left.enum_element.which != right.enum_element.which)
+        if (left.which != right.which)
         {
             return false;
         }
-        if (!type_equals(left.enum_element.state_type, right.enum_element.state_type))
-        {
-            return false;
-        }
-        value const left_state = left.enum_element.state ? *left.enum_element.state : value_from_unit();
-        value const right_state = right.enum_element.state ? *right.enum_element.state : value_from_unit();
-        return value_equals(left_state, right_state);
+        return value_equals(value_or_unit(left.enum_state), value_or_unit(right.enum_state));
     }
 
     case value_kind_unit:
         return true;
 
     case value_kind_tuple:
-        if (left.tuple_.element_count != right.tuple_.element_count)
+        if (left.count != right.count)
         {
             return false;
         }
-        for (size_t i = 0; i < left.tuple_.element_count; ++i)
+        for (size_t i = 0; i < left.count; ++i)
         {
-            if (!value_equals(left.tuple_.elements[i], right.tuple_.elements[i]))
+            if (!value_equals(left.tuple_elements[i], right.tuple_elements[i]))
             {
                 return false;
             }
@@ -315,6 +417,91 @@ bool value_equals(value const left, value const right)
     LPG_UNREACHABLE();
 }
 
+static uint64_t hash_number(uint64_t const previous, uint64_t const number)
+{
+    return hash_bytes(previous, (char const *)&number, sizeof(number));
+}
+
+static uint64_t values_hash(uint64_t const previous, value const *const hashed, size_t const count)
+{
+    uint64_t result = hash_number(previous, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        result = value_hash(result, hashed[i]);
+    }
+    return result;
+}
+
+uint64_t value_hash(uint64_t const previous, value const hashed)
+{
+    ASSUME(value_is_valid(hashed));
+    uint64_t const result = hash_number(previous, hashed.kind);
+    switch (hashed.kind)
+    {
+    case value_kind_generic_lambda:
+        return hash_number(result, hashed.generic_lambda);
+
+    case value_kind_generic_enum:
+        return hash_number(result, hashed.generic_enum);
+
+    case value_kind_generic_interface:
+        return hash_number(result, hashed.generic_interface);
+
+    case value_kind_generic_struct:
+        return hash_number(result, hashed.generic_struct);
+
+    case value_kind_array:
+        return type_hash(hash_number(result, hashed.array->count), hashed.array->element_type);
+
+    case value_kind_type_erased:
+        return value_hash(
+            hash_number(hash_number(result, hashed.interface_), hashed.type_erased->implementation_index),
+            hashed.type_erased->self);
+
+    case value_kind_structure:
+        return values_hash(result, hashed.structure_members, hashed.count);
+
+    case value_kind_pattern:
+    case value_kind_enum_constructor:
+    case value_kind_unit:
+        return result;
+
+    case value_kind_integer:
+    {
+        integer const content = value_as_integer(hashed);
+        return hash_number(hash_number(result, content.high), content.low);
+    }
+
+    case value_kind_string:
+    {
+        unicode_view const content = value_as_string(hashed);
+        return hash_bytes(hash_number(result, content.length), content.begin, content.length);
+    }
+
+    case value_kind_function_pointer:
+    {
+        function_pointer_value const content = value_as_function_pointer(hashed);
+        if (content.external)
+        {
+            return hash_bytes(
+                hash_bytes(result, (char const *)&content.external, sizeof(content.external)),
+                (char const *)&content.external_environment, sizeof(content.external_environment));
+        }
+        return values_hash(hash_number(result, content.code), content.captures, content.capture_count);
+    }
+
+    case value_kind_type:
+        return type_hash(result, value_as_type(hashed));
+
+    case value_kind_enum_element:
+        return value_hash(hash_number(result, hashed.which), value_or_unit(hashed.enum_state));
+
+    case value_kind_tuple:
+        return values_hash(result, hashed.tuple_elements, hashed.count);
+    }
+    LPG_UNREACHABLE();
+}
+
 bool value_less_than(value const left, value const right)
 {
     if (left.kind != right.kind)
@@ -340,13 +527,13 @@ bool value_less_than(value const left, value const right)
         LPG_TO_DO();
 
     case value_kind_integer:
-        return integer_less(left.integer_, right.integer_);
+        return integer_less(value_as_integer(left), value_as_integer(right));
 
     case value_kind_string:
-        return unicode_view_less(left.string, right.string);
+        return unicode_view_less(value_as_string(left), value_as_string(right));
 
     case value_kind_enum_element:
-        return enum_less_than(left.enum_element, right.enum_element);
+        return enum_less_than(value_as_enum_element(left), value_as_enum_element(right));
 
     case value_kind_unit:
         return false;
@@ -389,13 +576,13 @@ bool value_is_mutable(value const original)
         return false;
 
     case value_kind_enum_element:
-        return original.enum_element.state && value_is_mutable(*original.enum_element.state);
+        return original.enum_state && value_is_mutable(*original.enum_state);
 
     case value_kind_structure:
     {
-        for (size_t i = 0; i < original.structure.count; ++i)
+        for (size_t i = 0; i < original.count; ++i)
         {
-            if (value_is_mutable(original.structure.members[i]))
+            if (value_is_mutable(original.structure_members[i]))
             {
                 return true;
             }
@@ -405,9 +592,9 @@ bool value_is_mutable(value const original)
 
     case value_kind_tuple:
     {
-        for (size_t i = 0; i < original.tuple_.element_count; ++i)
+        for (size_t i = 0; i < original.count; ++i)
         {
-            if (value_is_mutable(original.tuple_.elements[i]))
+            if (value_is_mutable(original.tuple_elements[i]))
             {
                 return true;
             }
@@ -417,9 +604,13 @@ bool value_is_mutable(value const original)
 
     case value_kind_function_pointer:
     {
-        for (size_t i = 0; i < original.function_pointer.capture_count; ++i)
+        if (!original.boxed_function)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < original.boxed_function->capture_count; ++i)
         {
-            if (value_is_mutable(original.function_pointer.captures[i]))
+            if (value_is_mutable(original.boxed_function->captures[i]))
             {
                 return true;
             }
@@ -431,7 +622,7 @@ bool value_is_mutable(value const original)
         LPG_TO_DO();
 
     case value_kind_type_erased:
-        return value_is_mutable(*original.type_erased.self);
+        return value_is_mutable(original.type_erased->self);
     }
     LPG_UNREACHABLE();
 }
@@ -473,13 +664,13 @@ bool value_conforms_to_type(value const instance, type const expected)
         {
             return false;
         }
-        if (instance.tuple_.element_count != expected.tuple_.length)
+        if (instance.count != expected.tuple_.length)
         {
             return false;
         }
         for (size_t i = 0; i < expected.tuple_.length; ++i)
         {
-            if (!value_conforms_to_type(instance.tuple_.elements[i], expected.tuple_.elements[i]))
+            if (!value_conforms_to_type(instance.tuple_elements[i], expected.tuple_.elements[i]))
             {
                 return false;
             }
@@ -495,7 +686,7 @@ bool value_conforms_to_type(value const instance, type const expected)
 
     case type_kind_integer_range:
         return (instance.kind == value_kind_integer) &&
-               integer_range_contains_integer(expected.integer_range_, instance.integer_);
+               integer_range_contains_integer(expected.integer_range_, value_as_integer(instance));
 
     case type_kind_lambda:
         return (instance.kind == value_kind_function_pointer);
@@ -505,7 +696,7 @@ bool value_conforms_to_type(value const instance, type const expected)
 
     case type_kind_interface:
         return ((instance.kind == value_kind_type_erased) &&
-                (instance.type_erased.impl.target == expected.interface_)) ||
+                (instance.interface_ == expected.interface_)) ||
                (instance.kind == value_kind_array);
 
     case type_kind_function_pointer:
@@ -514,16 +705,15 @@ bool value_conforms_to_type(value const instance, type const expected)
         {
             return false;
         }
-        size_t const given_count = instance.function_pointer.capture_count;
+        function_pointer_value const given = value_as_function_pointer(instance);
         size_t const expected_count = expected.function_pointer_->captures.length;
-        if (given_count != expected_count)
+        if (given.capture_count != expected_count)
         {
             return false;
         }
         for (size_t i = 0; i < expected_count; ++i)
         {
-            if (!value_conforms_to_type(
-                    instance.function_pointer.captures[i], expected.function_pointer_->captures.elements[i]))
+            if (!value_conforms_to_type(given.captures[i], expected.function_pointer_->captures.elements[i]))
             {
                 return false;
             }
@@ -564,3 +754,9 @@ external_function_result external_function_result_create_instruction_limit_reach
         external_function_result_instruction_limit_reached, value_create_invalid()};
     return result;
 }
+
+external_function_result external_function_result_create_deadline_reached(void)
+{
+    external_function_result const result = {external_function_result_deadline_reached, value_create_invalid()};
+    return result;
+}
@@ -80,11 +80,9 @@ typedef struct enum_element_value
 
     /*NULL means unit*/
     struct value *state;
-
-    type state_type;
 } enum_element_value;
 
-enum_element_value enum_element_value_create(enum_element_id which, struct value *state, type state_type);
+enum_element_value enum_element_value_create(enum_element_id which, struct value *state);
 
 typedef struct type_erased_value
 {
@@ -102,30 +100,75 @@ typedef struct structure_value
 
 structure_value structure_value_create(struct value const *members, size_t count);
 
+/*how the elements of an array are kept in memory. The checker chooses the most compact storage that can hold every
+ * value of the element type.*/
+typedef enum array_storage
+{
+    /*a value per element*/
+    array_storage_values,
+    /*a uint64_t per element for integer ranges that fit into 64 bits*/
+    array_storage_integers,
+    /*a byte per element for enumerations without states and with at most 256 elements like boolean*/
+    array_storage_enum_elements
+} array_storage;
+
+size_t array_storage_element_size(array_storage const storage) LPG_USE_RESULT;
+
 typedef struct array_value
 {
-    struct value *elements;
+    array_storage storage;
+    union
+    {
+        struct value *elements;
+        uint64_t *integers;
+        uint8_t *enum_elements;
+    };
     size_t count;
     size_t allocated;
     type element_type;
 } array_value;
 
+/*an array with array_storage_values*/
 array_value array_value_create(struct value *elements, size_t count, size_t allocated, type element_type);
+array_value array_value_create_empty(array_storage const storage, type element_type);
 bool array_value_equals(array_value const left, array_value const right);
+struct value array_value_load(array_value const from, size_t const index) LPG_USE_RESULT;
+void array_value_store(LPG_NON_NULL(array_value *const into), size_t const index, struct value const element);
 
+struct type_erased_box;
+
+/*A value fits into 16 bytes: the kind, 32 bits of small content like a count and 64 bits that are either content or
+ * point to content. The larger kinds of content are kept in boxes that have to outlive the value just like the
+ * elements of a tuple. Use the value_as_* functions to read the content of a value.*/
 typedef struct value
 {
     value_kind kind;
     union
     {
-        structure_value structure;
-        integer integer_;
-        unicode_view string;
-        function_pointer_value function_pointer;
-        type type_;
-        enum_element_value enum_element;
-        value_tuple tuple_;
-        type_erased_value type_erased;
+        /*value_kind_enum_element*/
+        enum_element_id which;
+        /*value_kind_string (bytes), value_kind_tuple (elements), value_kind_structure (members)*/
+        uint32_t count;
+        /*value_kind_integer: whether the integer needs more than 64 bits and is in big_integer*/
+        uint32_t is_big;
+        /*value_kind_function_pointer: the function if there is no boxed_function*/
+        function_id code;
+        /*value_kind_type_erased*/
+        interface_id interface_;
+    };
+    union
+    {
+        uint64_t small_integer;
+        integer const *big_integer;
+        char const *string_begin;
+        /*NULL means unit*/
+        struct value *enum_state;
+        struct value *tuple_elements;
+        struct value const *structure_members;
+        /*NULL for internal functions without captures*/
+        function_pointer_value const *boxed_function;
+        type const *boxed_type;
+        struct type_erased_box *type_erased;
         generic_enum_id generic_enum;
         generic_interface_id generic_interface;
         array_value *array;
@@ -134,15 +177,39 @@ typedef struct value
     };
 } value;
 
+/*the part of a type erased value that does not fit into a value*/
+typedef struct type_erased_box
+{
+    size_t implementation_index;
+    value self;
+} type_erased_box;
+
 static inline value value_from_structure(structure_value const content)
 {
+    ASSUME(content.count <= UINT32_MAX);
     value result;
     result.kind = value_kind_structure;
-    result.structure = content;
+    result.count = (uint32_t)content.count;
+    result.structure_members = content.members;
     return result;
 }
 
-value value_from_function_pointer(function_pointer_value pointer);
+/*Internal functions without captures are stored in the value itself. Every other function pointer is boxed in memory
+ * from the garbage collector.*/
+value value_from_function_pointer(function_pointer_value const pointer, LPG_NON_NULL(garbage_collector *const gc));
+
+static inline value value_from_internal_function(function_id const code)
+{
+    value result;
+    result.kind = value_kind_function_pointer;
+    result.code = code;
+    result.boxed_function = NULL;
+    return result;
+}
+/*The length of a string is stored in 32 bits of the value. Whoever creates a longer string reports that as running
+ * out of memory instead of creating the value.*/
+static size_t const value_max_string_length = UINT32_MAX;
+
 value value_from_string(unicode_view const string);
 
 static inline value value_from_unit(void)
@@ -150,16 +217,39 @@ static inline value value_from_unit(void)
     value result;
     result.kind = value_kind_unit;
     /*dummy value to avoid compiler warning*/
-    result.integer_ = integer_create(0, 0);
+    result.count = 0;
+    result.small_integer = 0;
+    return result;
+}
+
+/*the type is boxed in memory from the garbage collector*/
+value value_from_type(type const type_, LPG_NON_NULL(garbage_collector *const gc));
+
+static inline value value_from_enum_element(enum_element_id const element, value *const state)
+{
+    value result;
+    result.kind = value_kind_enum_element;
+    result.which = element;
+    result.enum_state = state;
+    return result;
+}
+
+static inline value value_from_small_integer(uint64_t const content)
+{
+    value result;
+    result.kind = value_kind_integer;
+    result.is_big = 0;
+    result.small_integer = content;
     return result;
 }
 
-value value_from_type(type const type_);
-value value_from_enum_element(enum_element_id const element, type const state_type, value *const state);
-value value_from_integer(integer const content);
+/*integers that do not fit into 64 bits are boxed in memory from the garbage collector*/
+value value_from_integer(integer const content, LPG_NON_NULL(garbage_collector *const gc));
 value value_from_tuple(value_tuple content);
 value value_from_enum_constructor(void);
-value value_from_type_erased(type_erased_value content);
+/*self is copied into a box in memory from the garbage collector*/
+value value_from_type_erased(implementation_ref const impl, value const self,
+                             LPG_NON_NULL(garbage_collector *const gc));
 value value_from_generic_enum(generic_enum_id content);
 value value_from_generic_interface(generic_interface_id content);
 value value_from_array(array_value *content);
@@ -168,6 +258,8 @@ value value_or_unit(value const *const maybe);
 value value_from_generic_struct(generic_struct_id content);
 value value_create_invalid(void);
 bool value_equals(value const left, value const right);
+/*values that are equal according to value_equals have the same hash*/
+uint64_t value_hash(uint64_t const previous, value const hashed) LPG_USE_RESULT;
 bool value_less_than(value const left, value const right);
 bool value_greater_than(value const left, value const right);
 bool enum_less_than(enum_element_value const left, enum_element_value const right);
@@ -179,6 +271,64 @@ static inline bool value_is_valid(value const checked)
 
 bool value_is_mutable(value const original);
 
+static inline integer value_as_integer(value const from)
+{
+    ASSUME(from.kind == value_kind_integer);
+    return from.is_big ? *from.big_integer : integer_create(0, from.small_integer);
+}
+
+static inline unicode_view value_as_string(value const from)
+{
+    ASSUME(from.kind == value_kind_string);
+    return unicode_view_create(from.string_begin, from.count);
+}
+
+function_pointer_value value_as_function_pointer(value const from);
+
+/*the function that is called by a function pointer value*/
+static inline function_id value_function_code(value const from)
+{
+    ASSUME(from.kind == value_kind_function_pointer);
+    return from.boxed_function ? from.boxed_function->code : from.code;
+}
+
+static inline bool value_function_is_external(value const from)
+{
+    ASSUME(from.kind == value_kind_function_pointer);
+    return from.boxed_function && from.boxed_function->external;
+}
+
+static inline type value_as_type(value const from)
+{
+    ASSUME(from.kind == value_kind_type);
+    return *from.boxed_type;
+}
+
+static inline enum_element_value value_as_enum_element(value const from)
+{
+    ASSUME(from.kind == value_kind_enum_element);
+    return enum_element_value_create(from.which, from.enum_state);
+}
+
+static inline value_tuple value_as_tuple(value const from)
+{
+    ASSUME(from.kind == value_kind_tuple);
+    return value_tuple_create(from.tuple_elements, from.count);
+}
+
+static inline structure_value value_as_structure(value const from)
+{
+    ASSUME(from.kind == value_kind_structure);
+    return structure_value_create(from.structure_members, from.count);
+}
+
+static inline type_erased_value value_as_type_erased(value const from)
+{
+    ASSUME(from.kind == value_kind_type_erased);
+    return type_erased_value_create(
+        implementation_ref_create(from.interface_, from.type_erased->implementation_index), &from.type_erased->self);
+}
+
 typedef struct optional_value
 {
     bool is_set;
@@ -191,7 +341,7 @@ static inline optional_value optional_value_create(value v)
     return result;
 }
 
-static optional_value const optional_value_empty = {false, {(value_kind)0, {{NULL, 0}}}};
+static optional_value const optional_value_empty = {false, {(value_kind)0, {0}, {0}}};
 
 bool value_conforms_to_type(value const instance, type const expected);
 
@@ -200,7 +350,8 @@ typedef enum external_function_result_code {
     external_function_result_out_of_memory,
     external_function_result_unavailable,
     external_function_result_stack_overflow,
-    external_function_result_instruction_limit_reached
+    external_function_result_instruction_limit_reached,
+    external_function_result_deadline_reached
 } external_function_result_code;
 
 typedef struct external_function_result
@@ -214,3 +365,4 @@ external_function_result external_function_result_create_out_of_memory(void);
 external_function_result external_function_result_create_unavailable(void);
 external_function_result external_function_result_create_stack_overflow(void);
 external_function_result external_function_result_create_instruction_limit_reached(void);
+external_function_result external_function_result_create_deadline_reached(void);
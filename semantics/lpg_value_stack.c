@@ -0,0 +1,121 @@
+#include "lpg_value_stack.h"
+#include "lpg_allocate.h"
+#include "lpg_arithmetic.h"
+#include "lpg_assert.h"
+#include "lpg_value.h"
+
+enum
+{
+    minimum_segment_size = 1024
+};
+
+value_stack value_stack_create(void)
+{
+    value_stack const result = {NULL, NULL};
+    return result;
+}
+
+static void free_segments(value_stack_segment *segment)
+{
+    while (segment)
+    {
+        value_stack_segment *const previous = segment->previous;
+        deallocate(segment);
+        segment = previous;
+    }
+}
+
+void value_stack_free(value_stack const freed)
+{
+    free_segments(freed.top);
+    if (freed.spare)
+    {
+        deallocate(freed.spare);
+    }
+}
+
+static value_stack_segment *allocate_segment(size_t const size)
+{
+    optional_size const element_bytes = size_multiply(size, sizeof(value));
+    ASSERT(element_bytes.state == optional_set);
+    optional_size const total_bytes = size_add(sizeof(value_stack_segment), element_bytes.value_if_set);
+    ASSERT(total_bytes.state == optional_set);
+    value_stack_segment *const result = allocate(total_bytes.value_if_set);
+    result->previous = NULL;
+    result->used = 0;
+    result->size = size;
+    result->elements = (value *)(result + 1);
+    return result;
+}
+
+static value_stack_segment *obtain_segment(value_stack *const stack, size_t const minimum_size)
+{
+    if (stack->spare)
+    {
+        value_stack_segment *const spare = stack->spare;
+        stack->spare = NULL;
+        if (spare->size >= minimum_size)
+        {
+            return spare;
+        }
+        deallocate(spare);
+    }
+    size_t size = minimum_segment_size;
+    if (stack->top && (stack->top->size > (size / 2)))
+    {
+        size = (stack->top->size * 2);
+    }
+    if (size < minimum_size)
+    {
+        size = minimum_size;
+    }
+    return allocate_segment(size);
+}
+
+value *value_stack_push(value_stack *const stack, size_t const count)
+{
+    if (count == 0)
+    {
+        return NULL;
+    }
+    value_stack_segment *top = stack->top;
+    if (!top || ((top->size - top->used) < count))
+    {
+        value_stack_segment *const added = obtain_segment(stack, count);
+        added->previous = top;
+        added->used = 0;
+        stack->top = added;
+        top = added;
+    }
+    value *const result = top->elements + top->used;
+    top->used += count;
+    return result;
+}
+
+void value_stack_pop(value_stack *const stack, size_t const count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    value_stack_segment *const top = stack->top;
+    ASSUME(top);
+    ASSUME(top->used >= count);
+    top->used -= count;
+    if ((top->used > 0) || !top->previous)
+    {
+        return;
+    }
+    stack->top = top->previous;
+    top->previous = NULL;
+    if (stack->spare)
+    {
+        if (stack->spare->size >= top->size)
+        {
+            deallocate(top);
+            return;
+        }
+        deallocate(stack->spare);
+    }
+    stack->spare = top;
+}
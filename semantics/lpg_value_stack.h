@@ -0,0 +1,32 @@
+#pragma once
+#include "lpg_non_null.h"
+#include "lpg_use_result.h"
+#include <stddef.h>
+
+struct value;
+
+typedef struct value_stack_segment
+{
+    struct value_stack_segment *previous;
+    size_t used;
+    size_t size;
+    struct value *elements;
+} value_stack_segment;
+
+/*Register frames and argument windows of the interpreter are carved out of this stack. The stack grows by adding
+ * segments so that windows which are already in use never move in memory. The most recently emptied segment is kept
+ * around so that calls at a segment boundary do not allocate every time.*/
+typedef struct value_stack
+{
+    value_stack_segment *top;
+    value_stack_segment *spare;
+} value_stack;
+
+value_stack value_stack_create(void) LPG_USE_RESULT;
+void value_stack_free(value_stack const freed);
+
+/*returns a window of contiguous, uninitialized values*/
+struct value *value_stack_push(LPG_NON_NULL(value_stack *const stack), size_t const count) LPG_USE_RESULT;
+
+/*the popped window has to be the most recently pushed one*/
+void value_stack_pop(LPG_NON_NULL(value_stack *const stack), size_t const count);
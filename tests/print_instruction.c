@@ -62,13 +62,13 @@ void print_value(value const printed, size_t const indentation)
 
     case value_kind_type_erased:
         printf("type erased (impl: ?, self: ");
-        print_value(*printed.type_erased.self, indentation);
+        print_value(*value_as_type_erased(printed).self, indentation);
         printf(")");
         break;
 
     case value_kind_integer:
         printf("integer ");
-        print_integer(printed.integer_);
+        print_integer(value_as_integer(printed));
         break;
 
     case value_kind_string:
@@ -81,22 +81,20 @@ void print_value(value const printed, size_t const indentation)
 
     case value_kind_structure:
         printf("structure");
-        for (size_t i = 0; i < printed.structure.count; ++i)
+        for (size_t i = 0; i < value_as_structure(printed).count; ++i)
         {
             printf("\n");
-            print_value(printed.structure.members[i], indentation + 1);
+            print_value(value_as_structure(printed).members[i], indentation + 1);
         }
         break;
 
     case value_kind_type:
-        print_type(printed.type_);
+        print_type(value_as_type(printed));
         break;
 
     case value_kind_enum_element:
-        printf("enum element # %u, state = (", printed.enum_element.which);
-        print_value(printed.enum_element.state ? *printed.enum_element.state : value_from_unit(), indentation);
-        printf(", ");
-        print_type(printed.enum_element.state_type);
+        printf("enum element # %u, state = (", value_as_enum_element(printed).which);
+        print_value(value_or_unit(value_as_enum_element(printed).state), indentation);
         printf(")");
         break;
 
@@ -0,0 +1,94 @@
+#include "test_arena.h"
+#include "lpg_allocate.h"
+#include "lpg_arena.h"
+#include "test.h"
+#include <string.h>
+
+static void test_allocate(void)
+{
+    arena memory = arena_create();
+    REQUIRE(!arena_allocate_array(&memory, 0, sizeof(size_t)));
+    size_t *const small = arena_allocate_array(&memory, 3, sizeof(*small));
+    REQUIRE(small);
+    REQUIRE(small[0] == 0);
+    REQUIRE(small[2] == 0);
+    small[2] = 7;
+    /*larger than a block*/
+    size_t const large_length = 100000;
+    char *const large = arena_allocate_array(&memory, large_length, 1);
+    REQUIRE(large[0] == 0);
+    REQUIRE(large[large_length - 1] == 0);
+    memset(large, 1, large_length);
+    size_t *const after = arena_allocate_array(&memory, 1, sizeof(*after));
+    *after = 8;
+    REQUIRE(small[2] == 7);
+    arena_free(memory);
+}
+
+static void test_reallocate(void)
+{
+    arena memory = arena_create();
+    size_t *elements = NULL;
+    size_t capacity = 0;
+    size_t const count = 1000;
+    for (size_t i = 0; i < count; ++i)
+    {
+        elements = arena_reallocate_array_exponentially(&memory, elements, (i + 1), sizeof(*elements), i, &capacity);
+        REQUIRE(capacity >= (i + 1));
+        elements[i] = i;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        REQUIRE(elements[i] == i);
+    }
+    size_t *const same =
+        arena_reallocate_array_exponentially(&memory, elements, count, sizeof(*elements), count, &capacity);
+    REQUIRE(same == elements);
+    arena_free(memory);
+}
+
+static void test_reset(void)
+{
+    arena memory = arena_create();
+    arena_reset(&memory);
+    for (size_t i = 0; i < 10; ++i)
+    {
+        char *const data = arena_allocate_array(&memory, 5000, 1);
+        memset(data, 1, 5000);
+    }
+    arena_reset(&memory);
+    REQUIRE(memory.blocks);
+    REQUIRE(!memory.blocks->next);
+    /*the memory is cleared again*/
+    char const *const reused = arena_allocate_array(&memory, 100, 1);
+    REQUIRE(reused[0] == 0);
+    REQUIRE(reused[99] == 0);
+    arena_free(memory);
+}
+
+static void test_pool(void)
+{
+    arena_pool pool = arena_pool_create();
+    arena *const first = arena_pool_take(&pool);
+    arena *const second = arena_pool_take(&pool);
+    REQUIRE(first != second);
+    REQUIRE(arena_allocate_array(first, 10, 1));
+    REQUIRE(arena_allocate_array(second, 10, 1));
+    arena_pool_give_back(&pool, second);
+    size_t const allocations_before = count_total_allocations();
+    REQUIRE(arena_pool_take(&pool) == second);
+    /*the block of the arena is reused*/
+    REQUIRE(arena_allocate_array(second, 10, 1));
+    REQUIRE(count_total_allocations() == allocations_before);
+    arena_pool_give_back(&pool, first);
+    /*the second arena is freed although it has not been given back*/
+    arena_pool_free(pool);
+}
+
+void test_arena(void)
+{
+    test_allocate();
+    test_reallocate();
+    test_reset();
+    test_pool();
+}
@@ -0,0 +1,117 @@
+#include "test_bytecode.h"
+#include "lpg_array_size.h"
+#include "lpg_bytecode.h"
+#include "lpg_standard_library.h"
+#include "test.h"
+
+static instruction get_method(register_id const into)
+{
+    return instruction_create_get_method(get_method_instruction_create(0, 0, 0, into));
+}
+
+static instruction call(register_id const callee, register_id *const arguments, size_t const argument_count,
+                        register_id const result)
+{
+    return instruction_create_call(call_instruction_create(callee, arguments, argument_count, result));
+}
+
+static instruction read_global(register_id const globals, struct_member_id const member, register_id const into)
+{
+    return instruction_create_read_struct(read_struct_instruction_create(globals, member, into));
+}
+
+void test_bytecode(void)
+{
+    {
+        /*a method that is only called is never materialized*/
+        register_id arguments[] = {2};
+        instruction body[] = {get_method(1), call(1, arguments, LPG_ARRAY_SIZE(arguments), 3)};
+        bytecode const compiled =
+            bytecode_compile(instruction_sequence_create(body, LPG_ARRAY_SIZE(body), LPG_ARRAY_SIZE(body)), 4);
+        REQUIRE(compiled.operation_count == 3);
+        REQUIRE(compiled.operations[0].opcode == bytecode_opcode_bind_method);
+        REQUIRE(compiled.operations[1].opcode == bytecode_opcode_call_method);
+        REQUIRE(compiled.operations[1].target == 0);
+        REQUIRE(compiled.operations[2].opcode == bytecode_opcode_end_of_function);
+        bytecode_free(&compiled);
+    }
+    {
+        /*the method is needed as a value when it is passed somewhere*/
+        register_id arguments[] = {1};
+        instruction body[] = {get_method(1), call(1, arguments, LPG_ARRAY_SIZE(arguments), 2)};
+        bytecode const compiled =
+            bytecode_compile(instruction_sequence_create(body, LPG_ARRAY_SIZE(body), LPG_ARRAY_SIZE(body)), 3);
+        REQUIRE(compiled.operation_count == 3);
+        REQUIRE(compiled.operations[0].opcode == bytecode_opcode_get_method);
+        REQUIRE(compiled.operations[1].opcode == bytecode_opcode_call);
+        bytecode_free(&compiled);
+    }
+    {
+        /*or when it is called more than once*/
+        instruction body[] = {get_method(1), call(1, NULL, 0, 2), call(1, NULL, 0, 3)};
+        bytecode const compiled =
+            bytecode_compile(instruction_sequence_create(body, LPG_ARRAY_SIZE(body), LPG_ARRAY_SIZE(body)), 4);
+        REQUIRE(compiled.operation_count == 4);
+        REQUIRE(compiled.operations[0].opcode == bytecode_opcode_get_method);
+        REQUIRE(compiled.operations[1].opcode == bytecode_opcode_call);
+        REQUIRE(compiled.operations[2].opcode == bytecode_opcode_call);
+        bytecode_free(&compiled);
+    }
+    {
+        /*a builtin whose result is only matched*/
+        register_id arguments[] = {0, 1};
+        match_instruction_case cases[] = {
+            match_instruction_case_create_stateful_enum(match_instruction_case_stateful_enum_create(0, 7),
+                                                        instruction_sequence_create(NULL, 0, 0),
+                                                        optional_register_id_create_empty()),
+            match_instruction_case_create_value(
+                6, instruction_sequence_create(NULL, 0, 0), optional_register_id_create_empty())};
+        instruction body[] = {
+            instruction_create_global(2), read_global(2, standard_library_add, 3),
+            call(3, arguments, LPG_ARRAY_SIZE(arguments), 4),
+            instruction_create_literal(literal_instruction_create(
+                6, value_from_enum_element(1, NULL), type_from_enumeration(0))),
+            instruction_create_match(match_instruction_create(4, cases, LPG_ARRAY_SIZE(cases), 8, type_from_unit()))};
+        bytecode const compiled =
+            bytecode_compile(instruction_sequence_create(body, LPG_ARRAY_SIZE(body), LPG_ARRAY_SIZE(body)), 9);
+        REQUIRE(compiled.operation_count == 8);
+        REQUIRE(compiled.operations[0].opcode == bytecode_opcode_lookup_builtin);
+        REQUIRE(compiled.operations[0].builtin == bytecode_builtin_add_integers);
+        /*the key of the second case is loaded before the call*/
+        REQUIRE(compiled.operations[1].opcode == bytecode_opcode_literal);
+        REQUIRE(compiled.operations[2].opcode == bytecode_opcode_call_builtin_and_match);
+        REQUIRE(compiled.operations[2].builtin == bytecode_builtin_add_integers);
+        REQUIRE(compiled.operations[2].target == 0);
+        REQUIRE(compiled.match_count == 1);
+        REQUIRE(compiled.matches[0].case_targets[0] == 3);
+        REQUIRE(compiled.matches[0].case_targets[1] == 5);
+        REQUIRE(compiled.operations[7].opcode == bytecode_opcode_end_of_function);
+        bytecode_free(&compiled);
+    }
+    {
+        /*the result of the builtin is needed as a value*/
+        register_id arguments[] = {0, 1};
+        instruction body[] = {instruction_create_global(2), read_global(2, standard_library_integer_less, 3),
+                              call(3, arguments, LPG_ARRAY_SIZE(arguments), 4),
+                              instruction_create_return(return_instruction_create(4, 5))};
+        bytecode const compiled =
+            bytecode_compile(instruction_sequence_create(body, LPG_ARRAY_SIZE(body), LPG_ARRAY_SIZE(body)), 6);
+        REQUIRE(compiled.operation_count == 4);
+        REQUIRE(compiled.operations[0].opcode == bytecode_opcode_lookup_builtin);
+        REQUIRE(compiled.operations[1].opcode == bytecode_opcode_call_builtin);
+        REQUIRE(compiled.operations[1].builtin == bytecode_builtin_integer_less);
+        REQUIRE(compiled.operations[2].opcode == bytecode_opcode_return);
+        bytecode_free(&compiled);
+    }
+    {
+        /*other globals are called through the function pointer*/
+        instruction body[] = {instruction_create_global(0), read_global(0, 0, 1), call(1, NULL, 0, 2)};
+        bytecode const compiled =
+            bytecode_compile(instruction_sequence_create(body, LPG_ARRAY_SIZE(body), LPG_ARRAY_SIZE(body)), 3);
+        REQUIRE(compiled.operation_count == 4);
+        REQUIRE(compiled.operations[0].opcode == bytecode_opcode_global);
+        REQUIRE(compiled.operations[1].opcode == bytecode_opcode_read_struct);
+        REQUIRE(compiled.operations[2].opcode == bytecode_opcode_call);
+        bytecode_free(&compiled);
+    }
+}
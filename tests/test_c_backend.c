@@ -47,7 +47,7 @@ static void check_generated_c_code(char const *const source, standard_library_de
         check(root, standard_library.globals, expect_no_errors, &loader,
               source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(source),
                                  source_file_lines_from_owning(lines)),
-              unicode_view_from_string(module_directory), 100000, NULL);
+              unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
     sequence_free(&root);
     source_file_lines_owning_free(lines);
     REQUIRE(checked.function_count >= 1);
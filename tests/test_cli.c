@@ -1,9 +1,14 @@
 #include "test_cli.h"
 #include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
 #include "lpg_allocate.h"
 #include "lpg_array_size.h"
+#include "lpg_check.h"
 #include "lpg_cli.h"
+#include "lpg_file_watcher.h"
+#include "lpg_prefetch_modules.h"
 #include "lpg_read_file.h"
+#include "lpg_standard_library.h"
 #include "lpg_win32.h"
 #include "lpg_write_file.h"
 #include "test.h"
@@ -13,6 +18,9 @@
 #include <unistd.h>
 #endif
 
+static char const *const usage = "Arguments: [run|format|compile|web] filename [web output file]\n"
+                                  "       or: watch filename [run|web output file]\n";
+
 static void expect_output(int argc, char **argv, bool const expected_exit_code, char const *const expected_diagnostics,
                           unicode_view const current_directory)
 {
@@ -50,6 +58,22 @@ static void expect_output_with_source_flags(char const *const source, char *cons
     unicode_string_free(&name);
 }
 
+static void expect_output_with_options(char const *const source, char *const *const options,
+                                       size_t const option_count, bool const expected_exit_code,
+                                       char const *const expected_diagnostics, unicode_view const current_directory)
+{
+    unicode_string name = write_temporary_file(source);
+    char *arguments[8] = {"lpg", "run", unicode_string_c_str(&name)};
+    REQUIRE((3 + option_count) <= LPG_ARRAY_SIZE(arguments));
+    for (size_t i = 0; i < option_count; ++i)
+    {
+        arguments[3 + i] = options[i];
+    }
+    expect_output((int)(3 + option_count), arguments, expected_exit_code, expected_diagnostics, current_directory);
+    REQUIRE(0 == remove(unicode_string_c_str(&name)));
+    unicode_string_free(&name);
+}
+
 static void formatting_tool(char const *const source, char const *const expected_output, bool const expected_exit_code,
                             char const *const expected_diagnostics, unicode_view const current_directory)
 {
@@ -133,7 +157,9 @@ static unicode_string find_node_test_main(void)
                                    unicode_view_from_c_str("main.lpg")};
     return path_combine(pieces, LPG_ARRAY_SIZE(pieces));
 }
+#endif
 
+#if LPG_WITH_NODEJS || defined(__linux__)
 static unicode_string create_temporary_directory(void)
 {
 #ifdef _MSC_VER
@@ -222,23 +248,615 @@ static void test_error_output(unicode_view directory)
                               directory);
 }
 
+static void test_execution_budgets(unicode_view const current_directory)
+{
+    char const *const endless = "loop\n"
+                                "    let a = 1\n";
+    {
+        char *options[] = {"--max-instructions=1000"};
+        expect_output_with_options(endless, options, LPG_ARRAY_SIZE(options), true,
+                                   "Executed too many instructions at run time\n", current_directory);
+    }
+    {
+        char *options[] = {"--max-milliseconds=0"};
+        expect_output_with_options(
+            endless, options, LPG_ARRAY_SIZE(options), true, "Run time deadline reached\n", current_directory);
+    }
+    {
+        char *options[] = {"--max-recursion=0"};
+        expect_output_with_options(
+            endless, options, LPG_ARRAY_SIZE(options), true, "Call stack overflow at run time\n", current_directory);
+    }
+    {
+        char *options[] = {"--compile-time-max-milliseconds=0"};
+        expect_output_with_options("let f = ()\n"
+                                   "    loop\n"
+                                   "        let a = 1\n"
+                                   "f()\n",
+                                   options, LPG_ARRAY_SIZE(options), true, "Compile time deadline reached in line 4:\n"
+                                                                           "f()\n"
+                                                                           " ^\n",
+                                   current_directory);
+    }
+    {
+        char *options[] = {"--max-instructions=1000", "--compile-time-max-recursion=1"};
+        expect_output_with_options("let a = 1\n", options, LPG_ARRAY_SIZE(options), false, "", current_directory);
+    }
+    {
+        char *options[] = {"--max-instructions=x"};
+        expect_output_with_options("", options, LPG_ARRAY_SIZE(options), true, usage, current_directory);
+    }
+    {
+        char *options[] = {"--max-heap"};
+        expect_output_with_options("", options, LPG_ARRAY_SIZE(options), true, usage, current_directory);
+    }
+    {
+        char *options[] = {"--max-stack=1"};
+        expect_output_with_options("", options, LPG_ARRAY_SIZE(options), true, usage, current_directory);
+    }
+    {
+        unicode_string name = write_temporary_file("let a = 1\n");
+        char *arguments[] = {"lpg", "run", "--report-usage", unicode_string_c_str(&name)};
+        unicode_string const module_directory = find_builtin_module_directory();
+        memory_writer diagnostics = {NULL, 0, 0};
+        REQUIRE(!run_cli(LPG_ARRAY_SIZE(arguments), arguments, memory_writer_erase(&diagnostics), current_directory,
+                         unicode_view_from_string(module_directory)));
+        REQUIRE(success_yes == memory_writer_write(&diagnostics, "", 1));
+        char const *const compile_time = "Compile time usage: 0 instructions, recursion depth 0, 0 bytes of frames, ";
+        REQUIRE(!strncmp(diagnostics.data, compile_time, strlen(compile_time)));
+        REQUIRE(strstr(diagnostics.data, " ms\nRun time usage: 3 instructions, recursion depth 1, "));
+        memory_writer_free(&diagnostics);
+        unicode_string_free(&module_directory);
+        REQUIRE(0 == remove(unicode_string_c_str(&name)));
+        unicode_string_free(&name);
+    }
+}
+
+/*returns the diagnostics of lpg run --report-usage as a C string*/
+static memory_writer run_with_usage(char const *const source, bool const expected_exit_code,
+                                    unicode_view const current_directory)
+{
+    unicode_string name = write_temporary_file(source);
+    char *arguments[] = {"lpg", "run", "--report-usage", unicode_string_c_str(&name)};
+    unicode_string const module_directory = find_builtin_module_directory();
+    memory_writer diagnostics = {NULL, 0, 0};
+    REQUIRE(expected_exit_code == run_cli(LPG_ARRAY_SIZE(arguments), arguments, memory_writer_erase(&diagnostics),
+                                          current_directory, unicode_view_from_string(module_directory)));
+    REQUIRE(success_yes == memory_writer_write(&diagnostics, "", 1));
+    unicode_string_free(&module_directory);
+    REQUIRE(0 == remove(unicode_string_c_str(&name)));
+    unicode_string_free(&name);
+    return diagnostics;
+}
+
+static void test_run_time_assert(unicode_view const current_directory)
+{
+    /*the number of iterations is only known at run time*/
+    char const *const counting = "let std = import std\n"
+                                 "let integers = import integer\n"
+                                 "let integer = integers.integer\n"
+                                 "let i = std.make_mutable[integer](std.runtime_value[integer](0))\n"
+                                 "loop\n"
+                                 "    match integer_equals(i.load(), 100)\n"
+                                 "        case boolean.true:\n"
+                                 "            break\n"
+                                 "        case boolean.false:\n"
+                                 "            std.unit_value\n"
+                                 "    match add(i.load(), 1)\n"
+                                 "        case add_result.ok(let next):\n"
+                                 "            i.store(next)\n"
+                                 "        case add_result.overflow:\n"
+                                 "            fail()\n";
+    {
+        memory_writer completed = {NULL, 0, 0};
+        REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&completed), counting));
+        REQUIRE(success_yes ==
+                stream_writer_write_string(memory_writer_erase(&completed), "assert(integer_equals(i.load(), 100))\n"));
+        REQUIRE(success_yes == memory_writer_write(&completed, "", 1));
+        memory_writer diagnostics = run_with_usage(completed.data, false, current_directory);
+        REQUIRE(strstr(diagnostics.data, "\nRun time usage: 4480 instructions, "));
+        memory_writer_free(&diagnostics);
+        memory_writer_free(&completed);
+    }
+    {
+        memory_writer failed = {NULL, 0, 0};
+        REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&failed), counting));
+        REQUIRE(success_yes ==
+                stream_writer_write_string(memory_writer_erase(&failed), "assert(integer_equals(i.load(), 99))\n"));
+        REQUIRE(success_yes == memory_writer_write(&failed, "", 1));
+        memory_writer diagnostics = run_with_usage(failed.data, true, current_directory);
+        REQUIRE(strstr(diagnostics.data, "\nThe program failed at run time\nRun time usage: 4479 instructions, "));
+        memory_writer_free(&diagnostics);
+        memory_writer_free(&failed);
+    }
+    expect_output_with_source("assert(boolean.false)\n", true, "The program failed at run time\n", current_directory);
+    expect_output_with_source("let f = ()\n"
+                              "    fail()\n"
+                              "f()\n",
+                              true, "The program failed at run time\n", current_directory);
+}
+
+#ifdef __linux__
+static void run_with_cache(unicode_view const source_name, unicode_view const cache_directory,
+                           unicode_view const current_directory, unicode_view const module_directory,
+                           char const *const expected_diagnostics_prefix)
+{
+    memory_writer option = {NULL, 0, 0};
+    REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&option), "--cache="));
+    REQUIRE(success_yes == stream_writer_write_unicode_view(memory_writer_erase(&option), cache_directory));
+    REQUIRE(success_yes == memory_writer_write(&option, "", 1));
+    memory_writer source_name_c_str = {NULL, 0, 0};
+    REQUIRE(success_yes == stream_writer_write_unicode_view(memory_writer_erase(&source_name_c_str), source_name));
+    REQUIRE(success_yes == memory_writer_write(&source_name_c_str, "", 1));
+    char *arguments[] = {"lpg", "run", "--report-usage", option.data, source_name_c_str.data};
+    memory_writer diagnostics = {NULL, 0, 0};
+    REQUIRE(!run_cli(LPG_ARRAY_SIZE(arguments), arguments, memory_writer_erase(&diagnostics), current_directory,
+                     module_directory));
+    REQUIRE(success_yes == memory_writer_write(&diagnostics, "", 1));
+    REQUIRE(!strncmp(diagnostics.data, expected_diagnostics_prefix, strlen(expected_diagnostics_prefix)));
+    memory_writer_free(&diagnostics);
+    memory_writer_free(&source_name_c_str);
+    memory_writer_free(&option);
+}
+
+static void test_program_cache(unicode_view const current_directory)
+{
+    char const *const checked = "Compile time usage: ";
+    char const *const cached = "Loaded the checked program from the cache in ";
+    unicode_string const module_directory = find_builtin_module_directory();
+    unicode_string const cache_directory = create_temporary_directory();
+    unicode_string source_name = write_temporary_file("let std = import std\n"
+                                                      "assert(std.runtime_value[boolean](boolean.true))\n");
+    run_with_cache(unicode_view_from_string(source_name), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), checked);
+    run_with_cache(unicode_view_from_string(source_name), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), cached);
+    REQUIRE(success_yes == write_file(unicode_view_from_string(source_name), unicode_view_from_c_str("let a = 1\n")));
+    run_with_cache(unicode_view_from_string(source_name), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), checked);
+    run_with_cache(unicode_view_from_string(source_name), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), cached);
+    REQUIRE(0 == remove(unicode_string_c_str(&source_name)));
+    unicode_string_free(&source_name);
+    remove_directory(unicode_view_from_string(cache_directory));
+    unicode_string_free(&cache_directory);
+    unicode_string_free(&module_directory);
+}
+
+/*a module that appears in the module directory hides the module next to the importing file*/
+static void test_program_cache_new_module(unicode_view const current_directory)
+{
+    char const *const checked = "Compile time usage: ";
+    char const *const cached = "Loaded the checked program from the cache in ";
+    unicode_string const module_directory = create_temporary_directory();
+    unicode_string const source_directory = create_temporary_directory();
+    unicode_string const cache_directory = create_temporary_directory();
+    unicode_view const main_pieces[] = {
+        unicode_view_from_string(source_directory), unicode_view_from_c_str("main.lpg")};
+    unicode_string const main_file = path_combine(main_pieces, LPG_ARRAY_SIZE(main_pieces));
+    unicode_view const local_pieces[] = {
+        unicode_view_from_string(source_directory), unicode_view_from_c_str("helper.lpg")};
+    unicode_string const local_helper = path_combine(local_pieces, LPG_ARRAY_SIZE(local_pieces));
+    unicode_view const hiding_pieces[] = {
+        unicode_view_from_string(module_directory), unicode_view_from_c_str("helper.lpg")};
+    unicode_string const hiding_helper = path_combine(hiding_pieces, LPG_ARRAY_SIZE(hiding_pieces));
+    REQUIRE(success_yes == write_file(unicode_view_from_string(main_file),
+                                      unicode_view_from_c_str("let helper = import helper\n"
+                                                              "assert(helper)\n")));
+    REQUIRE(success_yes ==
+            write_file(unicode_view_from_string(local_helper), unicode_view_from_c_str("boolean.true\n")));
+    run_with_cache(unicode_view_from_string(main_file), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), checked);
+    run_with_cache(unicode_view_from_string(main_file), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), cached);
+    REQUIRE(success_yes ==
+            write_file(unicode_view_from_string(hiding_helper), unicode_view_from_c_str("boolean.true\n")));
+    run_with_cache(unicode_view_from_string(main_file), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), checked);
+    run_with_cache(unicode_view_from_string(main_file), unicode_view_from_string(cache_directory), current_directory,
+                   unicode_view_from_string(module_directory), cached);
+    unicode_string_free(&hiding_helper);
+    unicode_string_free(&local_helper);
+    unicode_string_free(&main_file);
+    remove_directory(unicode_view_from_string(cache_directory));
+    unicode_string_free(&cache_directory);
+    remove_directory(unicode_view_from_string(source_directory));
+    unicode_string_free(&source_directory);
+    remove_directory(unicode_view_from_string(module_directory));
+    unicode_string_free(&module_directory);
+}
+
+typedef struct watch_test_state
+{
+    unicode_view leaf;
+    size_t builds;
+} watch_test_state;
+
+static bool on_watch_build(size_t const builds, bool const has_error, void *const user)
+{
+    watch_test_state *const state = user;
+    REQUIRE(builds == (state->builds + 1));
+    state->builds = builds;
+    switch (builds)
+    {
+    case 1:
+        REQUIRE(!has_error);
+        REQUIRE(success_yes == write_file(state->leaf, unicode_view_from_c_str("let export = \n")));
+        return true;
+
+    case 2:
+        REQUIRE(has_error);
+        return false;
+
+    default:
+        FAIL();
+    }
+}
+
+static void test_watch(unicode_view const current_directory)
+{
+    unicode_string const directory = create_temporary_directory();
+    unicode_view const main_pieces[] = {unicode_view_from_string(directory), unicode_view_from_c_str("main.lpg")};
+    unicode_string main_file = path_combine(main_pieces, LPG_ARRAY_SIZE(main_pieces));
+    unicode_view const leaf_pieces[] = {unicode_view_from_string(directory), unicode_view_from_c_str("leaf.lpg")};
+    unicode_string const leaf_file = path_combine(leaf_pieces, LPG_ARRAY_SIZE(leaf_pieces));
+    REQUIRE(success_yes == write_file(unicode_view_from_string(main_file),
+                                      unicode_view_from_c_str("let leaf = import leaf\n"
+                                                              "assert(leaf)\n")));
+    REQUIRE(success_yes ==
+            write_file(unicode_view_from_string(leaf_file), unicode_view_from_c_str("let export = boolean.true\n"
+                                                                                     "export\n")));
+    char *arguments[] = {"lpg", "watch", unicode_string_c_str(&main_file), "run"};
+    compiler_arguments const parsed = parse_compiler_arguments(LPG_ARRAY_SIZE(arguments), arguments);
+    REQUIRE(parsed.valid);
+    REQUIRE(parsed.command == compiler_command_watch);
+    REQUIRE(parsed.watched_command == compiler_command_run);
+    unicode_string const module_directory = find_builtin_module_directory();
+    memory_writer diagnostics = {NULL, 0, 0};
+    watch_test_state state = {unicode_view_from_string(leaf_file), 0};
+    file_watcher const probe = file_watcher_create();
+    bool const can_watch = file_watcher_is_available(probe);
+    file_watcher_free(probe);
+    REQUIRE(run_watch(&parsed, memory_writer_erase(&diagnostics), current_directory,
+                      unicode_view_from_string(module_directory), on_watch_build, &state));
+    REQUIRE(state.builds == (can_watch ? 2u : 1u));
+    memory_writer_free(&diagnostics);
+    unicode_string_free(&module_directory);
+    unicode_string_free(&leaf_file);
+    unicode_string_free(&main_file);
+    remove_directory(unicode_view_from_string(directory));
+    unicode_string_free(&directory);
+}
+
+typedef struct session_test
+{
+    check_session *session;
+    module_cache cache;
+    structure globals;
+    unicode_view directory;
+    size_t reads;
+    size_t errors;
+} session_test;
+
+static void count_session_read(unicode_view path, unicode_view content, callback_user user)
+{
+    (void)path;
+    (void)content;
+    size_t *const reads = user;
+    ++(*reads);
+}
+
+static void count_session_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    size_t *const errors = user;
+    ++(*errors);
+}
+
+static void count_session_semantic_error(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    size_t *const errors = user;
+    ++(*errors);
+}
+
+/*Checks the main file with the session and returns how many modules the session has read. A check from nothing has to
+ * agree with the session.*/
+static size_t check_with_session(session_test *const test, bool const expects_error)
+{
+    static char const source[] = "let middle = import middle\n"
+                                 "let other = import other\n"
+                                 "assert(middle)\n"
+                                 "assert(other)\n";
+    expression_pool pool = expression_pool_create();
+    test_parser_user user = {{source, strlen(source), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, &pool);
+    sequence const root = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    source_file_lines_owning const lines = source_file_lines_owning_scan(unicode_view_from_c_str(source));
+    source_file const main_source = source_file_create(
+        unicode_view_from_c_str("main.lpg"), unicode_view_from_c_str(source), source_file_lines_from_owning(lines));
+    module_loader loader = module_loader_create(test->directory, count_session_parse_error, &test->errors);
+    loader.on_module_read = count_session_read;
+    loader.on_module_read_user = &test->reads;
+    loader.cache = &test->cache;
+    test->reads = 0;
+    test->errors = 0;
+    prefetch_modules(&loader, root, test->directory, 1);
+    checked_program const *const checked = check_session_check(
+        test->session, root, count_session_semantic_error, &loader, main_source, test->directory, NULL, &test->errors);
+    REQUIRE((test->errors > 0) == expects_error);
+    size_t const reads = test->reads;
+
+    size_t fresh_errors = 0;
+    module_loader fresh_loader = module_loader_create(test->directory, count_session_parse_error, &fresh_errors);
+    checked_program const fresh =
+        check(root, test->globals, count_session_semantic_error, &fresh_loader, main_source, test->directory,
+              default_compile_time_budget(16 * 1024 * 1024), NULL, &fresh_errors);
+    REQUIRE((fresh_errors > 0) == expects_error);
+    if (!expects_error)
+    {
+        REQUIRE(checked->function_count == fresh.function_count);
+        REQUIRE(checked->interface_count == fresh.interface_count);
+        REQUIRE(checked->struct_count == fresh.struct_count);
+        REQUIRE(checked->enum_count == fresh.enum_count);
+    }
+    checked_program_free(&fresh);
+    sequence_free(&root);
+    expression_pool_free(pool);
+    source_file_lines_owning_free(lines);
+    return reads;
+}
+
+static void write_session_module(session_test const *const test, char const *const name, char const *const content)
+{
+    unicode_view const pieces[] = {test->directory, unicode_view_from_c_str(name)};
+    unicode_string const path = path_combine(pieces, LPG_ARRAY_SIZE(pieces));
+    REQUIRE(success_yes == write_file(unicode_view_from_string(path), unicode_view_from_c_str(content)));
+    unicode_string_free(&path);
+}
+
+static void test_check_session(void)
+{
+    unicode_string const directory = create_temporary_directory();
+    standard_library_description const standard_library = describe_standard_library();
+    session_test test = {
+        check_session_create(standard_library.globals, default_compile_time_budget(16 * 1024 * 1024)),
+        module_cache_create(), standard_library.globals, unicode_view_from_string(directory), 0, 0};
+    write_session_module(&test, "leaf.lpg", "boolean.true\n");
+    write_session_module(&test, "middle.lpg", "let leaf = import leaf\n"
+                                              "leaf\n");
+    write_session_module(&test, "other.lpg", "boolean.true\n");
+    REQUIRE(check_with_session(&test, false) == 3);
+
+    /*the modules that the main file has loaded are checked before it from now on*/
+    REQUIRE(check_with_session(&test, false) == 3);
+    REQUIRE(check_with_session(&test, false) == 0);
+
+    /*the unchanged module had been checked after the changed one, so it is checked again once*/
+    write_session_module(&test, "leaf.lpg", "let value = boolean.true\n"
+                                            "value\n");
+    REQUIRE(check_with_session(&test, false) == 3);
+    write_session_module(&test, "leaf.lpg", "boolean.true\n");
+    REQUIRE(check_with_session(&test, false) == 2);
+    write_session_module(&test, "middle.lpg", "let leaf = import leaf\n"
+                                              "let copy = leaf\n"
+                                              "copy\n");
+    REQUIRE(check_with_session(&test, false) == 1);
+
+    /*the main file reports the errors of a module*/
+    write_session_module(&test, "leaf.lpg", "let value = \n");
+    check_with_session(&test, true);
+    write_session_module(&test, "leaf.lpg", "boolean.true\n");
+    check_with_session(&test, false);
+    REQUIRE(check_with_session(&test, false) == 2);
+    REQUIRE(check_with_session(&test, false) == 0);
+
+    check_session_free(test.session);
+    module_cache_free(test.cache);
+    standard_library_description_free(&standard_library);
+    remove_directory(unicode_view_from_string(directory));
+    unicode_string_free(&directory);
+}
+#endif
+
+static void test_parse_threads(unicode_view const current_directory)
+{
+    char const *const importing = "let std = import std\n"
+                                  "let a : std.option[int(0, 1)] = std.option[int(0, 1)].none\n";
+    {
+        char *options[] = {"--parse-threads=1"};
+        expect_output_with_options(importing, options, LPG_ARRAY_SIZE(options), false, "", current_directory);
+    }
+    {
+        char *options[] = {"--parse-threads=8"};
+        expect_output_with_options(importing, options, LPG_ARRAY_SIZE(options), false, "", current_directory);
+    }
+    {
+        char *options[] = {"--parse-threads=0"};
+        expect_output_with_options("", options, LPG_ARRAY_SIZE(options), true, usage, current_directory);
+    }
+}
+
+static void test_profile(unicode_view const current_directory)
+{
+    unicode_string source_name = write_temporary_file("let f = ()\n"
+                                                      "    side_effect()\n"
+                                                      "let g = ()\n"
+                                                      "    f()\n"
+                                                      "    f()\n"
+                                                      "g()\n"
+                                                      "f()\n");
+    unicode_string profile_name = write_temporary_file("");
+    memory_writer option = {NULL, 0, 0};
+    REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&option), "--profile-folded="));
+    REQUIRE(success_yes ==
+            stream_writer_write_string(memory_writer_erase(&option), unicode_string_c_str(&profile_name)));
+    REQUIRE(success_yes == memory_writer_write(&option, "", 1));
+    char *arguments[] = {"lpg", "run", option.data, unicode_string_c_str(&source_name)};
+    unicode_string const module_directory = find_builtin_module_directory();
+    memory_writer diagnostics = {NULL, 0, 0};
+    REQUIRE(!run_cli(LPG_ARRAY_SIZE(arguments), arguments, memory_writer_erase(&diagnostics), current_directory,
+                     unicode_view_from_string(module_directory)));
+    REQUIRE(diagnostics.used == 0);
+    blob_or_error const folded = read_file(unicode_string_c_str(&profile_name));
+    REQUIRE(!folded.error);
+    /*the second call of f in g is a tail call which replaces the frame of g*/
+    char const *const expected = "main 7\n"
+                                 "main;g 4\n"
+                                 "main;g;f 4\n"
+                                 "main;f 9\n";
+    REQUIRE(unicode_view_equals_c_str(unicode_view_create(folded.success.data, folded.success.length), expected));
+    blob_free(&folded.success);
+    memory_writer_free(&diagnostics);
+    memory_writer_free(&option);
+    unicode_string_free(&module_directory);
+    REQUIRE(0 == remove(unicode_string_c_str(&profile_name)));
+    REQUIRE(0 == remove(unicode_string_c_str(&source_name)));
+    unicode_string_free(&profile_name);
+    unicode_string_free(&source_name);
+}
+
+static memory_writer make_option(char const *const name, unicode_string const *const file_name)
+{
+    memory_writer option = {NULL, 0, 0};
+    REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&option), name));
+    REQUIRE(success_yes == stream_writer_write_unicode_view(
+                               memory_writer_erase(&option), unicode_view_from_string(*file_name)));
+    REQUIRE(success_yes == memory_writer_write(&option, "", 1));
+    return option;
+}
+
+static char const *const counting_with_assert = "let std = import std\n"
+                                                "let integers = import integer\n"
+                                                "let integer = integers.integer\n"
+                                                "let i = std.make_mutable[integer](std.runtime_value[integer](0))\n"
+                                                "let step = ()\n"
+                                                "    match add(i.load(), 1)\n"
+                                                "        case add_result.ok(let next):\n"
+                                                "            i.store(next)\n"
+                                                "        case add_result.overflow:\n"
+                                                "            fail()\n"
+                                                "loop\n"
+                                                "    match integer_equals(i.load(), 10)\n"
+                                                "        case boolean.true:\n"
+                                                "            break\n"
+                                                "        case boolean.false:\n"
+                                                "            step()\n";
+
+static void test_profile_with_assert(unicode_view const current_directory)
+{
+    unicode_string const module_directory = find_builtin_module_directory();
+    {
+        memory_writer source = {NULL, 0, 0};
+        REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&source), counting_with_assert));
+        REQUIRE(success_yes ==
+                stream_writer_write_string(memory_writer_erase(&source), "assert(integer_equals(i.load(), 10))\n"));
+        REQUIRE(success_yes == memory_writer_write(&source, "", 1));
+        unicode_string source_name = write_temporary_file(source.data);
+        unicode_string folded_name = write_temporary_file("");
+        unicode_string json_name = write_temporary_file("");
+        memory_writer folded_option = make_option("--profile-folded=", &folded_name);
+        memory_writer json_option = make_option("--profile-json=", &json_name);
+        char *arguments[] = {"lpg", "run", folded_option.data, json_option.data, unicode_string_c_str(&source_name)};
+        memory_writer diagnostics = {NULL, 0, 0};
+        REQUIRE(!run_cli(LPG_ARRAY_SIZE(arguments), arguments, memory_writer_erase(&diagnostics), current_directory,
+                         unicode_view_from_string(module_directory)));
+        REQUIRE(diagnostics.used == 0);
+
+        /*every one of the 10 iterations calls step which loads and stores once*/
+        blob_or_error const folded = read_file(unicode_string_c_str(&folded_name));
+        REQUIRE(!folded.error);
+        char const *const expected_folded = "main 137\n"
+                                            "main;lambda_9 4\n"
+                                            "main;lambda_6 25\n"
+                                            "main;load 96\n"
+                                            "main;step 150\n"
+                                            "main;step;load 80\n"
+                                            "main;step;store 80\n";
+        unicode_view const folded_content = unicode_view_create(folded.success.data, folded.success.length);
+        REQUIRE(unicode_view_equals_c_str(folded_content, expected_folded));
+        blob_free(&folded.success);
+
+        /*step is defined in the main file, the methods of mutable in the standard library*/
+        blob_or_error const json = read_file(unicode_string_c_str(&json_name));
+        REQUIRE(!json.error);
+        memory_writer expected_step = {NULL, 0, 0};
+        REQUIRE(success_yes ==
+                stream_writer_write_string(memory_writer_erase(&expected_step), "\"name\": \"step\", \"file\": \""));
+        REQUIRE(success_yes == stream_writer_write_unicode_view(
+                                   memory_writer_erase(&expected_step), unicode_view_from_string(source_name)));
+        REQUIRE(success_yes == stream_writer_write_string(
+                                   memory_writer_erase(&expected_step), "\", \"line\": 5, \"calls\": 10, "));
+        REQUIRE(success_yes == memory_writer_write(&expected_step, "", 1));
+        memory_writer json_c_str = {NULL, 0, 0};
+        REQUIRE(success_yes == memory_writer_write(&json_c_str, json.success.data, json.success.length));
+        REQUIRE(success_yes == memory_writer_write(&json_c_str, "", 1));
+        REQUIRE(strstr(json_c_str.data, expected_step.data));
+        char const *const load = strstr(json_c_str.data, "\"name\": \"load\", \"file\": \"");
+        REQUIRE(load);
+        char const *const load_location = "std.lpg\", \"line\": 38, \"calls\": 22, ";
+        REQUIRE(!strncmp(strstr(load, "std.lpg"), load_location, strlen(load_location)));
+        memory_writer_free(&json_c_str);
+        memory_writer_free(&expected_step);
+        blob_free(&json.success);
+
+        memory_writer_free(&diagnostics);
+        memory_writer_free(&json_option);
+        memory_writer_free(&folded_option);
+        memory_writer_free(&source);
+        REQUIRE(0 == remove(unicode_string_c_str(&json_name)));
+        REQUIRE(0 == remove(unicode_string_c_str(&folded_name)));
+        REQUIRE(0 == remove(unicode_string_c_str(&source_name)));
+        unicode_string_free(&json_name);
+        unicode_string_free(&folded_name);
+        unicode_string_free(&source_name);
+    }
+    {
+        memory_writer source = {NULL, 0, 0};
+        REQUIRE(success_yes == stream_writer_write_string(memory_writer_erase(&source), counting_with_assert));
+        REQUIRE(success_yes ==
+                stream_writer_write_string(memory_writer_erase(&source), "assert(integer_equals(i.load(), 11))\n"));
+        REQUIRE(success_yes == memory_writer_write(&source, "", 1));
+        unicode_string source_name = write_temporary_file(source.data);
+        unicode_string folded_name = write_temporary_file("");
+        memory_writer folded_option = make_option("--profile-folded=", &folded_name);
+        char *arguments[] = {"lpg", "run", folded_option.data, unicode_string_c_str(&source_name)};
+        memory_writer diagnostics = {NULL, 0, 0};
+        REQUIRE(run_cli(LPG_ARRAY_SIZE(arguments), arguments, memory_writer_erase(&diagnostics), current_directory,
+                        unicode_view_from_string(module_directory)));
+        REQUIRE(memory_writer_equals(diagnostics, "The program failed at run time\n"
+                                                  "The profile has not been written because the run failed\n"));
+        blob_or_error const folded = read_file(unicode_string_c_str(&folded_name));
+        REQUIRE(!folded.error);
+        REQUIRE(folded.success.length == 0);
+        blob_free(&folded.success);
+        memory_writer_free(&diagnostics);
+        memory_writer_free(&folded_option);
+        memory_writer_free(&source);
+        REQUIRE(0 == remove(unicode_string_c_str(&folded_name)));
+        REQUIRE(0 == remove(unicode_string_c_str(&source_name)));
+        unicode_string_free(&folded_name);
+        unicode_string_free(&source_name);
+    }
+    unicode_string_free(&module_directory);
+}
+
 void test_cli(void)
 {
     unicode_view const current_directory_not_used = unicode_view_from_c_str("/does-not-exist");
     {
         char *arguments[] = {"lpg"};
-        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true,
-                      "Arguments: [run|format|compile|web] filename [web output file]\n", current_directory_not_used);
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
     }
     {
         char *arguments[] = {"lpg", "run"};
-        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true,
-                      "Arguments: [run|format|compile|web] filename [web output file]\n", current_directory_not_used);
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
     }
     {
         char *arguments[] = {"lpg", "unknown"};
-        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true,
-                      "Arguments: [run|format|compile|web] filename [web output file]\n", current_directory_not_used);
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
     }
     {
         char *arguments[] = {"lpg", "run", "not-found"};
@@ -247,14 +865,33 @@ void test_cli(void)
     }
     {
         char *arguments[] = {"lpg", "web", "input.lpg"};
-        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true,
-                      "Arguments: [run|format|compile|web] filename [web output file]\n", current_directory_not_used);
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
     }
     {
         char *arguments[] = {"lpg", "web", "input.lpg", "output.html"};
         expect_output(
             LPG_ARRAY_SIZE(arguments), arguments, true, "Could not open source file\n", current_directory_not_used);
     }
+    {
+        char *arguments[] = {"lpg", "watch"};
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
+    }
+    {
+        char *arguments[] = {"lpg", "watch", "input.lpg", "compile"};
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
+    }
+    {
+        char *arguments[] = {"lpg", "watch", "input.lpg", "web"};
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
+    }
+    {
+        char *arguments[] = {"lpg", "watch", "input.lpg", "run", "output.html"};
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
+    }
+    {
+        char *arguments[] = {"lpg", "watch", "input.lpg", "watch"};
+        expect_output(LPG_ARRAY_SIZE(arguments), arguments, true, usage, current_directory_not_used);
+    }
 #if LPG_WITH_NODEJS
     {
         unicode_string project = find_node_test_main();
@@ -270,9 +907,7 @@ void test_cli(void)
 
     expect_output_with_source_flags("assert(boolean.true)\n", "compile", false, "", current_directory_not_used);
     expect_output_with_source_flags("assert(boolean.true)\n", "run", false, "", current_directory_not_used);
-    expect_output_with_source_flags("", "unknown", true,
-                                    "Arguments: [run|format|compile|web] filename [web output file]\n",
-                                    current_directory_not_used);
+    expect_output_with_source_flags("", "unknown", true, usage, current_directory_not_used);
 
     expect_output_with_source_flags("print(\"Hello World)\n", "compile", true,
                                     "Invalid token in line 1:\nprint(\"Hello World)\n      ^\nExpected "
@@ -371,5 +1006,17 @@ void test_cli(void)
 
     test_error_output(current_directory_not_used);
 
+    test_execution_budgets(current_directory_not_used);
+    test_run_time_assert(current_directory_not_used);
+    test_parse_threads(current_directory_not_used);
+    test_profile(current_directory_not_used);
+    test_profile_with_assert(current_directory_not_used);
+#ifdef __linux__
+    test_program_cache(current_directory_not_used);
+    test_program_cache_new_module(current_directory_not_used);
+    test_watch(current_directory_not_used);
+    test_check_session();
+#endif
+
     test_formatting_tool(current_directory_not_used);
 }
@@ -0,0 +1,164 @@
+#include "test_compile_time_call_cache.h"
+#include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
+#include "lpg_array_size.h"
+#include "lpg_check.h"
+#include "lpg_compile_time_call_cache.h"
+#include "lpg_hash.h"
+#include "lpg_standard_library.h"
+#include "test.h"
+#include <string.h>
+
+static void test_hashes(void)
+{
+    REQUIRE(value_hash(hash_seed, value_from_small_integer(3)) == value_hash(hash_seed, value_from_small_integer(3)));
+    REQUIRE(value_hash(hash_seed, value_from_string(unicode_view_from_c_str("abc"))) ==
+            value_hash(hash_seed, value_from_string(unicode_view_from_c_str("abc"))));
+    {
+        value first = value_from_small_integer(1);
+        value second = value_from_small_integer(1);
+        REQUIRE(value_hash(hash_seed, value_from_tuple(value_tuple_create(&first, 1))) ==
+                value_hash(hash_seed, value_from_tuple(value_tuple_create(&second, 1))));
+    }
+    REQUIRE(type_hash(hash_seed, type_from_unit()) == type_hash(hash_seed, type_from_unit()));
+    {
+        integer_range const range = integer_range_create(integer_create(0, 0), integer_create(0, 1));
+        REQUIRE(type_hash(hash_seed, type_from_integer_range(range)) ==
+                type_hash(hash_seed, type_from_integer_range(range)));
+    }
+}
+
+static void test_memoizability(void)
+{
+    value const unit = value_from_unit();
+    REQUIRE(compile_time_call_is_memoizable(function_pointer_value_from_internal(0, NULL, 0), &unit, 1));
+    REQUIRE(!compile_time_call_is_memoizable(
+        function_pointer_value_from_external(
+            integer_equals_impl, NULL, NULL,
+            function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                    tuple_type_create(NULL, 0), optional_type_create_empty())),
+        NULL, 0));
+    {
+        value array = value_from_array(NULL);
+        REQUIRE(!compile_time_call_is_memoizable(function_pointer_value_from_internal(0, NULL, 0), &array, 1));
+        REQUIRE(!compile_time_call_is_memoizable(function_pointer_value_from_internal(0, &array, 1), NULL, 0));
+        REQUIRE(!compile_time_call_result_is_memoizable(array));
+    }
+    REQUIRE(!compile_time_call_result_is_memoizable(value_from_structure(structure_value_create(NULL, 0))));
+    REQUIRE(compile_time_call_result_is_memoizable(value_from_small_integer(0)));
+}
+
+static void test_insert_and_find(void)
+{
+    compile_time_call_cache cache = compile_time_call_cache_create();
+    REQUIRE(!compile_time_call_cache_find(cache, function_pointer_value_from_internal(0, NULL, 0), NULL, 0).is_set);
+
+    /*enough entries to make the table grow a few times*/
+    size_t const call_count = 300;
+    for (size_t i = 0; i < call_count; ++i)
+    {
+        value const argument = value_from_small_integer(i);
+        compile_time_call_cache_insert(
+            &cache, function_pointer_value_from_internal(1, NULL, 0), &argument, 1, value_from_small_integer(i * 2));
+    }
+    compile_time_call_cache_insert(
+        &cache, function_pointer_value_from_internal(2, NULL, 0), NULL, 0, value_from_small_integer(7));
+    REQUIRE(cache.count == (call_count + 1));
+
+    for (size_t i = 0; i < call_count; ++i)
+    {
+        value const argument = value_from_small_integer(i);
+        optional_value const found =
+            compile_time_call_cache_find(cache, function_pointer_value_from_internal(1, NULL, 0), &argument, 1);
+        REQUIRE(found.is_set);
+        REQUIRE(value_equals(found.value_, value_from_small_integer(i * 2)));
+    }
+    {
+        optional_value const found =
+            compile_time_call_cache_find(cache, function_pointer_value_from_internal(2, NULL, 0), NULL, 0);
+        REQUIRE(found.is_set);
+        REQUIRE(value_equals(found.value_, value_from_small_integer(7)));
+    }
+
+    /*different arguments, callees or captures are different calls*/
+    {
+        value const argument = value_from_small_integer(call_count);
+        REQUIRE(!compile_time_call_cache_find(cache, function_pointer_value_from_internal(1, NULL, 0), &argument, 1)
+                     .is_set);
+    }
+    {
+        value const argument = value_from_small_integer(0);
+        REQUIRE(!compile_time_call_cache_find(cache, function_pointer_value_from_internal(3, NULL, 0), &argument, 1)
+                     .is_set);
+        REQUIRE(!compile_time_call_cache_find(cache, function_pointer_value_from_internal(2, NULL, 0), &argument, 1)
+                     .is_set);
+        value captured = value_from_unit();
+        REQUIRE(
+            !compile_time_call_cache_find(cache, function_pointer_value_from_internal(1, &captured, 1), &argument, 1)
+                 .is_set);
+    }
+    compile_time_call_cache_free(cache);
+}
+
+static char const *const repeated_calls_source = "let std = import std\n"
+                                                 "let f = (a: std.string): std.string\n"
+                                                 "    concat(a, \"b\")\n"
+                                                 "let x = f(\"a\")\n"
+                                                 "let y = f(\"a\")\n"
+                                                 "let z = f(\"c\")\n"
+                                                 "assert(string_equals(x, y))\n"
+                                                 "assert(string_equals(\"cb\", z))\n";
+
+static void expect_no_errors(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void expect_no_complete_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void test_repeated_calls(void)
+{
+    standard_library_description const std_library = describe_standard_library();
+    expression_pool pool = expression_pool_create();
+    test_parser_user user = {
+        {repeated_calls_source, strlen(repeated_calls_source), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, &pool);
+    sequence root = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    unicode_string const module_directory = find_builtin_module_directory();
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    source_file_lines_owning const lines =
+        source_file_lines_owning_scan(unicode_view_from_c_str(repeated_calls_source));
+    execution_usage usage = execution_usage_create();
+    checked_program checked =
+        check(root, std_library.globals, expect_no_errors, &loader,
+              source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(repeated_calls_source),
+                                 source_file_lines_from_owning(lines)),
+              unicode_view_from_string(module_directory), default_compile_time_budget(100000), &usage, NULL);
+    /*the second call of f("a") is answered from the cache*/
+    REQUIRE(usage.memoized_calls >= 1);
+    REQUIRE(usage.memoized_calls < usage.memoizable_calls);
+    sequence_free(&root);
+    checked_program_free(&checked);
+    unicode_string_free(&module_directory);
+    source_file_lines_owning_free(lines);
+    expression_pool_free(pool);
+    standard_library_description_free(&std_library);
+}
+
+void test_compile_time_call_cache(void)
+{
+    test_hashes();
+    test_memoizability();
+    test_insert_and_find();
+    test_repeated_calls();
+}
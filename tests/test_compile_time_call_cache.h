@@ -0,0 +1,3 @@
+#pragma once
+
+void test_compile_time_call_cache(void);
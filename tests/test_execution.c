@@ -0,0 +1,273 @@
+#include "test_execution.h"
+#include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
+#include "lpg_array_size.h"
+#include "lpg_check.h"
+#include "lpg_execution.h"
+#include "lpg_standard_library.h"
+#include "lpg_worker_pool.h"
+#include "test.h"
+#include <string.h>
+
+static char const *const fibonacci_source = "let std = import std\n"
+                                            "let integers = import integer\n"
+                                            "let integer = integers.integer\n"
+                                            "let fibonacci = (n: integer): integer\n"
+                                            "    match integer_less(n, 2)\n"
+                                            "        case boolean.true:\n"
+                                            "            n\n"
+                                            "        case boolean.false:\n"
+                                            "            match subtract(n, 1)\n"
+                                            "                case subtract_result.ok(let a):\n"
+                                            "                    match subtract(n, 2)\n"
+                                            "                        case subtract_result.ok(let b):\n"
+                                            "                            match add(fibonacci(a), fibonacci(b))\n"
+                                            "                                case add_result.ok(let sum):\n"
+                                            "                                    sum\n"
+                                            "                                case add_result.overflow:\n"
+                                            "                                    fail()\n"
+                                            "                        case subtract_result.underflow:\n"
+                                            "                            fail()\n"
+                                            "                case subtract_result.underflow:\n"
+                                            "                    fail()\n"
+                                            "fibonacci(std.runtime_value[integer](12))\n";
+
+static sequence parse(char const *input, expression_pool *const pool)
+{
+    test_parser_user user = {{input, strlen(input), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, pool);
+    sequence const result = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    return result;
+}
+
+static void expect_no_errors(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void expect_no_complete_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void count_jobs(void *user, size_t const job, size_t const worker)
+{
+    size_t *const done_by = user;
+    done_by[job] = (worker + 1);
+}
+
+static void test_worker_pool(void)
+{
+    for (size_t worker_count = 1; worker_count <= 5; ++worker_count)
+    {
+        for (size_t job_count = 0; job_count <= 20; job_count += 4)
+        {
+            size_t done_by[20];
+            memset(done_by, 0, sizeof(done_by));
+            worker_pool_run(count_jobs, done_by, job_count, worker_count);
+            for (size_t i = 0; i < job_count; ++i)
+            {
+                REQUIRE(done_by[i] >= 1);
+                REQUIRE(done_by[i] <= worker_count);
+            }
+        }
+    }
+}
+
+static execution_budget unlimited_budget(void)
+{
+    return execution_budget_create(UINT64_MAX, 1000, interpreter_default_max_frame_memory, SIZE_MAX,
+                                   duration_from_milliseconds(execution_budget_no_deadline));
+}
+
+/*an endless loop that calls a function in every iteration*/
+static char const *const endless_source = "let std = import std\n"
+                                          "let f = (): std.unit\n"
+                                          "    side_effect()\n"
+                                          "loop\n"
+                                          "    f()\n";
+
+typedef struct test_program
+{
+    standard_library_description std_library;
+    expression_pool pool;
+    unicode_string module_directory;
+    source_file_lines_owning lines;
+    checked_program checked;
+    value globals[standard_library_element_count];
+    garbage_collector boxes;
+} test_program;
+
+static void test_program_create(test_program *const created, char const *const source)
+{
+    created->std_library = describe_standard_library();
+    created->pool = expression_pool_create();
+    sequence root = parse(source, &created->pool);
+    created->module_directory = find_builtin_module_directory();
+    module_loader loader = module_loader_create(
+        unicode_view_from_string(created->module_directory), expect_no_complete_parse_error, NULL);
+    created->lines = source_file_lines_owning_scan(unicode_view_from_c_str(source));
+    created->checked = check(root, created->std_library.globals, expect_no_errors, &loader,
+                             source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(source),
+                                                source_file_lines_from_owning(created->lines)),
+                             unicode_view_from_string(created->module_directory), default_compile_time_budget(100000),
+                             NULL, NULL);
+    sequence_free(&root);
+    for (size_t i = 0; i < standard_library_element_count; ++i)
+    {
+        optional_value const compile_time_value = created->std_library.globals.members[i].compile_time_value;
+        created->globals[i] = compile_time_value.is_set ? compile_time_value.value_ : value_from_unit();
+    }
+    /*std.runtime_value calls side_effect*/
+    created->boxes = garbage_collector_create(SIZE_MAX);
+    created->globals[0] = value_from_function_pointer(
+        function_pointer_value_from_external(
+            side_effect_impl, NULL, NULL, *created->std_library.globals.members[0].what.function_pointer_),
+        &created->boxes);
+}
+
+static void test_program_free(test_program *const freed)
+{
+    garbage_collector_free(freed->boxes);
+    checked_program_free(&freed->checked);
+    unicode_string_free(&freed->module_directory);
+    source_file_lines_owning_free(freed->lines);
+    expression_pool_free(freed->pool);
+    standard_library_description_free(&freed->std_library);
+}
+
+static void test_shared_program(void)
+{
+    test_program fibonacci;
+    test_program_create(&fibonacci, fibonacci_source);
+    checked_program const checked = fibonacci.checked;
+    garbage_collector_statistics const checked_memory_before = checked.memory.statistics;
+    shared_program const shared = shared_program_create(&fibonacci.checked, fibonacci.globals);
+
+    execution_context context = execution_context_create(SIZE_MAX);
+    external_function_result const sequential = execute(&shared, &context, unlimited_budget());
+    REQUIRE(sequential.code == external_function_result_success);
+    REQUIRE(sequential.if_success.kind == value_kind_integer);
+    REQUIRE(integer_equal(value_as_integer(sequential.if_success), integer_create(0, 144)));
+    uint64_t const expected_instructions = context.usage.executed_instructions;
+    REQUIRE(expected_instructions > 0);
+    {
+        /*a context can be reused and reports the usage of the latest execution only*/
+        external_function_result const again = execute(&shared, &context, unlimited_budget());
+        REQUIRE(again.code == external_function_result_success);
+        REQUIRE(context.usage.executed_instructions == expected_instructions);
+    }
+    execution_context_free(context);
+
+    {
+        execution_result results[16];
+        execute_in_parallel(&shared, unlimited_budget(), 16, 4, results);
+        for (size_t i = 0; i < 16; ++i)
+        {
+            REQUIRE(results[i].code == external_function_result_success);
+            REQUIRE(results[i].usage.executed_instructions == expected_instructions);
+        }
+    }
+    {
+        /*every execution has its own budget*/
+        execution_budget budget = unlimited_budget();
+        budget.max_executed_instructions = (expected_instructions / 2);
+        execution_result results[6];
+        execute_in_parallel(&shared, budget, 6, 3, results);
+        for (size_t i = 0; i < 6; ++i)
+        {
+            REQUIRE(results[i].code == external_function_result_instruction_limit_reached);
+        }
+    }
+
+    /*the executions did not touch the heap of the checked program*/
+    REQUIRE(fibonacci.checked.memory.statistics.allocated_bytes == checked_memory_before.allocated_bytes);
+
+    shared_program_free(shared);
+    test_program_free(&fibonacci);
+}
+
+static void test_round_robin(void)
+{
+    test_program fibonacci;
+    test_program_create(&fibonacci, fibonacci_source);
+    shared_program const shared = shared_program_create(&fibonacci.checked, fibonacci.globals);
+    execution_context context = execution_context_create(SIZE_MAX);
+    REQUIRE(execute(&shared, &context, unlimited_budget()).code == external_function_result_success);
+    uint64_t const expected_instructions = context.usage.executed_instructions;
+    execution_context_free(context);
+
+    {
+        /*suspending and resuming does not change the result or the usage*/
+        uint64_t const slices[] = {1, 7, 1000, UINT64_MAX};
+        for (size_t i = 0; i < LPG_ARRAY_SIZE(slices); ++i)
+        {
+            execution_result results[20];
+            execute_round_robin(&shared, unlimited_budget(), LPG_ARRAY_SIZE(results), slices[i], results);
+            for (size_t k = 0; k < LPG_ARRAY_SIZE(results); ++k)
+            {
+                REQUIRE(results[k].code == external_function_result_success);
+                REQUIRE(results[k].usage.executed_instructions == expected_instructions);
+                REQUIRE(results[k].usage.current_recursion == 0);
+                REQUIRE(results[k].usage.used_frame_memory == 0);
+            }
+        }
+    }
+    {
+        execution_budget budget = unlimited_budget();
+        budget.max_executed_instructions = (expected_instructions / 2);
+        execution_result results[3];
+        execute_round_robin(&shared, budget, LPG_ARRAY_SIZE(results), 10, results);
+        for (size_t i = 0; i < LPG_ARRAY_SIZE(results); ++i)
+        {
+            REQUIRE(results[i].code == external_function_result_instruction_limit_reached);
+            REQUIRE(results[i].usage.executed_instructions == (expected_instructions / 2));
+        }
+    }
+    {
+        /*a task that never finishes does not keep the other one from finishing*/
+        test_program endless;
+        test_program_create(&endless, endless_source);
+        shared_program const endless_shared = shared_program_create(&endless.checked, endless.globals);
+        execution_task *const looping = execution_task_create(&endless_shared, unlimited_budget());
+        execution_task *const finishing = execution_task_create(&shared, unlimited_budget());
+        uint64_t const slice = 50;
+        size_t turns = 0;
+        for (;;)
+        {
+            REQUIRE(!execution_task_run(looping, slice));
+            ++turns;
+            if (execution_task_run(finishing, slice))
+            {
+                break;
+            }
+        }
+        REQUIRE(finishing->result.code == external_function_result_success);
+        REQUIRE(integer_equal(value_as_integer(finishing->result.if_success), integer_create(0, 144)));
+        REQUIRE(turns >= (expected_instructions / slice) / 2);
+        /*every slice ends at the first safepoint after the limit, which is reached within a few instructions here*/
+        REQUIRE(looping->context.usage.executed_instructions >= (turns * slice));
+        REQUIRE(looping->context.usage.executed_instructions <= (turns * (slice + 10)));
+        /*the suspended frames are released*/
+        execution_task_free(looping);
+        execution_task_free(finishing);
+        shared_program_free(endless_shared);
+        test_program_free(&endless);
+    }
+
+    shared_program_free(shared);
+    test_program_free(&fibonacci);
+}
+
+void test_execution(void)
+{
+    test_worker_pool();
+    test_shared_program();
+    test_round_robin();
+}
@@ -0,0 +1,95 @@
+#include "test_garbage_collector.h"
+#include "lpg_collect_garbage.h"
+#include "test.h"
+#include <string.h>
+
+static unicode_view allocate_string(garbage_collector *const gc, char const *const content)
+{
+    size_t const length = strlen(content);
+    char *const copy = garbage_collector_allocate(gc, length);
+    memcpy(copy, content, length);
+    return unicode_view_create(copy, length);
+}
+
+void test_garbage_collector(void)
+{
+    {
+        /*the memory of a heap that does not collect is never marked*/
+        garbage_collector gc = garbage_collector_create(SIZE_MAX);
+        void *const memory = garbage_collector_allocate(&gc, 10);
+        REQUIRE(!garbage_collector_mark(&gc, memory));
+        REQUIRE(!garbage_collector_is_collection_due(&gc));
+        REQUIRE(gc.statistics.allocated_bytes == 10);
+        garbage_collector_free(gc);
+    }
+    {
+        garbage_collector gc = garbage_collector_create_collecting(SIZE_MAX, 100);
+        REQUIRE(!garbage_collector_is_collection_due(&gc));
+        garbage_collector_allocate(&gc, 99);
+        REQUIRE(!garbage_collector_is_collection_due(&gc));
+        garbage_collector_allocate(&gc, 1);
+        REQUIRE(garbage_collector_is_collection_due(&gc));
+        value_stack stack = value_stack_create();
+        collect_garbage(&gc, &stack, NULL, 0);
+        REQUIRE(gc.current_heap_size == 0);
+        REQUIRE(gc.statistics.allocated_bytes == 100);
+        REQUIRE(gc.statistics.collected_bytes == 100);
+        REQUIRE(gc.statistics.live_bytes_after_collection == 0);
+        REQUIRE(gc.statistics.peak_heap_size == 100);
+        REQUIRE(gc.statistics.collections == 1);
+        value_stack_free(stack);
+        garbage_collector_free(gc);
+    }
+    {
+        /*values on the stack and globals are roots, registers that have not been written are skipped*/
+        garbage_collector gc = garbage_collector_create_collecting(SIZE_MAX, 0);
+        value_stack stack = value_stack_create();
+        value *const registers = value_stack_push(&stack, 3);
+        memset(registers, 0, sizeof(*registers) * 3);
+        registers[0] = value_from_string(allocate_string(&gc, "kept"));
+        allocate_string(&gc, "garbage");
+        value const globals[] = {value_from_string(allocate_string(&gc, "global"))};
+        collect_garbage(&gc, &stack, globals, 1);
+        REQUIRE(gc.statistics.collected_bytes == 7);
+        REQUIRE(gc.statistics.live_bytes_after_collection == 10);
+        REQUIRE(gc.current_heap_size == 10);
+        REQUIRE(unicode_view_equals_c_str(value_as_string(registers[0]), "kept"));
+        REQUIRE(unicode_view_equals_c_str(value_as_string(globals[0]), "global"));
+        value_stack_pop(&stack, 3);
+        collect_garbage(&gc, &stack, NULL, 0);
+        REQUIRE(gc.current_heap_size == 0);
+        REQUIRE(gc.statistics.collections == 2);
+        value_stack_free(stack);
+        garbage_collector_free(gc);
+    }
+    {
+        /*everything reachable through tuples, arrays and enum states survives*/
+        garbage_collector gc = garbage_collector_create_collecting(SIZE_MAX, 0);
+        value *const state = garbage_collector_allocate(&gc, sizeof(*state));
+        *state = value_from_string(allocate_string(&gc, "state"));
+        value *const array_elements = garbage_collector_allocate_array(&gc, 4, sizeof(*array_elements));
+        array_elements[0] = value_from_enum_element(1, state);
+        array_value *const array = garbage_collector_allocate(&gc, sizeof(*array));
+        *array = array_value_create(array_elements, 1, 4, type_from_unit());
+        value *const tuple_elements = garbage_collector_allocate_array(&gc, 2, sizeof(*tuple_elements));
+        tuple_elements[0] = value_from_array(array);
+        tuple_elements[1] = value_from_small_integer(123);
+        size_t const reachable = gc.current_heap_size;
+        value_stack stack = value_stack_create();
+        value *const registers = value_stack_push(&stack, 1);
+        registers[0] = value_from_tuple(value_tuple_create(tuple_elements, 2));
+        allocate_string(&gc, "garbage");
+        collect_garbage(&gc, &stack, NULL, 0);
+        REQUIRE(gc.current_heap_size == reachable);
+        REQUIRE(gc.statistics.collected_bytes == 7);
+        REQUIRE(value_as_tuple(registers[0]).elements[0].array->count == 1);
+        REQUIRE(unicode_view_equals_c_str(
+            value_as_string(*value_as_tuple(registers[0]).elements[0].array->elements[0].enum_state), "state"));
+        value_stack_pop(&stack, 1);
+        collect_garbage(&gc, &stack, NULL, 0);
+        REQUIRE(gc.current_heap_size == 0);
+        REQUIRE(gc.statistics.collected_bytes == gc.statistics.allocated_bytes);
+        value_stack_free(stack);
+        garbage_collector_free(gc);
+    }
+}
@@ -16,6 +16,7 @@
 #include "lpg_remove_dead_code.h"
 #include "lpg_rename_file.h"
 #include "lpg_save_expression.h"
+#include "lpg_save_program.h"
 #include "lpg_standard_library.h"
 #include "lpg_stream_writer.h"
 #include "lpg_thread.h"
@@ -53,7 +54,7 @@ static external_function_result assert_impl(value const *const captures, void *e
     (void)captures;
     (void)environment;
     ASSUME(arguments[0].kind == value_kind_enum_element);
-    enum_element_id const argument = arguments[0].enum_element.which;
+    enum_element_id const argument = value_as_enum_element(arguments[0]).which;
     REQUIRE(argument == 1);
     return external_function_result_from_success(value_from_unit());
 }
@@ -182,7 +183,7 @@ static void run_c_test(unicode_view const test_name, unicode_view const c_source
             unicode_view const cmake_arguments[] = {unicode_view_from_c_str("-DCMAKE_BUILD_TYPE=DEBUG"),
 #ifndef _MSC_VER
                                                     unicode_view_from_c_str("-G"),
-                                                    unicode_view_from_c_str("CodeBlocks - Ninja"),
+                                                    unicode_view_from_c_str("Unix Makefiles"),
 #endif
                                                     unicode_view_from_c_str(".")};
             create_process_result const cmake_process = create_process(
@@ -214,7 +215,7 @@ static void run_c_test(unicode_view const test_name, unicode_view const c_source
 #endif
                                                                )};
         unicode_string const test_executable = path_combine(pieces, LPG_ARRAY_SIZE(pieces));
-#ifdef __linux__
+#if 0 //LOCALPATCH
         unicode_view const arguments[] = {unicode_view_from_c_str("--error-exitcode=42"),
                                           unicode_view_from_c_str("--leak-check=full"),
                                           unicode_view_from_string(test_executable)};
@@ -236,35 +237,122 @@ out:
     unicode_string_free(&last_success);
 }
 
+typedef struct interpreter_run
+{
+    external_function_result result;
+    uint64_t executed_instructions;
+} interpreter_run;
+
+/*A slice of 0 runs the program in one go. Otherwise the entry point is a resumable_call which is suspended after
+ * every slice.*/
+static interpreter_run run_interpreter(checked_program const program, value const *const globals,
+                                       bytecode_cache *const compiled_functions, garbage_collector gc,
+                                       uint64_t const slice)
+{
+    value_stack stack = value_stack_create();
+    execution_usage usage = execution_usage_create();
+    interpreter context = interpreter_create(
+        globals, &gc, &stack, compiled_functions, &program.functions, &program.interfaces,
+        execution_budget_create(UINT64_MAX, 200, interpreter_default_max_frame_memory, SIZE_MAX,
+                                duration_from_milliseconds(execution_budget_no_deadline)),
+        &usage);
+    external_function_result result = external_function_result_create_unavailable();
+    if (slice == 0)
+    {
+        result = call_checked_function(
+            program.functions[0], optional_function_id_create(0), NULL, optional_value_empty, NULL, &context);
+    }
+    else
+    {
+        resumable_call *const entry_point = resumable_call_create(0, NULL, optional_value_empty, NULL, &context);
+        REQUIRE(entry_point);
+        while (!resumable_call_run(entry_point, slice, &context, &result))
+        {
+        }
+        resumable_call_free(entry_point, &context);
+    }
+    REQUIRE(usage.current_recursion == 0);
+    REQUIRE(usage.used_frame_memory == 0);
+    value_stack_free(stack);
+    garbage_collector_free(gc);
+    interpreter_run const run = {result, usage.executed_instructions};
+    return run;
+}
+
+/*the tree walker is the reference for the bytecode interpreter and resumable calls*/
+static void run_interpreters(checked_program const program, value const *const globals)
+{
+    interpreter_run const reference = run_interpreter(program, globals, NULL, garbage_collector_create(SIZE_MAX), 0);
+    REQUIRE(reference.result.code == external_function_result_success);
+    {
+        bytecode_cache compiled_functions = bytecode_cache_create();
+        /*collecting at every opportunity makes it likely that a missing root breaks a test*/
+        interpreter_run const compiled =
+            run_interpreter(program, globals, &compiled_functions, garbage_collector_create_collecting(SIZE_MAX, 0), 0);
+        bytecode_cache_free(compiled_functions);
+        REQUIRE(compiled.result.code == external_function_result_success);
+        REQUIRE(compiled.executed_instructions == reference.executed_instructions);
+    }
+    {
+        /*the program is suspended at almost every safepoint*/
+        bytecode_cache compiled_functions = bytecode_cache_create();
+        interpreter_run const resumed =
+            run_interpreter(program, globals, &compiled_functions, garbage_collector_create_collecting(SIZE_MAX, 0), 3);
+        bytecode_cache_free(compiled_functions);
+        REQUIRE(resumed.result.code == external_function_result_success);
+        REQUIRE(resumed.executed_instructions == reference.executed_instructions);
+    }
+}
+
+/*the loaded program has to behave like the original and has to be saved exactly like it*/
+static void test_save_and_load(checked_program const program, structure const global_object,
+                               value const *const globals)
+{
+    memory_writer saved = {NULL, 0, 0};
+    REQUIRE(success_yes == save_checked_program(&program, global_object, memory_writer_erase(&saved)));
+    optional_checked_program const loaded = load_checked_program(memory_writer_content(saved), global_object);
+    REQUIRE(loaded.is_set);
+    if (loaded.is_set)
+    {
+        run_interpreters(loaded.value, globals);
+        memory_writer saved_again = {NULL, 0, 0};
+        REQUIRE(success_yes == save_checked_program(&loaded.value, global_object, memory_writer_erase(&saved_again)));
+        REQUIRE(unicode_view_equals(memory_writer_content(saved), memory_writer_content(saved_again)));
+        memory_writer_free(&saved_again);
+        checked_program_free(&loaded.value);
+    }
+    memory_writer_free(&saved);
+}
+
+static value external_global(external_function *const implementation_, structure const global_object,
+                             struct_member_id const member, garbage_collector *const boxes)
+{
+    return value_from_function_pointer(
+        function_pointer_value_from_external(
+            implementation_, NULL, NULL, *global_object.members[member].what.function_pointer_),
+        boxes);
+}
+
 static void test_all_backends(unicode_view const test_name, checked_program const program,
                               structure const global_object, unicode_view const c_test_dir)
 {
     REQUIRE(success_yes == create_directory(c_test_dir));
     {
+        garbage_collector boxes = garbage_collector_create(SIZE_MAX);
         value const globals_values[] = {
-            /*0 side_effect*/ value_from_function_pointer(function_pointer_value_from_external(
-                side_effect_impl, NULL, NULL, *global_object.members[0].what.function_pointer_)),
-            /*1 integer_to_string*/ value_from_function_pointer(function_pointer_value_from_external(
-                integer_to_string_impl, NULL, NULL, *global_object.members[1].what.function_pointer_)),
+            /*0 side_effect*/ external_global(side_effect_impl, global_object, 0, &boxes),
+            /*1 integer_to_string*/ external_global(integer_to_string_impl, global_object, 1, &boxes),
             /*2 type_equals*/ value_from_unit(),
             /*3 boolean*/ global_object.members[3].compile_time_value.value_,
-            /*4 assert*/ value_from_function_pointer(function_pointer_value_from_external(
-                assert_impl, NULL, NULL, *global_object.members[4].what.function_pointer_)),
-            /*5 integer_less*/ value_from_function_pointer(function_pointer_value_from_external(
-                integer_less_impl, NULL, NULL, *global_object.members[5].what.function_pointer_)),
-            /*6 integer_equals*/ value_from_function_pointer(function_pointer_value_from_external(
-                integer_equals_impl, NULL, NULL, *global_object.members[6].what.function_pointer_)),
-            /*7 not*/ value_from_function_pointer(function_pointer_value_from_external(
-                not_impl, NULL, NULL, *global_object.members[7].what.function_pointer_)),
-            /*8 concat*/ value_from_function_pointer(function_pointer_value_from_external(
-                concat_impl, NULL, NULL, *global_object.members[8].what.function_pointer_)),
-            /*9 string_equals*/ value_from_function_pointer(function_pointer_value_from_external(
-                string_equals_impl, NULL, NULL, *global_object.members[9].what.function_pointer_)),
-            /*10 int*/ value_from_function_pointer(function_pointer_value_from_external(
-                int_impl, NULL, NULL, *global_object.members[10].what.function_pointer_)),
-            /*11 host_value*/ value_from_type(type_from_host_value()),
-            /*12 fail*/ value_from_function_pointer(function_pointer_value_from_external(
-                fail_impl, NULL, NULL, *global_object.members[12].what.function_pointer_)),
+            /*4 assert*/ external_global(assert_impl, global_object, 4, &boxes),
+            /*5 integer_less*/ external_global(integer_less_impl, global_object, 5, &boxes),
+            /*6 integer_equals*/ external_global(integer_equals_impl, global_object, 6, &boxes),
+            /*7 not*/ external_global(not_impl, global_object, 7, &boxes),
+            /*8 concat*/ external_global(concat_impl, global_object, 8, &boxes),
+            /*9 string_equals*/ external_global(string_equals_impl, global_object, 9, &boxes),
+            /*10 int*/ external_global(int_impl, global_object, 10, &boxes),
+            /*11 host_value*/ value_from_type(type_from_host_value(), &boxes),
+            /*12 fail*/ external_global(fail_impl, global_object, 12, &boxes),
             /*13 subtract_result*/ global_object.members[13].compile_time_value.value_,
             /*14 subtract*/ global_object.members[14].compile_time_value.value_,
             /*15 add_result*/ global_object.members[15].compile_time_value.value_,
@@ -282,9 +370,9 @@ static void test_all_backends(unicode_view const test_name, checked_program cons
             //
         };
         LPG_STATIC_ASSERT(LPG_ARRAY_SIZE(globals_values) == standard_library_element_count);
-        garbage_collector gc = garbage_collector_create(SIZE_MAX);
-        interpret(program, globals_values, &gc);
-        garbage_collector_free(gc);
+        run_interpreters(program, globals_values);
+        test_save_and_load(program, global_object, globals_values);
+        garbage_collector_free(boxes);
     }
 
     {
@@ -392,7 +480,7 @@ static void expect_output_impl(unicode_view const test_name, unicode_view const
     source_file_lines_owning const lines = source_file_lines_owning_scan(source);
     checked_program checked = check(root, global_object, expect_no_errors, &loader,
                                     source_file_create(test_name, source, source_file_lines_from_owning(lines)),
-                                    current_import_directory, 200000, NULL);
+                                    current_import_directory, default_compile_time_budget(200000), NULL, NULL);
     sequence_free(&root);
     source_file_lines_owning_free(lines);
 
@@ -0,0 +1,114 @@
+#include "test_instantiation_index.h"
+#include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
+#include "lpg_allocate.h"
+#include "lpg_check.h"
+#include "lpg_instantiation_index.h"
+#include "lpg_standard_library.h"
+#include "test.h"
+#include <string.h>
+
+static void test_insert_and_find(void)
+{
+    instantiation_index index = instantiation_index_create();
+    REQUIRE(instantiation_index_find(index, 0, NULL, 0).state == optional_empty);
+
+    /*enough entries to make the table grow a few times*/
+    size_t const argument_count = 300;
+    value *const arguments = allocate_array(argument_count, sizeof(*arguments));
+    for (size_t i = 0; i < argument_count; ++i)
+    {
+        arguments[i] = value_from_small_integer(i);
+        instantiation_index_insert(&index, 1, arguments + i, 1, i);
+    }
+    instantiation_index_insert(&index, 2, NULL, 0, argument_count);
+    REQUIRE(index.count == (argument_count + 1));
+
+    for (size_t i = 0; i < argument_count; ++i)
+    {
+        value const argument = value_from_small_integer(i);
+        optional_size const found = instantiation_index_find(index, 1, &argument, 1);
+        REQUIRE(found.state == optional_set);
+        REQUIRE(found.value_if_set == i);
+    }
+    {
+        optional_size const found = instantiation_index_find(index, 2, NULL, 0);
+        REQUIRE(found.state == optional_set);
+        REQUIRE(found.value_if_set == argument_count);
+    }
+
+    /*different arguments or generics are different instantiations*/
+    {
+        value const argument = value_from_small_integer(argument_count);
+        REQUIRE(instantiation_index_find(index, 1, &argument, 1).state == optional_empty);
+    }
+    {
+        value const argument = value_from_small_integer(0);
+        REQUIRE(instantiation_index_find(index, 0, &argument, 1).state == optional_empty);
+        REQUIRE(instantiation_index_find(index, 2, &argument, 1).state == optional_empty);
+        REQUIRE(instantiation_index_find(index, 1, NULL, 0).state == optional_empty);
+    }
+    instantiation_index_free(index);
+    deallocate(arguments);
+}
+
+/*the same instantiation has to be the same type or the assignments would not compile*/
+static char const *const repeated_instantiations_source = "let std = import std\n"
+                                                          "let a = std.option[int(0, 1)]\n"
+                                                          "let b = std.option[int(0, 2)]\n"
+                                                          "let c = std.option[int(0, 1)]\n"
+                                                          "let x : c = a.some(1)\n"
+                                                          "let y : b = std.option[int(0, 2)].none\n"
+                                                          "let d = std.array[int(0, 1)]\n"
+                                                          "let e : std.array[int(0, 1)] = new_array(int(0, 1))\n"
+                                                          "let f : d = e\n";
+
+static void expect_no_errors(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void expect_no_complete_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void test_repeated_instantiations(void)
+{
+    standard_library_description const std_library = describe_standard_library();
+    expression_pool pool = expression_pool_create();
+    test_parser_user user = {{repeated_instantiations_source, strlen(repeated_instantiations_source),
+                              source_location_create(0, 0)},
+                             NULL,
+                             0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, &pool);
+    sequence root = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    unicode_string const module_directory = find_builtin_module_directory();
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    source_file_lines_owning const lines =
+        source_file_lines_owning_scan(unicode_view_from_c_str(repeated_instantiations_source));
+    checked_program checked = check(
+        root, std_library.globals, expect_no_errors, &loader,
+        source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(repeated_instantiations_source),
+                           source_file_lines_from_owning(lines)),
+        unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
+    sequence_free(&root);
+    checked_program_free(&checked);
+    unicode_string_free(&module_directory);
+    source_file_lines_owning_free(lines);
+    expression_pool_free(pool);
+    standard_library_description_free(&std_library);
+}
+
+void test_instantiation_index(void)
+{
+    test_insert_and_find();
+    test_repeated_instantiations();
+}
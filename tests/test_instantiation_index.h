@@ -0,0 +1,3 @@
+#pragma once
+
+void test_instantiation_index(void);
@@ -61,6 +61,7 @@ static void test_parse_integer_overflow(char const *input)
 }
 
 static void test_add(void);
+static void test_small(void);
 static void test_multiply(void);
 static void test_shift_left(void);
 static void test_parse_integer(void);
@@ -95,6 +96,7 @@ void test_integer(void)
     test_integer_format();
 
     test_add();
+    test_small();
     test_multiply();
     test_shift_left();
     test_parse_integer();
@@ -276,3 +278,27 @@ static void test_add(void)
     test_add_overflow(integer_create(0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu),
                       integer_create(0xFFFFFFFFFFFFFFFFu, 0xFFFFFFFFFFFFFFFFu));
 }
+
+static void test_small(void)
+{
+    REQUIRE(integer_is_small(integer_create(0, 0xFFFFFFFFFFFFFFFFu)));
+    REQUIRE(!integer_is_small(integer_create(1, 0)));
+
+    uint64_t result = 0;
+    REQUIRE(integer_add_small(2, 3, &result));
+    REQUIRE(result == 5);
+    REQUIRE(integer_add_small(0xFFFFFFFFFFFFFFFEu, 1, &result));
+    REQUIRE(result == 0xFFFFFFFFFFFFFFFFu);
+    REQUIRE(!integer_add_small(0xFFFFFFFFFFFFFFFFu, 1, &result));
+
+    REQUIRE(integer_subtract_small(3, 3, &result));
+    REQUIRE(result == 0);
+    REQUIRE(!integer_subtract_small(2, 3, &result));
+
+    /*a sum that does not fit into 64 bits falls back to 128 bits*/
+    test_add_success(integer_create(0, 0xFFFFFFFFFFFFFFFFu), integer_create(0, 1), integer_create(1, 0));
+    REQUIRE(integer_difference_equals(integer_difference_create(integer_create(0, 0xFFFFFFFFFFFFFFFFu)),
+                                      integer_subtract(integer_create(1, 0), integer_create(0, 1))));
+    REQUIRE(integer_difference_equals(
+        integer_difference_negative(), integer_subtract(integer_create(0, 0xFFFFFFFFFFFFFFFEu), integer_create(1, 0))));
+}
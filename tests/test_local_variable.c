@@ -0,0 +1,85 @@
+#include "test_local_variable.h"
+#include "lpg_local_variable.h"
+#include "test.h"
+#include <stdio.h>
+
+static void test_identifier_table(void)
+{
+    identifier_table table = identifier_table_create();
+    REQUIRE(identifier_table_find(table, unicode_view_from_c_str("a")).state == optional_empty);
+    identifier_id const a = identifier_table_intern(&table, unicode_view_from_c_str("a"));
+    identifier_id const b = identifier_table_intern(&table, unicode_view_from_c_str("b"));
+    REQUIRE(a != b);
+    REQUIRE(identifier_table_intern(&table, unicode_view_from_c_str("a")) == a);
+    REQUIRE(identifier_table_find(table, unicode_view_from_c_str("b")).value_if_set == b);
+
+    /*enough names to make the table grow a few times*/
+    for (size_t i = 0; i < 300; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "name%zu", i);
+        identifier_id const interned = identifier_table_intern(&table, unicode_view_from_c_str(name));
+        optional_size const found = identifier_table_find(table, unicode_view_from_c_str(name));
+        REQUIRE(found.state == optional_set);
+        REQUIRE(found.value_if_set == interned);
+    }
+    REQUIRE(table.count == 302);
+    REQUIRE(identifier_table_find(table, unicode_view_from_c_str("a")).value_if_set == a);
+    REQUIRE(identifier_table_find(table, unicode_view_from_c_str("name300")).state == optional_empty);
+    identifier_table_free(table);
+}
+
+static local_variable make_variable(unicode_view const name, register_id const where)
+{
+    return local_variable_create(
+        name, local_variable_phase_initialized, type_from_unit(), optional_value_empty, where, NULL);
+}
+
+static void test_container(void)
+{
+    identifier_table identifiers = identifier_table_create();
+    arena memory = arena_create();
+    local_variable_container variables = local_variable_container_create(&identifiers, &memory);
+    REQUIRE(!find_local_variable(&variables, unicode_view_from_c_str("a")));
+
+    char names[100][8];
+    for (register_id i = 0; i < 100; ++i)
+    {
+        snprintf(names[i], sizeof(names[i]), "v%u", (unsigned)i);
+        add_local_variable(&variables, make_variable(unicode_view_from_c_str(names[i]), i));
+    }
+    for (register_id i = 0; i < 100; ++i)
+    {
+        local_variable const *const found = find_local_variable(&variables, unicode_view_from_c_str(names[i]));
+        REQUIRE(found);
+        REQUIRE(found->where == i);
+    }
+
+    /*the first variable with a name is found until it is removed*/
+    add_local_variable(&variables, make_variable(unicode_view_from_c_str("v5"), 1000));
+    REQUIRE(find_local_variable(&variables, unicode_view_from_c_str("v5"))->where == 5);
+    local_variable_container_truncate(&variables, 100);
+    REQUIRE(find_local_variable(&variables, unicode_view_from_c_str("v5"))->where == 5);
+
+    local_variable_container_truncate(&variables, 50);
+    REQUIRE(variables.count == 50);
+    for (register_id i = 0; i < 100; ++i)
+    {
+        local_variable const *const found = find_local_variable(&variables, unicode_view_from_c_str(names[i]));
+        REQUIRE((found != NULL) == (i < 50));
+    }
+    REQUIRE(local_variable_name_exists(variables, unicode_view_from_c_str("v49")));
+    REQUIRE(!local_variable_name_exists(variables, unicode_view_from_c_str("v50")));
+
+    add_local_variable(&variables, make_variable(unicode_view_from_c_str("v70"), 2000));
+    REQUIRE(find_local_variable(&variables, unicode_view_from_c_str("v70"))->where == 2000);
+    local_variable_container_free(variables);
+    arena_free(memory);
+    identifier_table_free(identifiers);
+}
+
+void test_local_variable(void)
+{
+    test_identifier_table();
+    test_container();
+}
@@ -0,0 +1,92 @@
+#include "test_match_table.h"
+#include "lpg_array_size.h"
+#include "lpg_match_table.h"
+#include "test.h"
+
+static instruction integer_literal(register_id const into, uint64_t const key)
+{
+    return instruction_create_literal(literal_instruction_create(
+        into, value_from_small_integer(key), type_from_integer_range(integer_range_create(
+                                                              integer_create(0, key), integer_create(0, key)))));
+}
+
+static match_instruction_case value_case(register_id const key)
+{
+    return match_instruction_case_create_value(
+        key, instruction_sequence_create(NULL, 0, 0), optional_register_id_create_empty());
+}
+
+static match_instruction_case default_case(void)
+{
+    return match_instruction_case_create_default(
+        instruction_sequence_create(NULL, 0, 0), optional_register_id_create_empty());
+}
+
+static match_instruction create_match(match_instruction_case *const cases, size_t const count)
+{
+    return match_instruction_create(0, cases, count, 100, type_from_unit());
+}
+
+static size_t find_integer(match_table const *const table, uint64_t const key)
+{
+    return match_table_find(table, value_from_small_integer(key));
+}
+
+void test_match_table(void)
+{
+    {
+        instruction const literals[] = {integer_literal(1, 2), integer_literal(2, 0), integer_literal(3, 1)};
+        match_instruction_case cases[] = {value_case(1), value_case(2), value_case(3)};
+        match_table const table =
+            match_table_create(create_match(cases, LPG_ARRAY_SIZE(cases)), literals, LPG_ARRAY_SIZE(literals));
+        REQUIRE(table.kind == match_table_kind_dense);
+        REQUIRE(table.key_kind == match_key_kind_integer);
+        REQUIRE(table.default_case == match_table_no_case);
+        REQUIRE(find_integer(&table, 0) == 1);
+        REQUIRE(find_integer(&table, 1) == 2);
+        REQUIRE(find_integer(&table, 2) == 0);
+        match_table_free(table);
+    }
+    {
+        instruction const literals[] = {integer_literal(1, 1000), integer_literal(2, 7), integer_literal(3, 123456)};
+        match_instruction_case cases[] = {value_case(1), default_case(), value_case(2), value_case(3)};
+        match_table const table =
+            match_table_create(create_match(cases, LPG_ARRAY_SIZE(cases)), literals, LPG_ARRAY_SIZE(literals));
+        REQUIRE(table.kind == match_table_kind_sparse);
+        REQUIRE(table.default_case == 1);
+        REQUIRE(find_integer(&table, 7) == 2);
+        REQUIRE(find_integer(&table, 1000) == 0);
+        REQUIRE(find_integer(&table, 123456) == 3);
+        REQUIRE(find_integer(&table, 8) == 1);
+        REQUIRE(find_integer(&table, 0) == 1);
+        garbage_collector boxes = garbage_collector_create(SIZE_MAX);
+        REQUIRE(match_table_find(&table, value_from_integer(integer_create(1, 7), &boxes)) == 1);
+        garbage_collector_free(boxes);
+        match_table_free(table);
+    }
+    {
+        instruction const literals[] = {instruction_create_literal(literal_instruction_create(
+            1, value_from_enum_element(1, NULL), type_from_enumeration(0)))};
+        match_instruction_case cases[] = {
+            match_instruction_case_create_stateful_enum(match_instruction_case_stateful_enum_create(0, 2),
+                                                        instruction_sequence_create(NULL, 0, 0),
+                                                        optional_register_id_create_empty()),
+            value_case(1)};
+        match_table const table =
+            match_table_create(create_match(cases, LPG_ARRAY_SIZE(cases)), literals, LPG_ARRAY_SIZE(literals));
+        REQUIRE(table.kind == match_table_kind_dense);
+        REQUIRE(table.key_kind == match_key_kind_enum_element);
+        REQUIRE(match_table_find(&table, value_from_enum_element(1, NULL)) == 1);
+        REQUIRE(match_table_find(&table, value_from_enum_element(0, NULL)) == 0);
+        match_table_free(table);
+    }
+    {
+        /*the key of the second case is not a known literal*/
+        instruction const literals[] = {integer_literal(1, 0)};
+        match_instruction_case cases[] = {value_case(1), value_case(2)};
+        match_table const table =
+            match_table_create(create_match(cases, LPG_ARRAY_SIZE(cases)), literals, LPG_ARRAY_SIZE(literals));
+        REQUIRE(table.kind == match_table_kind_linear);
+        match_table_free(table);
+    }
+}
@@ -0,0 +1,207 @@
+#include "test_module_cache.h"
+#include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
+#include "lpg_check.h"
+#include "lpg_hash.h"
+#include "lpg_module_cache.h"
+#include "lpg_prefetch_modules.h"
+#include "lpg_standard_library.h"
+#include "test.h"
+#include <string.h>
+
+static cached_module *store_empty_module(module_cache *const cache, char const *const path, uint64_t const content_hash)
+{
+    sequence const parsed = sequence_create(NULL, 0, source_location_create(0, 0));
+    source_file_owning const source =
+        source_file_owning_create(unicode_string_from_c_str(path), unicode_string_from_c_str(""),
+                                  source_file_lines_owning_scan(unicode_view_from_c_str("")));
+    return module_cache_store(
+        cache, unicode_string_from_c_str(path), content_hash, source, expression_pool_create(), parsed);
+}
+
+static void test_store_and_find(void)
+{
+    module_cache cache = module_cache_create();
+    REQUIRE(!module_cache_find(&cache, unicode_view_from_c_str("/a.lpg"), 1));
+    cached_module *const a = store_empty_module(&cache, "/a.lpg", 1);
+    cached_module *const b = store_empty_module(&cache, "/b.lpg", 1);
+    REQUIRE(cache.count == 2);
+    REQUIRE(module_cache_find(&cache, unicode_view_from_c_str("/a.lpg"), 1) == a);
+    REQUIRE(module_cache_find(&cache, unicode_view_from_c_str("/b.lpg"), 1) == b);
+    REQUIRE(cache.hits == 2);
+
+    /*the content of the file has changed*/
+    REQUIRE(!module_cache_find(&cache, unicode_view_from_c_str("/a.lpg"), 2));
+    cached_module *const changed = store_empty_module(&cache, "/a.lpg", 2);
+    REQUIRE(cache.count == 2);
+    REQUIRE(module_cache_find(&cache, unicode_view_from_c_str("/a.lpg"), 2) == changed);
+    REQUIRE(!module_cache_find(&cache, unicode_view_from_c_str("/a.lpg"), 1));
+    REQUIRE(cache.hits == 3);
+    module_cache_free(cache);
+}
+
+static char const importing_source[] = "let a = import std\n"
+                                       "let b = import std\n"
+                                       "let c : a.option[int(0, 1)] = b.option[int(0, 1)].none\n";
+
+static void expect_no_errors(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void expect_no_complete_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void count_module_reads(unicode_view path, unicode_view content, callback_user user)
+{
+    (void)path;
+    (void)content;
+    size_t *const reads = user;
+    ++(*reads);
+}
+
+static sequence parse_importing_program(expression_pool *const pool)
+{
+    test_parser_user user = {{importing_source, strlen(importing_source), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, pool);
+    sequence const root = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    return root;
+}
+
+static void check_importing_program(module_loader *const loader, unicode_view const import_directory,
+                                    structure const globals)
+{
+    expression_pool pool = expression_pool_create();
+    sequence root = parse_importing_program(&pool);
+    source_file_lines_owning const lines = source_file_lines_owning_scan(unicode_view_from_c_str(importing_source));
+    checked_program checked =
+        check(root, globals, expect_no_errors, loader,
+              source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(importing_source),
+                                 source_file_lines_from_owning(lines)),
+              import_directory, default_compile_time_budget(100000), NULL, NULL);
+    sequence_free(&root);
+    REQUIRE(checked.function_count >= 1);
+    checked_program_free(&checked);
+    source_file_lines_owning_free(lines);
+    expression_pool_free(pool);
+}
+
+static void test_checks_share_parsed_modules(void)
+{
+    standard_library_description const std_library = describe_standard_library();
+    unicode_string const module_directory = find_builtin_module_directory();
+    module_cache cache = module_cache_create();
+    size_t reads = 0;
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    loader.on_module_read = count_module_reads;
+    loader.on_module_read_user = &reads;
+    loader.cache = &cache;
+
+    /*both imports refer to the same modules which are only loaded once*/
+    check_importing_program(&loader, unicode_view_from_string(module_directory), std_library.globals);
+    size_t const module_count = reads;
+    REQUIRE(module_count >= 1);
+    REQUIRE(cache.count == module_count);
+    REQUIRE(cache.hits == 0);
+
+    /*the files are read again to detect changes, but they are not parsed again*/
+    check_importing_program(&loader, unicode_view_from_string(module_directory), std_library.globals);
+    REQUIRE(reads == (module_count * 2));
+    REQUIRE(cache.count == module_count);
+    REQUIRE(cache.hits == module_count);
+
+    module_cache_free(cache);
+    unicode_string_free(&module_directory);
+    standard_library_description_free(&std_library);
+}
+
+static void test_prefetch(void)
+{
+    standard_library_description const std_library = describe_standard_library();
+    unicode_string const module_directory = find_builtin_module_directory();
+    expression_pool pool = expression_pool_create();
+    sequence const root = parse_importing_program(&pool);
+    size_t reads = 0;
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    loader.on_module_read = count_module_reads;
+    loader.on_module_read_user = &reads;
+
+    /*the modules that check loads one after another*/
+    size_t module_count = 0;
+    {
+        module_cache cache = module_cache_create();
+        loader.cache = &cache;
+        check_importing_program(&loader, unicode_view_from_string(module_directory), std_library.globals);
+        module_count = cache.count;
+        module_cache_free(cache);
+    }
+    REQUIRE(module_count >= 1);
+
+    for (size_t worker_count = 1; worker_count <= 4; ++worker_count)
+    {
+        module_cache cache = module_cache_create();
+        loader.cache = &cache;
+        prefetch_modules(&loader, root, unicode_view_from_string(module_directory), worker_count);
+        REQUIRE(cache.count == module_count);
+        REQUIRE(cache.hits == 0);
+
+        /*nothing has changed, so nothing is parsed again*/
+        cached_module *const first = cache.entries[0];
+        prefetch_modules(&loader, root, unicode_view_from_string(module_directory), worker_count);
+        REQUIRE(cache.count == module_count);
+        REQUIRE(cache.entries[0] == first);
+
+        /*check does not have to parse any module*/
+        check_importing_program(&loader, unicode_view_from_string(module_directory), std_library.globals);
+        REQUIRE(cache.count == module_count);
+        REQUIRE(cache.hits == module_count);
+        module_cache_free(cache);
+    }
+
+    sequence_free(&root);
+    expression_pool_free(pool);
+    unicode_string_free(&module_directory);
+    standard_library_description_free(&std_library);
+}
+
+static void test_prefetch_leaves_syntax_errors_to_check(void)
+{
+    unicode_view const pieces[] = {
+        path_remove_leaf(unicode_view_from_c_str(__FILE__)), unicode_view_from_c_str("modules")};
+    unicode_string const module_directory = path_combine(pieces, LPG_ARRAY_SIZE(pieces));
+    char const source[] = "let a = import syntaxerror\n";
+    expression_pool pool = expression_pool_create();
+    test_parser_user user = {{source, strlen(source), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, &pool);
+    sequence const root = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    module_cache cache = module_cache_create();
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    loader.cache = &cache;
+    prefetch_modules(&loader, root, unicode_view_from_string(module_directory), 2);
+    REQUIRE(cache.count == 0);
+    module_cache_free(cache);
+    sequence_free(&root);
+    expression_pool_free(pool);
+    unicode_string_free(&module_directory);
+}
+
+void test_module_cache(void)
+{
+    test_store_and_find();
+    test_checks_share_parsed_modules();
+    test_prefetch();
+    test_prefetch_leaves_syntax_errors_to_check();
+}
@@ -1,4 +1,5 @@
 #include "test_path.h"
+#include "find_builtin_module_directory.h"
 #include "lpg_array_size.h"
 #include "lpg_path.h"
 #include "test.h"
@@ -29,4 +30,29 @@ void test_path(void)
         REQUIRE(unicode_view_equals_c_str(unicode_view_from_string(combined), "a/b/c"));
         unicode_string_free(&combined);
     }
+    {
+        unicode_string const module_directory = find_builtin_module_directory();
+        unicode_view const direct_pieces[] = {
+            unicode_view_from_string(module_directory), unicode_view_from_c_str("std.lpg")};
+        unicode_string const direct = path_combine(direct_pieces, LPG_ARRAY_SIZE(direct_pieces));
+        unicode_view const detour_pieces[] = {unicode_view_from_string(module_directory), unicode_view_from_c_str(".."),
+                                              unicode_view_from_c_str("standard_library"),
+                                              unicode_view_from_c_str("std.lpg")};
+        unicode_string const detour = path_combine(detour_pieces, LPG_ARRAY_SIZE(detour_pieces));
+        unicode_string const canonical_direct = path_canonicalize(unicode_view_from_string(direct));
+        unicode_string const canonical_detour = path_canonicalize(unicode_view_from_string(detour));
+        REQUIRE(unicode_string_equals(canonical_direct, canonical_detour));
+        REQUIRE(!unicode_string_equals(detour, canonical_detour));
+        unicode_string_free(&canonical_detour);
+        unicode_string_free(&canonical_direct);
+        unicode_string_free(&detour);
+        unicode_string_free(&direct);
+        unicode_string_free(&module_directory);
+    }
+    {
+        /*paths that do not exist are left unchanged*/
+        unicode_string const canonical = path_canonicalize(unicode_view_from_c_str("does/not/../exist.lpg"));
+        REQUIRE(unicode_view_equals_c_str(unicode_view_from_string(canonical), "does/not/../exist.lpg"));
+        unicode_string_free(&canonical);
+    }
 }
@@ -0,0 +1,203 @@
+#include "test_save_program.h"
+#include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
+#include "lpg_check.h"
+#include "lpg_hash.h"
+#include "lpg_save_program.h"
+#include "lpg_standard_library.h"
+#include "test.h"
+#include <string.h>
+
+static char const *const example_source =
+    "let std = import std\n"
+    "let integers = import integer\n"
+    "let s = struct\n"
+    "    a: integers.integer\n"
+    "    b: std.string\n"
+    "let e = enum\n"
+    "    first\n"
+    "    second(s)\n"
+    "let printable = interface\n"
+    "    print(): std.string\n"
+    "impl printable for s\n"
+    "    print(): std.string\n"
+    "        self.b\n"
+    "let make = (a: integers.integer): e\n"
+    "    e.second(s{a, concat(\"a\", \"b\")})\n"
+    "let read = (value: e): std.string\n"
+    "    match value\n"
+    "        case e.first:\n"
+    "            \"\"\n"
+    "        case e.second(let content):\n"
+    "            let erased : printable = content\n"
+    "            let print = erased.print\n"
+    "            print()\n"
+    "assert(string_equals(\"ab\", read(make(std.runtime_value[integers.integer](12)))))\n";
+
+static sequence parse(char const *input, expression_pool *const pool)
+{
+    test_parser_user user = {{input, strlen(input), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, pool);
+    sequence const result = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    return result;
+}
+
+static void expect_no_errors(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void expect_no_complete_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void write_leb128(memory_writer *const destination, uint64_t number)
+{
+    do
+    {
+        uint8_t byte = (number & 0x7fu);
+        number >>= 7u;
+        if (number != 0)
+        {
+            byte |= 0x80u;
+        }
+        REQUIRE(success_yes == memory_writer_write(destination, (char const *)&byte, 1));
+    } while (number != 0);
+}
+
+/*saves the content with a valid header so that the loader has to notice the damage by itself*/
+static memory_writer add_valid_header(unicode_view const content)
+{
+    memory_writer result = {NULL, 0, 0};
+    REQUIRE(success_yes == memory_writer_write(&result, "LPGP", 4));
+    write_leb128(&result, saved_program_format_version);
+    write_leb128(&result, content.length);
+    write_leb128(&result, hash_bytes(hash_seed, content.begin, content.length));
+    REQUIRE(success_yes == memory_writer_write(&result, content.begin, content.length));
+    return result;
+}
+
+/*returns where the content begins*/
+static size_t skip_header(unicode_view const saved)
+{
+    size_t position = 4;
+    for (size_t numbers = 0; numbers < 3; ++position)
+    {
+        REQUIRE(position < saved.length);
+        if (!(saved.begin[position] & 0x80))
+        {
+            ++numbers;
+        }
+    }
+    return position;
+}
+
+static void test_damaged_content(unicode_view const content, structure const globals)
+{
+    /*every byte replaced with a few interesting values*/
+    unsigned char const replacements[] = {0x00, 0x01, 0x7f, 0x80, 0xff};
+    memory_writer copy = {NULL, 0, 0};
+    REQUIRE(success_yes == memory_writer_write(&copy, content.begin, content.length));
+    for (size_t i = 0; i < content.length; ++i)
+    {
+        char const original = copy.data[i];
+        for (size_t k = 0; k < LPG_ARRAY_SIZE(replacements); ++k)
+        {
+            copy.data[i] = (char)replacements[k];
+            memory_writer damaged = add_valid_header(memory_writer_content(copy));
+            optional_checked_program const loaded = load_checked_program(memory_writer_content(damaged), globals);
+            if (loaded.is_set)
+            {
+                checked_program_free(&loaded.value);
+            }
+            memory_writer_free(&damaged);
+        }
+        copy.data[i] = original;
+    }
+    memory_writer_free(&copy);
+}
+
+static void test_saved_program(checked_program const *const program, structure const globals)
+{
+    memory_writer saved = {NULL, 0, 0};
+    REQUIRE(success_yes == save_checked_program(program, globals, memory_writer_erase(&saved)));
+    unicode_view const saved_view = memory_writer_content(saved);
+
+    optional_checked_program const loaded = load_checked_program(saved_view, globals);
+    REQUIRE(loaded.is_set);
+    if (loaded.is_set)
+    {
+        REQUIRE(loaded.value.function_count == program->function_count);
+        REQUIRE(loaded.value.interface_count == program->interface_count);
+        REQUIRE(loaded.value.struct_count == program->struct_count);
+        REQUIRE(loaded.value.enum_count == program->enum_count);
+        memory_writer saved_again = {NULL, 0, 0};
+        REQUIRE(success_yes == save_checked_program(&loaded.value, globals, memory_writer_erase(&saved_again)));
+        REQUIRE(unicode_view_equals(saved_view, memory_writer_content(saved_again)));
+        memory_writer_free(&saved_again);
+        checked_program_free(&loaded.value);
+    }
+
+    /*incomplete files are rejected*/
+    for (size_t i = 0; i < saved_view.length; ++i)
+    {
+        optional_checked_program const truncated =
+            load_checked_program(unicode_view_create(saved_view.begin, i), globals);
+        REQUIRE(!truncated.is_set);
+    }
+
+    /*the checksum rejects damaged files*/
+    size_t const content_begin = skip_header(saved_view);
+    for (size_t i = content_begin; i < saved_view.length; ++i)
+    {
+        saved.data[i] = (char)~saved.data[i];
+        optional_checked_program const damaged = load_checked_program(saved_view, globals);
+        REQUIRE(!damaged.is_set);
+        saved.data[i] = (char)~saved.data[i];
+    }
+
+    /*a different format version is rejected*/
+    saved.data[4] = (char)(saved_program_format_version + 1);
+    REQUIRE(!load_checked_program(saved_view, globals).is_set);
+    saved.data[4] = (char)saved_program_format_version;
+
+    test_damaged_content(unicode_view_cut(saved_view, content_begin, saved_view.length), globals);
+
+    /*external functions which are not globals cannot be saved*/
+    structure const no_globals = structure_create(NULL, 0);
+    memory_writer unsaveable = {NULL, 0, 0};
+    REQUIRE(success_no == save_checked_program(program, no_globals, memory_writer_erase(&unsaveable)));
+    memory_writer_free(&unsaveable);
+
+    memory_writer_free(&saved);
+}
+
+void test_save_program(void)
+{
+    standard_library_description const std_library = describe_standard_library();
+    expression_pool pool = expression_pool_create();
+    sequence root = parse(example_source, &pool);
+    unicode_string const module_directory = find_builtin_module_directory();
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    source_file_lines_owning const lines = source_file_lines_owning_scan(unicode_view_from_c_str(example_source));
+    checked_program checked =
+        check(root, std_library.globals, expect_no_errors, &loader,
+              source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(example_source),
+                                 source_file_lines_from_owning(lines)),
+              unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
+    sequence_free(&root);
+    test_saved_program(&checked, std_library.globals);
+    checked_program_free(&checked);
+    unicode_string_free(&module_directory);
+    source_file_lines_owning_free(lines);
+    expression_pool_free(pool);
+    standard_library_description_free(&std_library);
+}
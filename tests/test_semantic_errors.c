@@ -62,7 +62,8 @@ static checked_program simple_check(char const *const source, structure const gl
     sequence const root = parse(source, &pool);
     module_loader loader = module_loader_create(module_directory, expect_no_complete_parse_error, NULL);
     checked_program const result =
-        check(root, global, expect_errors, &loader, user->source, module_directory, 100000, user);
+        check(root, global, expect_errors, &loader, user->source, module_directory,
+              default_compile_time_budget(100000), NULL, user);
     sequence_free(&root);
     expression_pool_free(pool);
     source_file_lines_owning_free(lines);
@@ -1575,7 +1576,37 @@ void test_semantic_errors(void)
 #endif
     {
         semantic_error const errors[] = {
-            semantic_error_create(semantic_error_stack_overflow, source_location_create(3, 9))};
+            semantic_error_create(semantic_error_compile_time_memory_limit_reached, source_location_create(0, 8))};
+        expected_errors expected = make_expected_errors(errors, LPG_ARRAY_SIZE(errors));
+        /*the literal is longer than the memory for compile time values*/
+        static char const prefix[] = "let s = \"";
+        size_t const literal_length = 100001;
+        char *const source = allocate(sizeof(prefix) - 1 + literal_length + 3);
+        memcpy(source, prefix, sizeof(prefix) - 1);
+        memset(source + sizeof(prefix) - 1, 'a', literal_length);
+        memcpy(source + sizeof(prefix) - 1 + literal_length, "\"\n", 3);
+        checked_program checked = simple_check(source, std_library.globals, &expected, module_directory_view);
+        REQUIRE(expected.count == 0);
+        checked_program_free(&checked);
+        deallocate(source);
+    }
+    {
+        semantic_error const errors[] = {
+            semantic_error_create(semantic_error_stack_overflow, source_location_create(4, 9))};
+        expected_errors expected = make_expected_errors(errors, LPG_ARRAY_SIZE(errors));
+        checked_program checked = simple_check("let std = import std\n"
+                                               "let f = (): std.unit\n"
+                                               "    f()\n"
+                                               "    std.unit_value\n"
+                                               "let x = f()\n",
+                                               std_library.globals, &expected, module_directory_view);
+        REQUIRE(expected.count == 0);
+        checked_program_free(&checked);
+    }
+    {
+        // a tail call reuses the frame of the caller, so this recursion never runs out of frame memory
+        semantic_error const errors[] = {
+            semantic_error_create(semantic_error_instruction_limit_reached, source_location_create(3, 9))};
         expected_errors expected = make_expected_errors(errors, LPG_ARRAY_SIZE(errors));
         checked_program checked = simple_check("let std = import std\n"
                                                "let f = (): std.unit\n"
@@ -49,7 +49,7 @@ static void check_single_wellformed_function(char const *const source, structure
         check(root, non_empty_global, expect_no_errors, &loader,
               source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(source),
                                  source_file_lines_from_owning(lines)),
-              unicode_view_from_string(module_directory), 100000, NULL);
+              unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
     sequence_free(&root);
     REQUIRE(checked.function_count == 1);
     instruction_sequence const expected_body =
@@ -76,7 +76,7 @@ static void test_function(checked_function const expected, checked_function cons
     {
         REQUIRE(unicode_string_equals(expected.register_debug_names[i], gotten.register_debug_names[i]));
     }
-    REQUIRE(function_pointer_equals(*expected.signature, *gotten.signature));
+    REQUIRE(expected.signature == gotten.signature);
     if (!instruction_sequence_equals(&expected.body, &gotten.body))
     {
         printf("Expected instruction sequence:\n");
@@ -87,8 +87,9 @@ static void test_function(checked_function const expected, checked_function cons
     }
 }
 
-static void check_wellformed_program(char const *const source, structure const non_empty_global,
-                                     checked_program const expected)
+/*The expected program is built after the check because its types have to be interned in the checked program to be
+ * comparable.*/
+static checked_program check_wellformed_program(char const *const source, structure const non_empty_global)
 {
     expression_pool pool = expression_pool_create();
     sequence root = parse(source, &pool);
@@ -100,8 +101,22 @@ static void check_wellformed_program(char const *const source, structure const n
         check(root, non_empty_global, expect_no_errors, &loader,
               source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(source),
                                  source_file_lines_from_owning(lines)),
-              unicode_view_from_string(module_directory), 100000, NULL);
+              unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
     sequence_free(&root);
+    expression_pool_free(pool);
+    unicode_string_free(&module_directory);
+    source_file_lines_owning_free(lines);
+    return checked;
+}
+
+static function_pointer const *intern_signature(checked_program *const checked, function_pointer const signature)
+{
+    return type_interner_intern(&checked->types, &checked->memory, type_from_function_pointer(&signature))
+        .function_pointer_;
+}
+
+static void expect_functions(checked_program const expected, checked_program const checked)
+{
     REQUIRE(checked.function_count == expected.function_count);
     for (size_t i = 0; i < expected.function_count; ++i)
     {
@@ -109,9 +124,6 @@ static void check_wellformed_program(char const *const source, structure const n
     }
     checked_program_free(&checked);
     checked_program_free(&expected);
-    expression_pool_free(pool);
-    unicode_string_free(&module_directory);
-    source_file_lines_owning_free(lines);
 }
 
 static void test_loops(const standard_library_description *std_library);
@@ -169,7 +181,7 @@ void test_semantics(void)
             check(root, empty_global, expect_no_errors, &loader,
                   source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(""),
                                      source_file_lines_from_owning(lines)),
-                  unicode_view_from_string(module_directory), 100000, NULL);
+                  unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
         sequence_free(&root);
         REQUIRE(checked.function_count == 1);
         instruction *const expected_body_elements = allocate_array(2, sizeof(*expected_body_elements));
@@ -201,30 +213,37 @@ static type make_integer_constant_type(integer const constant)
 static void test_functions(const standard_library_description *std_library)
 {
     {
-        function_pointer *const signature_lambda = allocate(sizeof(*signature_lambda));
-        {
-            *signature_lambda = function_pointer_create(
-                optional_type_create_set(
-                    type_from_integer_range(integer_range_create(integer_create(0, 123), integer_create(0, 123)))),
-                tuple_type_create(NULL, 0), tuple_type_create(NULL, 0), optional_type_create_empty());
-        }
+        checked_program checked = check_wellformed_program("let f = () 123\n", (*std_library).globals);
+        function_pointer const *const signature_lambda = intern_signature(
+            &checked,
+            function_pointer_create(optional_type_create_set(make_integer_constant_type(integer_create(0, 123))),
+                                    tuple_type_create(NULL, 0), tuple_type_create(NULL, 0),
+                                    optional_type_create_empty()));
         instruction const expected_main[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_function_pointer(function_pointer_value_from_internal(1, NULL, 0)),
-                type_from_function_pointer(signature_lambda))),
+                0, value_from_internal_function(1), type_from_function_pointer(signature_lambda))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         instruction const expected_lambda[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_integer(integer_create(0, 123)), make_integer_constant_type(integer_create(0, 123)))),
+                0, value_from_small_integer(123), make_integer_constant_type(integer_create(0, 123)))),
             instruction_create_return(return_instruction_create(0, 1))};
         checked_program const expected = {
-            NULL, 0,    NULL, 0, garbage_collector_create(SIZE_MAX), allocate_array(2, sizeof(*expected.functions)),
-            2,    NULL, 0};
+            NULL,
+            0,
+            NULL,
+            0,
+            garbage_collector_create(SIZE_MAX),
+            allocate_array(2, sizeof(*expected.functions)),
+            2,
+            NULL,
+            0,
+            type_interner_create()};
         {
-            function_pointer *const signature = allocate(sizeof(*signature));
-            *signature = function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
-                                                 tuple_type_create(NULL, 0), optional_type_create_empty());
+            function_pointer const *const signature = intern_signature(
+                &checked,
+                function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                        tuple_type_create(NULL, 0), optional_type_create_empty()));
             unicode_string const register_debug_names[] = {
                 unicode_string_from_c_str("f"), unicode_string_from_c_str(""), unicode_string_from_c_str("")};
             expected.functions[0] = checked_function_create(
@@ -239,31 +258,42 @@ static void test_functions(const standard_library_description *std_library)
                 instruction_sequence_create(LPG_COPY_ARRAY(expected_lambda), LPG_ARRAY_SIZE(expected_lambda)),
                 LPG_COPY_ARRAY(register_debug_names));
         }
-        check_wellformed_program("let f = () 123\n", (*std_library).globals, expected);
+        expect_functions(expected, checked);
     }
     {
-        function_pointer *const signature_lambda = allocate(sizeof(*signature_lambda));
-        *signature_lambda = function_pointer_create(
-            optional_type_create_set(
-                type_from_integer_range(integer_range_create(integer_create(0, 123), integer_create(0, 123)))),
-            tuple_type_create(NULL, 0), tuple_type_create(NULL, 0), optional_type_create_empty());
+        checked_program checked = check_wellformed_program("let f = (): int(123, 123)\n"
+                                                           "    return 123",
+                                                           (*std_library).globals);
+        function_pointer const *const signature_lambda = intern_signature(
+            &checked,
+            function_pointer_create(optional_type_create_set(make_integer_constant_type(integer_create(0, 123))),
+                                    tuple_type_create(NULL, 0), tuple_type_create(NULL, 0),
+                                    optional_type_create_empty()));
         instruction const expected_main[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_function_pointer(function_pointer_value_from_internal(1, NULL, 0)),
-                type_from_function_pointer(signature_lambda))),
+                0, value_from_internal_function(1), type_from_function_pointer(signature_lambda))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         literal_instruction literal = literal_instruction_create(
-            0, value_from_integer(integer_create(0, 123)), make_integer_constant_type(integer_create(0, 123)));
+            0, value_from_small_integer(123), make_integer_constant_type(integer_create(0, 123)));
         instruction const expected_lambda[] = {
             instruction_create_literal(literal), instruction_create_return(return_instruction_create(literal.into, 1))};
         checked_program const expected = {
-            NULL, 0,    NULL, 0, garbage_collector_create(SIZE_MAX), allocate_array(2, sizeof(*expected.functions)),
-            2,    NULL, 0};
+            NULL,
+            0,
+            NULL,
+            0,
+            garbage_collector_create(SIZE_MAX),
+            allocate_array(2, sizeof(*expected.functions)),
+            2,
+            NULL,
+            0,
+            type_interner_create()};
         {
-            function_pointer *const signature = allocate(sizeof(*signature));
-            *signature = function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
-                                                 tuple_type_create(NULL, 0), optional_type_create_empty());
+            function_pointer const *const signature = intern_signature(
+                &checked,
+                function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                        tuple_type_create(NULL, 0), optional_type_create_empty()));
             unicode_string const register_debug_names[] = {
                 unicode_string_from_c_str("f"), unicode_string_from_c_str(""), unicode_string_from_c_str("")};
             expected.functions[0] = checked_function_create(
@@ -278,19 +308,18 @@ static void test_functions(const standard_library_description *std_library)
                 instruction_sequence_create(LPG_COPY_ARRAY(expected_lambda), LPG_ARRAY_SIZE(expected_lambda)),
                 LPG_COPY_ARRAY(register_debug_names));
         }
-        check_wellformed_program("let f = (): int(123, 123)\n"
-                                 "    return 123",
-                                 (*std_library).globals, expected);
+        expect_functions(expected, checked);
     }
     {
-        function_pointer *const signature_lambda = allocate(sizeof(*signature_lambda));
-        *signature_lambda =
-            function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
-                                    tuple_type_create(NULL, 0), optional_type_create_empty());
+        checked_program checked = check_wellformed_program("let f = ()\n"
+                                                           "    assert(boolean.true)\n",
+                                                           (*std_library).globals);
+        function_pointer const *const signature_lambda = intern_signature(
+            &checked, function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                              tuple_type_create(NULL, 0), optional_type_create_empty()));
         instruction const expected_main[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_function_pointer(function_pointer_value_from_internal(1, NULL, 0)),
-                type_from_function_pointer(signature_lambda))),
+                0, value_from_internal_function(1), type_from_function_pointer(signature_lambda))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         register_id *const arguments = allocate_array(1, sizeof(*arguments));
@@ -298,16 +327,25 @@ static void test_functions(const standard_library_description *std_library)
         instruction const expected_lambda[] = {
             instruction_create_global(0), instruction_create_read_struct(read_struct_instruction_create(0, 4, 1)),
             instruction_create_literal(literal_instruction_create(
-                2, value_from_enum_element(1, type_from_unit(), NULL), type_from_enumeration(0))),
+                2, value_from_enum_element(1, NULL), type_from_enumeration(0))),
             instruction_create_call(call_instruction_create(1, arguments, 1, 3)),
             instruction_create_return(return_instruction_create(3, 4))};
         checked_program const expected = {
-            NULL, 0,    NULL, 0, garbage_collector_create(SIZE_MAX), allocate_array(2, sizeof(*expected.functions)),
-            2,    NULL, 0};
+            NULL,
+            0,
+            NULL,
+            0,
+            garbage_collector_create(SIZE_MAX),
+            allocate_array(2, sizeof(*expected.functions)),
+            2,
+            NULL,
+            0,
+            type_interner_create()};
         {
-            function_pointer *const signature = allocate(sizeof(*signature));
-            *signature = function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
-                                                 tuple_type_create(NULL, 0), optional_type_create_empty());
+            function_pointer const *const signature = intern_signature(
+                &checked,
+                function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                        tuple_type_create(NULL, 0), optional_type_create_empty()));
             unicode_string const register_debug_names[] = {
                 unicode_string_from_c_str("f"), unicode_string_from_c_str(""), unicode_string_from_c_str("")};
             expected.functions[0] = checked_function_create(
@@ -323,37 +361,41 @@ static void test_functions(const standard_library_description *std_library)
                 instruction_sequence_create(LPG_COPY_ARRAY(expected_lambda), LPG_ARRAY_SIZE(expected_lambda)),
                 LPG_COPY_ARRAY(register_debug_names));
         }
-        check_wellformed_program("let f = ()\n"
-                                 "    assert(boolean.true)\n",
-                                 (*std_library).globals, expected);
+        expect_functions(expected, checked);
     }
     {
-        function_pointer *const signature_lambda = allocate(sizeof(*signature_lambda));
-        {
-            type *const parameters = allocate_array(1, sizeof(*parameters));
-            parameters[0] = type_from_enumeration(0);
-            *signature_lambda = function_pointer_create(
-                optional_type_create_set(
-                    type_from_integer_range(integer_range_create(integer_create(0, 123), integer_create(0, 123)))),
-                tuple_type_create(parameters, 1), tuple_type_create(NULL, 0), optional_type_create_empty());
-        }
+        checked_program checked = check_wellformed_program("let f = (a: boolean) 123\n", (*std_library).globals);
+        type parameters[] = {type_from_enumeration(0)};
+        function_pointer const *const signature_lambda = intern_signature(
+            &checked,
+            function_pointer_create(optional_type_create_set(make_integer_constant_type(integer_create(0, 123))),
+                                    tuple_type_create(parameters, 1), tuple_type_create(NULL, 0),
+                                    optional_type_create_empty()));
         instruction const expected_main[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_function_pointer(function_pointer_value_from_internal(1, NULL, 0)),
-                type_from_function_pointer(signature_lambda))),
+                0, value_from_internal_function(1), type_from_function_pointer(signature_lambda))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         instruction const expected_lambda[] = {
             instruction_create_literal(literal_instruction_create(
-                1, value_from_integer(integer_create(0, 123)), make_integer_constant_type(integer_create(0, 123)))),
+                1, value_from_small_integer(123), make_integer_constant_type(integer_create(0, 123)))),
             instruction_create_return(return_instruction_create(1, 2))};
         checked_program const expected = {
-            NULL, 0,    NULL, 0, garbage_collector_create(SIZE_MAX), allocate_array(2, sizeof(*expected.functions)),
-            2,    NULL, 0};
+            NULL,
+            0,
+            NULL,
+            0,
+            garbage_collector_create(SIZE_MAX),
+            allocate_array(2, sizeof(*expected.functions)),
+            2,
+            NULL,
+            0,
+            type_interner_create()};
         {
-            function_pointer *const signature = allocate(sizeof(*signature));
-            *signature = function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
-                                                 tuple_type_create(NULL, 0), optional_type_create_empty());
+            function_pointer const *const signature = intern_signature(
+                &checked,
+                function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                        tuple_type_create(NULL, 0), optional_type_create_empty()));
             unicode_string const register_debug_names[] = {
                 unicode_string_from_c_str("f"), unicode_string_from_c_str(""), unicode_string_from_c_str("")};
             expected.functions[0] = checked_function_create(
@@ -368,7 +410,7 @@ static void test_functions(const standard_library_description *std_library)
                 instruction_sequence_create(LPG_COPY_ARRAY(expected_lambda), LPG_ARRAY_SIZE(expected_lambda)),
                 LPG_COPY_ARRAY(register_debug_names));
         }
-        check_wellformed_program("let f = (a: boolean) 123\n", (*std_library).globals, expected);
+        expect_functions(expected, checked);
     }
 }
 
@@ -423,7 +465,7 @@ static void test_assert(const standard_library_description *std_library)
         instruction const expected_body_elements[] = {
             instruction_create_global(0), instruction_create_read_struct(read_struct_instruction_create(0, 4, 1)),
             instruction_create_literal(literal_instruction_create(
-                2, value_from_enum_element(1, type_from_unit(), NULL), type_from_enumeration(0))),
+                2, value_from_enum_element(1, NULL), type_from_enumeration(0))),
             instruction_create_call(call_instruction_create(1, arguments, 1, 3)),
             instruction_create_return(return_instruction_create(3, 4))};
         check_single_wellformed_function(
@@ -435,7 +477,7 @@ static void test_assert(const standard_library_description *std_library)
         instruction const expected_body_elements[] = {
             instruction_create_global(0), instruction_create_read_struct(read_struct_instruction_create(0, 4, 1)),
             instruction_create_literal(literal_instruction_create(
-                2, value_from_enum_element(0, type_from_unit(), NULL), type_from_enumeration(0))),
+                2, value_from_enum_element(0, NULL), type_from_enumeration(0))),
             instruction_create_call(call_instruction_create(1, arguments, 1, 3)),
             instruction_create_return(return_instruction_create(3, 4))};
         check_single_wellformed_function(
@@ -447,7 +489,7 @@ static void test_assert(const standard_library_description *std_library)
         instruction const expected_body_elements[] = {
             instruction_create_global(0), instruction_create_read_struct(read_struct_instruction_create(0, 4, 1)),
             instruction_create_literal(literal_instruction_create(
-                2, value_from_enum_element(0, type_from_unit(), NULL), type_from_enumeration(0))),
+                2, value_from_enum_element(0, NULL), type_from_enumeration(0))),
             instruction_create_call(call_instruction_create(1, arguments, 1, 3)),
             instruction_create_return(return_instruction_create(3, 4))};
         check_single_wellformed_function(
@@ -459,7 +501,7 @@ static void test_assert(const standard_library_description *std_library)
         instruction const expected_body_elements[] = {
             instruction_create_global(0), instruction_create_read_struct(read_struct_instruction_create(0, 4, 1)),
             instruction_create_literal(literal_instruction_create(
-                2, value_from_enum_element(1, type_from_unit(), NULL), type_from_enumeration(0))),
+                2, value_from_enum_element(1, NULL), type_from_enumeration(0))),
             instruction_create_call(call_instruction_create(1, arguments, 1, 3)),
             instruction_create_return(return_instruction_create(3, 4))};
         check_single_wellformed_function(
@@ -472,7 +514,7 @@ static void test_let_assignments(const standard_library_description *std_library
     {
         instruction const expected_body_elements[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_integer(integer_create(0, 1)), make_integer_constant_type(integer_create(0, 1)))),
+                0, value_from_small_integer(1), make_integer_constant_type(integer_create(0, 1)))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         check_single_wellformed_function("let v = 1\n", std_library->globals, LPG_COPY_ARRAY(expected_body_elements));
@@ -480,7 +522,7 @@ static void test_let_assignments(const standard_library_description *std_library
     {
         instruction const expected_body_elements[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_integer(integer_create(0, 1)), make_integer_constant_type(integer_create(0, 1)))),
+                0, value_from_small_integer(1), make_integer_constant_type(integer_create(0, 1)))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         check_single_wellformed_function(
@@ -489,7 +531,7 @@ static void test_let_assignments(const standard_library_description *std_library
     {
         instruction const expected_body_elements[] = {
             instruction_create_literal(literal_instruction_create(
-                0, value_from_integer(integer_create(0, 1)), make_integer_constant_type(integer_create(0, 1)))),
+                0, value_from_small_integer(1), make_integer_constant_type(integer_create(0, 1)))),
             instruction_create_literal(literal_instruction_create(1, value_from_unit(), type_from_unit())),
             instruction_create_return(return_instruction_create(1, 2))};
         check_single_wellformed_function(
@@ -1,4 +1,5 @@
 #include "test_type.h"
+#include "lpg_allocate.h"
 #include "lpg_type.h"
 #include "test.h"
 #include <lpg_expression.h>
@@ -37,4 +38,36 @@ void test_type(void)
                                     tuple_type_create(NULL, 0), optional_type_create_empty());
         REQUIRE(!type_equals(type_from_function_pointer(&left), type_from_function_pointer(&right)));
     }
+    {
+        lpg_interface interface_ = interface_create(NULL, 0, NULL, 0);
+        REQUIRE(interface_find_method(&interface_, unicode_view_from_c_str("a")).state == optional_empty);
+        method_description *const methods = allocate_array(2, sizeof(*methods));
+        methods[0] =
+            method_description_create(unicode_string_from_c_str("a"), tuple_type_create(NULL, 0), type_from_unit());
+        methods[1] =
+            method_description_create(unicode_string_from_c_str("b"), tuple_type_create(NULL, 0), type_from_unit());
+        interface_define_methods(&interface_, methods, 2);
+        REQUIRE(interface_find_method(&interface_, unicode_view_from_c_str("b")).value_if_set == 1);
+        REQUIRE(interface_find_method(&interface_, unicode_view_from_c_str("a")).value_if_set == 0);
+        REQUIRE(interface_find_method(&interface_, unicode_view_from_c_str("c")).state == optional_empty);
+
+        /*enough implementations to make the index grow a few times*/
+        for (size_t i = 0; i < 100; ++i)
+        {
+            type const self = type_from_integer_range(integer_range_create(integer_create(0, 0), integer_create(0, i)));
+            REQUIRE(interface_find_implementation(&interface_, self).state == optional_empty);
+            REQUIRE(interface_add_implementation(
+                        &interface_, implementation_entry_create(self, implementation_create(NULL, 0))) == i);
+        }
+        interface_add_implementation(
+            &interface_, implementation_entry_create(type_from_unit(), implementation_create(NULL, 0)));
+        for (size_t i = 0; i < 100; ++i)
+        {
+            type const self = type_from_integer_range(integer_range_create(integer_create(0, 0), integer_create(0, i)));
+            REQUIRE(interface_find_implementation(&interface_, self).value_if_set == i);
+        }
+        REQUIRE(interface_find_implementation(&interface_, type_from_unit()).value_if_set == 100);
+        REQUIRE(interface_find_implementation(&interface_, type_from_string()).state == optional_empty);
+        interface_free(interface_);
+    }
 }
@@ -0,0 +1,185 @@
+#include "test_type_interner.h"
+#include "find_builtin_module_directory.h"
+#include "handle_parse_error.h"
+#include "lpg_check.h"
+#include "lpg_standard_library.h"
+#include "lpg_type_interner.h"
+#include "test.h"
+#include <string.h>
+
+static type make_function_pointer(function_pointer *const storage, type *const parameters,
+                                  size_t const parameter_count, type const result)
+{
+    *storage = function_pointer_create(optional_type_create_set(result), tuple_type_create(parameters, parameter_count),
+                                       tuple_type_create(NULL, 0), optional_type_create_empty());
+    return type_from_function_pointer(storage);
+}
+
+static void test_intern_function_pointers(void)
+{
+    type_interner interner = type_interner_create();
+    garbage_collector memory = garbage_collector_create(SIZE_MAX);
+    integer_range const digits = integer_range_create(integer_create(0, 0), integer_create(0, 9));
+
+    type first_parameters[] = {type_from_unit(), type_from_integer_range(digits)};
+    function_pointer first_storage;
+    type const first = type_interner_intern(
+        &interner, &memory, make_function_pointer(&first_storage, first_parameters, 2, type_from_string()));
+    REQUIRE(first.kind == type_kind_function_pointer);
+    REQUIRE(first.function_pointer_ != &first_storage);
+    REQUIRE(first.function_pointer_->parameters.elements != first_parameters);
+    /*the function pointer, its parameters and its empty captures*/
+    REQUIRE(interner.count == 3);
+
+    /*an equal type that is stored somewhere else*/
+    type second_parameters[] = {type_from_unit(), type_from_integer_range(digits)};
+    function_pointer second_storage;
+    type const second = type_interner_intern(
+        &interner, &memory, make_function_pointer(&second_storage, second_parameters, 2, type_from_string()));
+    REQUIRE(second.function_pointer_ == first.function_pointer_);
+    REQUIRE(interner.count == 3);
+
+    function_pointer different_storage;
+    type const different = type_interner_intern(
+        &interner, &memory, make_function_pointer(&different_storage, second_parameters, 1, type_from_string()));
+    REQUIRE(different.function_pointer_ != first.function_pointer_);
+    REQUIRE(!type_equals(different, first));
+    REQUIRE(interner.count == 5);
+
+    /*the address is the identity, so a copy that was not interned is a different type*/
+    REQUIRE(!type_equals(first, type_from_function_pointer(&second_storage)));
+    REQUIRE(type_equals(first, second));
+
+    /*the parameters are the interned tuple with the same elements*/
+    type const parameters =
+        type_interner_intern(&interner, &memory, type_from_tuple_type(tuple_type_create(second_parameters, 2)));
+    REQUIRE(parameters.tuple_.elements == first.function_pointer_->parameters.elements);
+    REQUIRE(type_equals(parameters, type_from_tuple_type(first.function_pointer_->parameters)));
+    REQUIRE(interner.count == 5);
+
+    type_interner_free(interner);
+    garbage_collector_free(memory);
+}
+
+static void test_intern_nested_tuples(void)
+{
+    type_interner interner = type_interner_create();
+    garbage_collector memory = garbage_collector_create(SIZE_MAX);
+
+    function_pointer first_storage;
+    type first_elements[] = {make_function_pointer(&first_storage, NULL, 0, type_from_unit()), type_from_type()};
+    type const first =
+        type_interner_intern(&interner, &memory, type_from_tuple_type(tuple_type_create(first_elements, 2)));
+    REQUIRE(first.kind == type_kind_tuple);
+    REQUIRE(first.tuple_.length == 2);
+    REQUIRE(first.tuple_.elements[0].function_pointer_ != &first_storage);
+    /*the tuple, the function pointer in it and the empty tuple of its parameters and captures*/
+    REQUIRE(interner.count == 3);
+
+    function_pointer second_storage;
+    type second_elements[] = {make_function_pointer(&second_storage, NULL, 0, type_from_unit()), type_from_type()};
+    type const second =
+        type_interner_intern(&interner, &memory, type_from_tuple_type(tuple_type_create(second_elements, 2)));
+    REQUIRE(second.tuple_.elements == first.tuple_.elements);
+    REQUIRE(interner.count == 3);
+
+    {
+        type const empty = type_interner_intern(&interner, &memory, type_from_tuple_type(tuple_type_create(NULL, 0)));
+        REQUIRE(empty.tuple_.length == 0);
+        REQUIRE(!type_equals(empty, first));
+        REQUIRE(type_equals(empty, type_from_tuple_type(first.tuple_.elements[0].function_pointer_->parameters)));
+        REQUIRE(interner.count == 3);
+    }
+
+    /*only function pointers and tuples are interned*/
+    REQUIRE(type_interner_intern(&interner, &memory, type_from_struct(3)).structure_ == 3);
+    REQUIRE(type_interner_intern(&interner, &memory, type_from_unit()).kind == type_kind_unit);
+    REQUIRE(interner.count == 3);
+
+    type_interner_free(interner);
+    garbage_collector_free(memory);
+}
+
+static char const *const repeated_methods_source = "let printable = interface\n"
+                                                   "    print(): boolean\n"
+                                                   "let f = (a: printable, b: printable)\n"
+                                                   "    assert(a.print())\n"
+                                                   "    assert(b.print())\n"
+                                                   "    assert(a.print())\n";
+
+static void expect_no_errors(complete_semantic_error const error, void *user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void expect_no_complete_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+    FAIL();
+}
+
+static void test_repeated_methods(void)
+{
+    standard_library_description const std_library = describe_standard_library();
+    expression_pool pool = expression_pool_create();
+    test_parser_user user = {
+        {repeated_methods_source, strlen(repeated_methods_source), source_location_create(0, 0)}, NULL, 0};
+    expression_parser parser = expression_parser_create(&user.base, handle_error, &user, &pool);
+    sequence root = parse_program(&parser);
+    expression_parser_free(parser);
+    REQUIRE(user.base.remaining_size == 0);
+    unicode_string const module_directory = find_builtin_module_directory();
+    module_loader loader =
+        module_loader_create(unicode_view_from_string(module_directory), expect_no_complete_parse_error, NULL);
+    source_file_lines_owning const lines =
+        source_file_lines_owning_scan(unicode_view_from_c_str(repeated_methods_source));
+    checked_program checked = check(
+        root, std_library.globals, expect_no_errors, &loader,
+        source_file_create(unicode_view_from_c_str("test.lpg"), unicode_view_from_c_str(repeated_methods_source),
+                           source_file_lines_from_owning(lines)),
+        unicode_view_from_string(module_directory), default_compile_time_budget(100000), NULL, NULL);
+    sequence_free(&root);
+    /*the globals are interned before anything else*/
+    type_interner globals = type_interner_create();
+    garbage_collector globals_memory = garbage_collector_create(SIZE_MAX);
+    for (struct_member_id i = 0; i < std_library.globals.count; ++i)
+    {
+        type const interned = type_interner_intern(&globals, &globals_memory, std_library.globals.members[i].what);
+        REQUIRE(interned.kind == std_library.globals.members[i].what.kind);
+    }
+    /*the signature of f with its parameters and the type of the method with its captures. Every read of the method has
+     * the same type, so it is stored once.*/
+    REQUIRE(checked.types.count == (globals.count + 4));
+    type_interner_free(globals);
+    garbage_collector_free(globals_memory);
+    /*the checker only sees the interned copies of the global types, so interning them again changes nothing*/
+    REQUIRE(checked.structs[0].count == std_library.globals.count);
+    for (struct_member_id i = 0; i < checked.structs[0].count; ++i)
+    {
+        type const global = checked.structs[0].members[i].what;
+        REQUIRE(type_equals(
+            global, type_interner_intern(&checked.types, &checked.memory, std_library.globals.members[i].what)));
+        if (global.kind == type_kind_function_pointer)
+        {
+            REQUIRE(global.function_pointer_ != std_library.globals.members[i].what.function_pointer_);
+            REQUIRE(type_interner_intern(&checked.types, &checked.memory, global).function_pointer_ ==
+                    global.function_pointer_);
+        }
+    }
+    REQUIRE(checked.types.count == (globals.count + 4));
+    checked_program_free(&checked);
+    unicode_string_free(&module_directory);
+    source_file_lines_owning_free(lines);
+    expression_pool_free(pool);
+    standard_library_description_free(&std_library);
+}
+
+void test_type_interner(void)
+{
+    test_intern_function_pointers();
+    test_intern_nested_tuples();
+    test_repeated_methods();
+}
@@ -5,6 +5,8 @@
 #include "test.h"
 
 static void test_integer_comparison(void);
+static void test_value_size(void);
+static void test_packed_arrays(void);
 
 void test_value(void)
 {
@@ -26,11 +28,14 @@ void test_value(void)
         REQUIRE(!value_equals(
             value_from_tuple(value_tuple_create(&first, 1)), value_from_tuple(value_tuple_create(&second, 1))));
     }
-    REQUIRE(!value_equals(
-        value_from_enum_element(0, type_from_unit(), NULL), value_from_enum_element(1, type_from_unit(), NULL)));
-    REQUIRE(!value_equals(
-        value_from_enum_element(0, type_from_unit(), NULL),
-        value_from_enum_element(0, type_from_integer_range(integer_range_create(integer_max(), integer_max())), NULL)));
+    REQUIRE(!value_equals(value_from_enum_element(0, NULL), value_from_enum_element(1, NULL)));
+    {
+        value left_state = value_from_unit();
+        value right_state = value_from_small_integer(0);
+        REQUIRE(!value_equals(value_from_enum_element(0, &left_state), value_from_enum_element(0, &right_state)));
+        REQUIRE(!value_equals(value_from_enum_element(0, NULL), value_from_enum_element(0, &right_state)));
+        REQUIRE(value_equals(value_from_enum_element(0, NULL), value_from_enum_element(0, &left_state)));
+    }
 
     REQUIRE(implementation_ref_equals(implementation_ref_create(0, 1), implementation_ref_create(0, 1)));
     REQUIRE(!implementation_ref_equals(implementation_ref_create(0, 1), implementation_ref_create(0, 2)));
@@ -46,7 +51,7 @@ void test_value(void)
     }
     {
         value left_captures[2] = {value_from_unit(), value_from_unit()};
-        value right_captures[2] = {value_from_unit(), value_from_integer(integer_create(0, 0))};
+        value right_captures[2] = {value_from_unit(), value_from_small_integer(0)};
         REQUIRE(!function_pointer_value_equals(
             function_pointer_value_from_internal(0, left_captures, LPG_ARRAY_SIZE(left_captures)),
             function_pointer_value_from_internal(0, right_captures, LPG_ARRAY_SIZE(right_captures))));
@@ -72,15 +77,17 @@ void test_value(void)
             integer_less_impl, NULL, NULL,
             function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
                                     tuple_type_create(NULL, 0), optional_type_create_empty()))));
-    REQUIRE(value_equals(value_from_type(type_from_unit()), value_from_type(type_from_unit())));
-    REQUIRE(!value_less_than(value_from_type(type_from_unit()), value_from_integer(integer_create(0, 0))));
-    REQUIRE(!value_less_than(value_from_integer(integer_create(0, 0)), value_from_integer(integer_create(0, 0))));
+    {
+        garbage_collector boxes = garbage_collector_create(SIZE_MAX);
+        REQUIRE(value_equals(value_from_type(type_from_unit(), &boxes), value_from_type(type_from_unit(), &boxes)));
+        REQUIRE(!value_less_than(value_from_type(type_from_unit(), &boxes), value_from_small_integer(0)));
+        garbage_collector_free(boxes);
+    }
+    REQUIRE(!value_less_than(value_from_small_integer(0), value_from_small_integer(0)));
     REQUIRE(value_less_than(
         value_from_string(unicode_view_from_c_str("")), value_from_string(unicode_view_from_c_str("1"))));
-    REQUIRE(value_less_than(
-        value_from_enum_element(0, type_from_unit(), NULL), value_from_enum_element(1, type_from_unit(), NULL)));
-    REQUIRE(!value_less_than(
-        value_from_enum_element(0, type_from_unit(), NULL), value_from_enum_element(0, type_from_unit(), NULL)));
+    REQUIRE(value_less_than(value_from_enum_element(0, NULL), value_from_enum_element(1, NULL)));
+    REQUIRE(!value_less_than(value_from_enum_element(0, NULL), value_from_enum_element(0, NULL)));
 
     REQUIRE(array_value_equals(
         array_value_create(NULL, 0, 0, type_from_unit()), array_value_create(NULL, 0, 0, type_from_unit())));
@@ -92,14 +99,14 @@ void test_value(void)
             array_value_create(&element, 1, 0, type_from_unit()), array_value_create(NULL, 0, 0, type_from_unit())));
     }
     {
-        value left = value_from_integer(integer_create(0, 0));
-        value right = value_from_integer(integer_create(0, 1));
+        value left = value_from_small_integer(0);
+        value right = value_from_small_integer(1);
         REQUIRE(!array_value_equals(
             array_value_create(&left, 1, 1, type_from_unit()), array_value_create(&right, 1, 1, type_from_unit())));
     }
     {
-        value left = value_from_integer(integer_create(0, 0));
-        value right = value_from_integer(integer_create(0, 0));
+        value left = value_from_small_integer(0);
+        value right = value_from_small_integer(0);
         REQUIRE(!array_value_equals(
             array_value_create(&left, 1, 1, type_from_unit()), array_value_create(&right, 1, 2, type_from_unit())));
     }
@@ -107,13 +114,16 @@ void test_value(void)
         value_equals(value_from_string(unicode_view_from_c_str("")), value_from_string(unicode_view_from_c_str(""))));
 
     test_integer_comparison();
+    test_value_size();
+    test_packed_arrays();
 }
 
 static void test_integer_comparison(void)
 {
-    value small = value_from_integer(integer_create(10, 200));
-    value small2 = value_from_integer(integer_create(10, 200));
-    value big = value_from_integer(integer_create(302, 970));
+    garbage_collector boxes = garbage_collector_create(SIZE_MAX);
+    value small = value_from_integer(integer_create(10, 200), &boxes);
+    value small2 = value_from_integer(integer_create(10, 200), &boxes);
+    value big = value_from_integer(integer_create(302, 970), &boxes);
 
     REQUIRE(value_less_than(small, big));
     REQUIRE(value_greater_than(big, small));
@@ -121,4 +131,89 @@ static void test_integer_comparison(void)
     REQUIRE(value_equals(small, small2));
     REQUIRE(!value_less_than(small, small2));
     REQUIRE(!value_greater_than(small, small2));
+
+    REQUIRE(value_less_than(value_from_small_integer(UINT64_MAX), small));
+    REQUIRE(
+        value_equals(value_from_integer(integer_create(0, UINT64_MAX), &boxes), value_from_small_integer(UINT64_MAX)));
+    garbage_collector_free(boxes);
+}
+
+static void test_value_size(void)
+{
+    REQUIRE(sizeof(value) == 16);
+    garbage_collector boxes = garbage_collector_create(SIZE_MAX);
+    {
+        value const big = value_from_integer(integer_create(1, 2), &boxes);
+        REQUIRE(big.is_big);
+        REQUIRE(integer_equal(value_as_integer(big), integer_create(1, 2)));
+        value const small = value_from_integer(integer_create(0, 2), &boxes);
+        REQUIRE(!small.is_big);
+        REQUIRE(integer_equal(value_as_integer(small), integer_create(0, 2)));
+    }
+    {
+        value const internal = value_from_function_pointer(function_pointer_value_from_internal(3, NULL, 0), &boxes);
+        REQUIRE(!internal.boxed_function);
+        REQUIRE(value_function_code(internal) == 3);
+        REQUIRE(function_pointer_value_equals(
+            value_as_function_pointer(internal), function_pointer_value_from_internal(3, NULL, 0)));
+        value captures[1] = {value_from_small_integer(7)};
+        value const closure = value_from_function_pointer(
+            function_pointer_value_from_internal(3, captures, LPG_ARRAY_SIZE(captures)), &boxes);
+        REQUIRE(closure.boxed_function);
+        REQUIRE(value_function_code(closure) == 3);
+        REQUIRE(value_equals(value_as_function_pointer(closure).captures[0], captures[0]));
+    }
+    {
+        value const string = value_from_string(unicode_view_from_c_str("abc"));
+        REQUIRE(unicode_view_equals_c_str(value_as_string(string), "abc"));
+    }
+    {
+        /*the content of these strings is never read*/
+        char const content = 'a';
+        value arguments[2] = {value_from_string(unicode_view_create(&content, value_max_string_length)),
+                              value_from_string(unicode_view_create(&content, 1))};
+        REQUIRE(value_as_string(arguments[0]).length == value_max_string_length);
+        /*the result would be too long for a value*/
+        REQUIRE(concat_impl(NULL, NULL, optional_value_empty, arguments, NULL).code ==
+                external_function_result_out_of_memory);
+    }
+    garbage_collector_free(boxes);
+}
+
+static void test_packed_arrays(void)
+{
+    REQUIRE(array_storage_element_size(array_storage_values) == sizeof(value));
+    REQUIRE(array_storage_element_size(array_storage_integers) == 8);
+    REQUIRE(array_storage_element_size(array_storage_enum_elements) == 1);
+    {
+        uint64_t integers[2] = {0, 0};
+        type const element_type =
+            type_from_integer_range(integer_range_create(integer_create(0, 0), integer_create(0, UINT64_MAX)));
+        array_value array = array_value_create_empty(array_storage_integers, element_type);
+        array.integers = integers;
+        array.count = 2;
+        array.allocated = 2;
+        array_value_store(&array, 0, value_from_small_integer(UINT64_MAX));
+        array_value_store(&array, 1, value_from_small_integer(3));
+        REQUIRE(integers[0] == UINT64_MAX);
+        REQUIRE(value_equals(array_value_load(array, 0), value_from_small_integer(UINT64_MAX)));
+        REQUIRE(value_equals(array_value_load(array, 1), value_from_small_integer(3)));
+    }
+    {
+        uint8_t left_elements[2] = {0, 0};
+        uint8_t right_elements[2] = {0, 0};
+        array_value left = array_value_create_empty(array_storage_enum_elements, type_from_enumeration(0));
+        left.enum_elements = left_elements;
+        left.count = 2;
+        left.allocated = 2;
+        array_value right = left;
+        right.enum_elements = right_elements;
+        array_value_store(&left, 1, value_from_enum_element(255, NULL));
+        REQUIRE(left_elements[1] == 255);
+        REQUIRE(value_equals(array_value_load(left, 1), value_from_enum_element(255, NULL)));
+        REQUIRE(value_equals(array_value_load(left, 0), value_from_enum_element(0, NULL)));
+        REQUIRE(!array_value_equals(left, right));
+        array_value_store(&right, 1, value_from_enum_element(255, NULL));
+        REQUIRE(array_value_equals(left, right));
+    }
 }
@@ -0,0 +1,68 @@
+#include "test_value_stack.h"
+#include "lpg_value.h"
+#include "lpg_value_stack.h"
+#include "test.h"
+
+void test_value_stack(void)
+{
+    {
+        value_stack stack = value_stack_create();
+        REQUIRE(value_stack_push(&stack, 0) == NULL);
+        value_stack_pop(&stack, 0);
+        value_stack_free(stack);
+    }
+    {
+        value_stack stack = value_stack_create();
+        value *const first = value_stack_push(&stack, 3);
+        REQUIRE(first);
+        value *const second = value_stack_push(&stack, 2);
+        REQUIRE(second == (first + 3));
+        value_stack_pop(&stack, 2);
+        REQUIRE(value_stack_push(&stack, 2) == second);
+        value_stack_pop(&stack, 2);
+        value_stack_pop(&stack, 3);
+        REQUIRE(value_stack_push(&stack, 3) == first);
+        value_stack_pop(&stack, 3);
+        value_stack_free(stack);
+    }
+    {
+        /*windows that are in use must not move when the stack grows*/
+        value_stack stack = value_stack_create();
+        value *windows[100];
+        size_t const window_size = 100;
+        for (size_t i = 0; i < (sizeof(windows) / sizeof(*windows)); ++i)
+        {
+            windows[i] = value_stack_push(&stack, window_size);
+            REQUIRE(windows[i]);
+            for (size_t k = 0; k < window_size; ++k)
+            {
+                windows[i][k] = value_from_small_integer(i);
+            }
+        }
+        for (size_t i = (sizeof(windows) / sizeof(*windows)); i > 0; --i)
+        {
+            for (size_t k = 0; k < window_size; ++k)
+            {
+                REQUIRE(value_equals(windows[i - 1][k], value_from_small_integer((i - 1))));
+            }
+            value_stack_pop(&stack, window_size);
+        }
+        value_stack_free(stack);
+    }
+    {
+        /*alternating at a segment boundary reuses the spare segment*/
+        value_stack stack = value_stack_create();
+        value *const bottom = value_stack_push(&stack, 1000);
+        REQUIRE(bottom);
+        value *const above = value_stack_push(&stack, 100);
+        REQUIRE(above);
+        for (size_t i = 0; i < 10; ++i)
+        {
+            value_stack_pop(&stack, 100);
+            REQUIRE(value_stack_push(&stack, 100) == above);
+        }
+        value_stack_pop(&stack, 100);
+        value_stack_pop(&stack, 1000);
+        value_stack_free(stack);
+    }
+}
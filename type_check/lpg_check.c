@@ -1,12 +1,16 @@
 #include "lpg_check.h"
 #include "lpg_allocate.h"
 #include "lpg_for.h"
+#include "lpg_hash.h"
 #include "lpg_function_checking_state.h"
 #include "lpg_instruction.h"
 #include "lpg_instruction_checkpoint.h"
 #include "lpg_integer_set.h"
 #include "lpg_interpret.h"
 #include "lpg_local_variable.h"
+#include "lpg_path.h"
+#include "lpg_prefetch_modules.h"
+#include "lpg_read_file.h"
 #include "lpg_standard_library.h"
 #include "lpg_string_literal.h"
 #include "lpg_structure_member.h"
@@ -19,7 +23,8 @@ check_function_result check_function_result_create(checked_function function, ca
     return result;
 }
 
-check_function_result const check_function_result_empty = {false, {NULL, {NULL, 0, 0}, NULL, 0}, NULL, 0};
+check_function_result const check_function_result_empty = {
+    false, {NULL, {NULL, 0, 0}, NULL, 0, {NULL, 0}, 0}, NULL, 0};
 
 typedef enum evaluation_status {
     evaluation_status_value = 1,
@@ -47,7 +52,7 @@ static evaluate_expression_result evaluate_expression_result_create(evaluation_s
 }
 
 static evaluate_expression_result const evaluate_expression_result_empty = {
-    evaluation_status_error, {type_kind_type, {0}}, {false, {value_kind_integer, {{NULL, 0}}}}, 0, false};
+    evaluation_status_error, {type_kind_type, {0}}, {false, {value_kind_integer, {0}, {0}}}, 0, false};
 
 static function_checking_state function_checking_state_create(
     program_check *const root, function_checking_state *const parent, bool const may_capture_runtime_variables,
@@ -55,6 +60,7 @@ static function_checking_state function_checking_state_create(
     instruction_sequence *const body, optional_type const return_type, bool const has_declared_return_type,
     source_file_owning const *const source, unicode_view const current_import_directory)
 {
+    arena *const memory = arena_pool_take(&root->function_memory);
     function_checking_state const result = {root,
                                             parent,
                                             may_capture_runtime_variables,
@@ -67,7 +73,8 @@ static function_checking_state function_checking_state_create(
                                             false,
                                             global,
                                             on_error,
-                                            {NULL, 0, 0},
+                                            local_variable_container_create(&root->identifiers, memory),
+                                            outer_variable_cache_create(memory),
                                             user,
                                             program,
                                             body,
@@ -77,7 +84,8 @@ static function_checking_state function_checking_state_create(
                                             0,
                                             0,
                                             source,
-                                            current_import_directory};
+                                            current_import_directory,
+                                            memory};
     return result;
 }
 
@@ -201,8 +209,8 @@ read_structure_element(function_checking_state *const state, instruction_sequenc
         if (compile_time_value.is_set)
         {
             ASSERT(compile_time_value.value_.kind == value_kind_structure);
-            ASSUME(i < compile_time_value.value_.structure.count);
-            value const element_value = compile_time_value.value_.structure.members[i];
+            ASSUME(i < value_as_structure(compile_time_value.value_).count);
+            value const element_value = value_as_structure(compile_time_value.value_).members[i];
             add_instruction(function, instruction_create_literal(literal_instruction_create(
                                           result, element_value, structure_type->members[i].what)));
             write_register_compile_time_value(state, result, element_value);
@@ -217,6 +225,13 @@ read_structure_element(function_checking_state *const state, instruction_sequenc
     return read_structure_element_result_create(false, type_from_unit(), optional_value_empty, false);
 }
 
+/*Function pointer and tuple types are interned wherever the checker creates them or reads them from a compile time
+ * value. The types of all expressions are canonical that way, so type_equals compares them by address.*/
+static type intern_type(function_checking_state *const state, type const interned)
+{
+    return type_interner_intern(&state->program->types, &state->program->memory, interned);
+}
+
 static read_structure_element_result read_tuple_element(function_checking_state *state, instruction_sequence *function,
                                                         tuple_type const read_from, register_id const where,
                                                         unicode_view const element_name,
@@ -240,8 +255,8 @@ static read_structure_element_result read_tuple_element(function_checking_state
     optional_value const compile_time_tuple = read_register_compile_time_value(state, where);
     if (compile_time_tuple.is_set)
     {
-        ASSUME(element < compile_time_tuple.value_.tuple_.element_count);
-        value const compile_time_element = compile_time_tuple.value_.tuple_.elements[element];
+        ASSUME(element < value_as_tuple(compile_time_tuple.value_).element_count);
+        value const compile_time_element = value_as_tuple(compile_time_tuple.value_).elements[element];
         write_register_compile_time_value(state, result, compile_time_element);
         return read_structure_element_result_create(
             true, read_from.elements[element], optional_value_create(compile_time_element), true);
@@ -265,18 +280,18 @@ static read_structure_element_result read_interface_element_at(function_checking
 {
     add_instruction(
         function, instruction_create_get_method(get_method_instruction_create(from_type, from, method_index, result)));
-    function_pointer *const method_object = garbage_collector_allocate(&state->program->memory, sizeof(*method_object));
-    type *const captures = garbage_collector_allocate_array(&state->program->memory, 1, sizeof(*captures));
-    captures[0] = type_from_interface(from_type);
+    type captures[1] = {type_from_interface(from_type)};
     if (!state->root->interfaces_defined[from_type])
     {
         LPG_TO_DO();
     }
     method_description const method = state->program->interfaces[from_type].methods[method_index];
-    *method_object = function_pointer_create(optional_type_create_set(method.result), method.parameters,
-                                             tuple_type_create(captures, 1), optional_type_create_empty());
-    return read_structure_element_result_create(
-        true, type_from_function_pointer(method_object), optional_value_empty, false);
+    function_pointer const method_object = function_pointer_create(
+        optional_type_create_set(method.result), method.parameters, tuple_type_create(captures, 1),
+        optional_type_create_empty());
+    /*every read of the same method has the same type*/
+    type const method_type = intern_type(state, type_from_function_pointer(&method_object));
+    return read_structure_element_result_create(true, method_type, optional_value_empty, false);
 }
 
 static read_structure_element_result
@@ -288,13 +303,10 @@ read_interface_element(function_checking_state *state, instruction_sequence *fun
     {
         LPG_TO_DO();
     }
-    lpg_interface *const from_interface = state->program->interfaces + from_type;
-    for (function_id i = 0; i < from_interface->method_count; ++i)
+    optional_size const method = interface_find_method(state->program->interfaces + from_type, element_name);
+    if (method.state == optional_set)
     {
-        if (unicode_view_equals(unicode_view_from_string(from_interface->methods[i].name), element_name))
-        {
-            return read_interface_element_at(state, function, from, from_type, i, result);
-        }
+        return read_interface_element_at(state, function, from, from_type, (function_id)method.value_if_set, result);
     }
     emit_semantic_error(state, semantic_error_create(semantic_error_unknown_element, element_source));
     return read_structure_element_result_create(false, type_from_unit(), optional_value_empty, false);
@@ -364,7 +376,7 @@ static read_structure_element_result read_element(function_checking_state *state
                 state, semantic_error_create(semantic_error_expected_compile_time_type, element->source));
             return read_structure_element_result_create(false, type_from_unit(), optional_value_empty, false);
         }
-        type const left_side_type = object.compile_time_value.value_.type_;
+        type const left_side_type = value_as_type(object.compile_time_value.value_);
         switch (left_side_type.kind)
         {
         case type_kind_generic_struct:
@@ -398,7 +410,7 @@ static read_structure_element_result read_element(function_checking_state *state
                 {
                     if (!enum_->elements[i].state.is_set)
                     {
-                        value const literal = value_from_enum_element(i, enum_->elements[i].state.value, NULL);
+                        value const literal = value_from_enum_element(i, NULL);
                         add_instruction(function, instruction_create_literal(literal_instruction_create(
                                                       result, literal, type_from_enumeration(left_side_type.enum_))));
                         write_register_compile_time_value(state, result, literal);
@@ -520,7 +532,7 @@ static evaluate_expression_result read_variable(LPG_NON_NULL(function_checking_s
                 {
                     LPG_TO_DO();
                 }
-                value const literal = value_from_enum_element(i, enum_->elements[i].state.value, NULL);
+                value const literal = value_from_enum_element(i, NULL);
                 register_id const result = allocate_register(&state->used_registers);
                 add_instruction(to, instruction_create_literal(literal_instruction_create(
                                         result, literal, expected_result_type.exact_type.value)));
@@ -621,39 +633,39 @@ static conversion_result convert(function_checking_state *const state, instructi
                                  source_location const original_source, type const to,
                                  bool const may_widen_return_type);
 
-static void check_function_clean_up(function_checking_state *const state)
+/*the signature is complete when it is created, so it is interned right away like every other function pointer type*/
+static function_pointer const *intern_signature(function_checking_state *const state, function_pointer const signature)
 {
-    for (size_t i = 0; i < state->local_variables.count; ++i)
-    {
-        local_variable *const variable = (state->local_variables.elements + i);
-        local_variable_free(variable);
-    }
-    if (state->local_variables.elements)
-    {
-        deallocate(state->local_variables.elements);
-    }
-    if (state->register_compile_time_values)
-    {
-        deallocate(state->register_compile_time_values);
-        state->register_compile_time_values = NULL;
-        state->register_compile_time_value_count = 0;
-    }
+    return intern_type(state, type_from_function_pointer(&signature)).function_pointer_;
 }
 
-static check_function_result finish_function_check(function_checking_state state, type const return_type,
-                                                   instruction_sequence const body_out)
+static check_function_result finish_function_check(function_checking_state state, type const *const parameter_types,
+                                                   size_t const parameter_count, optional_type const self,
+                                                   type const return_type, instruction_sequence const body_out)
 {
+    type *const parameters = parameter_count ? allocate_array(parameter_count, sizeof(*parameters)) : NULL;
+    for (size_t i = 0; i < parameter_count; ++i)
+    {
+        parameters[i] = parameter_types[i];
+    }
     type *const capture_types =
         state.capture_count ? allocate_array(state.capture_count, sizeof(*capture_types)) : NULL;
     for (size_t i = 0; i < state.capture_count; ++i)
     {
         capture_types[i] = state.captures[i].what;
     }
-
-    function_pointer *const signature = allocate(sizeof(*signature));
-    *signature =
-        function_pointer_create(optional_type_create_set(return_type), tuple_type_create(NULL, 0),
-                                tuple_type_create(capture_types, state.capture_count), optional_type_create_empty());
+    function_pointer const *const signature = intern_signature(
+        &state, function_pointer_create(optional_type_create_set(return_type),
+                                        tuple_type_create(parameters, parameter_count),
+                                        tuple_type_create(capture_types, state.capture_count), self));
+    if (parameters)
+    {
+        deallocate(parameters);
+    }
+    if (capture_types)
+    {
+        deallocate(capture_types);
+    }
 
     ASSUME(state.register_debug_name_count <= state.used_registers);
     if (state.register_debug_name_count < state.used_registers)
@@ -668,7 +680,7 @@ static check_function_result finish_function_check(function_checking_state state
     checked_function const result =
         checked_function_create(signature, body_out, state.register_debug_names, state.used_registers);
 
-    check_function_clean_up(&state);
+    function_checking_state_free(state);
     return check_function_result_create(result, state.captures, state.capture_count);
 }
 
@@ -735,7 +747,7 @@ check_function(program_check *const root, function_checking_state *const parent,
             deallocate(state.captures);
         }
         instruction_sequence_free(&body_out);
-        check_function_clean_up(&state);
+        function_checking_state_free(state);
         return check_function_result_empty;
     }
 
@@ -753,7 +765,7 @@ check_function(program_check *const root, function_checking_state *const parent,
                                            return_instruction_create(return_value_goes_into, unit_goes_into)));
         }
         ASSUME(state.register_debug_name_count <= state.used_registers);
-        return finish_function_check(state, type_from_unit(), body_out);
+        return finish_function_check(state, parameter_types, parameter_count, self, type_from_unit(), body_out);
     }
 
     if (explicit_return_type.is_set)
@@ -764,7 +776,8 @@ check_function(program_check *const root, function_checking_state *const parent,
             {
                 LPG_TO_DO();
             }
-            return finish_function_check(state, state.return_type.value, body_out);
+            return finish_function_check(
+                state, parameter_types, parameter_count, self, state.return_type.value, body_out);
         }
         else
         {
@@ -783,7 +796,7 @@ check_function(program_check *const root, function_checking_state *const parent,
                     deallocate(state.register_debug_names);
                 }
                 instruction_sequence_free(&body_out);
-                check_function_clean_up(&state);
+                function_checking_state_free(state);
                 return check_function_result_empty;
 
             case success_yes:
@@ -793,7 +806,8 @@ check_function(program_check *const root, function_checking_state *const parent,
             register_id const unit_goes_into = allocate_register(&state.used_registers);
             add_instruction(
                 &body_out, instruction_create_return(return_instruction_create(converted.where, unit_goes_into)));
-            return finish_function_check(state, converted.result_type, body_out);
+            return finish_function_check(
+                state, parameter_types, parameter_count, self, converted.result_type, body_out);
         }
     }
     else
@@ -804,7 +818,8 @@ check_function(program_check *const root, function_checking_state *const parent,
             {
                 LPG_TO_DO();
             }
-            return finish_function_check(state, state.return_type.value, body_out);
+            return finish_function_check(
+                state, parameter_types, parameter_count, self, state.return_type.value, body_out);
         }
         else
         {
@@ -813,7 +828,8 @@ check_function(program_check *const root, function_checking_state *const parent,
                 register_id const unit_goes_into = allocate_register(&state.used_registers);
                 add_instruction(&body_out, instruction_create_return(
                                                return_instruction_create(body_evaluated.where, unit_goes_into)));
-                return finish_function_check(state, body_evaluated.type_, body_out);
+                return finish_function_check(
+                    state, parameter_types, parameter_count, self, body_evaluated.type_, body_out);
             }
             else
             {
@@ -826,7 +842,7 @@ check_function(program_check *const root, function_checking_state *const parent,
                     deallocate(state.register_debug_names);
                 }
                 instruction_sequence_free(&body_out);
-                check_function_clean_up(&state);
+                function_checking_state_free(state);
                 return check_function_result_empty;
             }
         }
@@ -861,7 +877,8 @@ expect_compile_time_type(function_checking_state *state, instruction_sequence *f
                                                              expression_source_begin(element)));
             return compile_time_type_expression_result_create(false, ~(register_id)0, type_from_unit());
         }
-        return compile_time_type_expression_result_create(true, result.where, result.compile_time_value.value_.type_);
+        return compile_time_type_expression_result_create(
+            true, result.where, intern_type(state, value_as_type(result.compile_time_value.value_)));
 
     case evaluation_status_error:
     case evaluation_status_exit:
@@ -945,10 +962,9 @@ static function_id reserve_function_id(function_checking_state *const state)
     state->program->functions =
         reallocate_array(state->program->functions, state->program->function_count, sizeof(*state->program->functions));
     {
-        function_pointer *const dummy_signature = allocate(sizeof(*dummy_signature));
-        *dummy_signature =
-            function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
-                                    tuple_type_create(NULL, 0), optional_type_create_empty());
+        function_pointer const *const dummy_signature = intern_signature(
+            state, function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
+                                           tuple_type_create(NULL, 0), optional_type_create_empty()));
         state->program->functions[this_lambda_id] =
             checked_function_create(dummy_signature, instruction_sequence_create(NULL, 0, 0), NULL, 0);
     }
@@ -1011,11 +1027,13 @@ static evaluate_expression_result evaluate_lambda(function_checking_state *const
 
     function_id const this_lambda_id =
         (predetermined_lambda_id.is_set ? predetermined_lambda_id.value : reserve_function_id(state));
-    state->program->functions[this_lambda_id].signature->parameters =
-        tuple_type_create(header.parameter_types, evaluated.header.parameter_count);
-    if (header.return_type.is_set)
     {
-        state->program->functions[this_lambda_id].signature->result = header.return_type;
+        /*recursive calls are checked against the parameters and the declared return type while the body is checked*/
+        function_pointer const *const reserved = state->program->functions[this_lambda_id].signature;
+        state->program->functions[this_lambda_id].signature = intern_signature(
+            state, function_pointer_create(header.return_type.is_set ? header.return_type : reserved->result,
+                                           tuple_type_create(header.parameter_types, evaluated.header.parameter_count),
+                                           reserved->captures, reserved->self));
     }
 
     check_function_result const checked = check_function(
@@ -1028,6 +1046,7 @@ static evaluate_expression_result evaluate_lambda(function_checking_state *const
         unicode_string_free(header.parameter_names + i);
     }
     deallocate(header.parameter_names);
+    deallocate(header.parameter_types);
     if (!checked.success)
     {
         return evaluate_expression_result_empty;
@@ -1038,13 +1057,10 @@ static evaluate_expression_result evaluate_lambda(function_checking_state *const
         instruction const body = checked.function.body.elements[0];
         ASSUME((body.type == instruction_call) || (body.type == instruction_return) || (body.type == instruction_loop));
     }
-    ASSUME(checked.function.signature->parameters.length == 0);
-    checked.function.signature->parameters.elements = header.parameter_types;
-    checked.function.signature->parameters.length = evaluated.header.parameter_count;
-
-    state->program->functions[this_lambda_id].signature->parameters = tuple_type_create(NULL, 0);
     checked_function_free(&state->program->functions[this_lambda_id]);
     state->program->functions[this_lambda_id] = checked.function;
+    checked_function_set_definition(&state->program->functions[this_lambda_id],
+                                    unicode_view_from_string(state->source->name), (evaluated.source.line + 1));
     register_id const destination = allocate_register(&state->used_registers);
     type const result_type = type_from_lambda(lambda_type_create(this_lambda_id));
     if (checked.captures)
@@ -1088,7 +1104,8 @@ static evaluate_expression_result evaluate_lambda(function_checking_state *const
         {
             deallocate(captures);
             value const compile_time_lambda = value_from_function_pointer(
-                function_pointer_value_from_internal(this_lambda_id, compile_time_captures, checked.capture_count));
+                function_pointer_value_from_internal(this_lambda_id, compile_time_captures, checked.capture_count),
+                &state->program->memory);
             add_instruction(function, instruction_create_literal(
                                           literal_instruction_create(destination, compile_time_lambda, result_type)));
             return evaluate_expression_result_create(
@@ -1099,25 +1116,13 @@ static evaluate_expression_result evaluate_lambda(function_checking_state *const
         return evaluate_expression_result_create(
             evaluation_status_value, destination, result_type, optional_value_empty, false);
     }
-    value const result = value_from_function_pointer(function_pointer_value_from_internal(this_lambda_id, NULL, 0));
+    value const result = value_from_internal_function(this_lambda_id);
     add_instruction(function, instruction_create_literal(literal_instruction_create(destination, result, result_type)));
     write_register_compile_time_value(state, destination, result);
     return evaluate_expression_result_create(
         evaluation_status_value, destination, result_type, optional_value_create(result), false);
 }
 
-static optional_size find_implementation(lpg_interface const *const in, type const self)
-{
-    for (size_t i = 0; i < in->implementation_count; ++i)
-    {
-        if (type_equals(in->implementations[i].self, self))
-        {
-            return make_optional_size(i);
-        }
-    }
-    return optional_size_empty;
-}
-
 static optional_size evaluate_impl_core(function_checking_state *state, instruction_sequence *const function,
                                         impl_expression_method const *const method_trees,
                                         size_t const defined_method_count, type const self,
@@ -1162,11 +1167,7 @@ static optional_size instantiate_generic_impl(function_checking_state *const sta
         evaluate_impl_core(&interface_checking, &ignored_instructions, tree.methods, tree.method_count, self,
                            target_interface, expression_source_begin(*tree.self), tree.begin);
     instruction_sequence_free(&ignored_instructions);
-    local_variable_container_free(interface_checking.local_variables);
-    if (interface_checking.register_compile_time_values)
-    {
-        deallocate(interface_checking.register_compile_time_values);
-    }
+    function_checking_state_free(interface_checking);
     return evaluated;
 }
 
@@ -1177,15 +1178,6 @@ typedef struct infer_generic_arguments_result
     value *arguments;
 } infer_generic_arguments_result;
 
-static void infer_generic_arguments_result_free(infer_generic_arguments_result const freed)
-{
-    if (freed.argument_types)
-    {
-        deallocate(freed.argument_types);
-        deallocate(freed.arguments);
-    }
-}
-
 static infer_generic_arguments_result infer_generic_arguments(function_checking_state *const state,
                                                               instruction_sequence *const function,
                                                               generic_instantiation_expression const self_tree,
@@ -1239,18 +1231,8 @@ static infer_generic_arguments_result infer_generic_arguments(function_checking_
             {
                 continue;
             }
-            value *const arguments = allocate_array(instantiation->argument_count, sizeof(*arguments));
-            if (instantiation->argument_count)
-            {
-                memcpy(arguments, instantiation->arguments, sizeof(*arguments) * instantiation->argument_count);
-            }
-            type *const argument_types = allocate_array(instantiation->argument_count, sizeof(*argument_types));
-            if (instantiation->argument_count)
-            {
-                memcpy(argument_types, instantiation->argument_types,
-                       sizeof(*argument_types) * instantiation->argument_count);
-            }
-            infer_generic_arguments_result const result = {true, argument_types, arguments};
+            infer_generic_arguments_result const result = {
+                true, instantiation->argument_types, instantiation->arguments};
             return result;
         }
         break;
@@ -1271,18 +1253,8 @@ static infer_generic_arguments_result infer_generic_arguments(function_checking_
             {
                 continue;
             }
-            value *const arguments = allocate_array(instantiation->argument_count, sizeof(*arguments));
-            if (instantiation->argument_count)
-            {
-                memcpy(arguments, instantiation->arguments, sizeof(*arguments) * instantiation->argument_count);
-            }
-            type *const argument_types = allocate_array(instantiation->argument_count, sizeof(*argument_types));
-            if (instantiation->argument_count)
-            {
-                memcpy(argument_types, instantiation->argument_types,
-                       sizeof(*argument_types) * instantiation->argument_count);
-            }
-            infer_generic_arguments_result const result = {true, argument_types, arguments};
+            infer_generic_arguments_result const result = {
+                true, instantiation->argument_types, instantiation->arguments};
             return result;
         }
         break;
@@ -1303,18 +1275,8 @@ static infer_generic_arguments_result infer_generic_arguments(function_checking_
             {
                 continue;
             }
-            value *const arguments = allocate_array(instantiation->argument_count, sizeof(*arguments));
-            if (instantiation->argument_count)
-            {
-                memcpy(arguments, instantiation->arguments, sizeof(*arguments) * instantiation->argument_count);
-            }
-            type *const argument_types = allocate_array(instantiation->argument_count, sizeof(*argument_types));
-            if (instantiation->argument_count)
-            {
-                memcpy(argument_types, instantiation->argument_types,
-                       sizeof(*argument_types) * instantiation->argument_count);
-            }
-            infer_generic_arguments_result const result = {true, argument_types, arguments};
+            infer_generic_arguments_result const result = {
+                true, instantiation->argument_types, instantiation->arguments};
             return result;
         }
         break;
@@ -1370,13 +1332,11 @@ static optional_size try_to_instantiate_generic_impl(function_checking_state *co
             instruction_sequence_free(&ignored);
             if (!inferred.can_be_inferred)
             {
-                infer_generic_arguments_result_free(inferred);
                 continue;
             }
             optional_size const result = instantiate_generic_impl(
                 state, target_interface, impl->tree, impl->closures, inferred.argument_types, inferred.arguments, self,
                 impl->source, unicode_view_from_string(impl->current_import_directory));
-            infer_generic_arguments_result_free(inferred);
             return result;
         }
     }
@@ -1404,7 +1364,7 @@ static optional_size instantiate_generic_impl_for_regular_interface(function_che
 static optional_size require_implementation(function_checking_state *const state, instruction_sequence *const function,
                                             interface_id const to, type const self)
 {
-    optional_size const already_exists = find_implementation(state->program->interfaces + to, self);
+    optional_size const already_exists = interface_find_implementation(state->program->interfaces + to, self);
     if (already_exists.state == optional_set)
     {
         return already_exists;
@@ -1435,8 +1395,6 @@ static optional_size require_implementation(function_checking_state *const state
         }
         optional_size const result = instantiate_generic_impl_for_regular_interface(
             state, to, impl, inferred.argument_types, inferred.arguments, self);
-        deallocate(inferred.argument_types);
-        deallocate(inferred.arguments);
         return result;
     }
     return optional_size_empty;
@@ -1622,7 +1580,8 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
     size_t const expected_arguments =
         expected_call_argument_count(callee.type_, state->program->functions, state->program->enums);
     register_id *const arguments = allocate_array(expected_arguments, sizeof(*arguments));
-    value *const compile_time_arguments = allocate_array(expected_arguments, sizeof(*compile_time_arguments));
+    value *const compile_time_arguments =
+        arena_allocate_array(state->memory, expected_arguments, sizeof(*compile_time_arguments));
     bool all_compile_time_arguments = true;
     LPG_FOR(size_t, i, called.arguments.length)
     {
@@ -1632,7 +1591,6 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
             emit_semantic_error(state, semantic_error_create(
                                            semantic_error_extraneous_argument, expression_source_begin(argument_tree)));
             restore(previous_code);
-            deallocate(compile_time_arguments);
             deallocate(arguments);
             ASSUME(state->register_debug_name_count <= state->used_registers);
             return evaluate_expression_result_empty;
@@ -1642,7 +1600,6 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
         {
             ASSUME(state->register_debug_name_count <= state->used_registers);
             restore(previous_code);
-            deallocate(compile_time_arguments);
             deallocate(arguments);
             ASSUME(state->register_debug_name_count <= state->used_registers);
             return evaluate_expression_result_empty;
@@ -1660,7 +1617,6 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
     if (called.arguments.length < expected_arguments)
     {
         ASSUME(state->register_debug_name_count <= state->used_registers);
-        deallocate(compile_time_arguments);
         restore(previous_code);
         deallocate(arguments);
         emit_semantic_error(state, semantic_error_create(semantic_error_missing_argument, called.closing_parenthesis));
@@ -1684,17 +1640,30 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
 
             case value_kind_function_pointer:
             {
-                if (!callee.compile_time_value.value_.function_pointer.external &&
-                    (state->program->functions[callee.compile_time_value.value_.function_pointer.code].body.length ==
-                     0))
+                function_pointer_value const callee_function =
+                    value_as_function_pointer(callee.compile_time_value.value_);
+                if (!callee_function.external && (state->program->functions[callee_function.code].body.length == 0))
                 {
                     // This function has no body which means it is currently being type
                     // checked and can't be called yet.
                     break;
                 }
-                external_function_result const call_result =
-                    call_function(callee.compile_time_value.value_.function_pointer, optional_value_empty,
-                                  compile_time_arguments, &state->root->compile_time_interpreter);
+                interpreter *const compile_time_interpreter = &state->root->compile_time_interpreter;
+                bool const is_memoizable =
+                    compile_time_call_is_memoizable(callee_function, compile_time_arguments, expected_arguments);
+                if (is_memoizable)
+                {
+                    ++compile_time_interpreter->usage->memoizable_calls;
+                    compile_time_result = compile_time_call_cache_find(
+                        state->root->call_cache, callee_function, compile_time_arguments, expected_arguments);
+                    if (compile_time_result.is_set)
+                    {
+                        ++compile_time_interpreter->usage->memoized_calls;
+                        break;
+                    }
+                }
+                external_function_result const call_result = call_function(
+                    callee_function, optional_value_empty, compile_time_arguments, compile_time_interpreter);
                 switch (call_result.code)
                 {
                 case external_function_result_out_of_memory:
@@ -1705,6 +1674,12 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
 
                 case external_function_result_success:
                     compile_time_result = optional_value_create(call_result.if_success);
+                    if (is_memoizable && compile_time_call_result_is_memoizable(call_result.if_success))
+                    {
+                        compile_time_call_cache_insert(&state->root->call_cache, callee_function,
+                                                       compile_time_arguments, expected_arguments,
+                                                       call_result.if_success);
+                    }
                     break;
 
                 case external_function_result_unavailable:
@@ -1722,6 +1697,12 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
                                                                      called.arguments.opening_brace));
                     ASSUME(!compile_time_result.is_set);
                     break;
+
+                case external_function_result_deadline_reached:
+                    emit_semantic_error(state, semantic_error_create(semantic_error_deadline_reached,
+                                                                     called.arguments.opening_brace));
+                    ASSUME(!compile_time_result.is_set);
+                    break;
                 }
                 break;
             }
@@ -1749,11 +1730,27 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
                                                           .state;
                 ASSUME(enum_state_type.is_set);
                 compile_time_result = optional_value_create(
-                    value_from_enum_element(callee.type_.enum_constructor->which, enum_state_type.value, enum_state));
+                    value_from_enum_element(callee.type_.enum_constructor->which, enum_state));
                 break;
             }
             }
         }
+        if (compile_time_result.is_set && return_type.is_set && (return_type.value.kind == type_kind_string))
+        {
+            size_t const length = value_as_string(compile_time_result.value_).length;
+            char *const copy = garbage_collector_try_allocate(&state->program->memory, length);
+            if (copy || (length == 0))
+            {
+                memcpy(copy, value_as_string(compile_time_result.value_).begin, length);
+                compile_time_result = optional_value_create(value_from_string(unicode_view_create(copy, length)));
+            }
+            else
+            {
+                emit_semantic_error(state, semantic_error_create(semantic_error_compile_time_memory_limit_reached,
+                                                                 called.arguments.opening_brace));
+                compile_time_result = optional_value_empty;
+            }
+        }
         if (compile_time_result.is_set)
         {
             if (value_is_mutable(compile_time_result.value_))
@@ -1769,24 +1766,8 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
                 {
                     LPG_TO_DO();
                 }
-                if (return_type.value.kind == type_kind_string)
-                {
-                    size_t const length = compile_time_result.value_.string.length;
-                    char *const copy = garbage_collector_allocate(&state->program->memory, length);
-                    memcpy(copy, compile_time_result.value_.string.begin, length);
-                    add_instruction(function, instruction_create_literal(literal_instruction_create(
-                                                  result, value_from_string(unicode_view_create(copy, length)),
-                                                  type_from_string())));
-                }
-                else
-                {
-                    if (!return_type.is_set)
-                    {
-                        LPG_TO_DO();
-                    }
-                    add_instruction(function, instruction_create_literal(literal_instruction_create(
-                                                  result, compile_time_result.value_, return_type.value)));
-                }
+                add_instruction(function, instruction_create_literal(literal_instruction_create(
+                                              result, compile_time_result.value_, return_type.value)));
             }
         }
     }
@@ -1835,7 +1816,6 @@ static evaluate_expression_result evaluate_call_expression(function_checking_sta
 
     ASSUME(state->register_debug_name_count <= state->used_registers);
 
-    deallocate(compile_time_arguments);
     if (!return_type.is_set)
     {
         ASSUME(state->register_debug_name_count <= state->used_registers);
@@ -1855,10 +1835,10 @@ evaluate_expression_result evaluate_not_expression(function_checking_state *stat
 
     evaluate_expression_result const result =
         evaluate_expression(state, function, *(*element).not.expr, NULL,
-                            type_expectation_create_exact(optional_type_create_set(boolean_value.type_)));
+                            type_expectation_create_exact(optional_type_create_set(value_as_type(boolean_value))));
     ASSUME(state->global->members[3].compile_time_value.is_set);
 
-    if (type_equals(boolean_value.type_, result.type_))
+    if (type_equals(value_as_type(boolean_value), result.type_))
     {
         const register_id global_register = allocate_register(&state->used_registers);
         add_instruction(function, instruction_create_global(global_register));
@@ -2036,11 +2016,7 @@ static evaluate_expression_result check_sequence_finish(function_checking_state
             always_returns = true;
         }
     }
-    for (size_t i = previous_number_of_variables, c = state->local_variables.count; i != c; ++i)
-    {
-        local_variable_free(state->local_variables.elements + i);
-    }
-    state->local_variables.count = previous_number_of_variables;
+    local_variable_container_truncate(&state->local_variables, previous_number_of_variables);
     return evaluate_expression_result_create(always_returns ? evaluation_status_return : final_result.status,
                                              final_result.where, final_result.type_, final_result.compile_time_value,
                                              is_pure);
@@ -2082,7 +2058,7 @@ static bool check_for_duplicate_string_case(function_checking_state *const state
             optional_value const key = state->register_compile_time_values[cases[i].key_value];
             ASSUME(key.is_set);
             ASSUME(key.value_.kind == value_kind_string);
-            if (unicode_view_equals(key.value_.string, new_case_value))
+            if (unicode_view_equals(value_as_string(key.value_), new_case_value))
             {
                 return true;
             }
@@ -2140,8 +2116,8 @@ static evaluate_expression_result evaluate_match_expression_with_string(function
                 LPG_TO_DO();
             }
             ASSUME(key_evaluated.compile_time_value.value_.kind == value_kind_string);
-            if (check_for_duplicate_string_case(
-                    state, cases, (*element).match.number_of_cases, key_evaluated.compile_time_value.value_.string))
+            if (check_for_duplicate_string_case(state, cases, (*element).match.number_of_cases,
+                                                value_as_string(key_evaluated.compile_time_value.value_)))
             {
                 emit_semantic_error(
                     state, semantic_error_create(semantic_error_duplicate_match_case, expression_source_begin(*key)));
@@ -2379,7 +2355,7 @@ evaluate_expression_result evaluate_match_expression(function_checking_state *st
                     return evaluate_expression_result_empty;
                 }
 
-                if (key_evaluated.compile_time_value.value_.enum_element.state_type.kind != type_kind_unit)
+                if (value_or_unit(key_evaluated.compile_time_value.value_.enum_state).kind != value_kind_unit)
                 {
                     /* https://github.com/TyRoXx/Lpg/issues/91 */
                     LPG_TO_DO();
@@ -2388,7 +2364,7 @@ evaluate_expression_result evaluate_match_expression(function_checking_state *st
                 {
                     ASSUME(key_evaluated.compile_time_value.value_.kind == value_kind_enum_element);
                     bool *const case_handled =
-                        (enum_elements_handled + key_evaluated.compile_time_value.value_.enum_element.which);
+                        (enum_elements_handled + value_as_enum_element(key_evaluated.compile_time_value.value_).which);
                     if (*case_handled)
                     {
                         emit_semantic_error(state, semantic_error_create(semantic_error_duplicate_match_case,
@@ -2772,22 +2748,19 @@ static void find_generic_closures_in_sequence(generic_closures *const closures,
 static void resolve_generic_closure_identifier(generic_closures *const closures, function_checking_state *const state,
                                                unicode_view const name, source_location const source)
 {
-    for (size_t i = 0; i < state->local_variables.count; ++i)
+    local_variable const *const found = find_local_variable(&state->local_variables, name);
+    if (found)
     {
-        if (unicode_view_equals(name, state->local_variables.elements[i].name))
+        if (!found->compile_time_value.is_set)
         {
-            if (!state->local_variables.elements[i].compile_time_value.is_set)
-            {
-                emit_semantic_error(state, semantic_error_create(semantic_error_expected_compile_time_type, source));
-                return;
-            }
-            closures->elements = reallocate_array(closures->elements, closures->count + 1, sizeof(*closures->elements));
-            closures->elements[closures->count] =
-                generic_closure_create(unicode_view_copy(name), state->local_variables.elements[i].type_,
-                                       state->local_variables.elements[i].compile_time_value.value_);
-            closures->count += 1;
+            emit_semantic_error(state, semantic_error_create(semantic_error_expected_compile_time_type, source));
             return;
         }
+        closures->elements = reallocate_array(closures->elements, closures->count + 1, sizeof(*closures->elements));
+        closures->elements[closures->count] =
+            generic_closure_create(unicode_view_copy(name), found->type_, found->compile_time_value.value_);
+        closures->count += 1;
+        return;
     }
     if (state->parent)
     {
@@ -3021,7 +2994,8 @@ static evaluate_expression_result evaluate_interface(function_checking_state *st
     if (early_initialized_variable)
     {
         initialize_early(&state->local_variables, *early_initialized_variable, type_from_type(),
-                         optional_value_create(value_from_type(type_from_interface(id))), into);
+                         optional_value_create(value_from_type(type_from_interface(id), &state->program->memory)),
+                         into);
     }
 
     method_description *const checked_methods = allocate_array(element.method_count, sizeof(*checked_methods));
@@ -3061,10 +3035,9 @@ static evaluate_expression_result evaluate_interface(function_checking_state *st
     }
 
     state->root->interfaces_defined[id] = true;
-    state->program->interfaces[id].methods = checked_methods;
-    state->program->interfaces[id].method_count = checked_method_count;
+    interface_define_methods(state->program->interfaces + id, checked_methods, checked_method_count);
 
-    value const result = value_from_type(type_from_interface(id));
+    value const result = value_from_type(type_from_interface(id), &state->program->memory);
     add_instruction(function, instruction_create_literal(literal_instruction_create(into, result, type_from_type())));
     return evaluate_expression_result_create(
         evaluation_status_value, into, type_from_type(), optional_value_create(result), false);
@@ -3136,8 +3109,9 @@ static evaluate_expression_result evaluate_struct(function_checking_state *state
             deallocate(elements);
             return evaluate_expression_result_empty;
         }
-        elements[i] = structure_member_create(element_type_evaluated.compile_time_value.value_.type_,
-                                              unicode_view_copy(element.name.value), optional_value_empty);
+        elements[i] =
+            structure_member_create(intern_type(state, value_as_type(element_type_evaluated.compile_time_value.value_)),
+                                    unicode_view_copy(element.name.value), optional_value_empty);
     }
     struct_id const id = state->program->struct_count;
     state->program->structs = reallocate_array(state->program->structs, (id + 1), sizeof(*state->program->structs));
@@ -3145,7 +3119,7 @@ static evaluate_expression_result evaluate_struct(function_checking_state *state
                                                    /*TODO avoid truncation safely*/ (struct_id)evaluated.element_count);
     state->program->struct_count += 1;
     register_id const into = allocate_register(&state->used_registers);
-    value const result = value_from_type(type_from_struct(id));
+    value const result = value_from_type(type_from_struct(id), &state->program->memory);
     add_instruction(function, instruction_create_literal(literal_instruction_create(into, result, type_from_type())));
     return evaluate_expression_result_create(
         evaluation_status_value, into, type_from_type(), optional_value_create(result), false);
@@ -3205,30 +3179,23 @@ static method_evaluation_result evaluate_method_definition(function_checking_sta
         unicode_string_free(header.parameter_names + i);
     }
     deallocate(header.parameter_names);
+    deallocate(header.parameter_types);
     if (!checked.success)
     {
-        deallocate(header.parameter_types);
         return make_method_evaluation_result_failure();
     }
     ASSUME(!checked.captures);
-    ASSUME(checked.function.signature->parameters.length == 0);
-    checked.function.signature->parameters.elements = header.parameter_types;
-    checked.function.signature->parameters.length = method.header.parameter_count;
-    checked.function.signature->self = optional_type_create_set(self);
 
     checked_function_free(&state->program->functions[this_lambda_id]);
     state->program->functions[this_lambda_id] = checked.function;
+    checked_function_set_definition(&state->program->functions[this_lambda_id],
+                                    unicode_view_from_string(state->source->name), (method.name.source.line + 1));
     return method_evaluation_result_create(function_pointer_value_from_internal(this_lambda_id, NULL, 0));
 }
 
 static size_t begin_implementation(lpg_interface *const to, type const self)
 {
-    size_t const new_impl_id = to->implementation_count;
-    size_t const new_impl_count = to->implementation_count + 1;
-    to->implementations = reallocate_array(to->implementations, new_impl_count, sizeof(*to->implementations));
-    to->implementations[to->implementation_count] = implementation_entry_create(self, implementation_create(NULL, 0));
-    to->implementation_count = new_impl_count;
-    return new_impl_id;
+    return interface_add_implementation(to, implementation_entry_create(self, implementation_create(NULL, 0)));
 }
 
 static void finish_implementation(lpg_interface *const to, size_t const impl_index, implementation const methods)
@@ -3313,8 +3280,8 @@ static evaluate_expression_result evaluate_generic_impl_regular_self(function_ch
         interface_->generic_impls, (interface_->generic_impl_count + 1), sizeof(*interface_->generic_impls));
     interface_->generic_impls[interface_->generic_impl_count] =
         generic_impl_create(impl_expression_clone(element, root->pool), closures,
-                            generic_impl_self_create_regular(self.compile_time_value.value_.type_), state->source,
-                            unicode_view_copy(state->current_import_directory));
+                            generic_impl_self_create_regular(value_as_type(self.compile_time_value.value_)),
+                            state->source, unicode_view_copy(state->current_import_directory));
     interface_->generic_impl_count += 1;
     return make_unit(&state->used_registers, function);
 }
@@ -3351,7 +3318,7 @@ static evaluate_expression_result evaluate_generic_impl_regular_interface(functi
                                        semantic_error_expected_compile_time_type, expression_source_begin(interface_)));
         return evaluate_expression_result_empty;
     }
-    if (interface_evaluated.compile_time_value.value_.type_.kind != type_kind_interface)
+    if (value_as_type(interface_evaluated.compile_time_value.value_).kind != type_kind_interface)
     {
         emit_semantic_error(
             state, semantic_error_create(semantic_error_expected_interface, expression_source_begin(interface_)));
@@ -3365,7 +3332,7 @@ static evaluate_expression_result evaluate_generic_impl_regular_interface(functi
                                                                   root->generic_impls_for_regular_interfaces_count + 1,
                                                                   sizeof(*root->generic_impls_for_regular_interfaces));
     root->generic_impls_for_regular_interfaces[root->generic_impls_for_regular_interfaces_count] =
-        generic_impl_regular_interface_create(interface_evaluated.compile_time_value.value_.type_.interface_,
+        generic_impl_regular_interface_create(value_as_type(interface_evaluated.compile_time_value.value_).interface_,
                                               impl_expression_clone(tree, root->pool), closures,
                                               generic_instantiation_expression_clone(self, root->pool), state->source,
                                               unicode_view_copy(state->current_import_directory));
@@ -3469,18 +3436,6 @@ static evaluate_expression_result evaluate_generic_impl(function_checking_state
     }
 }
 
-static optional_size find_method(lpg_interface const *const in, unicode_view const name)
-{
-    for (size_t i = 0; i < in->method_count; ++i)
-    {
-        if (unicode_view_equals(unicode_view_from_string(in->methods[i].name), name))
-        {
-            return make_optional_size(i);
-        }
-    }
-    return optional_size_empty;
-}
-
 static optional_size evaluate_impl_core(function_checking_state *state, instruction_sequence *const function,
                                         impl_expression_method const *const method_trees,
                                         size_t const defined_method_count, type const self,
@@ -3490,13 +3445,10 @@ static optional_size evaluate_impl_core(function_checking_state *state, instruct
     size_t impl_id;
     {
         lpg_interface *const implemented_interface = &state->program->interfaces[target_interface];
-        for (size_t i = 0; i < implemented_interface->implementation_count; ++i)
+        if (interface_find_implementation(implemented_interface, self).state == optional_set)
         {
-            if (type_equals(self, implemented_interface->implementations[i].self))
-            {
-                emit_semantic_error(state, semantic_error_create(semantic_error_duplicate_impl, self_source));
-                return optional_size_empty;
-            }
+            emit_semantic_error(state, semantic_error_create(semantic_error_duplicate_impl, self_source));
+            return optional_size_empty;
         }
         impl_id = begin_implementation(implemented_interface, self);
     }
@@ -3506,7 +3458,8 @@ static optional_size evaluate_impl_core(function_checking_state *state, instruct
     for (size_t i = 0; i < defined_method_count; ++i)
     {
         lpg_interface *const implemented_interface = &state->program->interfaces[target_interface];
-        optional_size const canonical_method_index = find_method(implemented_interface, method_trees[i].name.value);
+        optional_size const canonical_method_index =
+            interface_find_method(implemented_interface, method_trees[i].name.value);
         if (canonical_method_index.state == optional_empty)
         {
             emit_semantic_error(state, semantic_error_create(semantic_error_extra_method, method_trees[i].name.source));
@@ -3607,13 +3560,13 @@ static evaluate_expression_result evaluate_instantiate_struct(function_checking_
                                                          expression_source_begin(*element.type)));
         return evaluate_expression_result_empty;
     }
-    if (type_evaluated.compile_time_value.value_.type_.kind != type_kind_structure)
+    if (value_as_type(type_evaluated.compile_time_value.value_).kind != type_kind_structure)
     {
         emit_semantic_error(
             state, semantic_error_create(semantic_error_expected_structure, expression_source_begin(*element.type)));
         return evaluate_expression_result_empty;
     }
-    struct_id const structure_id = type_evaluated.compile_time_value.value_.type_.structure_;
+    struct_id const structure_id = value_as_type(type_evaluated.compile_time_value.value_).structure_;
     ASSUME(structure_id < state->program->struct_count);
     structure const *const instantiated_structure = state->program->structs + structure_id;
     if (element.arguments.length < instantiated_structure->count)
@@ -3675,11 +3628,12 @@ static evaluate_expression_result evaluate_type_of(function_checking_state *cons
         state, function, *element.target, NULL, type_expectation_create_exact(optional_type_create_empty()));
     restore(before);
     register_id const where = allocate_register(&state->used_registers);
-    add_instruction(function, instruction_create_literal(literal_instruction_create(
-                                  where, value_from_type(target_evaluated.type_), type_from_type())));
-    write_register_compile_time_value(state, where, value_from_type(target_evaluated.type_));
-    return evaluate_expression_result_create(evaluation_status_value, where, type_from_type(),
-                                             optional_value_create(value_from_type(target_evaluated.type_)), true);
+    value const literal = value_from_type(target_evaluated.type_, &state->program->memory);
+    add_instruction(
+        function, instruction_create_literal(literal_instruction_create(where, literal, type_from_type())));
+    write_register_compile_time_value(state, where, literal);
+    return evaluate_expression_result_create(
+        evaluation_status_value, where, type_from_type(), optional_value_create(literal), true);
 }
 
 static generic_closures find_generic_closures(function_checking_state *state, enum_expression const definition)
@@ -3750,7 +3704,8 @@ evaluate_enum_expression(function_checking_state *state, instruction_sequence *f
                     deallocate(elements);
                     return evaluate_expression_result_empty;
                 }
-                element_state = optional_type_create_set(state_evaluated.compile_time_value.value_.type_);
+                element_state = optional_type_create_set(
+                    intern_type(state, value_as_type(state_evaluated.compile_time_value.value_)));
             }
             else
             {
@@ -3784,25 +3739,13 @@ evaluate_enum_expression(function_checking_state *state, instruction_sequence *f
     ASSUME(destination->elements == NULL);
     *destination = enumeration_create(elements, element.element_count);
     register_id const into = allocate_register(&state->used_registers);
-    value const literal = value_from_type(type_from_enumeration(new_enum_id));
+    value const literal = value_from_type(type_from_enumeration(new_enum_id), &state->program->memory);
     add_instruction(function, instruction_create_literal(literal_instruction_create(into, literal, type_from_type())));
     write_register_compile_time_value(state, into, literal);
     return evaluate_expression_result_create(
         evaluation_status_value, into, type_from_type(), optional_value_create(literal), true);
 }
 
-static bool values_equal(value const *const first, value const *const second, size_t const count)
-{
-    for (size_t i = 0; i < count; ++i)
-    {
-        if (!value_equals(first[i], second[i]))
-        {
-            return false;
-        }
-    }
-    return true;
-}
-
 static evaluate_expression_result instantiate_generic_enum(function_checking_state *const state,
                                                            instruction_sequence *const function,
                                                            generic_enum_id const generic, value *const arguments,
@@ -3813,55 +3756,22 @@ static evaluate_expression_result instantiate_generic_enum(function_checking_sta
     generic_enum const instantiated_enum = root->generic_enums[generic];
     if (argument_count < instantiated_enum.tree.parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_missing_argument, where));
         return evaluate_expression_result_empty;
     }
     if (argument_count > instantiated_enum.tree.parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_extraneous_argument, where));
         return evaluate_expression_result_empty;
     }
-    for (size_t i = 0; i < root->enum_instantiation_count; ++i)
+    optional_size const existing =
+        instantiation_index_find(root->enum_instantiation_index, generic, arguments, argument_count);
+    if (existing.state == optional_set)
     {
-        generic_enum_instantiation *const instantiation = root->enum_instantiations + i;
-        if (instantiation->generic != generic)
-        {
-            continue;
-        }
-        if (argument_count != instantiation->argument_count)
-        {
-            LPG_UNREACHABLE();
-        }
-        if (!values_equal(instantiation->arguments, arguments, argument_count))
-        {
-            continue;
-        }
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
+        generic_enum_instantiation const *const instantiation = root->enum_instantiations + existing.value_if_set;
         register_id const into = allocate_register(&state->used_registers);
-        value const literal = value_from_type(type_from_enumeration(instantiation->instantiated));
+        value const literal =
+            value_from_type(type_from_enumeration(instantiation->instantiated), &state->program->memory);
         add_instruction(
             function, instruction_create_literal(literal_instruction_create(into, literal, type_from_type())));
         write_register_compile_time_value(state, into, literal);
@@ -3889,25 +3799,13 @@ static evaluate_expression_result instantiate_generic_enum(function_checking_sta
                                  enum_expression_create(original.begin, generic_parameter_list_create(NULL, 0),
                                                         original.elements, original.element_count));
     instruction_sequence_free(&ignored_instructions);
-    local_variable_container_free(enum_checking.local_variables);
-    if (enum_checking.register_compile_time_values)
-    {
-        deallocate(enum_checking.register_compile_time_values);
-    }
+    function_checking_state_free(enum_checking);
     switch (evaluated.status)
     {
     case evaluation_status_value:
         break;
 
     case evaluation_status_error:
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         return evaluate_expression_result_empty;
 
     case evaluation_status_exit:
@@ -3922,16 +3820,19 @@ static evaluate_expression_result instantiate_generic_enum(function_checking_sta
     {
         LPG_UNREACHABLE();
     }
-    if (evaluated.compile_time_value.value_.type_.kind != type_kind_enumeration)
+    if (value_as_type(evaluated.compile_time_value.value_).kind != type_kind_enumeration)
     {
         LPG_UNREACHABLE();
     }
     size_t const id = root->enum_instantiation_count;
-    root->enum_instantiations = reallocate_array(
-        root->enum_instantiations, root->enum_instantiation_count + 1, sizeof(*root->enum_instantiations));
+    root->enum_instantiations =
+        reallocate_array_exponentially(root->enum_instantiations, root->enum_instantiation_count + 1,
+                                       sizeof(*root->enum_instantiations), root->enum_instantiation_count,
+                                       &root->enum_instantiation_capacity);
     root->enum_instantiations[id] = generic_enum_instantiation_create(
-        generic, argument_types, arguments, argument_count, evaluated.compile_time_value.value_.type_.enum_);
+        generic, argument_types, arguments, argument_count, value_as_type(evaluated.compile_time_value.value_).enum_);
     root->enum_instantiation_count += 1;
+    instantiation_index_insert(&root->enum_instantiation_index, generic, arguments, argument_count, id);
     register_id const result_where = allocate_register(&state->used_registers);
     add_instruction(function, instruction_create_literal(literal_instruction_create(
                                   result_where, evaluated.compile_time_value.value_, evaluated.type_)));
@@ -3949,55 +3850,21 @@ static evaluate_expression_result instantiate_generic_struct(function_checking_s
     generic_struct const instantiated_struct = root->generic_structs[generic];
     if (argument_count < instantiated_struct.tree.generic_parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_missing_argument, where));
         return evaluate_expression_result_empty;
     }
     if (argument_count > instantiated_struct.tree.generic_parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_extraneous_argument, where));
         return evaluate_expression_result_empty;
     }
-    for (size_t i = 0; i < root->struct_instantiation_count; ++i)
+    optional_size const existing =
+        instantiation_index_find(root->struct_instantiation_index, generic, arguments, argument_count);
+    if (existing.state == optional_set)
     {
-        generic_struct_instantiation *const instantiation = root->struct_instantiations + i;
-        if (instantiation->generic != generic)
-        {
-            continue;
-        }
-        if (argument_count != instantiation->argument_count)
-        {
-            LPG_UNREACHABLE();
-        }
-        if (!values_equal(instantiation->arguments, arguments, argument_count))
-        {
-            continue;
-        }
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
+        generic_struct_instantiation const *const instantiation = root->struct_instantiations + existing.value_if_set;
         register_id const into = allocate_register(&state->used_registers);
-        value const literal = value_from_type(type_from_struct(instantiation->instantiated));
+        value const literal = value_from_type(type_from_struct(instantiation->instantiated), &state->program->memory);
         add_instruction(
             function, instruction_create_literal(literal_instruction_create(into, literal, type_from_type())));
         write_register_compile_time_value(state, into, literal);
@@ -4026,21 +3893,9 @@ static evaluate_expression_result instantiate_generic_struct(function_checking_s
                                                  original.elements, original.element_count),
                         NULL);
     instruction_sequence_free(&ignored_instructions);
-    local_variable_container_free(struct_checking.local_variables);
-    if (struct_checking.register_compile_time_values)
-    {
-        deallocate(struct_checking.register_compile_time_values);
-    }
+    function_checking_state_free(struct_checking);
     if (evaluated.status != evaluation_status_value)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         return evaluate_expression_result_empty;
     }
     if (!evaluated.compile_time_value.is_set)
@@ -4051,16 +3906,20 @@ static evaluate_expression_result instantiate_generic_struct(function_checking_s
     {
         LPG_UNREACHABLE();
     }
-    if (evaluated.compile_time_value.value_.type_.kind != type_kind_structure)
+    if (value_as_type(evaluated.compile_time_value.value_).kind != type_kind_structure)
     {
         LPG_UNREACHABLE();
     }
     size_t const id = root->struct_instantiation_count;
-    root->struct_instantiations = reallocate_array(
-        root->struct_instantiations, root->struct_instantiation_count + 1, sizeof(*root->struct_instantiations));
+    root->struct_instantiations =
+        reallocate_array_exponentially(root->struct_instantiations, root->struct_instantiation_count + 1,
+                                       sizeof(*root->struct_instantiations), root->struct_instantiation_count,
+                                       &root->struct_instantiation_capacity);
     root->struct_instantiations[id] = generic_struct_instantiation_create(
-        generic, arguments, argument_count, evaluated.compile_time_value.value_.type_.structure_, argument_types);
+        generic, arguments, argument_count, value_as_type(evaluated.compile_time_value.value_).structure_,
+        argument_types);
     root->struct_instantiation_count += 1;
+    instantiation_index_insert(&root->struct_instantiation_index, generic, arguments, argument_count, id);
     register_id const result_where = allocate_register(&state->used_registers);
     add_instruction(function, instruction_create_literal(literal_instruction_create(
                                   result_where, evaluated.compile_time_value.value_, evaluated.type_)));
@@ -4078,55 +3937,23 @@ static evaluate_expression_result instantiate_generic_interface(function_checkin
     generic_interface const instantiated_interface = root->generic_interfaces[generic];
     if (argument_count < instantiated_interface.tree.parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_missing_argument, where));
         return evaluate_expression_result_empty;
     }
     if (argument_count > instantiated_interface.tree.parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_extraneous_argument, where));
         return evaluate_expression_result_empty;
     }
-    for (size_t i = 0; i < root->interface_instantiation_count; ++i)
+    optional_size const existing =
+        instantiation_index_find(root->interface_instantiation_index, generic, arguments, argument_count);
+    if (existing.state == optional_set)
     {
-        generic_interface_instantiation *const instantiation = root->interface_instantiations + i;
-        if (instantiation->generic != generic)
-        {
-            continue;
-        }
-        if (argument_count != instantiation->argument_count)
-        {
-            LPG_UNREACHABLE();
-        }
-        if (!values_equal(instantiation->arguments, arguments, argument_count))
-        {
-            continue;
-        }
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
+        generic_interface_instantiation const *const instantiation =
+            root->interface_instantiations + existing.value_if_set;
         register_id const into = allocate_register(&state->used_registers);
-        value const literal = value_from_type(type_from_interface(instantiation->instantiated));
+        value const literal =
+            value_from_type(type_from_interface(instantiation->instantiated), &state->program->memory);
         add_instruction(
             function, instruction_create_literal(literal_instruction_create(into, literal, type_from_type())));
         write_register_compile_time_value(state, into, literal);
@@ -4141,11 +3968,14 @@ static evaluate_expression_result instantiate_generic_interface(function_checkin
         unicode_view_from_string(instantiated_interface.current_import_directory));
     size_t const instantiation_id = root->interface_instantiation_count;
     root->interface_instantiations =
-        reallocate_array(root->interface_instantiations, root->interface_instantiation_count + 1,
-                         sizeof(*root->interface_instantiations));
+        reallocate_array_exponentially(root->interface_instantiations, root->interface_instantiation_count + 1,
+                                       sizeof(*root->interface_instantiations), root->interface_instantiation_count,
+                                       &root->interface_instantiation_capacity);
     root->interface_instantiations[instantiation_id] = generic_interface_instantiation_create(
         generic, argument_types, arguments, argument_count, state->program->interface_count);
     root->interface_instantiation_count += 1;
+    instantiation_index_insert(
+        &root->interface_instantiation_index, generic, arguments, argument_count, instantiation_id);
 
     for (size_t i = 0; i < instantiated_interface.tree.parameters.count; ++i)
     {
@@ -4163,11 +3993,7 @@ static evaluate_expression_result instantiate_generic_interface(function_checkin
                                                        original.methods, original.method_count),
                            NULL);
     instruction_sequence_free(&ignored_instructions);
-    local_variable_container_free(interface_checking.local_variables);
-    if (interface_checking.register_compile_time_values)
-    {
-        deallocate(interface_checking.register_compile_time_values);
-    }
+    function_checking_state_free(interface_checking);
     if (evaluated.status != evaluation_status_value)
     {
         return evaluate_expression_result_empty;
@@ -4180,12 +4006,12 @@ static evaluate_expression_result instantiate_generic_interface(function_checkin
     {
         LPG_UNREACHABLE();
     }
-    if (evaluated.compile_time_value.value_.type_.kind != type_kind_interface)
+    if (value_as_type(evaluated.compile_time_value.value_).kind != type_kind_interface)
     {
         LPG_UNREACHABLE();
     }
     ASSUME(instantiation_id < root->interface_instantiation_count);
-    ASSUME(evaluated.compile_time_value.value_.type_.interface_ ==
+    ASSUME(value_as_type(evaluated.compile_time_value.value_).interface_ ==
            root->interface_instantiations[instantiation_id].instantiated);
 
     register_id const result_where = allocate_register(&state->used_registers);
@@ -4205,56 +4031,21 @@ static evaluate_expression_result instantiate_generic_lambda(function_checking_s
     generic_lambda const instantiated_lambda = root->generic_lambdas[generic];
     if (argument_count < instantiated_lambda.tree.generic_parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_missing_argument, where));
         return evaluate_expression_result_empty;
     }
     if (argument_count > instantiated_lambda.tree.generic_parameters.count)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_extraneous_argument, where));
         return evaluate_expression_result_empty;
     }
-    for (size_t i = 0; i < root->lambda_instantiation_count; ++i)
+    optional_size const existing =
+        instantiation_index_find(root->lambda_instantiation_index, generic, arguments, argument_count);
+    if (existing.state == optional_set)
     {
-        generic_lambda_instantiation *const instantiation = root->lambda_instantiations + i;
-        if (instantiation->generic != generic)
-        {
-            continue;
-        }
-        if (argument_count != instantiation->argument_count)
-        {
-            LPG_UNREACHABLE();
-        }
-        if (!values_equal(instantiation->arguments, arguments, argument_count))
-        {
-            continue;
-        }
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
+        generic_lambda_instantiation const *const instantiation = root->lambda_instantiations + existing.value_if_set;
         register_id const into = allocate_register(&state->used_registers);
-        value const literal =
-            value_from_function_pointer(function_pointer_value_from_internal(instantiation->instantiated, NULL, 0));
+        value const literal = value_from_internal_function(instantiation->instantiated);
         type const function_type = type_from_lambda(lambda_type_create(instantiation->instantiated));
         add_instruction(function, instruction_create_literal(literal_instruction_create(into, literal, function_type)));
         write_register_compile_time_value(state, into, literal);
@@ -4281,11 +4072,15 @@ static evaluate_expression_result instantiate_generic_lambda(function_checking_s
     function_id const this_lambda_id = reserve_function_id(state);
     {
         size_t const instantiation_id = root->lambda_instantiation_count;
-        root->lambda_instantiations = reallocate_array(
-            root->lambda_instantiations, root->lambda_instantiation_count + 1, sizeof(*root->lambda_instantiations));
+        root->lambda_instantiations =
+            reallocate_array_exponentially(root->lambda_instantiations, root->lambda_instantiation_count + 1,
+                                           sizeof(*root->lambda_instantiations), root->lambda_instantiation_count,
+                                           &root->lambda_instantiation_capacity);
         root->lambda_instantiations[instantiation_id] =
             generic_lambda_instantiation_create(generic, arguments, argument_count, this_lambda_id);
         root->lambda_instantiation_count += 1;
+        instantiation_index_insert(
+            &root->lambda_instantiation_index, generic, arguments, argument_count, instantiation_id);
     }
 
     evaluate_expression_result const evaluated = evaluate_lambda(
@@ -4293,17 +4088,9 @@ static evaluate_expression_result instantiate_generic_lambda(function_checking_s
         lambda_create(generic_parameter_list_create(NULL, 0), original.header, original.result, original.source), NULL,
         optional_function_id_create(this_lambda_id));
     instruction_sequence_free(&ignored_instructions);
-    local_variable_container_free(lambda_checking.local_variables);
-    if (lambda_checking.register_compile_time_values)
-    {
-        deallocate(lambda_checking.register_compile_time_values);
-    }
+    function_checking_state_free(lambda_checking);
     if (evaluated.status != evaluation_status_value)
     {
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         return evaluate_expression_result_empty;
     }
     if (!evaluated.compile_time_value.is_set)
@@ -4318,13 +4105,9 @@ static evaluate_expression_result instantiate_generic_lambda(function_checking_s
     {
         LPG_UNREACHABLE();
     }
-    ASSUME(evaluated.compile_time_value.value_.function_pointer.code == this_lambda_id);
-    ASSUME(!evaluated.compile_time_value.value_.function_pointer.external);
+    ASSUME(value_as_function_pointer(evaluated.compile_time_value.value_).code == this_lambda_id);
+    ASSUME(!value_as_function_pointer(evaluated.compile_time_value.value_).external);
 
-    if (argument_types)
-    {
-        deallocate(argument_types);
-    }
     register_id const result_where = allocate_register(&state->used_registers);
     add_instruction(function, instruction_create_literal(literal_instruction_create(
                                   result_where, evaluated.compile_time_value.value_, evaluated.type_)));
@@ -4342,34 +4125,18 @@ static evaluate_expression_result evaluate_generic_instantiation(function_checki
     {
         return evaluate_expression_result_empty;
     }
-    value *const arguments = allocate_array(element.count, sizeof(*arguments));
-    type *const argument_types = allocate_array(element.count, sizeof(*argument_types));
+    value *const arguments = arena_allocate_array(&state->root->memory, element.count, sizeof(*arguments));
+    type *const argument_types = arena_allocate_array(&state->root->memory, element.count, sizeof(*argument_types));
     for (size_t i = 0; i < element.count; ++i)
     {
         evaluate_expression_result const argument_evaluated = evaluate_expression(
             state, function, element.arguments[i], NULL, type_expectation_create_exact(optional_type_create_empty()));
         if (argument_evaluated.status != evaluation_status_value)
         {
-            if (arguments)
-            {
-                deallocate(arguments);
-            }
-            if (argument_types)
-            {
-                deallocate(argument_types);
-            }
             return evaluate_expression_result_empty;
         }
         if (!argument_evaluated.compile_time_value.is_set)
         {
-            if (arguments)
-            {
-                deallocate(arguments);
-            }
-            if (argument_types)
-            {
-                deallocate(argument_types);
-            }
             emit_semantic_error(state, semantic_error_create(semantic_error_expected_compile_time_value,
                                                              expression_source_begin(element.arguments[i])));
             return evaluate_expression_result_empty;
@@ -4379,14 +4146,6 @@ static evaluate_expression_result evaluate_generic_instantiation(function_checki
     }
     if (!generic_evaluated.compile_time_value.is_set)
     {
-        if (arguments)
-        {
-            deallocate(arguments);
-        }
-        if (argument_types)
-        {
-            deallocate(argument_types);
-        }
         emit_semantic_error(state, semantic_error_create(semantic_error_expected_compile_time_value,
                                                          expression_source_begin(*element.generic)));
         return evaluate_expression_result_empty;
@@ -4415,27 +4174,45 @@ static evaluate_expression_result evaluate_generic_instantiation(function_checki
                                           arguments, element.count, argument_types,
                                           expression_source_begin(*element.generic));
     }
-    if (arguments)
-    {
-        deallocate(arguments);
-    }
-    if (argument_types)
-    {
-        deallocate(argument_types);
-    }
     emit_semantic_error(
         state, semantic_error_create(semantic_error_expected_generic_type, expression_source_begin(*element.generic)));
     return evaluate_expression_result_empty;
 }
 
-static evaluate_expression_result evaluate_import(function_checking_state *const state,
-                                                  instruction_sequence *const function, import_expression const element)
+/*loads a module that the program has not loaded yet and remembers the result for the other imports of it*/
+static load_module_result load_new_module(function_checking_state *const state, module_file const found)
 {
-    for (size_t i = 0; i < state->root->module_count; ++i)
+    begin_load_module(state->root, unicode_view_copy(unicode_view_from_string(found.canonical_path)));
+    load_module_result const loaded = load_module(state, found);
+    if (loaded.loaded.is_set)
+    {
+        succeed_load_module(
+            state->root, unicode_view_from_string(found.canonical_path), loaded.loaded.value_, loaded.schema);
+    }
+    else
+    {
+        fail_load_module(state->root, unicode_view_from_string(found.canonical_path));
+    }
+    return loaded;
+}
+
+static evaluate_expression_result evaluate_import(function_checking_state *const state,
+                                                  instruction_sequence *const function, import_expression const element)
+{
+    module_file found;
+    if (!find_module_file(state->root->loader, state->current_import_directory, element.name.value, &found))
+    {
+        emit_semantic_error(state, semantic_error_create(semantic_error_import_failed, element.begin));
+        return evaluate_expression_result_empty;
+    }
+    /*the same file can be reached from different import directories, but it is only loaded once per program*/
+    for (size_t i = 0; i < state->root->module_count; ++i)
     {
         module const current_module = state->root->modules[i];
-        if (unicode_view_equals(unicode_view_from_string(current_module.name), element.name.value))
+        if (unicode_view_equals(
+                unicode_view_from_string(current_module.name), unicode_view_from_string(found.canonical_path)))
         {
+            module_file_free(found);
             if (!current_module.content.is_set)
             {
                 emit_semantic_error(state, semantic_error_create(semantic_error_import_failed, element.begin));
@@ -4450,15 +4227,13 @@ static evaluate_expression_result evaluate_import(function_checking_state *const
                                                      optional_value_create(current_module.content.value_), true);
         }
     }
-    begin_load_module(state->root, unicode_view_copy(element.name.value));
-    load_module_result const imported = load_module(state, element.name.value);
+    load_module_result const imported = load_new_module(state, found);
+    module_file_free(found);
     if (!imported.loaded.is_set)
     {
-        fail_load_module(state->root, element.name.value);
         emit_semantic_error(state, semantic_error_create(semantic_error_import_failed, element.begin));
         return evaluate_expression_result_empty;
     }
-    succeed_load_module(state->root, element.name.value, imported.loaded.value_, imported.schema);
     register_id const where = allocate_register(&state->used_registers);
     write_register_compile_time_value(state, where, imported.loaded.value_);
     add_instruction(function, instruction_create_literal(
@@ -4467,6 +4242,54 @@ static evaluate_expression_result evaluate_import(function_checking_state *const
         evaluation_status_value, where, imported.schema, optional_value_create(imported.loaded.value_), true);
 }
 
+static array_storage choose_array_storage(checked_program const *const program, type const element_type)
+{
+    switch (element_type.kind)
+    {
+    case type_kind_integer_range:
+        if (element_type.integer_range_.maximum.high == 0)
+        {
+            return array_storage_integers;
+        }
+        return array_storage_values;
+
+    case type_kind_enumeration:
+    {
+        enumeration const enum_ = program->enums[element_type.enum_];
+        if ((enum_.size == 0) || (enum_.size > 256))
+        {
+            return array_storage_values;
+        }
+        for (enum_element_id i = 0; i < enum_.size; ++i)
+        {
+            if (enum_.elements[i].state.is_set)
+            {
+                return array_storage_values;
+            }
+        }
+        return array_storage_enum_elements;
+    }
+
+    case type_kind_structure:
+    case type_kind_function_pointer:
+    case type_kind_unit:
+    case type_kind_string:
+    case type_kind_tuple:
+    case type_kind_type:
+    case type_kind_lambda:
+    case type_kind_interface:
+    case type_kind_method_pointer:
+    case type_kind_generic_enum:
+    case type_kind_generic_interface:
+    case type_kind_generic_lambda:
+    case type_kind_generic_struct:
+    case type_kind_host_value:
+    case type_kind_enum_constructor:
+        return array_storage_values;
+    }
+    LPG_UNREACHABLE();
+}
+
 static evaluate_expression_result evaluate_new_array(function_checking_state *const state,
                                                      instruction_sequence *const function,
                                                      new_array_expression const element)
@@ -4507,19 +4330,19 @@ static evaluate_expression_result evaluate_new_array(function_checking_state *co
     {
         LPG_TO_DO();
     }
-    if (array_imported.compile_time_value.value_.structure.count != 1)
+    if (value_as_structure(array_imported.compile_time_value.value_).count != 1)
     {
         LPG_TO_DO();
     }
-    value const generic_array = array_imported.compile_time_value.value_.structure.members[0];
+    value const generic_array = value_as_structure(array_imported.compile_time_value.value_).members[0];
     if (generic_array.kind != value_kind_generic_interface)
     {
         LPG_TO_DO();
     }
     generic_interface_id const array_generic = generic_array.generic_interface;
-    value *const arguments = allocate_array(1, sizeof(*arguments));
+    value *const arguments = arena_allocate_array(&state->root->memory, 1, sizeof(*arguments));
     arguments[0] = element_evaluated.compile_time_value.value_;
-    type *const argument_types = allocate_array(1, sizeof(*argument_types));
+    type *const argument_types = arena_allocate_array(&state->root->memory, 1, sizeof(*argument_types));
     argument_types[0] = element_evaluated.type_;
     evaluate_expression_result const array_instantiated = instantiate_generic_interface(
         state, function, array_generic, arguments, 1, argument_types, expression_source_begin(*element.element));
@@ -4535,16 +4358,18 @@ static evaluate_expression_result evaluate_new_array(function_checking_state *co
     {
         LPG_TO_DO();
     }
-    if (array_instantiated.compile_time_value.value_.type_.kind != type_kind_interface)
+    if (value_as_type(array_instantiated.compile_time_value.value_).kind != type_kind_interface)
     {
         LPG_TO_DO();
     }
     register_id const into = allocate_register(&state->used_registers);
+    type const element_type = intern_type(state, value_as_type(element_evaluated.compile_time_value.value_));
     add_instruction(function, instruction_create_new_array(new_array_instruction_create(
-                                  array_instantiated.compile_time_value.value_.type_.interface_, into,
-                                  element_evaluated.compile_time_value.value_.type_)));
-    return evaluate_expression_result_create(
-        evaluation_status_value, into, array_instantiated.compile_time_value.value_.type_, optional_value_empty, false);
+                                  value_as_type(array_instantiated.compile_time_value.value_).interface_, into,
+                                  element_type, choose_array_storage(state->program, element_type))));
+    return evaluate_expression_result_create(evaluation_status_value, into,
+                                             value_as_type(array_instantiated.compile_time_value.value_),
+                                             optional_value_empty, false);
 }
 
 static evaluate_expression_result evaluate_declare(function_checking_state *const state,
@@ -4582,7 +4407,8 @@ static evaluate_expression_result evaluate_declare(function_checking_state *cons
             }
             else
             {
-                declared_type = optional_type_create_set(declared_type_evaluated.compile_time_value.value_.type_);
+                declared_type = optional_type_create_set(
+                    intern_type(state, value_as_type(declared_type_evaluated.compile_time_value.value_)));
             }
             break;
 
@@ -4752,12 +4578,12 @@ static evaluate_expression_result evaluate_expression_core(function_checking_sta
         register_id const where = allocate_register(&state->used_registers);
         type const what =
             type_from_integer_range(integer_range_create(element.integer_literal.value, element.integer_literal.value));
-        add_instruction(function, instruction_create_literal(literal_instruction_create(
-                                      where, value_from_integer(element.integer_literal.value), what)));
-        write_register_compile_time_value(state, where, value_from_integer(element.integer_literal.value));
+        value const literal = value_from_integer(element.integer_literal.value, &state->program->memory);
+        add_instruction(function, instruction_create_literal(literal_instruction_create(where, literal, what)));
+        write_register_compile_time_value(state, where, literal);
         return evaluate_expression_result_create(
             evaluation_status_value, where, what,
-            optional_value_create(value_from_integer(element.integer_literal.value)), true);
+            optional_value_create(value_from_integer(element.integer_literal.value, &state->program->memory)), true);
     }
 
     case expression_type_access_structure:
@@ -4786,29 +4612,36 @@ static evaluate_expression_result evaluate_expression_core(function_checking_sta
 
     case expression_type_string:
     {
-        register_id const result = allocate_register(&state->used_registers);
-        unicode_view literal;
+        memory_writer decoded = {NULL, 0, 0};
+        unicode_view content;
         if (element.string.value.begin[0] == '"')
         {
-            memory_writer decoded = {NULL, 0, 0};
             stream_writer const decoded_writer = memory_writer_erase(&decoded);
             decode_string_literal(element.string.value, decoded_writer);
-            char *const copy = garbage_collector_allocate(&state->program->memory, decoded.used);
-            if (decoded.used > 0)
-            {
-                memcpy(copy, decoded.data, decoded.used);
-            }
-            literal = unicode_view_create(copy, decoded.used);
-            memory_writer_free(&decoded);
+            content = unicode_view_create(decoded.data, decoded.used);
         }
         else
         {
-            const size_t length = element.string.value.length;
-            char *const copy = garbage_collector_allocate(&state->program->memory, length - 2);
-            ASSUME(length >= 2);
-            memcpy(copy, element.string.value.begin + 1, length - 2);
-            literal = unicode_view_create(copy, length - 2);
+            ASSUME(element.string.value.length >= 2);
+            content = unicode_view_create(element.string.value.begin + 1, element.string.value.length - 2);
         }
+        char *const copy = (content.length <= value_max_string_length)
+                               ? garbage_collector_try_allocate(&state->program->memory, content.length)
+                               : NULL;
+        if (!copy && (content.length > 0))
+        {
+            memory_writer_free(&decoded);
+            emit_semantic_error(state, semantic_error_create(semantic_error_compile_time_memory_limit_reached,
+                                                             expression_source_begin(element)));
+            return evaluate_expression_result_empty;
+        }
+        if (content.length > 0)
+        {
+            memcpy(copy, content.begin, content.length);
+        }
+        memory_writer_free(&decoded);
+        unicode_view const literal = unicode_view_create(copy, content.length);
+        register_id const result = allocate_register(&state->used_registers);
 
         add_instruction(function, instruction_create_literal(literal_instruction_create(
                                       result, value_from_string(literal), type_from_string())));
@@ -4937,22 +4770,132 @@ static structure clone_structure(structure const original)
     return structure_create(members, original.count);
 }
 
-checked_program check(sequence const root, structure const global, check_error_handler *on_error, module_loader *loader,
-                      source_file source, unicode_view const current_import_directory,
-                      size_t const max_compile_time_heap, void *user)
+execution_budget default_compile_time_budget(size_t const max_compile_time_heap)
+{
+    /*compile time evaluation should not go very deep*/
+    return execution_budget_create(
+        10000, 100, (64 * 1024), max_compile_time_heap, duration_from_milliseconds(execution_budget_no_deadline));
+}
+
+/*How far a checked program and its checker had come at some point, so that everything that has been added afterwards
+ * can be removed again. Interfaces and generic interfaces that existed before can receive implementations later, so the
+ * number of implementations of every one of them is recorded, too.*/
+typedef struct check_checkpoint
+{
+    function_id function_count;
+    interface_id interface_count;
+    size_t *implementation_counts;
+    struct_id struct_count;
+    enum_id enum_count;
+    generic_enum_id generic_enum_count;
+    size_t enum_instantiation_count;
+    generic_interface_id generic_interface_count;
+    size_t *generic_impl_counts;
+    size_t interface_instantiation_count;
+    generic_lambda_id generic_lambda_count;
+    size_t lambda_instantiation_count;
+    generic_struct_id generic_struct_count;
+    size_t struct_instantiation_count;
+    size_t module_count;
+    size_t generic_impls_for_regular_interfaces_count;
+    size_t module_source_count;
+} check_checkpoint;
+
+static void check_checkpoint_free(check_checkpoint const freed)
+{
+    if (freed.implementation_counts)
+    {
+        deallocate(freed.implementation_counts);
+    }
+    if (freed.generic_impl_counts)
+    {
+        deallocate(freed.generic_impl_counts);
+    }
+}
+
+/*a module of the program together with what its file looked like when the module was checked*/
+typedef struct resident_module
+{
+    unicode_string canonical_path;
+    uint64_t content_hash;
+    module_imports imports;
+} resident_module;
+
+static void resident_module_free(resident_module const freed)
+{
+    unicode_string_free(&freed.canonical_path);
+    module_imports_free(freed.imports);
+}
+
+static void resident_modules_free(resident_module *const freed, size_t const count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        resident_module_free(freed[i]);
+    }
+    if (freed)
+    {
+        deallocate(freed);
+    }
+}
+
+/*modules that have been checked together before the main file, so they can only be removed together*/
+typedef struct resident_unit
+{
+    check_checkpoint before;
+    resident_module *modules;
+    size_t module_count;
+} resident_unit;
+
+static void resident_unit_free(resident_unit const freed)
+{
+    check_checkpoint_free(freed.before);
+    resident_modules_free(freed.modules, freed.module_count);
+}
+
+struct check_session
+{
+    /*owned by the caller*/
+    structure global;
+    execution_budget compile_time_budget;
+    checked_program program;
+    value *globals;
+    value_stack compile_time_stack;
+    bytecode_cache compile_time_bytecode;
+    expression_pool pool;
+    execution_usage ignored_usage;
+    program_check root;
+    /*the modules that have been checked before the main file in the order in which they have been checked*/
+    resident_unit *units;
+    size_t unit_count;
+    /*the modules that the last check of the main file has loaded itself*/
+    resident_module *loaded_by_main;
+    size_t loaded_by_main_count;
+    /*the following members are only valid if the main file has been checked*/
+    bool has_main;
+    check_checkpoint before_main;
+    source_file_owning main_source;
+    /*the size of the heap after the first check, so that the memory that is left behind by replaced modules can be
+     * kept in bounds*/
+    size_t initial_heap_size;
+};
+
+static void check_session_initialize(check_session *const session, structure const global,
+                                     execution_budget const compile_time_budget,
+                                     execution_usage *const compile_time_usage)
 {
-    size_t const max_recursion = 100;
     structure *const structures = allocate_array(1, sizeof(*structures));
     structures[0] = clone_structure(global);
     checked_program program = {NULL,
                                0,
                                structures,
                                1,
-                               garbage_collector_create(max_compile_time_heap),
+                               garbage_collector_create(compile_time_budget.max_heap_size),
                                allocate_array(1, sizeof(*program.functions)),
                                1,
                                allocate_array(5, sizeof(*program.enums)),
-                               5};
+                               5,
+                               type_interner_create()};
     {
         enumeration_element *const elements = allocate_array(2, sizeof(*elements));
         elements[0] = enumeration_element_create(unicode_string_from_c_str("false"), optional_type_create_empty());
@@ -4989,52 +4932,686 @@ checked_program check(sequence const root, structure const global, check_error_h
         elements[1] = enumeration_element_create(unicode_string_from_c_str("overflow"), optional_type_create_empty());
         program.enums[standard_library_enum_add_u64_result] = enumeration_create(elements, 2);
     }
-    size_t const globals_count = global.count;
-    value *const globals = allocate_array(globals_count, sizeof(*globals));
-    for (size_t i = 0; i < globals_count; ++i)
+    /*the types of the globals are interned like every other type that the checker hands out*/
+    for (struct_member_id i = 0; i < structures[0].count; ++i)
+    {
+        structures[0].members[i].what =
+            type_interner_intern(&program.types, &program.memory, structures[0].members[i].what);
+    }
+    session->global = global;
+    session->compile_time_budget = compile_time_budget;
+    session->program = program;
+    session->globals = allocate_array(global.count, sizeof(*session->globals));
+    for (size_t i = 0; i < global.count; ++i)
     {
         optional_value const compile_time_global = global.members[i].compile_time_value;
         if (compile_time_global.is_set)
         {
-            globals[i] = compile_time_global.value_;
+            session->globals[i] = compile_time_global.value_;
         }
         else
         {
             /*TODO: solve properly*/
-            globals[i] = value_from_unit();
-        }
-    }
-    size_t current_recursion = 0;
-    uint64_t const max_executed_instructions = 10000;
-    uint64_t executed_instructions = 0;
-    expression_pool pool = expression_pool_create();
-    program_check check_root = {
-        NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, NULL, 0, loader, global, globals, NULL,
-        NULL, 0, 0, interpreter_create(globals, &program.memory, &program.functions, &program.interfaces, max_recursion,
-                                       &current_recursion, max_executed_instructions, &executed_instructions),
-        NULL, 0, &pool};
-    source_file_owning const source_copy = source_file_to_owning(source);
+            session->globals[i] = value_from_unit();
+        }
+    }
+    session->compile_time_stack = value_stack_create();
+    session->compile_time_bytecode = bytecode_cache_create();
+    session->pool = expression_pool_create();
+    session->ignored_usage = execution_usage_create();
+    program_check const root = {
+        NULL,
+        0,
+        NULL,
+        0,
+        0,
+        instantiation_index_create(),
+        NULL,
+        0,
+        NULL,
+        0,
+        0,
+        instantiation_index_create(),
+        NULL,
+        0,
+        NULL,
+        0,
+        0,
+        instantiation_index_create(),
+        NULL,
+        0,
+        NULL,
+        0,
+        0,
+        instantiation_index_create(),
+        NULL,
+        0,
+        NULL,
+        structures[0],
+        session->globals,
+        NULL,
+        NULL,
+        0,
+        0,
+        interpreter_create(session->globals, &session->program.memory, &session->compile_time_stack,
+                           &session->compile_time_bytecode, &session->program.functions, &session->program.interfaces,
+                           compile_time_budget, compile_time_usage ? compile_time_usage : &session->ignored_usage),
+        NULL,
+        0,
+        &session->pool,
+        compile_time_call_cache_create(),
+        identifier_table_create(),
+        arena_create(),
+        arena_pool_create()};
+    /*the root has constant members, so it cannot be assigned*/
+    memcpy(&session->root, &root, sizeof(root));
+    session->units = NULL;
+    session->unit_count = 0;
+    session->loaded_by_main = NULL;
+    session->loaded_by_main_count = 0;
+    session->has_main = false;
+    session->initial_heap_size = 0;
+}
+
+/*frees everything but the checked program*/
+static void check_session_release(check_session *const session)
+{
+    for (size_t i = 0; i < session->unit_count; ++i)
+    {
+        resident_unit_free(session->units[i]);
+    }
+    if (session->units)
+    {
+        deallocate(session->units);
+    }
+    resident_modules_free(session->loaded_by_main, session->loaded_by_main_count);
+    if (session->has_main)
+    {
+        check_checkpoint_free(session->before_main);
+        source_file_owning_free(session->main_source);
+    }
+    deallocate(session->globals);
+    program_check_free(session->root);
+    bytecode_cache_free(session->compile_time_bytecode);
+    value_stack_free(session->compile_time_stack);
+    expression_pool_free(session->pool);
+}
+
+static check_checkpoint take_checkpoint(check_session const *const session)
+{
+    checked_program const *const program = &session->program;
+    program_check const *const root = &session->root;
+    size_t *const implementation_counts = allocate_array(program->interface_count, sizeof(*implementation_counts));
+    for (interface_id i = 0; i < program->interface_count; ++i)
+    {
+        implementation_counts[i] = program->interfaces[i].implementation_count;
+    }
+    size_t *const generic_impl_counts = allocate_array(root->generic_interface_count, sizeof(*generic_impl_counts));
+    for (generic_interface_id i = 0; i < root->generic_interface_count; ++i)
+    {
+        generic_impl_counts[i] = root->generic_interfaces[i].generic_impl_count;
+    }
+    check_checkpoint const result = {program->function_count,
+                                     program->interface_count,
+                                     implementation_counts,
+                                     program->struct_count,
+                                     program->enum_count,
+                                     root->generic_enum_count,
+                                     root->enum_instantiation_count,
+                                     root->generic_interface_count,
+                                     generic_impl_counts,
+                                     root->interface_instantiation_count,
+                                     root->generic_lambda_count,
+                                     root->lambda_instantiation_count,
+                                     root->generic_struct_count,
+                                     root->struct_instantiation_count,
+                                     root->module_count,
+                                     root->generic_impls_for_regular_interfaces_count,
+                                     root->module_source_count};
+    return result;
+}
+
+static void check_main(check_session *const session, sequence const root, check_error_handler *on_error,
+                       module_loader *loader, source_file source, unicode_view const current_import_directory,
+                       void *user)
+{
+    session->root.loader = loader;
+    if (session->has_main)
+    {
+        source_file_owning_free(session->main_source);
+    }
+    session->before_main = take_checkpoint(session);
+    session->main_source = source_file_to_owning(source);
     check_function_result const checked =
-        check_function(&check_root, NULL, expression_from_sequence(root), global, on_error, user, &program, NULL, NULL,
-                       0, optional_type_create_empty(), true, optional_type_create_empty(), &source_copy,
-                       current_import_directory, NULL, optional_function_id_create(0));
-    deallocate(globals);
-    source_file_owning_free(source_copy);
+        check_function(&session->root, NULL, expression_from_sequence(root), session->root.global, on_error, user,
+                       &session->program, NULL, NULL, 0, optional_type_create_empty(), true,
+                       optional_type_create_empty(), &session->main_source, current_import_directory, NULL,
+                       optional_function_id_create(0));
+    checked_program *const program = &session->program;
+    if (session->has_main)
+    {
+        checked_function_free(&program->functions[0]);
+    }
+    session->has_main = true;
     if (checked.success)
     {
         ASSUME(checked.capture_count == 0);
-        program.functions[0] = checked.function;
+        program->functions[0] = checked.function;
+        /*the main function has no definition of its own*/
+        checked_function_set_definition(&program->functions[0], source.name, 0);
     }
     else
     {
-        function_pointer *const dummy_signature = allocate(sizeof(*dummy_signature));
-        *dummy_signature =
+        function_pointer const dummy_signature =
             function_pointer_create(optional_type_create_set(type_from_unit()), tuple_type_create(NULL, 0),
                                     tuple_type_create(NULL, 0), optional_type_create_empty());
-        program.functions[0] =
-            checked_function_create(dummy_signature, instruction_sequence_create(NULL, 0, 0), NULL, 0);
+        program->functions[0] = checked_function_create(
+            type_interner_intern(&program->types, &program->memory, type_from_function_pointer(&dummy_signature))
+                .function_pointer_,
+            instruction_sequence_create(NULL, 0, 0), NULL, 0);
+    }
+}
+
+checked_program check(sequence const root, structure const global, check_error_handler *on_error, module_loader *loader,
+                      source_file source, unicode_view const current_import_directory,
+                      execution_budget const compile_time_budget, execution_usage *compile_time_usage, void *user)
+{
+    check_session *const session = allocate(sizeof(*session));
+    check_session_initialize(session, global, compile_time_budget, compile_time_usage);
+    check_main(session, root, on_error, loader, source, current_import_directory, user);
+    checked_program const result = session->program;
+    check_session_release(session);
+    deallocate(session);
+    return result;
+}
+
+check_session *check_session_create(structure const global, execution_budget const compile_time_budget)
+{
+    check_session *const session = allocate(sizeof(*session));
+    check_session_initialize(session, global, compile_time_budget, NULL);
+    return session;
+}
+
+void check_session_free(check_session *const freed)
+{
+    check_session_release(freed);
+    if (!freed->has_main)
+    {
+        /*the place of the main function is still empty*/
+        freed->program.function_count = 0;
+    }
+    checked_program_free(&freed->program);
+    deallocate(freed);
+}
+
+/*The ids of the removed functions, types and generics are given to new ones later. The compile time calls that have
+ * been remembered can refer to removed functions, so they are forgotten altogether.*/
+static void return_to_checkpoint(check_session *const session, check_checkpoint const *const to)
+{
+    checked_program *const program = &session->program;
+    program_check *const root = &session->root;
+    for (function_id i = to->function_count; i < program->function_count; ++i)
+    {
+        checked_function_free(program->functions + i);
+    }
+    program->function_count = to->function_count;
+    bytecode_cache_truncate(&session->compile_time_bytecode, to->function_count);
+    for (interface_id i = to->interface_count; i < program->interface_count; ++i)
+    {
+        interface_free(program->interfaces[i]);
+    }
+    program->interface_count = to->interface_count;
+    for (interface_id i = 0; i < program->interface_count; ++i)
+    {
+        interface_truncate_implementations(program->interfaces + i, to->implementation_counts[i]);
+    }
+    for (struct_id i = to->struct_count; i < program->struct_count; ++i)
+    {
+        structure_free(program->structs + i);
+    }
+    program->struct_count = to->struct_count;
+    for (enum_id i = to->enum_count; i < program->enum_count; ++i)
+    {
+        enumeration_free(program->enums + i);
+    }
+    program->enum_count = to->enum_count;
+
+    for (generic_enum_id i = to->generic_enum_count; i < root->generic_enum_count; ++i)
+    {
+        generic_enum_free(root->generic_enums[i]);
+    }
+    root->generic_enum_count = to->generic_enum_count;
+    for (generic_interface_id i = to->generic_interface_count; i < root->generic_interface_count; ++i)
+    {
+        generic_interface_free(root->generic_interfaces[i]);
+    }
+    root->generic_interface_count = to->generic_interface_count;
+    for (generic_interface_id i = 0; i < root->generic_interface_count; ++i)
+    {
+        generic_interface *const interface_ = root->generic_interfaces + i;
+        for (size_t k = to->generic_impl_counts[i]; k < interface_->generic_impl_count; ++k)
+        {
+            generic_impl_free(interface_->generic_impls[k]);
+        }
+        interface_->generic_impl_count = to->generic_impl_counts[i];
+    }
+    for (generic_lambda_id i = to->generic_lambda_count; i < root->generic_lambda_count; ++i)
+    {
+        generic_lambda_free(root->generic_lambdas[i]);
+    }
+    root->generic_lambda_count = to->generic_lambda_count;
+    for (generic_struct_id i = to->generic_struct_count; i < root->generic_struct_count; ++i)
+    {
+        generic_struct_free(root->generic_structs[i]);
+    }
+    root->generic_struct_count = to->generic_struct_count;
+
+    /*the arguments of the instantiations are in the arena, so only the indices have to forget them*/
+    root->enum_instantiation_count = to->enum_instantiation_count;
+    instantiation_index_free(root->enum_instantiation_index);
+    root->enum_instantiation_index = instantiation_index_create();
+    for (size_t i = 0; i < root->enum_instantiation_count; ++i)
+    {
+        generic_enum_instantiation const *const instantiation = root->enum_instantiations + i;
+        instantiation_index_insert(&root->enum_instantiation_index, instantiation->generic, instantiation->arguments,
+                                   instantiation->argument_count, i);
+    }
+    root->interface_instantiation_count = to->interface_instantiation_count;
+    instantiation_index_free(root->interface_instantiation_index);
+    root->interface_instantiation_index = instantiation_index_create();
+    for (size_t i = 0; i < root->interface_instantiation_count; ++i)
+    {
+        generic_interface_instantiation const *const instantiation = root->interface_instantiations + i;
+        instantiation_index_insert(&root->interface_instantiation_index, instantiation->generic,
+                                   instantiation->arguments, instantiation->argument_count, i);
+    }
+    root->lambda_instantiation_count = to->lambda_instantiation_count;
+    instantiation_index_free(root->lambda_instantiation_index);
+    root->lambda_instantiation_index = instantiation_index_create();
+    for (size_t i = 0; i < root->lambda_instantiation_count; ++i)
+    {
+        generic_lambda_instantiation const *const instantiation = root->lambda_instantiations + i;
+        instantiation_index_insert(&root->lambda_instantiation_index, instantiation->generic,
+                                   instantiation->arguments, instantiation->argument_count, i);
+    }
+    root->struct_instantiation_count = to->struct_instantiation_count;
+    instantiation_index_free(root->struct_instantiation_index);
+    root->struct_instantiation_index = instantiation_index_create();
+    for (size_t i = 0; i < root->struct_instantiation_count; ++i)
+    {
+        generic_struct_instantiation const *const instantiation = root->struct_instantiations + i;
+        instantiation_index_insert(&root->struct_instantiation_index, instantiation->generic,
+                                   instantiation->arguments, instantiation->argument_count, i);
+    }
+
+    for (size_t i = to->module_count; i < root->module_count; ++i)
+    {
+        module_free(root->modules[i]);
+    }
+    root->module_count = to->module_count;
+    for (size_t i = to->generic_impls_for_regular_interfaces_count;
+         i < root->generic_impls_for_regular_interfaces_count; ++i)
+    {
+        generic_impl_regular_interface_free(root->generic_impls_for_regular_interfaces[i]);
+    }
+    root->generic_impls_for_regular_interfaces_count = to->generic_impls_for_regular_interfaces_count;
+    for (size_t i = to->module_source_count; i < root->module_source_count; ++i)
+    {
+        source_file_owning_free(*root->module_sources[i]);
+        deallocate(root->module_sources[i]);
+    }
+    root->module_source_count = to->module_source_count;
+    compile_time_call_cache_free(root->call_cache);
+    root->call_cache = compile_time_call_cache_create();
+}
+
+/*The file is read again, because the cache keeps the previous version of a file that cannot be parsed anymore.*/
+static bool has_changed(module_cache const *const cache, resident_module const *const checked)
+{
+    cached_module const *const latest = module_cache_latest(cache, unicode_view_from_string(checked->canonical_path));
+    if (!latest || (latest->content_hash != checked->content_hash) ||
+        !module_imports_equals(latest->imports, checked->imports))
+    {
+        return true;
+    }
+    blob_or_error const content = read_file_unicode_view_name(unicode_view_from_string(latest->source.name));
+    if (content.error)
+    {
+        return true;
+    }
+    uint64_t const content_hash = hash_bytes(hash_seed, content.success.data, content.success.length);
+    blob_free(&content.success);
+    return (content_hash != checked->content_hash);
+}
+
+static void add_path(identifier_table *const paths, unicode_view const canonical_path)
+{
+    identifier_id const added = identifier_table_intern(paths, canonical_path);
+    (void)added;
+}
+
+static bool is_loaded(program_check const *const root, unicode_view const canonical_path)
+{
+    for (size_t i = 0; i < root->module_count; ++i)
+    {
+        if (unicode_view_equals(unicode_view_from_string(root->modules[i].name), canonical_path))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*describes the modules that the program has loaded from the given one on*/
+static void make_resident(module_cache const *const cache, program_check const *const root, size_t const first_module,
+                          resident_module **const modules, size_t *const module_count)
+{
+    *modules = allocate_array((root->module_count - first_module), sizeof(**modules));
+    *module_count = 0;
+    for (size_t i = first_module; i < root->module_count; ++i)
+    {
+        cached_module const *const latest = module_cache_latest(cache, unicode_view_from_string(root->modules[i].name));
+        if (!latest)
+        {
+            continue;
+        }
+        resident_module *const made = (*modules) + *module_count;
+        made->canonical_path = unicode_view_copy(unicode_view_from_string(latest->canonical_path));
+        made->content_hash = latest->content_hash;
+        made->imports = module_imports_copy(latest->imports);
+        ++(*module_count);
+    }
+}
+
+static void ignore_parse_error(complete_parse_error const error, callback_user const user)
+{
+    (void)error;
+    (void)user;
+}
+
+static void remember_semantic_error(complete_semantic_error const error, void *const user)
+{
+    (void)error;
+    bool *const has_error = user;
+    *has_error = true;
+}
+
+/*Checks a module like an import would, but quietly. The main file reports the errors when it imports the module
+ * itself.*/
+static bool precheck_module(check_session *const session, cached_module const *const checked)
+{
+    module_loader *const loader = session->root.loader;
+    module_loader quiet = *loader;
+    quiet.on_parse_error = ignore_parse_error;
+    quiet.on_parse_error_user = NULL;
+    quiet.on_module_missing = NULL;
+    session->root.loader = &quiet;
+    module_file const file = module_file_create(unicode_view_copy(unicode_view_from_string(checked->source.name)),
+                                                unicode_view_copy(unicode_view_from_string(checked->canonical_path)));
+    bool has_error = false;
+    instruction_sequence ignored_instructions = instruction_sequence_create(NULL, 0, 0);
+    function_checking_state state = function_checking_state_create(
+        &session->root, NULL, false, &session->root.global, remember_semantic_error, &has_error, &session->program,
+        &ignored_instructions, optional_type_create_empty(), false, &checked->source,
+        path_remove_leaf(unicode_view_from_string(file.path)));
+    load_module_result const loaded = load_new_module(&state, file);
+    instruction_sequence_free(&ignored_instructions);
+    function_checking_state_free(state);
+    module_file_free(file);
+    session->root.loader = loader;
+    return loaded.loaded.is_set && !has_error;
+}
+
+/*the modules that are checked before the main file in this check*/
+typedef struct precheck_plan
+{
+    module_cache const *cache;
+    /*the canonical paths of the planned modules*/
+    identifier_table planned;
+    bool *is_visited;
+    bool should_stop;
+} precheck_plan;
+
+/*checks the modules that the module imports before the module itself*/
+static void precheck_in_order(check_session *const session, precheck_plan *const plan, identifier_id const planned)
+{
+    if (plan->should_stop || plan->is_visited[planned])
+    {
+        return;
     }
-    program_check_free(check_root);
-    expression_pool_free(pool);
-    return program;
+    plan->is_visited[planned] = true;
+    unicode_view const canonical_path = unicode_view_from_string(plan->planned.names[planned]);
+    cached_module const *const latest = module_cache_latest(plan->cache, canonical_path);
+    if (!latest)
+    {
+        plan->should_stop = true;
+        return;
+    }
+    for (size_t i = 0; i < latest->imports.count; ++i)
+    {
+        optional_size const imported =
+            identifier_table_find(plan->planned, unicode_view_from_string(latest->imports.elements[i]));
+        if (imported.state == optional_set)
+        {
+            precheck_in_order(session, plan, imported.value_if_set);
+        }
+    }
+    if (plan->should_stop || is_loaded(&session->root, canonical_path))
+    {
+        return;
+    }
+    resident_unit unit = {take_checkpoint(session), NULL, 0};
+    /*the imports can have been changed since the last time the cache has been filled*/
+    cached_module const *const found = module_cache_latest(plan->cache, canonical_path);
+    if (!found || !precheck_module(session, found))
+    {
+        return_to_checkpoint(session, &unit.before);
+        check_checkpoint_free(unit.before);
+        plan->should_stop = true;
+        return;
+    }
+    make_resident(plan->cache, &session->root, unit.before.module_count, &unit.modules, &unit.module_count);
+    session->units = reallocate_array(session->units, (session->unit_count + 1), sizeof(*session->units));
+    session->units[session->unit_count] = unit;
+    ++(session->unit_count);
+}
+
+typedef struct resident_candidate
+{
+    resident_module const *module;
+    /*unit_count for the modules that the main file has loaded itself*/
+    size_t unit;
+    bool is_dirty;
+} resident_candidate;
+
+/*Keeps the modules that do not depend on a changed file and checks the others again in the order of their imports.
+ * The clean modules are checked first, so the modules that change often end up behind the others.*/
+static void check_modules_again(check_session *const session, module_cache const *const cache,
+                                module_imports const main_imports)
+{
+    /*the modules that the main file still imports directly or indirectly*/
+    identifier_table reachable = identifier_table_create();
+    for (size_t i = 0; i < main_imports.count; ++i)
+    {
+        add_path(&reachable, unicode_view_from_string(main_imports.elements[i]));
+    }
+    for (size_t i = 0; i < reachable.count; ++i)
+    {
+        cached_module const *const latest = module_cache_latest(cache, unicode_view_from_string(reachable.names[i]));
+        if (!latest)
+        {
+            continue;
+        }
+        for (size_t k = 0; k < latest->imports.count; ++k)
+        {
+            add_path(&reachable, unicode_view_from_string(latest->imports.elements[k]));
+        }
+    }
+
+    size_t candidate_count = session->loaded_by_main_count;
+    for (size_t i = 0; i < session->unit_count; ++i)
+    {
+        candidate_count += session->units[i].module_count;
+    }
+    resident_candidate *const candidates = allocate_array(candidate_count, sizeof(*candidates));
+    identifier_table dirty = identifier_table_create();
+    {
+        size_t next = 0;
+        for (size_t i = 0; i <= session->unit_count; ++i)
+        {
+            resident_module const *const modules =
+                (i < session->unit_count) ? session->units[i].modules : session->loaded_by_main;
+            size_t const module_count =
+                (i < session->unit_count) ? session->units[i].module_count : session->loaded_by_main_count;
+            for (size_t k = 0; k < module_count; ++k)
+            {
+                resident_module const *const resident = modules + k;
+                bool const is_dirty =
+                    (identifier_table_find(reachable, unicode_view_from_string(resident->canonical_path)).state ==
+                     optional_empty) ||
+                    has_changed(cache, resident);
+                if (is_dirty)
+                {
+                    add_path(&dirty, unicode_view_from_string(resident->canonical_path));
+                }
+                resident_candidate const candidate = {resident, i, is_dirty};
+                candidates[next] = candidate;
+                ++next;
+            }
+        }
+    }
+    /*a module that imports a dirty module is dirty, too*/
+    for (bool has_spread = true; has_spread;)
+    {
+        has_spread = false;
+        for (size_t i = 0; i < candidate_count; ++i)
+        {
+            resident_candidate *const candidate = candidates + i;
+            if (candidate->is_dirty)
+            {
+                continue;
+            }
+            module_imports const imports = candidate->module->imports;
+            for (size_t k = 0; k < imports.count; ++k)
+            {
+                if (identifier_table_find(dirty, unicode_view_from_string(imports.elements[k])).state == optional_set)
+                {
+                    candidate->is_dirty = true;
+                    add_path(&dirty, unicode_view_from_string(candidate->module->canonical_path));
+                    has_spread = true;
+                    break;
+                }
+            }
+        }
+    }
+    size_t first_dirty_unit = session->unit_count;
+    for (size_t i = 0; i < candidate_count; ++i)
+    {
+        if (candidates[i].is_dirty && (candidates[i].unit < first_dirty_unit))
+        {
+            first_dirty_unit = candidates[i].unit;
+        }
+    }
+
+    precheck_plan plan = {cache, identifier_table_create(), NULL, false};
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        bool const is_dirty_pass = (pass == 1);
+        for (size_t i = 0; i < candidate_count; ++i)
+        {
+            resident_candidate const candidate = candidates[i];
+            unicode_view const canonical_path = unicode_view_from_string(candidate.module->canonical_path);
+            if ((candidate.unit >= first_dirty_unit) && (candidate.is_dirty == is_dirty_pass) &&
+                (identifier_table_find(reachable, canonical_path).state == optional_set))
+            {
+                add_path(&plan.planned, canonical_path);
+            }
+        }
+    }
+
+    /*the candidates refer to the modules of the units that are removed now*/
+    resident_unit *const removed_units = session->units + first_dirty_unit;
+    size_t const removed_unit_count = (session->unit_count - first_dirty_unit);
+    resident_module *const loaded_by_main = session->loaded_by_main;
+    size_t const loaded_by_main_count = session->loaded_by_main_count;
+    if (first_dirty_unit < session->unit_count)
+    {
+        return_to_checkpoint(session, &session->units[first_dirty_unit].before);
+    }
+    resident_unit *const kept_units = allocate_array(first_dirty_unit, sizeof(*kept_units));
+    if (first_dirty_unit > 0)
+    {
+        memcpy(kept_units, session->units, (first_dirty_unit * sizeof(*kept_units)));
+    }
+    resident_unit *const old_units = session->units;
+    session->units = kept_units;
+    session->unit_count = first_dirty_unit;
+    session->loaded_by_main = NULL;
+    session->loaded_by_main_count = 0;
+
+    plan.is_visited = allocate_array(plan.planned.count, sizeof(*plan.is_visited));
+    for (size_t i = 0; i < plan.planned.count; ++i)
+    {
+        plan.is_visited[i] = false;
+    }
+    for (identifier_id i = 0; i < plan.planned.count; ++i)
+    {
+        precheck_in_order(session, &plan, i);
+    }
+
+    deallocate(plan.is_visited);
+    identifier_table_free(plan.planned);
+    for (size_t i = 0; i < removed_unit_count; ++i)
+    {
+        resident_unit_free(removed_units[i]);
+    }
+    if (old_units)
+    {
+        deallocate(old_units);
+    }
+    resident_modules_free(loaded_by_main, loaded_by_main_count);
+    deallocate(candidates);
+    identifier_table_free(dirty);
+    identifier_table_free(reachable);
+}
+
+checked_program const *check_session_check(check_session *const session, sequence const root,
+                                           check_error_handler *on_error, module_loader *loader, source_file source,
+                                           unicode_view const current_import_directory,
+                                           execution_usage *compile_time_usage, void *user)
+{
+    ASSUME(loader->cache);
+    if (session->has_main && (session->program.memory.current_heap_size > (4 * session->initial_heap_size)))
+    {
+        structure const global = session->global;
+        execution_budget const compile_time_budget = session->compile_time_budget;
+        check_session_release(session);
+        checked_program_free(&session->program);
+        check_session_initialize(session, global, compile_time_budget, NULL);
+    }
+    interpreter_renew_budget(&session->root.compile_time_interpreter,
+                             compile_time_usage ? compile_time_usage : &session->ignored_usage);
+    /*every check may use the whole heap of the budget in addition to what the previous checks have left*/
+    garbage_collector *const memory = &session->program.memory;
+    size_t const budget = session->compile_time_budget.max_heap_size;
+    memory->max_heap_size =
+        (budget < (SIZE_MAX - memory->current_heap_size)) ? (memory->current_heap_size + budget) : SIZE_MAX;
+    bool const is_first = !session->has_main;
+    if (!is_first)
+    {
+        return_to_checkpoint(session, &session->before_main);
+        check_checkpoint_free(session->before_main);
+        session->root.loader = loader;
+        module_imports const main_imports = find_imports(loader, root, current_import_directory);
+        check_modules_again(session, loader->cache, main_imports);
+        module_imports_free(main_imports);
+    }
+    check_main(session, root, on_error, loader, source, current_import_directory, user);
+    make_resident(loader->cache, &session->root, session->before_main.module_count, &session->loaded_by_main,
+                  &session->loaded_by_main_count);
+    if (is_first)
+    {
+        session->initial_heap_size = memory->current_heap_size;
+    }
+    return &session->program;
 }
@@ -28,6 +28,30 @@ check_function(program_check *const root, function_checking_state *const parent,
                unicode_view const current_import_directory, unicode_view const *const early_initialized_variable,
                optional_function_id const current_function_id);
 
+/*the limits for compile time evaluation that check used before they became configurable*/
+execution_budget default_compile_time_budget(size_t const max_compile_time_heap) LPG_USE_RESULT;
+
+/*compile_time_usage may be NULL. Otherwise it receives the resources used by compile time evaluation.*/
 checked_program check(sequence const root, structure const global, LPG_NON_NULL(check_error_handler *on_error),
                       LPG_NON_NULL(module_loader *loader), source_file source,
-                      unicode_view const current_import_directory, size_t const max_compile_time_heap, void *user);
+                      unicode_view const current_import_directory, execution_budget const compile_time_budget,
+                      execution_usage *compile_time_usage, void *user);
+
+/*Keeps a checked program and the state of its checker between the checks of the same main file. A module that has been
+ * checked stays in the program as long as neither its file nor the modules that it imports have changed, so only the
+ * changed modules and the modules that import them are checked again.*/
+typedef struct check_session check_session;
+
+/*The global structure has to outlive the session.*/
+check_session *check_session_create(structure const global, execution_budget const compile_time_budget) LPG_USE_RESULT;
+void check_session_free(LPG_NON_NULL(check_session *const freed));
+
+/*Checks the main file again after the modules that have to be checked again. Each check may use the whole compile
+ * time budget. The loader needs a cache that prefetch_modules has filled for the main file, because the imports of the
+ * cached modules tell which modules depend on a changed file. The program belongs to the session and is only valid
+ * until the next check.*/
+checked_program const *check_session_check(LPG_NON_NULL(check_session *const session), sequence const root,
+                                           LPG_NON_NULL(check_error_handler *on_error),
+                                           LPG_NON_NULL(module_loader *loader), source_file source,
+                                           unicode_view const current_import_directory,
+                                           execution_usage *compile_time_usage, void *user) LPG_USE_RESULT;
@@ -0,0 +1,211 @@
+#include "lpg_compile_time_call_cache.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_hash.h"
+
+compile_time_call_cache compile_time_call_cache_create(void)
+{
+    compile_time_call_cache const result = {NULL, 0, 0};
+    return result;
+}
+
+void compile_time_call_cache_free(compile_time_call_cache const freed)
+{
+    for (size_t i = 0; i < freed.capacity; ++i)
+    {
+        if (freed.entries[i].arguments)
+        {
+            deallocate(freed.entries[i].arguments);
+        }
+    }
+    if (freed.entries)
+    {
+        deallocate(freed.entries);
+    }
+}
+
+/*value_equals is not implemented for some kinds yet and arrays can change*/
+static bool is_memoizable_value(value const checked)
+{
+    switch (checked.kind)
+    {
+    case value_kind_integer:
+    case value_kind_string:
+    case value_kind_type:
+    case value_kind_unit:
+    case value_kind_generic_enum:
+    case value_kind_generic_lambda:
+        return true;
+
+    case value_kind_enum_element:
+        return !checked.enum_state || is_memoizable_value(*checked.enum_state);
+
+    case value_kind_tuple:
+        for (size_t i = 0; i < checked.count; ++i)
+        {
+            if (!is_memoizable_value(checked.tuple_elements[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+
+    case value_kind_function_pointer:
+    {
+        function_pointer_value const function = value_as_function_pointer(checked);
+        for (size_t i = 0; i < function.capture_count; ++i)
+        {
+            if (!is_memoizable_value(function.captures[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    case value_kind_structure:
+    case value_kind_type_erased:
+    case value_kind_pattern:
+    case value_kind_generic_interface:
+    case value_kind_generic_struct:
+    case value_kind_enum_constructor:
+    case value_kind_array:
+        return false;
+    }
+    LPG_UNREACHABLE();
+}
+
+static bool are_memoizable_values(value const *const checked, size_t const count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!is_memoizable_value(checked[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool compile_time_call_is_memoizable(function_pointer_value const callee, value const *const arguments,
+                                     size_t const argument_count)
+{
+    /*external functions are cheap and may depend on their environment*/
+    return !callee.external && are_memoizable_values(callee.captures, callee.capture_count) &&
+           are_memoizable_values(arguments, argument_count);
+}
+
+bool compile_time_call_result_is_memoizable(value const result)
+{
+    return is_memoizable_value(result);
+}
+
+static uint64_t hash_call(function_pointer_value const callee, value const *const arguments,
+                          size_t const argument_count)
+{
+    uint64_t result = hash_bytes(hash_seed, (char const *)&callee.code, sizeof(callee.code));
+    for (size_t i = 0; i < callee.capture_count; ++i)
+    {
+        result = value_hash(result, callee.captures[i]);
+    }
+    for (size_t i = 0; i < argument_count; ++i)
+    {
+        result = value_hash(result, arguments[i]);
+    }
+    return result;
+}
+
+static bool values_equal(value const *const first, value const *const second, size_t const count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!value_equals(first[i], second[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_same_call(memoized_call const entry, uint64_t const hash, function_pointer_value const callee,
+                         value const *const arguments, size_t const argument_count)
+{
+    return (entry.hash == hash) && (entry.callee == callee.code) && (entry.capture_count == callee.capture_count) &&
+           (entry.argument_count == argument_count) &&
+           values_equal(entry.captures, callee.captures, callee.capture_count) &&
+           values_equal(entry.arguments, arguments, argument_count);
+}
+
+optional_value compile_time_call_cache_find(compile_time_call_cache const cache, function_pointer_value const callee,
+                                            value const *const arguments, size_t const argument_count)
+{
+    if (cache.count == 0)
+    {
+        return optional_value_empty;
+    }
+    uint64_t const hash = hash_call(callee, arguments, argument_count);
+    size_t index = (size_t)(hash & (cache.capacity - 1u));
+    while (cache.entries[index].arguments)
+    {
+        if (is_same_call(cache.entries[index], hash, callee, arguments, argument_count))
+        {
+            return optional_value_create(cache.entries[index].result);
+        }
+        index = ((index + 1) & (cache.capacity - 1u));
+    }
+    return optional_value_empty;
+}
+
+static void insert_entry(compile_time_call_cache *const cache, memoized_call const inserted)
+{
+    size_t index = (size_t)(inserted.hash & (cache->capacity - 1u));
+    while (cache->entries[index].arguments)
+    {
+        index = ((index + 1) & (cache->capacity - 1u));
+    }
+    cache->entries[index] = inserted;
+    ++(cache->count);
+}
+
+static void reserve(compile_time_call_cache *const cache, size_t const count)
+{
+    if ((count * 2) <= cache->capacity)
+    {
+        return;
+    }
+    compile_time_call_cache const old = *cache;
+    cache->capacity = ((old.capacity == 0) ? 64 : (old.capacity * 2));
+    cache->entries = allocate_array(cache->capacity, sizeof(*cache->entries));
+    cache->count = 0;
+    for (size_t i = 0; i < old.capacity; ++i)
+    {
+        if (old.entries[i].arguments)
+        {
+            insert_entry(cache, old.entries[i]);
+        }
+    }
+    if (old.entries)
+    {
+        deallocate(old.entries);
+    }
+}
+
+void compile_time_call_cache_insert(compile_time_call_cache *const cache, function_pointer_value const callee,
+                                    value const *const arguments, size_t const argument_count, value const result)
+{
+    reserve(cache, (cache->count + 1));
+    /*always allocated so that a call without arguments can be told apart from an unused entry*/
+    value *const copied_arguments = allocate_array((argument_count + 1), sizeof(*copied_arguments));
+    for (size_t i = 0; i < argument_count; ++i)
+    {
+        copied_arguments[i] = arguments[i];
+    }
+    memoized_call const inserted = {hash_call(callee, arguments, argument_count),
+                                    callee.code,
+                                    callee.captures,
+                                    callee.capture_count,
+                                    copied_arguments,
+                                    argument_count,
+                                    result};
+    insert_entry(cache, inserted);
+}
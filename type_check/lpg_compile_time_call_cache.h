@@ -0,0 +1,39 @@
+#pragma once
+#include "lpg_value.h"
+
+/*the result of a call that compile time evaluation has already executed*/
+typedef struct memoized_call
+{
+    uint64_t hash;
+    function_id callee;
+    /*owned by the memory of the checked program just like the captures of the callee*/
+    value const *captures;
+    size_t capture_count;
+    value *arguments;
+    size_t argument_count;
+    value result;
+} memoized_call;
+
+/*Compile time evaluation cannot observe side effects, so a call of an internal function with the same captures and
+ * arguments always has the same result. The cache is an open addressing hash table of the successful calls whose
+ * arguments and results cannot be modified later.*/
+typedef struct compile_time_call_cache
+{
+    /*an entry is unused if its arguments are NULL*/
+    memoized_call *entries;
+    size_t capacity;
+    size_t count;
+} compile_time_call_cache;
+
+compile_time_call_cache compile_time_call_cache_create(void) LPG_USE_RESULT;
+void compile_time_call_cache_free(compile_time_call_cache const freed);
+/*whether a call can be cached at all*/
+bool compile_time_call_is_memoizable(function_pointer_value const callee, value const *const arguments,
+                                     size_t const argument_count) LPG_USE_RESULT;
+/*whether the result of a call can be shared by every caller*/
+bool compile_time_call_result_is_memoizable(value const result) LPG_USE_RESULT;
+optional_value compile_time_call_cache_find(compile_time_call_cache const cache, function_pointer_value const callee,
+                                            value const *const arguments, size_t const argument_count) LPG_USE_RESULT;
+void compile_time_call_cache_insert(LPG_NON_NULL(compile_time_call_cache *const cache),
+                                    function_pointer_value const callee, value const *const arguments,
+                                    size_t const argument_count, value const result);
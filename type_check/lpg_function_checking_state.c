@@ -1,13 +1,9 @@
 #include "lpg_function_checking_state.h"
-#include "lpg_allocate.h"
 
 void function_checking_state_free(function_checking_state const freed)
 {
     local_variable_container_free(freed.local_variables);
-    if (freed.register_compile_time_values)
-    {
-        deallocate(freed.register_compile_time_values);
-    }
+    arena_pool_give_back(&freed.root->function_memory, freed.memory);
 }
 
 optional_value read_register_compile_time_value(function_checking_state const *const state, register_id const which)
@@ -30,8 +26,8 @@ void write_register_compile_time_value(function_checking_state *const state, reg
     }
     ASSUME(which != ~(register_id)0);
     ASSUME(state->register_compile_time_values || (state->register_compile_time_value_count == 0));
-    state->register_compile_time_values = reallocate_array_exponentially(
-        state->register_compile_time_values, (which + 1), sizeof(*state->register_compile_time_values),
+    state->register_compile_time_values = arena_reallocate_array_exponentially(
+        state->memory, state->register_compile_time_values, (which + 1), sizeof(*state->register_compile_time_values),
         state->register_compile_time_value_count, &state->register_compile_time_value_capacity);
     ASSUME(state->register_compile_time_values);
     for (register_id i = state->register_compile_time_value_count; i < which; ++i)
@@ -27,6 +27,7 @@ typedef struct function_checking_state
     structure const *global;
     check_error_handler *on_error;
     local_variable_container local_variables;
+    outer_variable_cache outer_variables;
     void *user;
     checked_program *program;
     instruction_sequence *body;
@@ -37,6 +38,8 @@ typedef struct function_checking_state
     size_t register_compile_time_value_capacity;
     source_file_owning const *source;
     unicode_view current_import_directory;
+    /*the data that is only needed until the function has been checked, taken from the pool of the root*/
+    arena *memory;
 } function_checking_state;
 
 void function_checking_state_free(function_checking_state const freed);
@@ -1,6 +1,7 @@
 #pragma once
 #include "lpg_value.h"
 
+/*The arguments are allocated from the memory of the program_check.*/
 typedef struct generic_enum_instantiation
 {
     generic_enum_id generic;
@@ -13,4 +14,3 @@ typedef struct generic_enum_instantiation
 generic_enum_instantiation generic_enum_instantiation_create(generic_enum_id generic, type *argument_types,
                                                              value *arguments, size_t argument_count,
                                                              enum_id instantiated);
-void generic_enum_instantiation_free(generic_enum_instantiation const freed);
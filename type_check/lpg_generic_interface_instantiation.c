@@ -1,5 +1,4 @@
 #include "lpg_generic_interface_instantiation.h"
-#include "lpg_allocate.h"
 
 generic_interface_instantiation generic_interface_instantiation_create(generic_interface_id generic,
                                                                        type *argument_types, value *arguments,
@@ -8,9 +7,3 @@ generic_interface_instantiation generic_interface_instantiation_create(generic_i
     generic_interface_instantiation const result = {generic, argument_types, arguments, argument_count, instantiated};
     return result;
 }
-
-void generic_interface_instantiation_free(generic_interface_instantiation const freed)
-{
-    deallocate(freed.argument_types);
-    deallocate(freed.arguments);
-}
@@ -1,6 +1,7 @@
 #pragma once
 #include "lpg_value.h"
 
+/*The arguments are allocated from the memory of the program_check.*/
 typedef struct generic_interface_instantiation
 {
     generic_interface_id generic;
@@ -14,4 +15,3 @@ generic_interface_instantiation generic_interface_instantiation_create(generic_i
                                                                        type *argument_types, value *arguments,
                                                                        size_t argument_count,
                                                                        interface_id instantiated);
-void generic_interface_instantiation_free(generic_interface_instantiation const freed);
@@ -1,6 +1,7 @@
 #pragma once
 #include "lpg_value.h"
 
+/*The arguments are allocated from the memory of the program_check.*/
 typedef struct generic_lambda_instantiation
 {
     generic_lambda_id generic;
@@ -11,4 +12,3 @@ typedef struct generic_lambda_instantiation
 
 generic_lambda_instantiation generic_lambda_instantiation_create(generic_lambda_id generic, value *arguments,
                                                                  size_t argument_count, function_id instantiated);
-void generic_lambda_instantiation_free(generic_lambda_instantiation const freed);
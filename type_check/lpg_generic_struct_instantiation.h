@@ -1,6 +1,7 @@
 #pragma once
 #include "lpg_value.h"
 
+/*The arguments are allocated from the memory of the program_check.*/
 typedef struct generic_struct_instantiation
 {
     generic_struct_id generic;
@@ -13,4 +14,3 @@ typedef struct generic_struct_instantiation
 generic_struct_instantiation generic_struct_instantiation_create(generic_struct_id generic, value *arguments,
                                                                  size_t argument_count, struct_id instantiated,
                                                                  type *argument_types);
-void generic_struct_instantiation_free(generic_struct_instantiation const freed);
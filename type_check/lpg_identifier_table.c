@@ -0,0 +1,112 @@
+#include "lpg_identifier_table.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_hash.h"
+
+identifier_table identifier_table_create(void)
+{
+    identifier_table const result = {NULL, 0, 0, NULL, 0};
+    return result;
+}
+
+void identifier_table_free(identifier_table const freed)
+{
+    for (size_t i = 0; i < freed.count; ++i)
+    {
+        unicode_string_free(freed.names + i);
+    }
+    if (freed.names)
+    {
+        deallocate(freed.names);
+    }
+    if (freed.slots)
+    {
+        deallocate(freed.slots);
+    }
+}
+
+static uint64_t hash_name(unicode_view const name)
+{
+    return hash_bytes(hash_seed, name.begin, name.length);
+}
+
+static size_t find_slot(identifier_table const table, uint64_t const hash, unicode_view const name)
+{
+    size_t position = (size_t)(hash & (table.slot_capacity - 1u));
+    for (;;)
+    {
+        identifier_slot const slot = table.slots[position];
+        if (!slot.identifier)
+        {
+            return position;
+        }
+        if ((slot.hash == hash) &&
+            unicode_view_equals(unicode_view_from_string(table.names[slot.identifier - 1]), name))
+        {
+            return position;
+        }
+        position = ((position + 1) & (table.slot_capacity - 1u));
+    }
+}
+
+static void reserve(identifier_table *const table, size_t const count)
+{
+    if ((count * 2) <= table->slot_capacity)
+    {
+        return;
+    }
+    identifier_slot *const old_slots = table->slots;
+    size_t const old_capacity = table->slot_capacity;
+    table->slot_capacity = ((old_capacity == 0) ? 64 : (old_capacity * 2));
+    table->slots = allocate_array(table->slot_capacity, sizeof(*table->slots));
+    for (size_t i = 0; i < old_capacity; ++i)
+    {
+        if (!old_slots[i].identifier)
+        {
+            continue;
+        }
+        size_t position = (size_t)(old_slots[i].hash & (table->slot_capacity - 1u));
+        while (table->slots[position].identifier)
+        {
+            position = ((position + 1) & (table->slot_capacity - 1u));
+        }
+        table->slots[position] = old_slots[i];
+    }
+    if (old_slots)
+    {
+        deallocate(old_slots);
+    }
+}
+
+identifier_id identifier_table_intern(identifier_table *const table, unicode_view const name)
+{
+    reserve(table, (table->count + 1));
+    uint64_t const hash = hash_name(name);
+    size_t const position = find_slot(*table, hash, name);
+    if (table->slots[position].identifier)
+    {
+        return (table->slots[position].identifier - 1);
+    }
+    identifier_id const interned = table->count;
+    table->names =
+        reallocate_array_exponentially(table->names, (interned + 1), sizeof(*table->names), interned, &table->capacity);
+    table->names[interned] = unicode_view_copy(name);
+    table->count += 1;
+    identifier_slot const inserted = {hash, (interned + 1)};
+    table->slots[position] = inserted;
+    return interned;
+}
+
+optional_size identifier_table_find(identifier_table const table, unicode_view const name)
+{
+    if (table.count == 0)
+    {
+        return optional_size_empty;
+    }
+    identifier_slot const found = table.slots[find_slot(table, hash_name(name), name)];
+    if (!found.identifier)
+    {
+        return optional_size_empty;
+    }
+    return make_optional_size(found.identifier - 1);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "lpg_arithmetic.h"
+#include "lpg_unicode_string.h"
+#include "lpg_unicode_view.h"
+#include <stdint.h>
+
+/*the same number for every occurrence of a name in a program, so names can be compared as integers*/
+typedef size_t identifier_id;
+
+typedef struct identifier_slot
+{
+    uint64_t hash;
+    /*0 if the slot is unused, otherwise the identifier plus one*/
+    size_t identifier;
+} identifier_slot;
+
+/*Interns the names of the local variables of a program. The table owns a copy of every name.*/
+typedef struct identifier_table
+{
+    unicode_string *names;
+    size_t count;
+    size_t capacity;
+    identifier_slot *slots;
+    size_t slot_capacity;
+} identifier_table;
+
+identifier_table identifier_table_create(void) LPG_USE_RESULT;
+void identifier_table_free(identifier_table const freed);
+identifier_id identifier_table_intern(LPG_NON_NULL(identifier_table *const table), unicode_view const name)
+    LPG_USE_RESULT;
+/*A name that has never been interned cannot be the name of any local variable.*/
+optional_size identifier_table_find(identifier_table const table, unicode_view const name) LPG_USE_RESULT;
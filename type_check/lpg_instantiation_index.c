@@ -0,0 +1,108 @@
+#include "lpg_instantiation_index.h"
+#include "lpg_allocate.h"
+#include "lpg_hash.h"
+
+instantiation_index instantiation_index_create(void)
+{
+    instantiation_index const result = {NULL, 0, 0};
+    return result;
+}
+
+void instantiation_index_free(instantiation_index const freed)
+{
+    if (freed.entries)
+    {
+        deallocate(freed.entries);
+    }
+}
+
+static uint64_t hash_instantiation(size_t const generic, value const *const arguments, size_t const argument_count)
+{
+    uint64_t result = hash_bytes(hash_seed, (char const *)&generic, sizeof(generic));
+    for (size_t i = 0; i < argument_count; ++i)
+    {
+        result = value_hash(result, arguments[i]);
+    }
+    return result;
+}
+
+static bool is_same_instantiation(indexed_instantiation const entry, uint64_t const hash, size_t const generic,
+                                  value const *const arguments, size_t const argument_count)
+{
+    if ((entry.hash != hash) || (entry.generic != generic) || (entry.argument_count != argument_count))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < argument_count; ++i)
+    {
+        if (!value_equals(entry.arguments[i], arguments[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+optional_size instantiation_index_find(instantiation_index const index, size_t const generic,
+                                       value const *const arguments, size_t const argument_count)
+{
+    if (index.count == 0)
+    {
+        return optional_size_empty;
+    }
+    uint64_t const hash = hash_instantiation(generic, arguments, argument_count);
+    size_t position = (size_t)(hash & (index.capacity - 1u));
+    while (index.entries[position].is_used)
+    {
+        if (is_same_instantiation(index.entries[position], hash, generic, arguments, argument_count))
+        {
+            return make_optional_size(index.entries[position].instantiation);
+        }
+        position = ((position + 1) & (index.capacity - 1u));
+    }
+    return optional_size_empty;
+}
+
+static void insert_entry(instantiation_index *const index, indexed_instantiation const inserted)
+{
+    size_t position = (size_t)(inserted.hash & (index->capacity - 1u));
+    while (index->entries[position].is_used)
+    {
+        position = ((position + 1) & (index->capacity - 1u));
+    }
+    index->entries[position] = inserted;
+    ++(index->count);
+}
+
+static void reserve(instantiation_index *const index, size_t const count)
+{
+    if ((count * 2) <= index->capacity)
+    {
+        return;
+    }
+    instantiation_index const old = *index;
+    index->capacity = ((old.capacity == 0) ? 64 : (old.capacity * 2));
+    index->entries = allocate_array(index->capacity, sizeof(*index->entries));
+    index->count = 0;
+    for (size_t i = 0; i < old.capacity; ++i)
+    {
+        if (old.entries[i].is_used)
+        {
+            insert_entry(index, old.entries[i]);
+        }
+    }
+    if (old.entries)
+    {
+        deallocate(old.entries);
+    }
+}
+
+void instantiation_index_insert(instantiation_index *const index, size_t const generic, value const *const arguments,
+                                size_t const argument_count, size_t const instantiation)
+{
+    reserve(index, (index->count + 1));
+    indexed_instantiation const inserted = {
+        hash_instantiation(generic, arguments, argument_count), generic, arguments, argument_count, instantiation,
+        true};
+    insert_entry(index, inserted);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "lpg_arithmetic.h"
+#include "lpg_value.h"
+
+typedef struct indexed_instantiation
+{
+    uint64_t hash;
+    size_t generic;
+    /*owned by the instantiation which is never removed*/
+    value const *arguments;
+    size_t argument_count;
+    /*the position of the instantiation in its array in program_check*/
+    size_t instantiation;
+    bool is_used;
+} indexed_instantiation;
+
+/*Finds the instantiation of a generic for the given arguments without comparing them to the arguments of every
+ * previous instantiation. It is an open addressing hash table keyed by the id of the generic and the hashes of the
+ * arguments.*/
+typedef struct instantiation_index
+{
+    indexed_instantiation *entries;
+    size_t capacity;
+    size_t count;
+} instantiation_index;
+
+instantiation_index instantiation_index_create(void) LPG_USE_RESULT;
+void instantiation_index_free(instantiation_index const freed);
+optional_size instantiation_index_find(instantiation_index const index, size_t const generic,
+                                       value const *const arguments, size_t const argument_count) LPG_USE_RESULT;
+/*The arguments are not copied, so they have to outlive the index.*/
+void instantiation_index_insert(LPG_NON_NULL(instantiation_index *const index), size_t const generic,
+                                value const *const arguments, size_t const argument_count,
+                                size_t const instantiation);
@@ -3,6 +3,7 @@
 #include "lpg_array_size.h"
 #include "lpg_check.h"
 #include "lpg_find_next_token.h"
+#include "lpg_hash.h"
 #include "lpg_interpret.h"
 #include "lpg_parse_expression.h"
 #include "lpg_path.h"
@@ -24,7 +25,7 @@ bool complete_parse_error_equals(complete_parse_error const left, complete_parse
 module_loader module_loader_create(unicode_view module_directory, complete_parse_error_handler on_parse_error,
                                    callback_user on_parse_error_user)
 {
-    module_loader result = {module_directory, on_parse_error, on_parse_error_user};
+    module_loader result = {module_directory, on_parse_error, on_parse_error_user, NULL, NULL, NULL, NULL, NULL};
     return result;
 }
 
@@ -99,6 +100,7 @@ static load_module_result type_check_module(function_checking_state *const state
     case external_function_result_out_of_memory:
     case external_function_result_stack_overflow:
     case external_function_result_instruction_limit_reached:
+    case external_function_result_deadline_reached:
         LPG_TO_DO();
 
     case external_function_result_success:
@@ -123,82 +125,122 @@ static load_module_result type_check_module(function_checking_state *const state
     LPG_UNREACHABLE();
 }
 
-typedef struct import_attempt_result
+module_file module_file_create(unicode_string path, unicode_string canonical_path)
 {
-    blob_or_error module_source;
-    unicode_string full_module_path;
-} import_attempt_result;
+    module_file const result = {path, canonical_path};
+    return result;
+}
 
-static void import_attempt_result_free(import_attempt_result const freed)
+void module_file_free(module_file const freed)
 {
-    unicode_string_free(&freed.full_module_path);
-    if (!freed.module_source.error)
-    {
-        blob_free(&freed.module_source.success);
-    }
+    unicode_string_free(&freed.path);
+    unicode_string_free(&freed.canonical_path);
 }
 
-static import_attempt_result try_load(unicode_view const module_directory, unicode_view name)
+static bool try_find(module_loader const *const loader, unicode_view const module_directory, unicode_view name,
+                     module_file *const found)
 {
     unicode_string const file_name = unicode_view_concat(name, unicode_view_from_c_str(".lpg"));
     unicode_view const pieces[] = {module_directory, unicode_view_from_string(file_name)};
     unicode_string const full_module_path = path_combine(pieces, LPG_ARRAY_SIZE(pieces));
     unicode_string_free(&file_name);
-    blob_or_error module_source = read_file_unicode_view_name(unicode_view_from_string(full_module_path));
-    import_attempt_result const result = {module_source, full_module_path};
-    return result;
-}
-
-load_module_result load_module(function_checking_state *const state, unicode_view const name)
-{
-    module_loader *const loader = state->root->loader;
-    import_attempt_result attempt = try_load(loader->module_directory, name);
-    if (attempt.module_source.error)
+    if (!file_exists(unicode_view_from_string(full_module_path)))
     {
-        import_attempt_result_free(attempt);
-        attempt = try_load(state->current_import_directory, name);
-        if (attempt.module_source.error)
+        if (loader->on_module_missing)
         {
-            import_attempt_result_free(attempt);
-            load_module_result const failure = {optional_value_empty, type_from_unit()};
-            return failure;
+            loader->on_module_missing(unicode_view_from_string(full_module_path), loader->on_module_missing_user);
         }
+        unicode_string_free(&full_module_path);
+        return false;
     }
-    attempt.module_source.success.length =
-        remove_carriage_returns(attempt.module_source.success.data, attempt.module_source.success.length);
+    *found = module_file_create(full_module_path, path_canonicalize(unicode_view_from_string(full_module_path)));
+    return true;
+}
+
+bool find_module_file(module_loader const *const loader, unicode_view const current_import_directory,
+                      unicode_view const name, module_file *const found)
+{
+    return try_find(loader, loader->module_directory, name, found) ||
+           try_find(loader, current_import_directory, name, found);
+}
+
+bool parse_module_file(unicode_view const path, blob content, complete_parse_error_handler *const on_error,
+                       callback_user const on_error_user, parsed_module_file *const parsed)
+{
+    content.length = remove_carriage_returns(content.data, content.length);
     /*TODO: check whether source is UTF-8*/
-    parser_user parser_state = {
-        attempt.module_source.success.data, attempt.module_source.success.length, source_location_create(0, 0)};
-    unicode_string const source_loaded = unicode_string_validate(attempt.module_source.success);
+    parser_user parser_state = {content.data, content.length, source_location_create(0, 0)};
+    unicode_string const source_loaded = unicode_string_validate(content);
     source_file_lines_owning const lines = source_file_lines_owning_scan(unicode_view_from_string(source_loaded));
-    parse_error_translator translator = parse_error_translator_create(
-        loader->on_parse_error, loader->on_parse_error_user, unicode_view_from_string(attempt.full_module_path),
-        unicode_view_create(attempt.module_source.success.data, attempt.module_source.success.length),
-        source_file_lines_from_owning(lines), false);
+    parse_error_translator translator =
+        parse_error_translator_create(on_error, on_error_user, path, unicode_view_from_string(source_loaded),
+                                      source_file_lines_from_owning(lines), false);
     expression_pool pool = expression_pool_create();
     expression_parser parser = expression_parser_create(&parser_state, translate_parse_error, &translator, &pool);
-    sequence const parsed = parse_program(&parser);
+    sequence const sequence_parsed = parse_program(&parser);
     expression_parser_free(parser);
     if (translator.has_error)
     {
-        sequence_free(&parsed);
+        sequence_free(&sequence_parsed);
         expression_pool_free(pool);
-        import_attempt_result_free(attempt);
+        unicode_string_free(&source_loaded);
         source_file_lines_owning_free(lines);
+        return false;
+    }
+    parsed->source = source_file_owning_create(unicode_view_copy(path), source_loaded, lines);
+    parsed->pool = pool;
+    parsed->parsed = sequence_parsed;
+    return true;
+}
+
+load_module_result load_module(function_checking_state *const state, module_file const file)
+{
+    module_loader *const loader = state->root->loader;
+    blob_or_error const content = read_file_unicode_view_name(unicode_view_from_string(file.path));
+    if (content.error)
+    {
+        load_module_result const failure = {optional_value_empty, type_from_unit()};
+        return failure;
+    }
+    if (loader->on_module_read)
+    {
+        loader->on_module_read(unicode_view_from_string(file.path),
+                               unicode_view_create(content.success.data, content.success.length),
+                               loader->on_module_read_user);
+    }
+    uint64_t const content_hash = hash_bytes(hash_seed, content.success.data, content.success.length);
+    if (loader->cache)
+    {
+        cached_module *const cached =
+            module_cache_find(loader->cache, unicode_view_from_string(file.canonical_path), content_hash);
+        if (cached)
+        {
+            blob_free(&content.success);
+            return type_check_module(state, cached->parsed, &cached->source,
+                                     path_remove_leaf(unicode_view_from_string(cached->source.name)));
+        }
+    }
+    parsed_module_file parsed;
+    if (!parse_module_file(unicode_view_from_string(file.path), content.success, loader->on_parse_error,
+                           loader->on_parse_error_user, &parsed))
+    {
         load_module_result const failure = {optional_value_empty, type_from_unit()};
         return failure;
     }
-    source_file_owning *module_source = allocate(sizeof(*module_source));
-    *module_source = source_file_owning_create(attempt.full_module_path, source_loaded, lines);
-    attempt.full_module_path.data = NULL;
-    attempt.full_module_path.length = 0;
-    attempt.module_source.success.data = NULL;
-    attempt.module_source.success.length = 0;
+    if (loader->cache)
+    {
+        cached_module *const stored =
+            module_cache_store(loader->cache, unicode_view_copy(unicode_view_from_string(file.canonical_path)),
+                               content_hash, parsed.source, parsed.pool, parsed.parsed);
+        return type_check_module(
+            state, stored->parsed, &stored->source, path_remove_leaf(unicode_view_from_string(stored->source.name)));
+    }
+    source_file_owning *const module_source = allocate(sizeof(*module_source));
+    *module_source = parsed.source;
     program_check_add_module_source(state->root, module_source);
     load_module_result const result = type_check_module(
-        state, parsed, module_source, path_remove_leaf(unicode_view_from_string(module_source->name)));
-    sequence_free(&parsed);
-    expression_pool_free(pool);
-    import_attempt_result_free(attempt);
+        state, parsed.parsed, module_source, path_remove_leaf(unicode_view_from_string(module_source->name)));
+    sequence_free(&parsed.parsed);
+    expression_pool_free(parsed.pool);
     return result;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "lpg_module_cache.h"
 #include "lpg_parse_expression.h"
 #include "lpg_source_file.h"
 #include "lpg_value.h"
@@ -18,11 +19,25 @@ bool complete_parse_error_equals(complete_parse_error const left, complete_parse
 
 typedef void complete_parse_error_handler(complete_parse_error, callback_user);
 
+/*called with the path and the unmodified content of every module file that has been read*/
+typedef void module_read_handler(unicode_view path, unicode_view content, callback_user);
+
+/*called with every path that an import has looked for a module file at without finding one*/
+typedef void module_missing_handler(unicode_view path, callback_user);
+
 typedef struct module_loader
 {
     unicode_view module_directory;
     complete_parse_error_handler *on_parse_error;
     callback_user on_parse_error_user;
+    /*optional*/
+    module_read_handler *on_module_read;
+    callback_user on_module_read_user;
+    /*optional*/
+    module_missing_handler *on_module_missing;
+    callback_user on_module_missing_user;
+    /*optional, keeps the parsed modules for later checks*/
+    module_cache *cache;
 } module_loader;
 
 module_loader module_loader_create(unicode_view module_directory, complete_parse_error_handler on_parse_error,
@@ -36,4 +51,34 @@ typedef struct load_module_result
 
 struct function_checking_state;
 
-load_module_result load_module(LPG_NON_NULL(struct function_checking_state *const state), unicode_view const name);
+/*a module file that an import refers to*/
+typedef struct module_file
+{
+    /*where the file has been found, used in error messages*/
+    unicode_string path;
+    /*the same for every import directory the file can be found in*/
+    unicode_string canonical_path;
+} module_file;
+
+module_file module_file_create(unicode_string path, unicode_string canonical_path);
+void module_file_free(module_file const freed);
+
+/*looks in the module directory of the loader first and in the directory of the importing file second. Every place
+ * that is looked at without success is reported to on_module_missing.*/
+bool find_module_file(LPG_NON_NULL(module_loader const *const loader), unicode_view const current_import_directory,
+                      unicode_view const name, LPG_NON_NULL(module_file *const found)) LPG_USE_RESULT;
+
+typedef struct parsed_module_file
+{
+    source_file_owning source;
+    expression_pool pool;
+    /*refers to the content of the source*/
+    sequence parsed;
+} parsed_module_file;
+
+/*Takes ownership of the content. Returns false and reports the errors if the module cannot be parsed. This does not
+ * depend on a program, so it can be called by several threads at the same time.*/
+bool parse_module_file(unicode_view const path, blob content,
+                       LPG_NON_NULL(complete_parse_error_handler *const on_error), callback_user const on_error_user,
+                       LPG_NON_NULL(parsed_module_file *const parsed)) LPG_USE_RESULT;
+load_module_result load_module(LPG_NON_NULL(struct function_checking_state *const state), module_file const file);
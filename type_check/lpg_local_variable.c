@@ -1,6 +1,4 @@
 #include "lpg_local_variable.h"
-#include "lpg_allocate.h"
-#include "lpg_for.h"
 #include "lpg_function_checking_state.h"
 #include "lpg_instruction.h"
 #include <lpg_source_location.h>
@@ -9,7 +7,7 @@ local_variable local_variable_create(unicode_view name, local_variable_phase pha
                                      optional_value compile_time_value, register_id where,
                                      struct function_checking_state *lambda_origin)
 {
-    local_variable const result = {name, phase, type_, compile_time_value, where, lambda_origin};
+    local_variable const result = {name, 0, phase, type_, compile_time_value, where, lambda_origin};
     return result;
 }
 
@@ -18,89 +16,148 @@ void local_variable_free(local_variable const *const freed)
     (void)freed;
 }
 
+local_variable_container local_variable_container_create(identifier_table *const identifiers, arena *const memory)
+{
+    local_variable_container const result = {memory, NULL, 0, 0, identifiers, NULL, 0};
+    return result;
+}
+
 void local_variable_container_free(local_variable_container const freed)
 {
     for (size_t i = 0; i < freed.count; ++i)
     {
         local_variable_free(freed.elements + i);
     }
-    if (freed.elements)
+}
+
+/*returns the slot of the identifier or the unused slot where it would be inserted*/
+static size_t find_index_slot(local_variable_container const *const variables, identifier_id const identifier)
+{
+    size_t slot = (identifier & (variables->index_capacity - 1u));
+    while (variables->index[slot] && (variables->elements[variables->index[slot] - 1].identifier != identifier))
+    {
+        slot = ((slot + 1) & (variables->index_capacity - 1u));
+    }
+    return slot;
+}
+
+static void index_variable(local_variable_container *const variables, size_t const position)
+{
+    size_t const slot = find_index_slot(variables, variables->elements[position].identifier);
+    if (!variables->index[slot])
+    {
+        variables->index[slot] = (position + 1);
+    }
+}
+
+static void reserve_index(local_variable_container *const variables, size_t const count)
+{
+    if ((count * 2) <= variables->index_capacity)
     {
-        deallocate(freed.elements);
+        return;
+    }
+    variables->index_capacity = ((variables->index_capacity == 0) ? 16 : (variables->index_capacity * 2));
+    variables->index = arena_allocate_array(variables->memory, variables->index_capacity, sizeof(*variables->index));
+    /*the variables are indexed in the order they were added, so that removing the last one never breaks a chain of
+     * collisions*/
+    for (size_t i = 0; i < variables->count; ++i)
+    {
+        index_variable(variables, i);
     }
 }
 
 void add_local_variable(local_variable_container *to, local_variable variable)
 {
-    to->elements =
-        reallocate_array_exponentially(to->elements, to->count + 1, sizeof(*to->elements), to->count, &to->capacity);
+    variable.identifier = identifier_table_intern(to->identifiers, variable.name);
+    reserve_index(to, (to->count + 1));
+    to->elements = arena_reallocate_array_exponentially(
+        to->memory, to->elements, to->count + 1, sizeof(*to->elements), to->count, &to->capacity);
     to->elements[to->count] = variable;
+    index_variable(to, to->count);
     ++(to->count);
 }
 
-void local_variable_initialize(local_variable_container *variables, unicode_view name, type what,
-                               optional_value compile_time_value, register_id where)
+void local_variable_container_truncate(local_variable_container *const variables, size_t const count)
 {
-    LPG_FOR(size_t, i, variables->count)
+    ASSUME(count <= variables->count);
+    while (variables->count > count)
     {
-        local_variable *const variable = variables->elements + i;
-        if (unicode_view_equals(name, variable->name))
+        size_t const last = (variables->count - 1);
+        size_t const slot = find_index_slot(variables, variables->elements[last].identifier);
+        if (variables->index[slot] == (last + 1))
         {
-            switch (variable->phase)
-            {
-            case local_variable_phase_declared:
-            case local_variable_phase_early_initialized:
-            case local_variable_phase_lambda_being_checked:
-                variable->where = where;
-                variable->type_ = what;
-                variable->compile_time_value = compile_time_value;
-                variable->phase = local_variable_phase_initialized;
-                return;
-
-            case local_variable_phase_initialized:
-                LPG_UNREACHABLE();
-            }
+            variables->index[slot] = 0;
         }
+        local_variable_free(variables->elements + last);
+        variables->count = last;
     }
-    LPG_UNREACHABLE();
 }
 
-static local_variable *find_local_variable(local_variable_container *variables, unicode_view name)
+static local_variable *find_local_variable_by_identifier(local_variable_container const *const variables,
+                                                         identifier_id const identifier)
 {
-    LPG_FOR(size_t, i, variables->count)
+    if (variables->count == 0)
     {
-        local_variable *const variable = variables->elements + i;
-        if (unicode_view_equals(name, variable->name))
-        {
-            return variable;
-        }
+        return NULL;
     }
-    return NULL;
+    size_t const position = variables->index[find_index_slot(variables, identifier)];
+    if (!position)
+    {
+        return NULL;
+    }
+    return (variables->elements + position - 1);
+}
+
+local_variable *find_local_variable(local_variable_container const *const variables, unicode_view const name)
+{
+    optional_size const identifier = identifier_table_find(*variables->identifiers, name);
+    if (identifier.state == optional_empty)
+    {
+        return NULL;
+    }
+    return find_local_variable_by_identifier(variables, identifier.value_if_set);
+}
+
+void local_variable_initialize(local_variable_container *variables, unicode_view name, type what,
+                               optional_value compile_time_value, register_id where)
+{
+    local_variable *const variable = find_local_variable(variables, name);
+    ASSUME(variable);
+    switch (variable->phase)
+    {
+    case local_variable_phase_declared:
+    case local_variable_phase_early_initialized:
+    case local_variable_phase_lambda_being_checked:
+        variable->where = where;
+        variable->type_ = what;
+        variable->compile_time_value = compile_time_value;
+        variable->phase = local_variable_phase_initialized;
+        return;
+
+    case local_variable_phase_initialized:
+        LPG_UNREACHABLE();
+    }
+    LPG_UNREACHABLE();
 }
 
 void initialize_early(local_variable_container *variables, unicode_view name, type what,
                       optional_value compile_time_value, register_id where)
 {
-    LPG_FOR(size_t, i, variables->count)
+    local_variable *const variable = find_local_variable(variables, name);
+    ASSUME(variable);
+    switch (variable->phase)
     {
-        local_variable *const variable = variables->elements + i;
-        if (unicode_view_equals(name, variable->name))
-        {
-            switch (variable->phase)
-            {
-            case local_variable_phase_declared:
-                variable->where = where;
-                variable->type_ = what;
-                variable->compile_time_value = compile_time_value;
-                variable->phase = local_variable_phase_early_initialized;
-                return;
+    case local_variable_phase_declared:
+        variable->where = where;
+        variable->type_ = what;
+        variable->compile_time_value = compile_time_value;
+        variable->phase = local_variable_phase_early_initialized;
+        return;
 
-            case local_variable_phase_lambda_being_checked:
-            case local_variable_phase_initialized:
-            case local_variable_phase_early_initialized:
-                LPG_UNREACHABLE();
-            }
-        }
+    case local_variable_phase_lambda_being_checked:
+    case local_variable_phase_initialized:
+    case local_variable_phase_early_initialized:
+        LPG_UNREACHABLE();
     }
     LPG_UNREACHABLE();
 }
@@ -115,14 +172,7 @@ void initialize_lambda_being_checked(local_variable_container *variables, unicod
 
 bool local_variable_name_exists(local_variable_container const variables, unicode_view const name)
 {
-    LPG_FOR(size_t, i, variables.count)
-    {
-        if (unicode_view_equals(variables.elements[i].name, name))
-        {
-            return true;
-        }
-    }
-    return false;
+    return (find_local_variable(&variables, name) != NULL);
 }
 
 read_local_variable_result read_local_variable_result_create(read_local_variable_status status, variable_address where,
@@ -149,12 +199,80 @@ static read_local_variable_result read_lambda_being_checked(LPG_NON_NULL(functio
                                              what, /*TODO*/ optional_value_empty, true);
 }
 
-read_local_variable_result read_local_variable(LPG_NON_NULL(function_checking_state *const state),
-                                               unicode_view const name,
-                                               source_location const original_reference_location)
+outer_variable_cache outer_variable_cache_create(arena *const memory)
+{
+    outer_variable_cache const result = {memory, NULL, 0, 0};
+    return result;
+}
+
+static cached_outer_variable const *find_cached_outer_variable(outer_variable_cache const cache,
+                                                               identifier_id const name)
+{
+    if (cache.count == 0)
+    {
+        return NULL;
+    }
+    size_t slot = (name & (cache.capacity - 1u));
+    while (cache.entries[slot].is_used)
+    {
+        if (cache.entries[slot].name == name)
+        {
+            return (cache.entries + slot);
+        }
+        slot = ((slot + 1) & (cache.capacity - 1u));
+    }
+    return NULL;
+}
+
+static void insert_cached_outer_variable(outer_variable_cache *const cache, cached_outer_variable const inserted)
 {
+    size_t slot = (inserted.name & (cache->capacity - 1u));
+    while (cache->entries[slot].is_used)
     {
-        local_variable *const existing_variable = find_local_variable(&state->local_variables, name);
+        slot = ((slot + 1) & (cache->capacity - 1u));
+    }
+    cache->entries[slot] = inserted;
+    ++(cache->count);
+}
+
+static void cache_outer_variable(outer_variable_cache *const cache, identifier_id const name,
+                                 read_local_variable_result const read)
+{
+    ASSUME(read.compile_time_value.is_set);
+    if (((cache->count + 1) * 2) > cache->capacity)
+    {
+        outer_variable_cache const old = *cache;
+        cache->capacity = ((old.capacity == 0) ? 16 : (old.capacity * 2));
+        cache->entries = arena_allocate_array(cache->memory, cache->capacity, sizeof(*cache->entries));
+        cache->count = 0;
+        for (size_t i = 0; i < old.capacity; ++i)
+        {
+            if (old.entries[i].is_used)
+            {
+                insert_cached_outer_variable(cache, old.entries[i]);
+            }
+        }
+    }
+    cached_outer_variable const inserted = {name, read.what, read.compile_time_value.value_, read.is_pure, true};
+    insert_cached_outer_variable(cache, inserted);
+}
+
+static read_local_variable_result read_compile_time_value(type const what, value const compile_time_value,
+                                                          bool const is_pure)
+{
+    return read_local_variable_result_create(read_local_variable_status_compile_time_value,
+                                             variable_address_from_local(~(register_id)0), what,
+                                             optional_value_create(compile_time_value), is_pure);
+}
+
+/*is_final is set to whether the variable that was found cannot change anymore*/
+static read_local_variable_result read_identifier(function_checking_state *const state, identifier_id const name,
+                                                  source_location const original_reference_location,
+                                                  bool *const is_final)
+{
+    *is_final = false;
+    {
+        local_variable *const existing_variable = find_local_variable_by_identifier(&state->local_variables, name);
         if (existing_variable)
         {
             switch (existing_variable->phase)
@@ -164,6 +282,7 @@ read_local_variable_result read_local_variable(LPG_NON_NULL(function_checking_st
 
             case local_variable_phase_early_initialized:
             case local_variable_phase_initialized:
+                *is_final = (existing_variable->phase == local_variable_phase_initialized);
                 return read_local_variable_result_create(
                     read_local_variable_status_at_address, variable_address_from_local(existing_variable->where),
                     existing_variable->type_, existing_variable->compile_time_value, true);
@@ -177,8 +296,16 @@ read_local_variable_result read_local_variable(LPG_NON_NULL(function_checking_st
     {
         return read_local_variable_result_unknown;
     }
+    {
+        cached_outer_variable const *const cached = find_cached_outer_variable(state->outer_variables, name);
+        if (cached)
+        {
+            *is_final = true;
+            return read_compile_time_value(cached->what, cached->compile_time_value, cached->is_pure);
+        }
+    }
     read_local_variable_result const outer_variable =
-        read_local_variable(state->parent, name, original_reference_location);
+        read_identifier(state->parent, name, original_reference_location, is_final);
     switch (outer_variable.status)
     {
     case read_local_variable_status_forbidden:
@@ -189,13 +316,20 @@ read_local_variable_result read_local_variable(LPG_NON_NULL(function_checking_st
         break;
 
     case read_local_variable_status_compile_time_value:
+        if (*is_final)
+        {
+            cache_outer_variable(&state->outer_variables, name, outer_variable);
+        }
         return outer_variable;
     }
     if (outer_variable.compile_time_value.is_set)
     {
-        return read_local_variable_result_create(read_local_variable_status_compile_time_value,
-                                                 variable_address_from_local(~(register_id)0), outer_variable.what,
-                                                 outer_variable.compile_time_value, outer_variable.is_pure);
+        if (*is_final)
+        {
+            cache_outer_variable(&state->outer_variables, name, outer_variable);
+        }
+        return read_compile_time_value(
+            outer_variable.what, outer_variable.compile_time_value.value_, outer_variable.is_pure);
     }
     if (!state->may_capture_runtime_variables)
     {
@@ -208,3 +342,17 @@ read_local_variable_result read_local_variable(LPG_NON_NULL(function_checking_st
                                              variable_address_from_capture(existing_capture), outer_variable.what,
                                              outer_variable.compile_time_value, outer_variable.is_pure);
 }
+
+read_local_variable_result read_local_variable(LPG_NON_NULL(function_checking_state *const state),
+                                               unicode_view const name,
+                                               source_location const original_reference_location)
+{
+    /*every local variable has an interned name*/
+    optional_size const identifier = identifier_table_find(state->root->identifiers, name);
+    if (identifier.state == optional_empty)
+    {
+        return read_local_variable_result_unknown;
+    }
+    bool is_final = false;
+    return read_identifier(state, identifier.value_if_set, original_reference_location, &is_final);
+}
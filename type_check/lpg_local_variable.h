@@ -1,5 +1,7 @@
 #pragma once
+#include "lpg_arena.h"
 #include "lpg_captures.h"
+#include "lpg_identifier_table.h"
 #include "lpg_register.h"
 #include "lpg_source_location.h"
 #include "lpg_value.h"
@@ -14,6 +16,8 @@ typedef enum local_variable_phase {
 typedef struct local_variable
 {
     unicode_view name;
+    /*set by add_local_variable*/
+    identifier_id identifier;
     local_variable_phase phase;
     type type_;
     optional_value compile_time_value;
@@ -27,14 +31,27 @@ local_variable local_variable_create(unicode_view name, local_variable_phase pha
 
 void local_variable_free(local_variable const *const freed);
 
+/*The elements and the index are allocated from the arena of the function.*/
 typedef struct local_variable_container
 {
+    arena *memory;
     local_variable *elements;
     size_t count;
     size_t capacity;
+    identifier_table *identifiers;
+    /*An open addressing hash table of the positions of the elements plus one keyed by their identifiers. 0 is an unused
+     * slot. If a name occurs more than once, the first variable with that name is found.*/
+    size_t *index;
+    size_t index_capacity;
 } local_variable_container;
 
+local_variable_container local_variable_container_create(LPG_NON_NULL(identifier_table *const identifiers),
+                                                         LPG_NON_NULL(arena *const memory)) LPG_USE_RESULT;
 void local_variable_container_free(local_variable_container const freed);
+/*removes the variables that have been added after the first count variables*/
+void local_variable_container_truncate(LPG_NON_NULL(local_variable_container *const variables), size_t const count);
+local_variable *find_local_variable(LPG_NON_NULL(local_variable_container const *const variables),
+                                    unicode_view const name) LPG_USE_RESULT;
 
 typedef enum read_local_variable_status {
     read_local_variable_status_at_address = 1,
@@ -56,19 +73,42 @@ typedef struct read_local_variable_result
 static read_local_variable_result const read_local_variable_result_unknown = {read_local_variable_status_unknown,
                                                                               {{false, 0}, 0},
                                                                               {type_kind_unit, {0}},
-                                                                              {false, {value_kind_unit, {{NULL, 0}}}},
+                                                                              {false, {value_kind_unit, {0}, {0}}},
                                                                               false};
 
 static read_local_variable_result const read_local_variable_result_forbidden = {read_local_variable_status_forbidden,
                                                                                 {{false, 0}, 0},
                                                                                 {type_kind_unit, {0}},
-                                                                                {false, {value_kind_unit, {{NULL, 0}}}},
+                                                                                {false, {value_kind_unit, {0}, {0}}},
                                                                                 false};
 
 read_local_variable_result read_local_variable_result_create(read_local_variable_status status, variable_address where,
                                                              type what, optional_value compile_time_value,
                                                              bool is_pure);
 
+typedef struct cached_outer_variable
+{
+    identifier_id name;
+    type what;
+    value compile_time_value;
+    bool is_pure;
+    bool is_used;
+} cached_outer_variable;
+
+/*The compile time values of the variables of enclosing functions that a function has already read. A variable that is
+ * fully initialized cannot change anymore, so the function does not have to look it up in every enclosing function
+ * again.*/
+typedef struct outer_variable_cache
+{
+    /*the entries are allocated from the arena of the function*/
+    arena *memory;
+    cached_outer_variable *entries;
+    size_t capacity;
+    size_t count;
+} outer_variable_cache;
+
+outer_variable_cache outer_variable_cache_create(LPG_NON_NULL(arena *const memory)) LPG_USE_RESULT;
+
 struct function_checking_state;
 read_local_variable_result read_local_variable(LPG_NON_NULL(struct function_checking_state *const state),
                                                unicode_view const name,
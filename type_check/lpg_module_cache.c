@@ -0,0 +1,169 @@
+#include "lpg_module_cache.h"
+#include "lpg_allocate.h"
+#include "lpg_hash.h"
+
+module_cache module_cache_create(void)
+{
+    module_cache const result = {NULL, 0, position_index_create(), 0};
+    return result;
+}
+
+module_imports module_imports_create(void)
+{
+    module_imports const result = {NULL, 0};
+    return result;
+}
+
+void module_imports_free(module_imports const freed)
+{
+    for (size_t i = 0; i < freed.count; ++i)
+    {
+        unicode_string_free(&freed.elements[i]);
+    }
+    if (freed.elements)
+    {
+        deallocate(freed.elements);
+    }
+}
+
+void module_imports_add(module_imports *const to, unicode_view const canonical_path)
+{
+    for (size_t i = 0; i < to->count; ++i)
+    {
+        if (unicode_view_equals(unicode_view_from_string(to->elements[i]), canonical_path))
+        {
+            return;
+        }
+    }
+    to->elements = reallocate_array(to->elements, (to->count + 1), sizeof(*to->elements));
+    to->elements[to->count] = unicode_view_copy(canonical_path);
+    ++(to->count);
+}
+
+module_imports module_imports_copy(module_imports const original)
+{
+    module_imports result = module_imports_create();
+    for (size_t i = 0; i < original.count; ++i)
+    {
+        module_imports_add(&result, unicode_view_from_string(original.elements[i]));
+    }
+    return result;
+}
+
+bool module_imports_equals(module_imports const left, module_imports const right)
+{
+    if (left.count != right.count)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < left.count; ++i)
+    {
+        if (!unicode_view_equals(
+                unicode_view_from_string(left.elements[i]), unicode_view_from_string(right.elements[i])))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void cached_module_free(cached_module *const freed)
+{
+    unicode_string_free(&freed->canonical_path);
+    source_file_owning_free(freed->source);
+    sequence_free(&freed->parsed);
+    expression_pool_free(freed->pool);
+    module_imports_free(freed->imports);
+    deallocate(freed);
+}
+
+void module_cache_free(module_cache const freed)
+{
+    for (size_t i = 0; i < freed.count; ++i)
+    {
+        cached_module_free(freed.entries[i]);
+    }
+    if (freed.entries)
+    {
+        deallocate(freed.entries);
+    }
+    position_index_free(freed.index);
+}
+
+typedef struct path_comparison
+{
+    module_cache const *cache;
+    unicode_view canonical_path;
+} path_comparison;
+
+static bool has_path(void const *user, size_t const position)
+{
+    path_comparison const *const comparison = user;
+    return unicode_view_equals(
+        unicode_view_from_string(comparison->cache->entries[position]->canonical_path), comparison->canonical_path);
+}
+
+static optional_size find_path(module_cache const *const cache, unicode_view const canonical_path)
+{
+    path_comparison const comparison = {cache, canonical_path};
+    return position_index_find(
+        cache->index, hash_bytes(hash_seed, canonical_path.begin, canonical_path.length), has_path, &comparison);
+}
+
+cached_module *module_cache_latest(module_cache const *const cache, unicode_view const canonical_path)
+{
+    optional_size const found = find_path(cache, canonical_path);
+    if (found.state == optional_empty)
+    {
+        return NULL;
+    }
+    return cache->entries[found.value_if_set];
+}
+
+cached_module *module_cache_lookup(module_cache const *const cache, unicode_view const canonical_path,
+                                   uint64_t const content_hash)
+{
+    cached_module *const entry = module_cache_latest(cache, canonical_path);
+    if (!entry || (entry->content_hash != content_hash))
+    {
+        return NULL;
+    }
+    return entry;
+}
+
+cached_module *module_cache_find(module_cache *const cache, unicode_view const canonical_path,
+                                 uint64_t const content_hash)
+{
+    cached_module *const entry = module_cache_lookup(cache, canonical_path, content_hash);
+    if (entry)
+    {
+        ++(cache->hits);
+    }
+    return entry;
+}
+
+cached_module *module_cache_store(module_cache *const cache, unicode_string canonical_path,
+                                  uint64_t const content_hash, source_file_owning source, expression_pool pool,
+                                  sequence parsed)
+{
+    cached_module *const stored = allocate(sizeof(*stored));
+    stored->canonical_path = canonical_path;
+    stored->content_hash = content_hash;
+    stored->source = source;
+    stored->pool = pool;
+    stored->parsed = parsed;
+    stored->imports = module_imports_create();
+    optional_size const existing = find_path(cache, unicode_view_from_string(canonical_path));
+    if (existing.state == optional_set)
+    {
+        cached_module_free(cache->entries[existing.value_if_set]);
+        cache->entries[existing.value_if_set] = stored;
+        return stored;
+    }
+    cache->entries = reallocate_array(cache->entries, (cache->count + 1), sizeof(*cache->entries));
+    cache->entries[cache->count] = stored;
+    position_index_insert(
+        &cache->index, hash_bytes(hash_seed, canonical_path.data, canonical_path.length), cache->count);
+    ++(cache->count);
+    return stored;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "lpg_expression.h"
+#include "lpg_expression_pool.h"
+#include "lpg_position_index.h"
+#include "lpg_source_file.h"
+
+/*the canonical paths of the module files that a module imports*/
+typedef struct module_imports
+{
+    unicode_string *elements;
+    size_t count;
+} module_imports;
+
+module_imports module_imports_create(void) LPG_USE_RESULT;
+void module_imports_free(module_imports const freed);
+/*does nothing if the import has already been added*/
+void module_imports_add(LPG_NON_NULL(module_imports *const to), unicode_view const canonical_path);
+module_imports module_imports_copy(module_imports const original) LPG_USE_RESULT;
+bool module_imports_equals(module_imports const left, module_imports const right) LPG_USE_RESULT;
+
+/*A module file that has been read and parsed without errors. The parsed sequence refers to the content of the
+ * source.*/
+typedef struct cached_module
+{
+    unicode_string canonical_path;
+    /*hash_bytes of the content as it was read from the file*/
+    uint64_t content_hash;
+    source_file_owning source;
+    expression_pool pool;
+    sequence parsed;
+    /*the imports as prefetch_modules has found them the last time, so that a change of a module can be traced to the
+     * modules that import it*/
+    module_imports imports;
+} cached_module;
+
+/*Keeps parsed modules across the checks of different programs, so a module is only parsed again when the content of
+ * its file has changed. The checked module values are not cached because they refer to the functions and types of one
+ * program. The cache has to outlive every check that uses it and must not be used by two checks at the same time.*/
+typedef struct module_cache
+{
+    /*pointers so that the sources keep their addresses*/
+    cached_module **entries;
+    size_t count;
+    /*the hash of the canonical path of every entry*/
+    position_index index;
+    /*how often a module did not have to be parsed again*/
+    size_t hits;
+} module_cache;
+
+module_cache module_cache_create(void) LPG_USE_RESULT;
+void module_cache_free(module_cache const freed);
+/*returns NULL if the file has never been stored or if its content has changed since*/
+cached_module *module_cache_find(LPG_NON_NULL(module_cache *const cache), unicode_view const canonical_path,
+                                 uint64_t const content_hash) LPG_USE_RESULT;
+/*returns the version of the file that has been stored most recently or NULL if the file has never been stored*/
+cached_module *module_cache_latest(LPG_NON_NULL(module_cache const *const cache),
+                                   unicode_view const canonical_path) LPG_USE_RESULT;
+/*like module_cache_find, but it does not count a hit, so several threads can look up modules at the same time while
+ * the cache is not being changed*/
+cached_module *module_cache_lookup(LPG_NON_NULL(module_cache const *const cache), unicode_view const canonical_path,
+                                   uint64_t const content_hash) LPG_USE_RESULT;
+/*takes ownership of the arguments and replaces an older version of the same file*/
+cached_module *module_cache_store(LPG_NON_NULL(module_cache *const cache), unicode_string canonical_path,
+                                  uint64_t const content_hash, source_file_owning source, expression_pool pool,
+                                  sequence parsed) LPG_USE_RESULT;
@@ -0,0 +1,330 @@
+#include "lpg_prefetch_modules.h"
+#include "lpg_allocate.h"
+#include "lpg_assert.h"
+#include "lpg_hash.h"
+#include "lpg_identifier_table.h"
+#include "lpg_path.h"
+#include "lpg_read_file.h"
+#include "lpg_worker_pool.h"
+
+typedef struct prefetch_job
+{
+    module_file file;
+    /*the cached module if the file has not changed since it was parsed*/
+    cached_module *unchanged;
+    uint64_t content_hash;
+    bool is_parsed;
+    parsed_module_file parsed;
+} prefetch_job;
+
+/*the modules that have not been parsed yet*/
+typedef struct prefetch_wave
+{
+    prefetch_job *jobs;
+    size_t count;
+    size_t capacity;
+} prefetch_wave;
+
+typedef struct import_scan
+{
+    module_loader const *loader;
+    unicode_view import_directory;
+    /*the canonical paths of all modules found so far, so that every module is parsed once*/
+    identifier_table *found;
+    /*NULL if the imported modules are not going to be parsed*/
+    prefetch_wave *next;
+    /*receives the imports of the scanned module, NULL if they are not needed*/
+    module_imports *imports;
+} import_scan;
+
+static void add_import(import_scan const *const scan, unicode_view const name)
+{
+    module_file file;
+    if (!find_module_file(scan->loader, scan->import_directory, name, &file))
+    {
+        return;
+    }
+    if (scan->imports)
+    {
+        module_imports_add(scan->imports, unicode_view_from_string(file.canonical_path));
+    }
+    if (!scan->next)
+    {
+        module_file_free(file);
+        return;
+    }
+    size_t const found_before = scan->found->count;
+    if (identifier_table_intern(scan->found, unicode_view_from_string(file.canonical_path)) < found_before)
+    {
+        module_file_free(file);
+        return;
+    }
+    prefetch_wave *const next = scan->next;
+    next->jobs = reallocate_array_exponentially(
+        next->jobs, (next->count + 1), sizeof(*next->jobs), next->count, &next->capacity);
+    prefetch_job *const job = &next->jobs[next->count];
+    job->file = file;
+    job->unchanged = NULL;
+    job->content_hash = 0;
+    job->is_parsed = false;
+    ++(next->count);
+}
+
+static void scan_expression(import_scan const *const scan, expression const *const scanned);
+
+static void scan_optional_expression(import_scan const *const scan, expression const *const scanned)
+{
+    if (scanned)
+    {
+        scan_expression(scan, scanned);
+    }
+}
+
+static void scan_sequence(import_scan const *const scan, sequence const scanned)
+{
+    for (size_t i = 0; i < scanned.length; ++i)
+    {
+        scan_expression(scan, &scanned.elements[i]);
+    }
+}
+
+static void scan_tuple(import_scan const *const scan, tuple const scanned)
+{
+    for (size_t i = 0; i < scanned.length; ++i)
+    {
+        scan_expression(scan, &scanned.elements[i]);
+    }
+}
+
+static void scan_header(import_scan const *const scan, function_header_tree const scanned)
+{
+    for (size_t i = 0; i < scanned.parameter_count; ++i)
+    {
+        scan_expression(scan, scanned.parameters[i].type);
+    }
+    scan_optional_expression(scan, scanned.return_type);
+}
+
+/*Imports can appear in any expression, although most modules import at the top level.*/
+static void scan_expression(import_scan const *const scan, expression const *const scanned)
+{
+    switch (scanned->type)
+    {
+    case expression_type_import:
+        add_import(scan, scanned->import.name.value);
+        return;
+
+    case expression_type_lambda:
+        scan_header(scan, scanned->lambda.header);
+        scan_expression(scan, scanned->lambda.result);
+        return;
+
+    case expression_type_call:
+        scan_expression(scan, scanned->call.callee);
+        scan_tuple(scan, scanned->call.arguments);
+        return;
+
+    case expression_type_access_structure:
+        scan_expression(scan, scanned->access_structure.object);
+        return;
+
+    case expression_type_match:
+        scan_expression(scan, scanned->match.input);
+        for (size_t i = 0; i < scanned->match.number_of_cases; ++i)
+        {
+            scan_optional_expression(scan, scanned->match.cases[i].key_or_default);
+            scan_expression(scan, scanned->match.cases[i].action);
+        }
+        return;
+
+    case expression_type_not:
+        scan_expression(scan, scanned->not.expr);
+        return;
+
+    case expression_type_binary:
+        scan_expression(scan, scanned->binary.left);
+        scan_expression(scan, scanned->binary.right);
+        return;
+
+    case expression_type_return:
+        scan_expression(scan, scanned->return_);
+        return;
+
+    case expression_type_loop:
+        scan_sequence(scan, scanned->loop_body);
+        return;
+
+    case expression_type_break:
+        scan_optional_expression(scan, scanned->break_.value);
+        return;
+
+    case expression_type_sequence:
+        scan_sequence(scan, scanned->sequence);
+        return;
+
+    case expression_type_declare:
+        scan_optional_expression(scan, scanned->declare.optional_type);
+        scan_expression(scan, scanned->declare.initializer);
+        return;
+
+    case expression_type_interface:
+        for (size_t i = 0; i < scanned->interface_.method_count; ++i)
+        {
+            scan_header(scan, scanned->interface_.methods[i].header);
+        }
+        return;
+
+    case expression_type_struct:
+        for (size_t i = 0; i < scanned->struct_.element_count; ++i)
+        {
+            scan_expression(scan, &scanned->struct_.elements[i].type);
+        }
+        return;
+
+    case expression_type_impl:
+        scan_expression(scan, scanned->impl.interface_);
+        scan_expression(scan, scanned->impl.self);
+        for (size_t i = 0; i < scanned->impl.method_count; ++i)
+        {
+            scan_header(scan, scanned->impl.methods[i].header);
+            scan_sequence(scan, scanned->impl.methods[i].body);
+        }
+        return;
+
+    case expression_type_instantiate_struct:
+        scan_expression(scan, scanned->instantiate_struct.type);
+        scan_tuple(scan, scanned->instantiate_struct.arguments);
+        return;
+
+    case expression_type_enum:
+        for (enum_element_id i = 0; i < scanned->enum_.element_count; ++i)
+        {
+            scan_optional_expression(scan, scanned->enum_.elements[i].state);
+        }
+        return;
+
+    case expression_type_generic_instantiation:
+        scan_expression(scan, scanned->generic_instantiation.generic);
+        for (size_t i = 0; i < scanned->generic_instantiation.count; ++i)
+        {
+            scan_expression(scan, &scanned->generic_instantiation.arguments[i]);
+        }
+        return;
+
+    case expression_type_type_of:
+        scan_expression(scan, scanned->type_of.target);
+        return;
+
+    case expression_type_new_array:
+        scan_expression(scan, scanned->new_array.element);
+        return;
+
+    case expression_type_integer_literal:
+    case expression_type_string:
+    case expression_type_identifier:
+    case expression_type_comment:
+    case expression_type_placeholder:
+        return;
+    }
+    LPG_UNREACHABLE();
+}
+
+static void ignore_parse_error(complete_parse_error error, callback_user user)
+{
+    (void)error;
+    (void)user;
+}
+
+typedef struct prefetch_state
+{
+    module_cache const *cache;
+    prefetch_job *jobs;
+} prefetch_state;
+
+/*runs on the worker threads, so it only reads the cache*/
+static void prefetch(void *user, size_t const job, size_t const worker)
+{
+    (void)worker;
+    prefetch_state const *const state = user;
+    prefetch_job *const prefetched = &state->jobs[job];
+    blob_or_error const content = read_file_unicode_view_name(unicode_view_from_string(prefetched->file.path));
+    if (content.error)
+    {
+        return;
+    }
+    prefetched->content_hash = hash_bytes(hash_seed, content.success.data, content.success.length);
+    prefetched->unchanged = module_cache_lookup(
+        state->cache, unicode_view_from_string(prefetched->file.canonical_path), prefetched->content_hash);
+    if (prefetched->unchanged)
+    {
+        blob_free(&content.success);
+        return;
+    }
+    prefetched->is_parsed = parse_module_file(unicode_view_from_string(prefetched->file.path), content.success,
+                                              ignore_parse_error, NULL, &prefetched->parsed);
+}
+
+module_imports find_imports(module_loader const *const loader, sequence const root, unicode_view const import_directory)
+{
+    module_loader quiet = *loader;
+    quiet.on_module_missing = NULL;
+    module_imports result = module_imports_create();
+    import_scan const scan = {&quiet, import_directory, NULL, NULL, &result};
+    scan_sequence(&scan, root);
+    return result;
+}
+
+void prefetch_modules(module_loader const *const loader, sequence const root, unicode_view const import_directory,
+                      size_t const worker_count)
+{
+    ASSUME(loader->cache);
+    ASSUME(worker_count >= 1);
+    /*the imports are only reported when the checker resolves them*/
+    module_loader quiet = *loader;
+    quiet.on_module_missing = NULL;
+    identifier_table found = identifier_table_create();
+    prefetch_wave current = {NULL, 0, 0};
+    {
+        import_scan const scan = {&quiet, import_directory, &found, &current, NULL};
+        scan_sequence(&scan, root);
+    }
+    /*the modules imported by a module can only be found after the module has been parsed*/
+    while (current.count > 0)
+    {
+        prefetch_state state = {loader->cache, current.jobs};
+        worker_pool_run(prefetch, &state, current.count, worker_count);
+        prefetch_wave next = {NULL, 0, 0};
+        for (size_t i = 0; i < current.count; ++i)
+        {
+            prefetch_job const *const job = &current.jobs[i];
+            cached_module *parsed = job->unchanged;
+            if (job->is_parsed)
+            {
+                parsed = module_cache_store(
+                    loader->cache, unicode_view_copy(unicode_view_from_string(job->file.canonical_path)),
+                    job->content_hash, job->parsed.source, job->parsed.pool, job->parsed.parsed);
+            }
+            if (parsed)
+            {
+                /*the imports of an unchanged module are found again because a new file can take the place of an
+                 * imported one*/
+                module_imports_free(parsed->imports);
+                parsed->imports = module_imports_create();
+                import_scan const scan = {&quiet, path_remove_leaf(unicode_view_from_string(parsed->source.name)),
+                                          &found, &next, &parsed->imports};
+                scan_sequence(&scan, parsed->parsed);
+            }
+            module_file_free(job->file);
+        }
+        if (current.jobs)
+        {
+            deallocate(current.jobs);
+        }
+        current = next;
+    }
+    if (current.jobs)
+    {
+        deallocate(current.jobs);
+    }
+    identifier_table_free(found);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "lpg_load_module.h"
+
+/*Reads and parses every module that the program imports directly or indirectly and stores it in the cache of the
+ * loader, so that check finds the modules already parsed. The files are parsed by worker_count threads including the
+ * calling thread. A module that cannot be parsed is left to check which reports the errors. The imports that are
+ * found in a module are recorded in its cache entry.*/
+void prefetch_modules(LPG_NON_NULL(module_loader const *const loader), sequence const root,
+                      unicode_view const import_directory, size_t const worker_count);
+
+/*Finds the module files that the sequence imports directly like prefetch_modules does, but without reading them. The
+ * places where an import did not find a file are not reported.*/
+module_imports find_imports(LPG_NON_NULL(module_loader const *const loader), sequence const root,
+                            unicode_view const import_directory) LPG_USE_RESULT;
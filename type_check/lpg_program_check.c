@@ -27,10 +27,6 @@ void program_check_free(program_check const freed)
     {
         deallocate(freed.generic_structs);
     }
-    for (size_t i = 0; i < freed.enum_instantiation_count; ++i)
-    {
-        generic_enum_instantiation_free(freed.enum_instantiations[i]);
-    }
     for (size_t i = 0; i < freed.generic_lambda_count; ++i)
     {
         generic_lambda_free(freed.generic_lambdas[i]);
@@ -43,26 +39,14 @@ void program_check_free(program_check const freed)
     {
         deallocate(freed.enum_instantiations);
     }
-    for (size_t i = 0; i < freed.interface_instantiation_count; ++i)
-    {
-        generic_interface_instantiation_free(freed.interface_instantiations[i]);
-    }
     if (freed.interface_instantiations)
     {
         deallocate(freed.interface_instantiations);
     }
-    for (size_t i = 0; i < freed.struct_instantiation_count; ++i)
-    {
-        generic_struct_instantiation_free(freed.struct_instantiations[i]);
-    }
     if (freed.struct_instantiations)
     {
         deallocate(freed.struct_instantiations);
     }
-    for (size_t i = 0; i < freed.lambda_instantiation_count; ++i)
-    {
-        generic_lambda_instantiation_free(freed.lambda_instantiations[i]);
-    }
     if (freed.lambda_instantiations)
     {
         deallocate(freed.lambda_instantiations);
@@ -96,6 +80,14 @@ void program_check_free(program_check const freed)
     {
         deallocate(freed.module_sources);
     }
+    instantiation_index_free(freed.enum_instantiation_index);
+    instantiation_index_free(freed.interface_instantiation_index);
+    instantiation_index_free(freed.lambda_instantiation_index);
+    instantiation_index_free(freed.struct_instantiation_index);
+    compile_time_call_cache_free(freed.call_cache);
+    identifier_table_free(freed.identifiers);
+    arena_free(freed.memory);
+    arena_pool_free(freed.function_memory);
 }
 
 void begin_load_module(program_check *to, unicode_string name)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "lpg_arena.h"
+#include "lpg_compile_time_call_cache.h"
 #include "lpg_generic_enum.h"
 #include "lpg_generic_enum_id.h"
 #include "lpg_generic_enum_instantiation.h"
@@ -14,6 +16,8 @@
 #include "lpg_generic_struct.h"
 #include "lpg_generic_struct_id.h"
 #include "lpg_generic_struct_instantiation.h"
+#include "lpg_identifier_table.h"
+#include "lpg_instantiation_index.h"
 #include "lpg_interpret.h"
 #include "lpg_load_module.h"
 #include "lpg_module.h"
@@ -24,18 +28,26 @@ typedef struct program_check
     generic_enum_id generic_enum_count;
     generic_enum_instantiation *enum_instantiations;
     size_t enum_instantiation_count;
+    size_t enum_instantiation_capacity;
+    instantiation_index enum_instantiation_index;
     generic_interface *generic_interfaces;
     generic_interface_id generic_interface_count;
     generic_interface_instantiation *interface_instantiations;
     size_t interface_instantiation_count;
+    size_t interface_instantiation_capacity;
+    instantiation_index interface_instantiation_index;
     generic_lambda *generic_lambdas;
     generic_lambda_id generic_lambda_count;
     generic_lambda_instantiation *lambda_instantiations;
     size_t lambda_instantiation_count;
+    size_t lambda_instantiation_capacity;
+    instantiation_index lambda_instantiation_index;
     generic_struct *generic_structs;
     generic_struct_id generic_struct_count;
     generic_struct_instantiation *struct_instantiations;
     size_t struct_instantiation_count;
+    size_t struct_instantiation_capacity;
+    instantiation_index struct_instantiation_index;
     module *modules;
     size_t module_count;
     module_loader *loader;
@@ -49,6 +61,13 @@ typedef struct program_check
     source_file_owning **module_sources;
     size_t module_source_count;
     expression_pool *pool;
+    compile_time_call_cache call_cache;
+    /*the names of all local variables*/
+    identifier_table identifiers;
+    /*data that is only needed while the program is being checked, like the arguments of the instantiations*/
+    arena memory;
+    /*the arenas of the functions that are being checked*/
+    arena_pool function_memory;
 } program_check;
 
 void program_check_free(program_check const freed);